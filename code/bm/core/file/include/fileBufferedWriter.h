@@ -0,0 +1,114 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "fileWriter.h"
+#include "bm/core/system/include/mutex.h"
+#include "bm/core/system/include/conditionVariable.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+/// setup of the buffered writer
+struct FileBufferedWriterSetup
+{
+    uint32_t blockSize = 1U << 20; // size of single staging block, small writes are coalesced into it
+    uint32_t directWriteThreshold = 256U << 10; // (sync mode only) writes bigger than this are not copied but written together with the staged data in one vectored write
+    uint32_t maxPendingBlocks = 8; // (write-behind only) maximum number of filled blocks waiting to be written, bounds the memory use, writes block when exceeded
+
+    bool writeBehind = false; // filled blocks are written on a background task, the writing thread only copies memory
+    bool atomicCommit = false; // (only when opened via Open) data is written to a temporary file that replaces the target file on commit()
+    bool syncToDisk = false; // ask the OS to commit data to the physical disk on commit() (fdatasync)
+};
+
+//--
+
+/// buffered writer that sits on top of other writer, coalesces small writes into big blocks and can write them in the background
+/// NOTE: all data is flushed on seek/read (so those are expensive), final flush happens in commit() or in destructor
+class BM_CORE_FILE_API FileBufferedWriter : public IFileWriter
+{
+public:
+    FileBufferedWriter(FileWriterPtr target, const FileBufferedWriterSetup& setup = FileBufferedWriterSetup());
+    virtual ~FileBufferedWriter();
+
+    //--
+
+    //! get the writer we are writing to
+    INLINE const FileWriterPtr& target() const { return m_target; }
+
+    //! setup we use
+    INLINE const FileBufferedWriterSetup& setup() const { return m_setup; }
+
+    //! did any of the writes fail ? once that happens all further writes are ignored
+    INLINE bool failed() const { return m_failed.load(); }
+
+    //! was the content committed already
+    INLINE bool committed() const { return m_committed; }
+
+    //--
+
+    //! flush all data, optionally sync it to disk and (in atomic mode) replace target file with the written content
+    //! NOTE: writer can't be used after commit, returns false if any of the writes failed (in atomic mode the target file is left intact in that case)
+    bool commit();
+
+    //! discard all data, in atomic mode the temporary file is deleted and target file is left intact
+    void discard();
+
+    //--
+    // IFileWriter
+
+    virtual uint64_t size() const override final;
+    virtual uint64_t pos() const override final;
+    virtual void seek(uint64_t offset) override final;
+
+    virtual uint64_t readSync(void* ptr, uint64_t size) override final;
+    virtual uint64_t writeSync(const void* ptr, uint64_t size) override final;
+    virtual uint64_t writeVectorSync(ArrayView<BufferView> blocks) override final;
+    virtual bool flushSync(bool toDisk) override final;
+
+    //--
+
+    //! open file for buffered writing, in atomic mode the content is written to a temporary file next to the target and renamed on commit()
+    static FileBufferedWriterPtr Open(StringView absoluteFilePath, const FileBufferedWriterSetup& setup = FileBufferedWriterSetup(), IFileSystem& fs = FileSystem());
+
+private:
+    struct Block;
+
+    FileWriterPtr m_target;
+    FileBufferedWriterSetup m_setup;
+
+    uint64_t m_pos = 0;
+    uint64_t m_size = 0;
+
+    Block* m_activeBlock = nullptr;
+
+    Mutex m_lock;
+    ConditionVariable m_blockReturned;
+    Array<Block*> m_pendingBlocks; // waiting for the background write, in order
+    Array<Block*> m_freeBlocks;
+    uint32_t m_numAllocatedBlocks = 0;
+    bool m_backgroundWriteRunning = false;
+
+    std::atomic<bool> m_failed = false;
+    bool m_committed = false;
+
+    IFileSystem* m_fileSystem = nullptr; // only in atomic mode
+    StringBuf m_targetPath;
+    StringBuf m_tempPath;
+
+    Block* allocBlock();
+    void submitActiveBlock();
+    void waitForPendingWrites();
+    void writeBlocks(ArrayView<Block*> blocks);
+    void processPendingBlocks();
+    void drain();
+};
+
+//--
+
+END_INFERNO_NAMESPACE()
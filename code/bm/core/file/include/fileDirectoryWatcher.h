@@ -39,6 +39,9 @@ public:
 
     /// handle file event
     virtual void handleEvent(const DirectoryWatcherEvent& evt) = 0;
+
+    /// handle batch of file events, by default calls handleEvent() for each of them
+    virtual void handleEvents(ArrayView<DirectoryWatcherEvent> events);
 };
 
 ///--
@@ -68,6 +71,7 @@ protected:
     //--
 
     void dispatchEvent(const DirectoryWatcherEvent& evt);
+    void dispatchEvents(ArrayView<DirectoryWatcherEvent> events);
 
     //--
 };
@@ -0,0 +1,64 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "fileDirectoryWatcher.h"
+#include "bm/core/containers/include/hashMap.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+///--
+
+// Collects raw file system events and turns them into a minimal set of logical events
+// Events for the same path are merged (ie. create + modify + close = FileAdded, create + delete = nothing, delete + create = FileContentChanged, delete + modify = FileRemoved)
+// Path is reported only after it was quiet for the debounce time (or after the max delay if it keeps changing)
+// NOTE: not thread safe, meant to be owned by the watcher thread
+class BM_CORE_FILE_API DirectoryWatcherEventCoalescer : public MainPoolData<NoCopy>
+{
+public:
+    DirectoryWatcherEventCoalescer(double debounceTime = 0.2, double maxDelay = 2.0);
+
+    //--
+
+    //! number of paths with pending changes
+    INLINE uint32_t pendingCount() const { return m_pending.size(); }
+
+    //--
+
+    //! push raw event
+    void push(DirectoryWatcherEventType type, StringView path, NativeTimePoint now = NativeTimePoint::Now());
+
+    //! collect events for paths that stayed quiet long enough (or all of them if forced), events are in the order of first change
+    //! returns true if anything was collected
+    bool flush(Array<DirectoryWatcherEvent>& outEvents, NativeTimePoint now = NativeTimePoint::Now(), bool force = false);
+
+    //! drop all pending events
+    void reset();
+
+    //--
+
+private:
+    struct Entry
+    {
+        DirectoryWatcherEventType type;
+        NativeTimePoint firstTime;
+        NativeTimePoint lastTime;
+        uint64_t order = 0;
+    };
+
+    HashMap<StringBuf, Entry> m_pending;
+    uint64_t m_orderCounter = 0;
+
+    double m_debounceTime = 0.0;
+    double m_maxDelay = 0.0;
+
+    static bool Merge(DirectoryWatcherEventType current, DirectoryWatcherEventType incoming, DirectoryWatcherEventType& outMerged);
+};
+
+///--
+
+END_INFERNO_NAMESPACE()
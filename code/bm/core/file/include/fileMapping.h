@@ -37,6 +37,14 @@ public:
 
 	//--
 
+	//! Tell the OS how given part of the mapped memory is going to be accessed, no-op if not supported
+	virtual void accessHint(uint64_t offset, uint64_t size, FileAccessHint hint) const;
+
+	//! Tell the OS how the whole mapped memory is going to be accessed
+	INLINE void accessHint(FileAccessHint hint) const { accessHint(0, m_size, hint); }
+
+	//--
+
 protected:
 	IFileMapping(StringBuf info, const void* data, uint64_t size);
 
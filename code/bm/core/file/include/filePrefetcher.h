@@ -0,0 +1,73 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "fileAbsoluteRange.h"
+#include "bm/core/system/include/mutex.h"
+#include "bm/core/system/include/conditionVariable.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+/// Warms up the OS file cache for ranges of files that we know will be loaded soon
+/// Declared ranges are hinted to the OS and then read on a background task so the actual load is served from memory
+class BM_CORE_FILE_API FilePrefetcher : public ISingleton
+{
+    DECLARE_SINGLETON(FilePrefetcher);
+
+public:
+    FilePrefetcher();
+
+    //--
+
+    //! number of bytes waiting to be prefetched
+    INLINE uint64_t pendingBytes() const { return m_pendingBytes.load(); }
+
+    //! total number of bytes prefetched so far
+    INLINE uint64_t prefetchedBytes() const { return m_prefetchedBytes.load(); }
+
+    //--
+
+    //! declare range of file that will be needed soon, range is clamped to the file size
+    //! NOTE: files that are already in memory are ignored
+    void prefetch(IFileReader* file, FileAbsoluteRange range);
+
+    //! declare that whole file will be needed soon
+    void prefetch(IFileReader* file);
+
+    //! wait for all pending prefetches to finish
+    void waitForAll();
+
+    //--
+
+private:
+    static const uint32_t READ_CHUNK_SIZE = 256U << 10;
+
+    struct Request
+    {
+        FileReaderPtr file;
+        FileAbsoluteRange range;
+    };
+
+    Mutex m_lock;
+    ConditionVariable m_finished;
+    Array<Request> m_requests;
+    bool m_backgroundTaskRunning = false;
+
+    std::atomic<uint64_t> m_pendingBytes = 0;
+    std::atomic<uint64_t> m_prefetchedBytes = 0;
+
+    void processRequests();
+    void processRequest(const Request& request, void* readBuffer);
+
+    virtual void deinit() override;
+};
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -76,6 +76,11 @@ public:
     //! NOTE: it's should be considered a blocking call
 	virtual FileMappingPtr createMapping(FileAbsoluteRange range) = 0;
 
+	//--
+
+	//! Tell the OS how given range of the file is going to be accessed, no-op if not supported
+	virtual void accessHint(FileAbsoluteRange range, FileAccessHint hint);
+
 	//----
 
     // create a file handle from memory buffer
@@ -74,7 +74,7 @@ public:
     //! Make sure all directories along the way exist
     virtual bool createPath(StringView absoluteFilePath) = 0;
 
-    //! Move file
+    //! Move file, replaces the destination file if it exists
     virtual bool moveFile(StringView srcAbsolutePath, StringView destAbsolutePath) = 0;
 
     //! Copy file
@@ -48,6 +48,14 @@ public:
 	//! NOTE: interface is inherently slow, should be used only when reading small amount of data (headers) when memory-mapping is not worth it
 	virtual uint64_t readSync(void* readBuffer, uint64_t size) = 0;
 
+    //--
+
+	//! Tell the OS how given (absolute) range of the file is going to be accessed, no-op if not supported
+	virtual void accessHint(FileAbsoluteRange range, FileAccessHint hint);
+
+	//! Tell the OS how the whole view is going to be accessed
+	INLINE void accessHint(FileAccessHint hint) { accessHint(m_range, hint); }
+
     //--
 
 	// create a file view from memory buffer in a Buffer, will keep the buffer alive
@@ -44,6 +44,15 @@ public:
 	//! write data to file at current location
 	virtual uint64_t writeSync(const void* ptr, uint64_t size) = 0;
 
+	//! write a batch of memory blocks at current location as if they were one continuous block (writev style)
+	//! returns total number of bytes written, stops at first incomplete write
+	//! NOTE: default implementation issues one writeSync() per block
+	virtual uint64_t writeVectorSync(ArrayView<BufferView> blocks);
+
+	//! flush data buffered by this writer, optionally ask the OS to commit the data to the physical disk as well (fdatasync style)
+	//! NOTE: committing to disk is slow and should be used only when durability matters
+	virtual bool flushSync(bool toDisk = false);
+
     //----
 
 protected:
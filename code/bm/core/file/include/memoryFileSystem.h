@@ -9,6 +9,8 @@
 #include "bm/core/file/include/fileSystem.h"
 #include "bm/core/file/include/fileDirectoryWatcher.h"
 #include "bm/core/memory/include/structureAllocator.h"
+#include "bm/core/containers/include/hashMap.h"
+#include "bm/core/system/include/mutex.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -19,15 +21,34 @@ class MemoryFileSystemWatcher;
 //--
 
 // Fully in-memory file system with ALL features of a normal file system, including file notifications
-// Mostly used for testing as a mock file system
+// Mostly used for testing as a mock file system but it's also safe to share between threads as an in-process file cache:
+//  - directory structure is guarded by a single lock, files are found via a sharded table of full paths so reading files never walks or locks the tree
+//  - file content is kept in immutable buffers that are shared (copy-on-write) with readers and copies
+//  - with a memory budget set the least recently used files are evicted once the content stored exceeds it
 class BM_CORE_FILE_API MemoryFileSystem : public IFileSystem
 {
 public:
-    MemoryFileSystem();
+    MemoryFileSystem(uint64_t memoryBudget = 0);
     virtual ~MemoryFileSystem();
 
     //--
 
+    //! Get total size of file content stored in the file system
+    //! NOTE: content shared between files (copies) is counted for every file
+    INLINE uint64_t memoryUsage() const { return m_memoryUsage.load(); }
+
+    //! Get memory budget for stored file content, 0 if not limited
+    INLINE uint64_t memoryBudget() const { return m_memoryBudget.load(); }
+
+    //! Get number of files evicted so far because of the memory budget
+    INLINE uint64_t evictedFileCount() const { return m_evictedFileCount.load(); }
+
+    //! Change the memory budget, least recently used files are evicted right away if we are over it
+    //! NOTE: read only files are never evicted
+    void memoryBudget(uint64_t budget);
+
+    //--
+
     //-----
     // IFileSystem 
     virtual FileReaderPtr openForReading(StringView absoluteFilePath, FileReadMode mode, TimeStamp* outTimestamp = nullptr) const override final;
@@ -112,22 +133,30 @@ protected:
 
 	struct Directory;
 
+	// NOTE: nodes are never freed until the file system is destroyed, deleted entries are only flagged
+	// NOTE: structure (links, new nodes) is modified under m_lock, file state is modified under m_lock AND the lock of the file's shard
+	// NOTE: the LRU links are guarded by m_lruLock only, it's never held together with any other lock
 	struct File : public MainPoolData<NoCopy>
 	{
 		Directory* parent = nullptr;
 		StringBuf name;
+		StringBuf path;
 		Buffer content;
 		TimeStamp timestamp;
 		bool readonly = false;
 		bool deleted = false;
         File* next = nullptr;
+
+		File* lruPrev = nullptr; // more recently used
+		File* lruNext = nullptr; // less recently used
+		bool lruLinked = false; // only files that can be evicted are linked
 	};
 
 	struct Directory : public MainPoolData<NoCopy>
 	{
 		Directory* parent = nullptr;
 		StringBuf name;
-		//StringBuf path;
+		StringBuf path;
 
 		File* firstFile = nullptr;
         File* lastFile = nullptr;
@@ -139,27 +168,68 @@ protected:
 		bool deleted = false;
 	};
 
+	// part of the full path -> file table, files are assigned to shards by path hash
+	struct FileShard
+	{
+		Mutex lock;
+		HashMap<StringBuf, File*> files; // includes deleted files
+	};
+
+	// state of file captured for readers
+	struct FileState
+	{
+		Buffer content;
+		TimeStamp timestamp;
+		bool readonly = false;
+	};
+
+	static const uint32_t NUM_FILE_SHARDS = 16;
+
+	Mutex m_lock;
+
 	Directory* m_root = nullptr;
     StructureAllocator<Directory> m_directoryPool;
-    StructureAllocator<File> m_filePool;	
+    StructureAllocator<File> m_filePool;
+
+	HashMap<StringBuf, Directory*> m_directories; // full path (with trailing "/") -> directory, includes deleted directories
+	FileShard m_fileShards[NUM_FILE_SHARDS];
 
-	Directory* testCreatePath(StringView absoluteFilePath, bool notify);
+	std::atomic<uint64_t> m_memoryUsage = 0;
+	std::atomic<uint64_t> m_memoryBudget = 0;
+	std::atomic<uint64_t> m_evictedFileCount = 0;
 
-	Directory* testDirectoryEntryFind(StringView path);
-	const Directory* testDirectoryEntryFind(StringView path) const;
+	mutable Mutex m_lruLock;
+	mutable File* m_lruHead = nullptr; // most recently used
+	mutable File* m_lruTail = nullptr; // least recently used
 
-	File* testFileEntryFind(StringView path);
-	const File* testFileEntryFind(StringView path) const;
+	Mutex m_dispatchLock; // keeps batches of events from different threads in order
+
+	class StructureLock;
+
+	FileShard& fileShard(StringView path) const;
+
+	bool readFile(StringView path, FileState& outState) const; // safe to call without m_lock
+
+	void lruUnlink_NoLock(File* file) const;
+	void lruLinkFront_NoLock(File* file) const;
+	void lruTouch(File* file) const; // moves file to front if it's linked
+	void lruUpdate(File* file); // links or unlinks the file depending on whether it can be evicted
+
+	// NOTE: all functions below require m_lock to be held
+	Directory* findDirectory(StringView path) const;
+	File* findFile(StringView path) const;
+	Directory* createDirectoryPath(StringView path, bool notify);
+	File* storeFile(Directory* dir, StringView path, Buffer content, TimeStamp timestamp, bool notify);
+	void updateFile(File* file, Buffer content, TimeStamp timestamp, bool deleted);
+	void removeFile(File* file);
+	void evictFiles(const File* fileToKeep);
 
     void cleanupDirectory(Directory* dir);
 
     //--
 
     Array<RefWeakPtr<MemoryFileSystemWatcher>> m_watchers;
-
-	StringBuf fileAbsolutePath(const File* file) const;
-	StringBuf dirAbsolutePath(const Directory* dir) const;
-    void dirAbsolutePath(const Directory* dir, IFormatStream& f) const;
+	Array<DirectoryWatcherEvent> m_pendingEvents;
 
 	void notiftFileAdded(const File* file);
 	void notiftFileRemoved(const File* file);
@@ -167,7 +237,8 @@ protected:
 	void notiftDirectoryAdded(const Directory* dir);
 	void notiftDirectoryRemoved(const Directory* dir);
 
-	void dispatchFileSystemEvent(const DirectoryWatcherEvent& evt);
+	void queueFileSystemEvent(DirectoryWatcherEventType type, const StringBuf& path);
+	void dispatchPendingEvents();
 
     //--
 };
@@ -37,6 +37,13 @@ typedef RefPtr<IFileMapping> FileMappingPtr;
 class IFileWriter;
 typedef RefPtr<IFileWriter> FileWriterPtr;
 
+class FileBufferedWriter;
+typedef RefPtr<FileBufferedWriter> FileBufferedWriterPtr;
+
+struct FileBufferedWriterSetup;
+
+class FilePrefetcher;
+
 typedef std::function<void(int actualReadSize)> TAsyncReadCallback; // negative read size on errors
 typedef std::function<void(FileMappingPtr mappedView)> TAsyncMappingCallback;
 
@@ -87,6 +94,16 @@ enum class FileWriteMode : uint8_t
 	ReadWrite, // read/write access (append)
 };
 
+/// hint about how a range of file is going to be accessed, purely advisory
+enum class FileAccessHint : uint8_t
+{
+	Normal, // no special treatment, default OS read ahead
+	Sequential, // data will be read sequentially, read ahead aggressively
+	Random, // data will be read in random order, do not read ahead
+	WillNeed, // data will be needed soon, start loading it into memory
+	DontNeed, // data is no longer needed, memory can be dropped
+};
+
 //--
 
 class IVirtualFileSystem;
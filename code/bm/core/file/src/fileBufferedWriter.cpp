@@ -0,0 +1,396 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "fileBufferedWriter.h"
+#include "fileSystem.h"
+
+#include "bm/core/containers/include/inplaceArray.h"
+#include "bm/core/task/include/taskBuilder.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+struct FileBufferedWriter::Block : public MainPoolData<NoCopy>
+{
+    uint8_t* data = nullptr;
+    uint32_t size = 0;
+};
+
+//--
+
+FileBufferedWriter::FileBufferedWriter(FileWriterPtr target, const FileBufferedWriterSetup& setup)
+    : IFileWriter(target->flags() | FileFlagBit::Buffered, target->info())
+    , m_target(target)
+    , m_setup(setup)
+{
+    m_setup.blockSize = std::max<uint32_t>(m_setup.blockSize, 4096);
+    m_setup.maxPendingBlocks = std::max<uint32_t>(m_setup.maxPendingBlocks, 1);
+
+    m_pos = m_target->pos();
+    m_size = m_target->size();
+}
+
+FileBufferedWriter::~FileBufferedWriter()
+{
+    if (!m_committed)
+    {
+        if (m_fileSystem)
+        {
+            TRACE_WARNING("[FILE] Buffered file '{}' was not committed, content is discarded", m_targetPath);
+            discard();
+        }
+        else
+        {
+            drain();
+        }
+    }
+
+    DEBUG_CHECK_EX(m_pendingBlocks.empty(), "Pending writes while closing file");
+    DEBUG_CHECK_EX(!m_backgroundWriteRunning, "Background write still running while closing file");
+
+    if (m_activeBlock)
+        m_freeBlocks.pushBack(m_activeBlock);
+
+    for (auto* block : m_freeBlocks)
+    {
+        PoolFree(MainPool(), block->data);
+        delete block;
+    }
+}
+
+//--
+
+uint64_t FileBufferedWriter::size() const
+{
+    return m_size;
+}
+
+uint64_t FileBufferedWriter::pos() const
+{
+    return m_pos;
+}
+
+void FileBufferedWriter::seek(uint64_t offset)
+{
+    if (offset != m_pos)
+    {
+        drain();
+        m_target->seek(offset);
+        m_pos = offset;
+    }
+}
+
+uint64_t FileBufferedWriter::readSync(void* ptr, uint64_t size)
+{
+    drain();
+
+    const auto numRead = m_target->readSync(ptr, size);
+    m_pos += numRead;
+    return numRead;
+}
+
+uint64_t FileBufferedWriter::writeSync(const void* ptr, uint64_t size)
+{
+    DEBUG_CHECK_RETURN_EX_V(!m_committed, "Writing to already committed file", 0);
+
+    if (m_failed)
+        return 0;
+
+    // big writes are not copied in the sync mode, they are written together with the staged data in one call
+    if (!m_setup.writeBehind && size >= m_setup.directWriteThreshold)
+    {
+        const auto stagedSize = m_activeBlock ? m_activeBlock->size : 0;
+
+        InplaceArray<BufferView, 2> blocks;
+        if (stagedSize)
+            blocks.emplaceBack(m_activeBlock->data, stagedSize);
+        blocks.emplaceBack(ptr, size);
+
+        const auto numWritten = m_target->writeVectorSync(blocks);
+        if (m_activeBlock)
+            m_activeBlock->size = 0;
+
+        if (numWritten != stagedSize + size)
+        {
+            TRACE_ERROR("[FILE] Failed to write {} to '{}' (written {})", MemSize(stagedSize + size), m_info, MemSize(numWritten));
+            m_failed = true;
+
+            const auto numWrittenFromCaller = (numWritten > stagedSize) ? (numWritten - stagedSize) : 0;
+            m_pos += numWrittenFromCaller;
+            m_size = std::max(m_size, m_pos);
+            return numWrittenFromCaller;
+        }
+
+        m_pos += size;
+        m_size = std::max(m_size, m_pos);
+        return size;
+    }
+
+    // coalesce into staging blocks
+    const auto* readPtr = (const uint8_t*)ptr;
+    auto left = size;
+    while (left > 0)
+    {
+        if (!m_activeBlock)
+            m_activeBlock = allocBlock();
+
+        const auto copySize = std::min<uint64_t>(left, m_setup.blockSize - m_activeBlock->size);
+        memcpy(m_activeBlock->data + m_activeBlock->size, readPtr, copySize);
+        m_activeBlock->size += copySize;
+        readPtr += copySize;
+        left -= copySize;
+
+        if (m_activeBlock->size == m_setup.blockSize)
+            submitActiveBlock();
+    }
+
+    m_pos += size;
+    m_size = std::max(m_size, m_pos);
+    return size;
+}
+
+uint64_t FileBufferedWriter::writeVectorSync(ArrayView<BufferView> blocks)
+{
+    uint64_t totalWritten = 0;
+
+    for (const auto& block : blocks)
+    {
+        const auto numWritten = writeSync(block.data(), block.size());
+        totalWritten += numWritten;
+
+        if (numWritten != block.size())
+            break;
+    }
+
+    return totalWritten;
+}
+
+bool FileBufferedWriter::flushSync(bool toDisk)
+{
+    drain();
+
+    if (m_failed)
+        return false;
+
+    return m_target->flushSync(toDisk);
+}
+
+//--
+
+bool FileBufferedWriter::commit()
+{
+    DEBUG_CHECK_RETURN_EX_V(!m_committed, "File already committed", false);
+
+    drain();
+
+    bool valid = !m_failed;
+    if (valid && !m_target->flushSync(m_setup.syncToDisk))
+        valid = false;
+
+    m_committed = true;
+
+    if (m_fileSystem)
+    {
+        // close the temporary file so it can be moved
+        m_target.reset();
+
+        if (!valid)
+        {
+            m_fileSystem->deleteFile(m_tempPath);
+            return false;
+        }
+
+        if (!m_fileSystem->moveFile(m_tempPath, m_targetPath))
+        {
+            TRACE_ERROR("[FILE] Failed to move temporary file '{}' into '{}'", m_tempPath, m_targetPath);
+            m_fileSystem->deleteFile(m_tempPath);
+            return false;
+        }
+    }
+
+    return valid;
+}
+
+void FileBufferedWriter::discard()
+{
+    DEBUG_CHECK_RETURN_EX(!m_committed, "File already committed");
+
+    // nothing more will be written
+    m_failed = true;
+
+    if (m_activeBlock)
+        m_activeBlock->size = 0;
+
+    waitForPendingWrites();
+
+    m_committed = true;
+
+    if (m_fileSystem)
+    {
+        m_target.reset();
+        m_fileSystem->deleteFile(m_tempPath);
+    }
+}
+
+//--
+
+FileBufferedWriter::Block* FileBufferedWriter::allocBlock()
+{
+    auto lock = CreateLock(m_lock);
+
+    // memory budget is limited, wait for the background write to give us a block back
+    while (m_freeBlocks.empty() && m_numAllocatedBlocks > m_setup.maxPendingBlocks)
+        m_blockReturned.waitInfinite(m_lock);
+
+    if (!m_freeBlocks.empty())
+    {
+        auto* block = m_freeBlocks.back();
+        m_freeBlocks.popBack();
+        return block;
+    }
+
+    auto* block = new Block();
+    block->data = (uint8_t*)PoolAllocate(MainPool(), m_setup.blockSize, 16);
+    block->size = 0;
+    m_numAllocatedBlocks += 1;
+    return block;
+}
+
+void FileBufferedWriter::writeBlocks(ArrayView<Block*> blocks)
+{
+    // once failed we don't write anything more
+    if (m_failed)
+        return;
+
+    InplaceArray<BufferView, 16> views;
+    uint64_t expectedSize = 0;
+    for (const auto* block : blocks)
+    {
+        views.emplaceBack(block->data, block->size);
+        expectedSize += block->size;
+    }
+
+    const auto numWritten = m_target->writeVectorSync(views);
+    if (numWritten != expectedSize)
+    {
+        TRACE_ERROR("[FILE] Failed to write {} to '{}' (written {})", MemSize(expectedSize), m_info, MemSize(numWritten));
+        m_failed = true;
+    }
+}
+
+void FileBufferedWriter::submitActiveBlock()
+{
+    if (!m_activeBlock || !m_activeBlock->size)
+        return;
+
+    // in sync mode write directly and reuse the block
+    if (!m_setup.writeBehind)
+    {
+        writeBlocks(ArrayView<Block*>(&m_activeBlock, 1));
+        m_activeBlock->size = 0;
+        return;
+    }
+
+    // queue for the background write
+    auto lock = CreateLock(m_lock);
+    m_pendingBlocks.pushBack(m_activeBlock);
+    m_activeBlock = nullptr;
+
+    if (!m_backgroundWriteRunning)
+    {
+        m_backgroundWriteRunning = true;
+
+        TaskBuilder("FileWriteBehind"_id) << [this](TaskContext& tc)
+        {
+            processPendingBlocks();
+        };
+    }
+}
+
+void FileBufferedWriter::processPendingBlocks()
+{
+    PC_SCOPE_LVL1(FileWriteBehind);
+
+    InplaceArray<Block*, 16> blocks;
+    for (;;)
+    {
+        // grab everything that was queued so far, it will be written in one batch
+        {
+            auto lock = CreateLock(m_lock);
+            if (m_pendingBlocks.empty())
+            {
+                m_backgroundWriteRunning = false;
+                m_blockReturned.wakeAll();
+                return;
+            }
+
+            blocks.reset();
+            blocks.pushBackMany(m_pendingBlocks);
+            m_pendingBlocks.reset();
+        }
+
+        writeBlocks(blocks);
+
+        // return blocks so the writing thread can reuse them
+        {
+            auto lock = CreateLock(m_lock);
+            for (auto* block : blocks)
+            {
+                block->size = 0;
+                m_freeBlocks.pushBack(block);
+            }
+
+            m_blockReturned.wakeAll();
+        }
+    }
+}
+
+void FileBufferedWriter::waitForPendingWrites()
+{
+    auto lock = CreateLock(m_lock);
+    while (m_backgroundWriteRunning || !m_pendingBlocks.empty())
+        m_blockReturned.waitInfinite(m_lock);
+}
+
+void FileBufferedWriter::drain()
+{
+    submitActiveBlock();
+    waitForPendingWrites();
+}
+
+//--
+
+FileBufferedWriterPtr FileBufferedWriter::Open(StringView absoluteFilePath, const FileBufferedWriterSetup& setup, IFileSystem& fs)
+{
+    if (!setup.atomicCommit)
+    {
+        auto file = fs.openForWriting(absoluteFilePath, FileWriteMode::WriteOnly);
+        if (!file)
+            return nullptr;
+
+        return RefNew<FileBufferedWriter>(file, setup);
+    }
+
+    // write to a temporary file next to the target so the final move does not cross volumes
+    static std::atomic<uint32_t> GTempFileCounter = 0;
+    const auto tempPath = StringBuf(TempString("{}.{}.tmp", absoluteFilePath, GTempFileCounter++));
+
+    auto file = fs.openForWriting(tempPath, FileWriteMode::WriteOnly);
+    if (!file)
+        return nullptr;
+
+    auto ret = RefNew<FileBufferedWriter>(file, setup);
+    ret->m_fileSystem = &fs;
+    ret->m_targetPath = StringBuf(absoluteFilePath);
+    ret->m_tempPath = tempPath;
+    return ret;
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
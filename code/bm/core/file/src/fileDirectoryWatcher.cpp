@@ -14,6 +14,12 @@ BEGIN_INFERNO_NAMESPACE()
 IDirectoryWatcherListener::~IDirectoryWatcherListener()
 {}
 
+void IDirectoryWatcherListener::handleEvents(ArrayView<DirectoryWatcherEvent> events)
+{
+    for (const auto& evt : events)
+        handleEvent(evt);
+}
+
 //--
 
 IDirectoryWatcher::~IDirectoryWatcher()
@@ -55,6 +61,27 @@ void IDirectoryWatcher::dispatchEvent(const DirectoryWatcherEvent& evt)
     }
 }
 
+void IDirectoryWatcher::dispatchEvents(ArrayView<DirectoryWatcherEvent> events)
+{
+    if (events.empty())
+        return;
+
+    // dispatch whole batch to each listener, lock is taken once
+    {
+        bool hasEmptyEntry = false;
+
+        auto lock = CreateLock(m_listenersLock);
+        for (auto listener : m_listeners)
+            if (listener)
+                listener->handleEvents(events);
+            else
+                hasEmptyEntry = true;
+
+        if (hasEmptyEntry)
+            m_listeners.removeAll(nullptr); // preserve order (strange bugs otherwise..)
+    }
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
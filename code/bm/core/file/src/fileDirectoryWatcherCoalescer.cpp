@@ -0,0 +1,145 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "fileDirectoryWatcherCoalescer.h"
+
+#include "bm/core/containers/include/inplaceArray.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+DirectoryWatcherEventCoalescer::DirectoryWatcherEventCoalescer(double debounceTime /*= 0.2*/, double maxDelay /*= 2.0*/)
+    : m_debounceTime(debounceTime)
+    , m_maxDelay(std::max(debounceTime, maxDelay))
+{}
+
+bool DirectoryWatcherEventCoalescer::Merge(DirectoryWatcherEventType current, DirectoryWatcherEventType incoming, DirectoryWatcherEventType& outMerged)
+{
+    switch (incoming)
+    {
+        case DirectoryWatcherEventType::FileAdded:
+            // deleted and created again - file was replaced
+            outMerged = (current == DirectoryWatcherEventType::FileRemoved) ? DirectoryWatcherEventType::FileContentChanged : DirectoryWatcherEventType::FileAdded;
+            return true;
+
+        case DirectoryWatcherEventType::FileRemoved:
+            // created and deleted before anybody noticed (temp files)
+            if (current == DirectoryWatcherEventType::FileAdded)
+                return false;
+
+            outMerged = DirectoryWatcherEventType::FileRemoved;
+            return true;
+
+        case DirectoryWatcherEventType::FileContentChanged:
+            // new file is still reported as new, removed file stays removed until it's added again (late modification events)
+            if (current == DirectoryWatcherEventType::FileAdded || current == DirectoryWatcherEventType::FileRemoved)
+                outMerged = current;
+            else
+                outMerged = DirectoryWatcherEventType::FileContentChanged;
+            return true;
+
+        case DirectoryWatcherEventType::FileMetadataChanged:
+            // any other change is more important
+            outMerged = current;
+            return true;
+
+        case DirectoryWatcherEventType::DirectoryAdded:
+            outMerged = DirectoryWatcherEventType::DirectoryAdded;
+            return true;
+
+        case DirectoryWatcherEventType::DirectoryRemoved:
+            if (current == DirectoryWatcherEventType::DirectoryAdded)
+                return false;
+
+            outMerged = DirectoryWatcherEventType::DirectoryRemoved;
+            return true;
+    }
+
+    outMerged = incoming;
+    return true;
+}
+
+void DirectoryWatcherEventCoalescer::push(DirectoryWatcherEventType type, StringView path, NativeTimePoint now /*= NativeTimePoint::Now()*/)
+{
+    if (auto* existing = m_pending.find(path))
+    {
+        DirectoryWatcherEventType merged;
+        if (Merge(existing->type, type, merged))
+        {
+            existing->type = merged;
+            existing->lastTime = now;
+        }
+        else
+        {
+            m_pending.remove(path);
+        }
+    }
+    else
+    {
+        Entry entry;
+        entry.type = type;
+        entry.firstTime = now;
+        entry.lastTime = now;
+        entry.order = m_orderCounter++;
+        m_pending.set(StringBuf(path), entry);
+    }
+}
+
+bool DirectoryWatcherEventCoalescer::flush(Array<DirectoryWatcherEvent>& outEvents, NativeTimePoint now /*= NativeTimePoint::Now()*/, bool force /*= false*/)
+{
+    if (m_pending.empty())
+        return false;
+
+    struct ReadyEntry
+    {
+        uint64_t order = 0;
+        uint32_t index = 0;
+    };
+
+    InplaceArray<ReadyEntry, 64> ready;
+
+    const auto& values = m_pending.values();
+    for (auto i : values.indexRange())
+    {
+        const auto& entry = values[i];
+        if (force || (entry.lastTime + m_debounceTime) <= now || (entry.firstTime + m_maxDelay) <= now)
+        {
+            auto& info = ready.emplaceBack();
+            info.order = entry.order;
+            info.index = i;
+        }
+    }
+
+    if (ready.empty())
+        return false;
+
+    std::sort(ready.begin(), ready.end(), [](const ReadyEntry& a, const ReadyEntry& b) { return a.order < b.order; });
+
+    InplaceArray<StringBuf, 64> readyPaths;
+    for (const auto& info : ready)
+    {
+        auto& evt = outEvents.emplaceBack();
+        evt.type = values[info.index].type;
+        evt.path = m_pending.keys()[info.index];
+        readyPaths.pushBack(evt.path);
+    }
+
+    for (const auto& path : readyPaths)
+        m_pending.remove(path);
+
+    return true;
+}
+
+void DirectoryWatcherEventCoalescer::reset()
+{
+    m_pending.clear();
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -26,6 +26,11 @@ Buffer IFileMapping::createBuffer() const
 	return Buffer::CreateExternal(view(), [selfRef](void*) {});
 }
 
+void IFileMapping::accessHint(uint64_t offset, uint64_t size, FileAccessHint hint) const
+{
+	// nothing to do by default, memory backed mappings are already resident
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
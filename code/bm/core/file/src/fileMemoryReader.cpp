@@ -47,9 +47,9 @@ Buffer FileMemoryReader::loadToBuffer(IPoolUnmanaged& pool, FileAbsoluteRange ra
 class FileMappingFromBuffer : public IFileMapping
 {
 public:
-    FileMappingFromBuffer(StringBuf info, Buffer buffer, uint64_t offset, uint64_t size)
-        : IFileMapping(info, buffer.data() + offset, size)
-        , m_buffer(buffer)
+    FileMappingFromBuffer(StringBuf info, Buffer buffer, const uint8_t* data, uint64_t size)
+        : IFileMapping(info, data, size)
+        , m_buffer(buffer) // keeps the data alive, may be empty if reader was created from external view
     {}
 
 private:
@@ -69,8 +69,8 @@ FileMappingPtr FileMemoryReader::createMapping(FileAbsoluteRange range)
 {
     DEBUG_CHECK_RETURN_EX_V(fullRange().contains(range), "Invalid mapping range", nullptr);
 
-    const auto view = m_buffer.view().subView(range.absoluteStart(), range.absoluteEnd());
-    return RefNew<FileMappingFromBuffer>(info(), m_buffer, range.absoluteStart(), range.size());
+    const auto* data = m_view.data() + range.absoluteStart();
+    return RefNew<FileMappingFromBuffer>(info(), m_buffer, data, range.size());
 }
 
 /*bool FileMemoryReader::createMappingAsync(FileAbsoluteRange range, TAsyncMappingCallback callback)
@@ -0,0 +1,138 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "filePrefetcher.h"
+#include "fileReader.h"
+#include "fileView.h"
+
+#include "bm/core/task/include/taskBuilder.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+FilePrefetcher::FilePrefetcher()
+{}
+
+void FilePrefetcher::deinit()
+{
+    waitForAll();
+}
+
+void FilePrefetcher::prefetch(IFileReader* file)
+{
+    DEBUG_CHECK_RETURN_EX(file, "No file to prefetch");
+    prefetch(file, file->fullRange());
+}
+
+void FilePrefetcher::prefetch(IFileReader* file, FileAbsoluteRange range)
+{
+    DEBUG_CHECK_RETURN_EX(file, "No file to prefetch");
+
+    // nothing to warm up if content is already in memory
+    if (file->flags().test(FileFlagBit::MemoryBacked) && !file->flags().test(FileFlagBit::MemoryMapped))
+        return;
+
+    const auto start = std::min<uint64_t>(range.absoluteStart(), file->size());
+    const auto end = std::min<uint64_t>(range.absoluteEnd(), file->size());
+    if (end <= start)
+        return;
+
+    // NOTE: even the OS hint is given on the background task, on some platforms (readahead) it blocks until data is read
+    auto lock = CreateLock(m_lock);
+
+    auto& request = m_requests.emplaceBack();
+    request.file = AddRef(file);
+    request.range = FileAbsoluteRange(start, end);
+    m_pendingBytes += request.range.size();
+
+    if (!m_backgroundTaskRunning)
+    {
+        m_backgroundTaskRunning = true;
+
+        TaskBuilder("FilePrefetch"_id) << [this](TaskContext& tc)
+        {
+            processRequests();
+        };
+    }
+}
+
+void FilePrefetcher::waitForAll()
+{
+    auto lock = CreateLock(m_lock);
+    while (m_backgroundTaskRunning)
+        m_finished.waitInfinite(m_lock);
+}
+
+void FilePrefetcher::processRequests()
+{
+    PC_SCOPE_LVL1(FilePrefetch);
+
+    auto* readBuffer = PoolAllocate(MainPool(), READ_CHUNK_SIZE, 16);
+
+    Array<Request> requests;
+    for (;;)
+    {
+        // grab everything that was declared so far
+        {
+            auto lock = CreateLock(m_lock);
+            if (m_requests.empty())
+            {
+                m_backgroundTaskRunning = false;
+                m_finished.wakeAll();
+                break;
+            }
+
+            requests = std::move(m_requests);
+            m_requests.reset();
+        }
+
+        // let the OS start on all of the ranges, on some platforms this is all we need
+        for (const auto& request : requests)
+            request.file->accessHint(request.range, FileAccessHint::WillNeed);
+
+        // requests are processed in order they were declared as that's most likely the order of loading
+        for (const auto& request : requests)
+        {
+            processRequest(request, readBuffer);
+            m_pendingBytes -= request.range.size();
+        }
+
+        requests.reset();
+    }
+
+    PoolFree(MainPool(), readBuffer);
+}
+
+void FilePrefetcher::processRequest(const Request& request, void* readBuffer)
+{
+    // reading through a separate view pulls the data into the OS file cache, the data itself is not needed
+    auto view = request.file->createView(request.range);
+    if (!view)
+        return;
+
+    view->accessHint(FileAccessHint::Sequential);
+
+    auto left = request.range.size();
+    while (left > 0)
+    {
+        const auto chunkSize = std::min<uint64_t>(left, READ_CHUNK_SIZE);
+        const auto numRead = view->readSync(readBuffer, chunkSize);
+        if (numRead != chunkSize)
+        {
+            TRACE_WARNING("[FILE] Prefetch of '{}' stopped at {} of {}", request.file->info(), request.range.size() - left, request.range);
+            break;
+        }
+
+        m_prefetchedBytes += numRead;
+        left -= numRead;
+    }
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -49,6 +49,11 @@ bool IFileReader::readAsync(TaskContext& tc, FileAbsoluteRange range, void* ptr,
 	return false;
 }
 
+void IFileReader::accessHint(FileAbsoluteRange range, FileAccessHint hint)
+{
+	// nothing to do by default
+}
+
 //--
 
 
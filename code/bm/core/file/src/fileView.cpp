@@ -20,6 +20,11 @@ IFileView::IFileView(FileFlags flags, StringBuf info, FileAbsoluteRange range)
 IFileView::~IFileView()
 {}
 
+void IFileView::accessHint(FileAbsoluteRange range, FileAccessHint hint)
+{
+	// nothing to do by default
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
@@ -21,6 +21,27 @@ IFileWriter::IFileWriter(FileFlags flags, StringBuf info)
 IFileWriter::~IFileWriter()
 {}
 
+uint64_t IFileWriter::writeVectorSync(ArrayView<BufferView> blocks)
+{
+    uint64_t totalWritten = 0;
+
+    for (const auto& block : blocks)
+    {
+        const auto numWritten = writeSync(block.data(), block.size());
+        totalWritten += numWritten;
+
+        if (numWritten != block.size())
+            break;
+    }
+
+    return totalWritten;
+}
+
+bool IFileWriter::flushSync(bool toDisk)
+{
+    return true;
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
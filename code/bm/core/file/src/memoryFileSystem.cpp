@@ -30,15 +30,46 @@ public:
 
 //--
 
-MemoryFileSystem::MemoryFileSystem()
+// Locks the file system structure, notifications queued while the lock was held are dispatched after it's released
+class MemoryFileSystem::StructureLock : public NoCopy
+{
+public:
+	StructureLock(MemoryFileSystem& fs)
+		: m_fs(fs)
+	{
+		m_fs.m_lock.acquire();
+	}
+
+	~StructureLock()
+	{
+		m_fs.m_lock.release();
+		m_fs.dispatchPendingEvents();
+	}
+
+private:
+	MemoryFileSystem& m_fs;
+};
+
+//--
+
+MemoryFileSystem::MemoryFileSystem(uint64_t memoryBudget /*= 0*/)
+	: m_memoryBudget(memoryBudget)
 {
 	auto* root = m_directoryPool.create();
 	root->name = "";
+	root->path = "/";
 	m_root = root;
+
+	m_directories[root->path] = root;
 }
 
 MemoryFileSystem::~MemoryFileSystem()
 {
+	for (auto& shard : m_fileShards)
+		shard.files.clear();
+
+	m_directories.clear();
+
 	cleanupDirectory(m_root);
 	m_root = nullptr;
 }
@@ -68,89 +99,299 @@ void MemoryFileSystem::cleanupDirectory(Directory* dir)
 	m_directoryPool.free(dir);
 }
 
-bool MemoryFileSystem::testUpdateFileContentExternal(StringView path, Buffer data, TimeStamp timestamp /*= TimeStamp::GetNow()*/)
+void MemoryFileSystem::memoryBudget(uint64_t budget)
 {
-	DEBUG_CHECK_RETURN_EX_V(ValidateDepotFilePath(path), "Invalid path", false);
+	StructureLock lock(*this);
+	m_memoryBudget = budget;
+	evictFiles(nullptr);
+}
 
-	auto* dir = testDirectoryEntryFind(path.pathParent());
-	DEBUG_CHECK_RETURN_EX_V(dir, "Directory entry does not exist yet or is deleted", false);
+//--
+
+MemoryFileSystem::FileShard& MemoryFileSystem::fileShard(StringView path) const
+{
+	const auto hash = StringBuf::CalcHash(path);
+	return const_cast<FileShard&>(m_fileShards[hash % NUM_FILE_SHARDS]);
+}
 
-	const auto fileName = path.pathFileName();
+bool MemoryFileSystem::readFile(StringView path, FileState& outState) const
+{
+	ASSERT(ValidateDepotFilePath(path));
 
+	auto& shard = fileShard(path);
 	File* file = nullptr;
-	for (auto* entry = dir->firstFile; entry; entry = entry->next)
+
 	{
-		if (entry->name == fileName)
-		{
-			file = entry;
-			break;
-		}
+		auto lock = CreateLock(shard.lock);
+
+		if (!shard.files.find(path, file) || file->deleted)
+			return false;
+
+		outState.content = file->content;
+		outState.timestamp = file->timestamp;
+		outState.readonly = file->readonly;
 	}
 
-	if (file)
+	// file nodes are never freed so it's safe to touch it even if it got removed in the mean time
+	lruTouch(file);
+	return true;
+}
+
+void MemoryFileSystem::lruUnlink_NoLock(File* file) const
+{
+	if (file->lruPrev)
+		file->lruPrev->lruNext = file->lruNext;
+	else
+		m_lruHead = file->lruNext;
+
+	if (file->lruNext)
+		file->lruNext->lruPrev = file->lruPrev;
+	else
+		m_lruTail = file->lruPrev;
+
+	file->lruPrev = nullptr;
+	file->lruNext = nullptr;
+	file->lruLinked = false;
+}
+
+void MemoryFileSystem::lruLinkFront_NoLock(File* file) const
+{
+	file->lruPrev = nullptr;
+	file->lruNext = m_lruHead;
+
+	if (m_lruHead)
+		m_lruHead->lruPrev = file;
+	else
+		m_lruTail = file;
+
+	m_lruHead = file;
+	file->lruLinked = true;
+}
+
+void MemoryFileSystem::lruTouch(File* file) const
+{
+	auto lock = CreateLock(m_lruLock);
+
+	if (file->lruLinked && m_lruHead != file)
 	{
-		file->content = data;
-		file->timestamp = timestamp;
+		lruUnlink_NoLock(file);
+		lruLinkFront_NoLock(file);
+	}
+}
 
-		if (file->deleted)
+void MemoryFileSystem::lruUpdate(File* file)
+{
+	auto lock = CreateLock(m_lruLock);
+
+	if (file->lruLinked)
+		lruUnlink_NoLock(file);
+
+	if (!file->deleted && !file->readonly && file->content)
+		lruLinkFront_NoLock(file);
+}
+
+MemoryFileSystem::Directory* MemoryFileSystem::findDirectory(StringView path) const
+{
+	ASSERT(ValidateDepotDirPath(path));
+
+	Directory* dir = nullptr;
+	if (m_directories.find(path, dir) && !dir->deleted)
+		return dir;
+
+	return nullptr;
+}
+
+MemoryFileSystem::File* MemoryFileSystem::findFile(StringView path) const
+{
+	ASSERT(ValidateDepotFilePath(path));
+
+	// we hold the structure lock so no one can modify the shard
+	File* file = nullptr;
+	if (fileShard(path).files.find(path, file) && !file->deleted)
+		return file;
+
+	return nullptr;
+}
+
+MemoryFileSystem::Directory* MemoryFileSystem::createDirectoryPath(StringView path, bool notify)
+{
+	DEBUG_CHECK_RETURN_EX_V(ValidateDepotDirPath(path), "Invalid path", nullptr);
+
+	InplaceArray<StringView, 10> parts;
+	path.slice('/', parts);
+
+	if (!path.endsWith("/") && !parts.empty())
+		parts.popBack();
+
+	TempString dirPath;
+	dirPath << "/";
+
+	Directory* dir = m_root;
+	for (auto part : parts)
+	{
+		dirPath << part;
+		dirPath << "/";
+
+		Directory* childDir = nullptr;
+		if (m_directories.find(StringView(dirPath), childDir))
 		{
-			notiftFileAdded(file);
-			file->deleted = false;
+			if (childDir->deleted)
+			{
+				childDir->deleted = false;
+
+				if (notify)
+					notiftDirectoryAdded(childDir);
+			}
 		}
 		else
 		{
-			notiftFileChanged(file);
+			childDir = m_directoryPool.create();
+			childDir->parent = dir;
+			childDir->name = StringBuf(part);
+			childDir->path = StringBuf(StringView(dirPath));
+
+			if (dir->lastDir)
+				dir->lastDir->next = childDir;
+			else
+				dir->firstDir = childDir;
+			dir->lastDir = childDir;
+
+			m_directories[childDir->path] = childDir;
+
+			if (notify)
+				notiftDirectoryAdded(childDir);
+		}
+
+		dir = childDir;
+	}
+
+	return dir;
+}
+
+MemoryFileSystem::File* MemoryFileSystem::storeFile(Directory* dir, StringView path, Buffer content, TimeStamp timestamp, bool notify)
+{
+	auto& shard = fileShard(path);
+
+	File* file = nullptr;
+	if (shard.files.find(path, file))
+	{
+		const auto wasDeleted = file->deleted;
+		updateFile(file, content, timestamp, false);
+
+		if (notify)
+		{
+			if (wasDeleted)
+				notiftFileAdded(file);
+			else
+				notiftFileChanged(file);
 		}
 	}
 	else
 	{
-		auto* info = m_filePool.create();
-		info->parent = dir;
-		info->content = data;
-		info->name = StringBuf(path.pathFileName());
-		info->readonly = false;
-		info->timestamp = timestamp;
-		info->next = nullptr;
+		file = m_filePool.create();
+		file->parent = dir;
+		file->name = StringBuf(path.pathFileName());
+		file->path = StringBuf(path);
+		file->readonly = false;
+		file->next = nullptr;
 
 		if (dir->lastFile)
-			dir->lastFile->next = info;
+			dir->lastFile->next = file;
 		else
-			dir->firstFile = info;
-		dir->lastFile = info;
+			dir->firstFile = file;
+		dir->lastFile = file;
 
-		notiftFileAdded(info);
+		{
+			auto lock = CreateLock(shard.lock);
+			shard.files[file->path] = file;
+		}
+
+		updateFile(file, content, timestamp, false);
+
+		if (notify)
+			notiftFileAdded(file);
 	}
 
-	return true;
+	evictFiles(file);
+	return file;
 }
 
-bool MemoryFileSystem::testStoreFileContent(StringView path, Buffer data, TimeStamp timestamp /*= TimeStamp::GetNow()*/)
+void MemoryFileSystem::updateFile(File* file, Buffer content, TimeStamp timestamp, bool deleted)
 {
-	DEBUG_CHECK_RETURN_EX_V(ValidateDepotFilePath(path), "Invalid path", false);
+	{
+		auto& shard = fileShard(file->path);
+		auto lock = CreateLock(shard.lock);
 
-	auto* dir = testCreatePath(path.pathParent(), false);
-	DEBUG_CHECK_RETURN_EX_V(dir, "Directory entry does not exist yet or is deleted", false);
+		m_memoryUsage -= file->content.size();
+		m_memoryUsage += content.size();
+
+		file->content = content;
+		file->timestamp = timestamp;
+		file->deleted = deleted;
+	}
+
+	// any update counts as use
+	lruUpdate(file);
+}
 
-	const auto fileName = path.pathFileName();
-	for (auto* file = dir->firstFile; file; file = file->next)
+void MemoryFileSystem::removeFile(File* file)
+{
+	// release the content so it's no longer accounted for
+	updateFile(file, nullptr, file->timestamp, true);
+	notiftFileRemoved(file);
+}
+
+void MemoryFileSystem::evictFiles(const File* fileToKeep)
+{
+	const auto budget = m_memoryBudget.load();
+	if (!budget || m_memoryUsage <= budget)
+		return;
+
+	while (m_memoryUsage > budget)
 	{
-		DEBUG_CHECK_RETURN_EX_V(file->name != fileName, "File already exists in directory", false);
+		File* file = nullptr;
+
+		{
+			auto lock = CreateLock(m_lruLock);
+			file = m_lruTail;
+		}
+
+		// the file we just stored is the most recently used one, nothing older is left
+		if (!file || file == fileToKeep)
+			break;
+
+		removeFile(file);
+		++m_evictedFileCount;
 	}
+}
 
-	auto* info = m_filePool.create();
-	info->parent = dir;
-	info->content = data;
-	info->name = StringBuf(fileName);
-	info->readonly = false;
-	info->timestamp = timestamp;
-	info->next = nullptr;
+//--
 
-	if (dir->lastFile)
-		dir->lastFile->next = info;
-	else
-		dir->firstFile = info;
-	dir->lastFile = info;
+bool MemoryFileSystem::testUpdateFileContentExternal(StringView path, Buffer data, TimeStamp timestamp /*= TimeStamp::GetNow()*/)
+{
+	DEBUG_CHECK_RETURN_EX_V(ValidateDepotFilePath(path), "Invalid path", false);
+
+	StructureLock lock(*this);
+
+	auto* dir = findDirectory(path.pathParent());
+	DEBUG_CHECK_RETURN_EX_V(dir, "Directory entry does not exist yet or is deleted", false);
+
+	storeFile(dir, path, data, timestamp, true);
+	return true;
+}
 
+bool MemoryFileSystem::testStoreFileContent(StringView path, Buffer data, TimeStamp timestamp /*= TimeStamp::GetNow()*/)
+{
+	DEBUG_CHECK_RETURN_EX_V(ValidateDepotFilePath(path), "Invalid path", false);
+
+	StructureLock lock(*this);
+
+	auto* dir = createDirectoryPath(path.pathParent(), false);
+	DEBUG_CHECK_RETURN_EX_V(dir, "Directory entry does not exist yet or is deleted", false);
+
+	DEBUG_CHECK_RETURN_EX_V(!findFile(path), "File already exists in directory", false);
+
+	storeFile(dir, path, data, timestamp, false);
 	return true;
 }
 
@@ -161,38 +402,39 @@ bool MemoryFileSystem::testStoreFileContentText(StringView path, StringView data
 
 bool MemoryFileSystem::testHasFile(StringView path) const
 {
-	const auto* file = testFileEntryFind(path);
-	return file != nullptr;
+	FileState state;
+	return readFile(path, state);
 }
 
 bool MemoryFileSystem::testHasDirectory(StringView path) const
 {
-	const auto* dir = testDirectoryEntryFind(path);
-	return dir != nullptr;
+	auto lock = CreateLock(m_lock);
+	return findDirectory(path) != nullptr;
 }
 
 Buffer MemoryFileSystem::testLoadFileContent(StringView path) const
 {
-	const auto* file = testFileEntryFind(path);
-	return file ? file->content : nullptr;
+	FileState state;
+	return readFile(path, state) ? state.content : nullptr;
 }
 
 StringBuf MemoryFileSystem::testLoadFileContentText(StringView path) const
 {
-	const auto* file = testFileEntryFind(path);
-	return file ? StringBuf(file->content) : nullptr;
+	FileState state;
+	return readFile(path, state) ? StringBuf(state.content) : nullptr;
 }
 
 //--
 
 FileReaderPtr MemoryFileSystem::openForReading(StringView absoluteFilePath, FileReadMode mode, TimeStamp* outTimestamp /*= nullptr*/) const
 {
-	if (const auto* file = testFileEntryFind(absoluteFilePath))
+	FileState state;
+	if (readFile(absoluteFilePath, state))
 	{
 		if (outTimestamp)
-			*outTimestamp = file->timestamp;
+			*outTimestamp = state.timestamp;
 
-		return IFileReader::CreateFromBuffer(file->content, StringBuf(absoluteFilePath));
+		return IFileReader::CreateFromBuffer(state.content, StringBuf(absoluteFilePath));
 	}
 
 	return nullptr;
@@ -220,197 +462,94 @@ private:
 
 FileWriterPtr MemoryFileSystem::openForWriting(StringView absoluteFilePath, FileWriteMode mode)
 {
-	auto dirPath = absoluteFilePath.pathParent();
-	auto* dir = testDirectoryEntryFind(dirPath);
-	if (!dir)
-		return nullptr;
-
-	auto ret = RefNew<MemoryFileSystemFileWriter>(*this, StringBuf(absoluteFilePath));
-
-	if (mode == FileWriteMode::ReadWrite)
 	{
-		if (auto* file = testFileEntryFind(absoluteFilePath))
-			ret->writeSync(file->content.data(), file->content.size());
-	}
-
-	return ret;
-}
-
-MemoryFileSystem::File* MemoryFileSystem::testFileEntryFind(StringView path)
-{
-	return const_cast<MemoryFileSystem::File*>(const_cast<const MemoryFileSystem*>(this)->testFileEntryFind(path));
-}
-
-const MemoryFileSystem::File* MemoryFileSystem::testFileEntryFind(StringView path) const
-{
-	ASSERT(ValidateDepotFilePath(path));
-
-	const auto dirPath = path.pathParent();
-	const auto fileName = path.pathFileName();
-
-	if (auto* dir = testDirectoryEntryFind(dirPath))
-		for (auto* file = dir->firstFile; file; file = file->next)
-			if (!file->deleted && file->name == fileName)
-				return file;
-
-	return nullptr;
-}
-
-MemoryFileSystem::Directory* MemoryFileSystem::testDirectoryEntryFind(StringView path)
-{
-	return const_cast<MemoryFileSystem::Directory*>(const_cast<const MemoryFileSystem*>(this)->testDirectoryEntryFind(path));
-}
-
-const MemoryFileSystem::Directory* MemoryFileSystem::testDirectoryEntryFind(StringView path) const
-{
-	ASSERT(ValidateDepotDirPath(path));
-
-	InplaceArray<StringView, 10> parts;
-	path.slice('/', parts);
-
-	const Directory* dir = m_root;
-	for (auto part : parts)
-	{
-		const Directory* childDir = nullptr;
-		for (const auto* testDir = dir->firstDir; testDir; testDir = testDir->next)
-		{
-			if (!testDir->deleted && testDir->name == part)
-			{
-				childDir = testDir;
-				break;
-			}
-		}
-
-		if (!childDir)
+		auto lock = CreateLock(m_lock);
+		if (!findDirectory(absoluteFilePath.pathParent()))
 			return nullptr;
-
-		dir = childDir;
 	}
 
-	return dir;
-}
-
-MemoryFileSystem::Directory* MemoryFileSystem::testCreatePath(StringView path, bool notify)
-{
-	DEBUG_CHECK_RETURN_EX_V(ValidateDepotDirPath(path), "Invalid path", nullptr);
-
-	InplaceArray<StringView, 10> parts;
-	path.slice('/', parts);
-
-	if (!path.endsWith("/") && !parts.empty())
-		parts.popBack();
+	auto ret = RefNew<MemoryFileSystemFileWriter>(*this, StringBuf(absoluteFilePath));
 
-	Directory* dir = m_root;
-	for (auto part : parts)
+	if (mode == FileWriteMode::ReadWrite)
 	{
-		Directory* childDir = nullptr;
-		for (auto* testDir = dir->firstDir; testDir; testDir = testDir->next)
-		{
-			if (testDir->name == part)
-			{
-				childDir = testDir;
-				break;
-			}
-		}
-
-		if (childDir)
-		{
-			if (childDir->deleted)
-			{
-				childDir->deleted = false;
-
-				if (notify)
-					notiftDirectoryAdded(childDir);
-			}
-		}
-		else
-		{
-			childDir = m_directoryPool.create();
-			childDir->parent = dir;
-			childDir->name = StringBuf(part);
-
-			if (dir->lastDir)
-				dir->lastDir->next = childDir;
-			else
-				dir->firstDir = childDir;
-			dir->lastDir = childDir;
-
-			if (notify)
-				notiftDirectoryAdded(childDir);
-		}
-
-		dir = childDir;
+		// stored content is never modified in place, we write to a private copy
+		FileState state;
+		if (readFile(absoluteFilePath, state))
+			ret->writeSync(state.content.data(), state.content.size());
 	}
 
-	return dir;
+	return ret;
 }
 
 bool MemoryFileSystem::createPath(StringView path)
 {
-	return nullptr != testCreatePath(path, true);
+	StructureLock lock(*this);
+	return nullptr != createDirectoryPath(path, true);
 }
 
 bool MemoryFileSystem::moveFile(StringView srcAbsolutePath, StringView destAbsolutePath)
 {
-	auto* srcEntry = testFileEntryFind(srcAbsolutePath);
-	if (!srcEntry || srcEntry->deleted)
+	StructureLock lock(*this);
+
+	auto* srcEntry = findFile(srcAbsolutePath);
+	if (!srcEntry)
 		return false;
 
-	if (testFileEntryFind(destAbsolutePath))
+	if (srcEntry == findFile(destAbsolutePath))
 		return false;
 
 	const auto destAbsoluteDirPath = destAbsolutePath.pathParent();
-	auto* destDir = testDirectoryEntryFind(destAbsoluteDirPath);
+	auto* destDir = findDirectory(destAbsoluteDirPath);
 	if (!destDir)
 		return false;
 
-	srcEntry->deleted = true;
-	notiftFileRemoved(srcEntry);
-
-	if (!testUpdateFileContentExternal(destAbsolutePath, srcEntry->content, srcEntry->timestamp))
-	{
-		srcEntry->deleted = false;
-		notiftFileAdded(srcEntry);
-		return false;
-	}
+	const auto content = srcEntry->content;
+	const auto timestamp = srcEntry->timestamp;
+	removeFile(srcEntry);
 
+	storeFile(destDir, destAbsolutePath, content, timestamp, true);
 	return true;
 }
 
 bool MemoryFileSystem::copyFile(StringView srcAbsolutePath, StringView destAbsolutePath)
 {
-	auto* srcEntry = testFileEntryFind(srcAbsolutePath);
-	if (!srcEntry || srcEntry->deleted)
+	StructureLock lock(*this);
+
+	auto* srcEntry = findFile(srcAbsolutePath);
+	if (!srcEntry)
 		return false;
 
-	if (testFileEntryFind(destAbsolutePath))
+	if (findFile(destAbsolutePath))
 		return false;
 
 	const auto destAbsoluteDirPath = destAbsolutePath.pathParent();
-	auto* destDir = testDirectoryEntryFind(destAbsoluteDirPath);
+	auto* destDir = findDirectory(destAbsoluteDirPath);
 	if (!destDir)
 		return false;
 
-	testUpdateFileContentExternal(destAbsolutePath, srcEntry->content, srcEntry->timestamp);
+	// content is shared, not copied
+	storeFile(destDir, destAbsolutePath, srcEntry->content, srcEntry->timestamp, true);
 	return true;
 }
 
 bool MemoryFileSystem::deleteFile(StringView absoluteFilePath)
 {
-	auto* srcEntry = testFileEntryFind(absoluteFilePath);
-	if (!srcEntry || srcEntry->deleted)
-		return false;
+	StructureLock lock(*this);
 
-	srcEntry->deleted = true;
-	notiftFileRemoved(srcEntry);
+	auto* srcEntry = findFile(absoluteFilePath);
+	if (!srcEntry)
+		return false;
 
+	removeFile(srcEntry);
 	return true;
 }
 
 bool MemoryFileSystem::deleteDir(StringView absoluteDirPath)
 {
-	auto* srcEntry = testDirectoryEntryFind(absoluteDirPath);
-	if (!srcEntry || srcEntry->deleted || srcEntry == m_root)
+	StructureLock lock(*this);
+
+	auto* srcEntry = findDirectory(absoluteDirPath);
+	if (!srcEntry || srcEntry == m_root)
 		return false;
 
 	for (auto* file = srcEntry->firstFile; file; file = file->next)
@@ -429,46 +568,60 @@ bool MemoryFileSystem::deleteDir(StringView absoluteDirPath)
 
 bool MemoryFileSystem::fileInfo(StringView absoluteFilePath, TimeStamp* outTimeStamp /*= nullptr*/, uint64_t* outFileSize /*= nullptr*/) const
 {
-	const auto* srcEntry = testFileEntryFind(absoluteFilePath);
-	if (!srcEntry || srcEntry->deleted)
+	FileState state;
+	if (!readFile(absoluteFilePath, state))
 		return false;
 
 	if (outTimeStamp)
-		*outTimeStamp = srcEntry->timestamp;
+		*outTimeStamp = state.timestamp;
 
 	if (outFileSize)
-		*outFileSize = srcEntry->content.size();
+		*outFileSize = state.content.size();
 
 	return true;
 }
 
 bool MemoryFileSystem::touchFile(StringView absoluteFilePath)
 {
-	auto* srcEntry = testFileEntryFind(absoluteFilePath);
-	if (!srcEntry || srcEntry->deleted)
+	StructureLock lock(*this);
+
+	auto* srcEntry = findFile(absoluteFilePath);
+	if (!srcEntry)
 		return false;
 
-	srcEntry->timestamp = TimeStamp::GetNow();
+	updateFile(srcEntry, srcEntry->content, TimeStamp::GetNow(), false);
 	notiftFileChanged(srcEntry);
 	return true;
 }
 
 bool MemoryFileSystem::isFileReadOnly(StringView absoluteFilePath) const
 {
-	const auto* srcEntry = testFileEntryFind(absoluteFilePath);
-	if (!srcEntry || srcEntry->deleted)
+	FileState state;
+	if (!readFile(absoluteFilePath, state))
 		return false;
 
-	return srcEntry->readonly;
+	return state.readonly;
 }
 
 bool MemoryFileSystem::readOnlyFlag(StringView absoluteFilePath, bool flag)
 {
-	auto* srcEntry = testFileEntryFind(absoluteFilePath);
-	if (!srcEntry || srcEntry->deleted)
+	StructureLock lock(*this);
+
+	auto* srcEntry = findFile(absoluteFilePath);
+	if (!srcEntry)
 		return false;
 
-	srcEntry->readonly = flag;
+	{
+		auto shardLock = CreateLock(fileShard(srcEntry->path).lock);
+		srcEntry->readonly = flag;
+	}
+
+	lruUpdate(srcEntry);
+
+	// file might have been the only thing keeping us within budget
+	if (!flag)
+		evictFiles(nullptr);
+
 	return true;
 }
 
@@ -478,13 +631,12 @@ bool MemoryFileSystem::enumFiles(StringView absoluteFilePath, StringView searchP
 {
 	DEBUG_CHECK_RETURN_EX_V(ValidateDepotDirPath(absoluteFilePath), "Invalid path", false);
 
+	auto lock = CreateLock(m_lock);
+
 	InplaceArray<const Directory*, 64> dirStack;
 
-	{
-		const auto* entry = testDirectoryEntryFind(absoluteFilePath);
-		if (entry && !entry->deleted)
-			dirStack.pushBack(entry);
-	}
+	if (const auto* entry = findDirectory(absoluteFilePath))
+		dirStack.pushBack(entry);
 
 	while (!dirStack.empty())
 	{
@@ -499,8 +651,7 @@ bool MemoryFileSystem::enumFiles(StringView absoluteFilePath, StringView searchP
 			if (!file->name.view().matchPattern(searchPattern))
 				continue;
 
-			const auto fullPath = fileAbsolutePath(file);
-			if (enumFunc(fullPath, file->name))
+			if (enumFunc(file->path, file->name))
 				return true;
 		}
 
@@ -527,8 +678,10 @@ bool MemoryFileSystem::enumSubDirs(StringView absoluteFilePath, const std::funct
 {
 	DEBUG_CHECK_RETURN_EX_V(ValidateDepotDirPath(absoluteFilePath), "Invalid path", false);
 
-	const auto* entry = testDirectoryEntryFind(absoluteFilePath);
-	if (!entry || entry->deleted)
+	auto lock = CreateLock(m_lock);
+
+	const auto* entry = findDirectory(absoluteFilePath);
+	if (!entry)
 		return false;
 
 	for (const auto* childDir = entry->firstDir; childDir; childDir = childDir->next)
@@ -547,8 +700,10 @@ bool MemoryFileSystem::enumLocalFiles(StringView absoluteFilePath, StringView se
 {
 	DEBUG_CHECK_RETURN_EX_V(ValidateDepotDirPath(absoluteFilePath), "Invalid path", false);
 
-	const auto* entry = testDirectoryEntryFind(absoluteFilePath);
-	if (!entry || entry->deleted)
+	auto lock = CreateLock(m_lock);
+
+	const auto* entry = findDirectory(absoluteFilePath);
+	if (!entry)
 		return false;
 
 	for (const auto* file = entry->firstFile; file; file = file->next)
@@ -560,7 +715,7 @@ bool MemoryFileSystem::enumLocalFiles(StringView absoluteFilePath, StringView se
 			continue;
 
 		if (enumFunc(file->name))
-			return true; 
+			return true;
 	}
 
 	return false;
@@ -576,6 +731,8 @@ bool MemoryFileSystem::enumFileSystemRoots(const std::function<bool(StringView n
 DirectoryWatcherPtr MemoryFileSystem::createDirectoryWatcher(StringView path)
 {
 	auto watcher = RefNew<MemoryFileSystemWatcher>();
+
+	auto lock = CreateLock(m_lock);
 	m_watchers.pushBack(watcher.get());
 	return watcher;
 }
@@ -584,125 +741,98 @@ DirectoryWatcherPtr MemoryFileSystem::createDirectoryWatcher(StringView path)
 
 bool MemoryFileSystem::loadFileToBuffer(StringView absoluteFilePath, IPoolUnmanaged& pool, Buffer& outBuffer, TimeStamp* outTimestamp /*= nullptr*/, FileReadMode mode /*= FileReadMode::MemoryMapped*/) const
 {
-	const auto* entry = testFileEntryFind(absoluteFilePath);
-	if (!entry || entry->deleted)
+	FileState state;
+	if (!readFile(absoluteFilePath, state))
 		return false;
 
-	outBuffer = entry->content;
+	outBuffer = state.content;
 
 	if (outTimestamp)
-		*outTimestamp = entry->timestamp;
+		*outTimestamp = state.timestamp;
 
 	return true;
 }
 
 bool MemoryFileSystem::saveFileFromBuffer(StringView absoluteFilePath, BufferView data, const TimeStamp* timestampToAssign /*= nullptr*/)
 {
-	if (auto* file = testFileEntryFind(absoluteFilePath))
-	{
-		file->content = Buffer::CreateFromCopy(MainPool(), data);
-		file->timestamp = timestampToAssign ? *timestampToAssign : TimeStamp::GetNow();
+	DEBUG_CHECK_RETURN_EX_V(ValidateDepotFilePath(absoluteFilePath), "Invalid path", false);
 
-		notiftFileChanged(file);
-	}
-	else
-	{
-		if (!testStoreFileContent(absoluteFilePath, Buffer::CreateFromCopy(MainPool(), data)))
-			return false;
+	// copy outside the lock
+	auto content = Buffer::CreateFromCopy(MainPool(), data);
+	const auto timestamp = timestampToAssign ? *timestampToAssign : TimeStamp::GetNow();
 
-		if (auto* file = testFileEntryFind(absoluteFilePath))
-			notiftFileAdded(file);
-	}
+	StructureLock lock(*this);
+
+	auto* dir = createDirectoryPath(absoluteFilePath.pathParent(), false);
+	if (!dir)
+		return false;
 
+	storeFile(dir, absoluteFilePath, content, timestamp, true);
 	return true;
 }
 
 //--
 
-void MemoryFileSystem::dispatchFileSystemEvent(const DirectoryWatcherEvent& evt)
+void MemoryFileSystem::queueFileSystemEvent(DirectoryWatcherEventType type, const StringBuf& path)
 {
-	for (const auto& watcher : m_watchers)
-		if (auto locked = watcher.lock())
-			locked->dispatchEvent(evt);
+	if (m_watchers.empty())
+		return;
+
+	auto& evt = m_pendingEvents.emplaceBack();
+	evt.type = type;
+	evt.path = path;
 }
 
-void MemoryFileSystem::dirAbsolutePath(const Directory* dir, IFormatStream& f) const
+void MemoryFileSystem::dispatchPendingEvents()
 {
-	DEBUG_CHECK_RETURN_EX(dir, "Invalid directory");
+	// events are taken and dispatched under one lock so a batch queued later can't overtake an earlier one being dispatched on other thread
+	auto dispatchLock = CreateLock(m_dispatchLock);
 
-	if (dir == m_root)
-	{
-		f << "/";
-	}
-	else
-	{
-		ASSERT(dir->parent != nullptr);
-		dirAbsolutePath(dir->parent, f);
+	Array<DirectoryWatcherEvent> events;
+	InplaceArray<RefPtr<MemoryFileSystemWatcher>, 8> watchers;
 
-		f << dir->name;
-		f << "/";
-	}
-}
-
-StringBuf MemoryFileSystem::fileAbsolutePath(const File* file) const
-{
-	DEBUG_CHECK_RETURN_EX_V(file, "Invalid file", "");
+	{
+		auto lock = CreateLock(m_lock);
+		if (m_pendingEvents.empty())
+			return;
 
-	TempString txt;
-	dirAbsolutePath(file->parent, txt);
-	txt << file->name;	
-	return txt;
-}
+		events = std::move(m_pendingEvents);
 
-StringBuf MemoryFileSystem::dirAbsolutePath(const Directory* dir) const
-{
-	DEBUG_CHECK_RETURN_EX_V(dir, "Invalid directory", "");
+		for (const auto& watcher : m_watchers)
+			if (auto locked = watcher.lock())
+				watchers.pushBack(locked);
+	}
 
-	TempString txt;
-	dirAbsolutePath(dir, txt);
-	return txt;
+	for (const auto& evt : events)
+		for (const auto& watcher : watchers)
+			watcher->dispatchEvent(evt);
 }
 
 void MemoryFileSystem::notiftFileAdded(const File* file)
 {
-	DirectoryWatcherEvent evt;
-	evt.type = DirectoryWatcherEventType::FileAdded;
-	evt.path = fileAbsolutePath(file);
-	dispatchFileSystemEvent(evt);	
+	queueFileSystemEvent(DirectoryWatcherEventType::FileAdded, file->path);
 }
 
 void MemoryFileSystem::notiftFileRemoved(const File* file)
 {
-	DirectoryWatcherEvent evt;
-	evt.type = DirectoryWatcherEventType::FileRemoved;
-	evt.path = fileAbsolutePath(file);
-	dispatchFileSystemEvent(evt);
+	queueFileSystemEvent(DirectoryWatcherEventType::FileRemoved, file->path);
 }
 
 void MemoryFileSystem::notiftFileChanged(const File* file)
 {
-	DirectoryWatcherEvent evt;
-	evt.type = DirectoryWatcherEventType::FileContentChanged;
-	evt.path = fileAbsolutePath(file);
-	dispatchFileSystemEvent(evt);
+	queueFileSystemEvent(DirectoryWatcherEventType::FileContentChanged, file->path);
 }
 
 void MemoryFileSystem::notiftDirectoryAdded(const Directory* dir)
 {
-	DirectoryWatcherEvent evt;
-	evt.type = DirectoryWatcherEventType::DirectoryAdded;
-	evt.path = dirAbsolutePath(dir);
-	dispatchFileSystemEvent(evt);
+	queueFileSystemEvent(DirectoryWatcherEventType::DirectoryAdded, dir->path);
 }
 
 void MemoryFileSystem::notiftDirectoryRemoved(const Directory* dir)
 {
-	DirectoryWatcherEvent evt;
-	evt.type = DirectoryWatcherEventType::DirectoryRemoved;
-	evt.path = dirAbsolutePath(dir);
-	dispatchFileSystemEvent(evt);
+	queueFileSystemEvent(DirectoryWatcherEventType::DirectoryRemoved, dir->path);
 }
 
 //--
 
-END_INFERNO_NAMESPACE()
\ No newline at end of file
+END_INFERNO_NAMESPACE()
@@ -17,8 +17,11 @@
 #include <sys/types.h>
 #include <sys/inotify.h>
 #include <sys/stat.h>
+#include <sys/uio.h>
+#include <sys/mman.h>
 #include <dirent.h>
 #include <fcntl.h>
+#include <unistd.h>
 
 BEGIN_INFERNO_NAMESPACE_EX(posix)
 
@@ -273,6 +276,87 @@ uint64_t ReadFileHandle::readSync(void* data, uint64_t size)
     return numRead;
 }
 
+void ReadFileHandle::accessHint(FileAbsoluteRange range, FileAccessHint hint)
+{
+    if (!range)
+        return;
+
+    int advice = POSIX_FADV_NORMAL;
+    switch (hint)
+    {
+        case FileAccessHint::Sequential: advice = POSIX_FADV_SEQUENTIAL; break;
+        case FileAccessHint::Random: advice = POSIX_FADV_RANDOM; break;
+        case FileAccessHint::WillNeed: advice = POSIX_FADV_WILLNEED; break;
+        case FileAccessHint::DontNeed: advice = POSIX_FADV_DONTNEED; break;
+        default: break;
+    }
+
+#ifdef PLATFORM_LINUX
+    // readahead() populates the page cache right away instead of just scheduling it
+    if (hint == FileAccessHint::WillNeed && 0 == readahead(m_fileHandle, range.absoluteStart(), range.size()))
+        return;
+#endif
+
+    if (const auto ret = posix_fadvise(m_fileHandle, range.absoluteStart(), range.size(), advice))
+        TRACE_WARNING("[FILE] posix_fadvise failed for '{}', error: {}", m_origin, ret);
+}
+
+FileMappingPtr ReadFileHandle::createMapping(FileAbsoluteRange range)
+{
+    DEBUG_CHECK_RETURN_EX_V(range.size(), "Cannot map empty file view", nullptr);
+    DEBUG_CHECK_RETURN_EX_V(range.absoluteEnd() <= size(), "File range is invalid", nullptr);
+
+    // mmap requires page aligned offset
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+    const auto mappedOffset = range.absoluteStart() & ~(pageSize - 1);
+    const auto dataOffset = range.absoluteStart() - mappedOffset;
+    const auto mappedSize = dataOffset + range.size();
+
+    void* ptr = mmap(nullptr, mappedSize, PROT_READ, MAP_PRIVATE, m_fileHandle, mappedOffset);
+    DEBUG_CHECK_RETURN_EX_V(ptr != MAP_FAILED, TempString("Failed to create memory mapped view of file '{}' at {}, error: {}", m_origin, range, errno), nullptr);
+
+    return RefNew<MemoryMappedView>(m_origin, ptr, mappedSize, dataOffset, range.size());
+}
+
+//--
+
+MemoryMappedView::MemoryMappedView(StringBuf info, void* mappedPtr, uint64_t mappedSize, uint64_t dataOffset, uint64_t size)
+    : IFileMapping(info, (const uint8_t*)mappedPtr + dataOffset, size)
+    , m_mappedPtr(mappedPtr)
+    , m_mappedSize(mappedSize)
+{}
+
+MemoryMappedView::~MemoryMappedView()
+{
+    munmap(m_mappedPtr, m_mappedSize);
+}
+
+void MemoryMappedView::accessHint(uint64_t offset, uint64_t size, FileAccessHint hint) const
+{
+    DEBUG_CHECK_RETURN_EX(offset <= m_size && size <= m_size - offset, "Invalid range of mapped memory");
+
+    if (!size)
+        return;
+
+    int advice = MADV_NORMAL;
+    switch (hint)
+    {
+        case FileAccessHint::Sequential: advice = MADV_SEQUENTIAL; break;
+        case FileAccessHint::Random: advice = MADV_RANDOM; break;
+        case FileAccessHint::WillNeed: advice = MADV_WILLNEED; break;
+        case FileAccessHint::DontNeed: advice = MADV_DONTNEED; break; // NOTE: safe, the mapping is private and read only so pages are just loaded again
+        default: break;
+    }
+
+    // madvise requires page aligned start
+    static const uint64_t pageSize = sysconf(_SC_PAGESIZE);
+    const auto start = (uint64_t)(m_data + offset) & ~(pageSize - 1);
+    const auto end = (uint64_t)(m_data + offset + size);
+
+    if (0 != madvise((void*)start, end - start, advice))
+        TRACE_WARNING("[FILE] madvise failed for {} of '{}', error: {}", MemSize(size), m_info, errno);
+}
+
 //--
 
 WriteFileHandle::WriteFileHandle(int hFile, const StringBuf& origin)
@@ -322,6 +406,83 @@ uint64_t WriteFileHandle::writeSync(const void* data, uint64_t size)
     return numWritten;
 }
 
+uint64_t WriteFileHandle::writeVectorSync(ArrayView<BufferView> blocks)
+{
+    static const uint32_t MAX_BLOCKS_PER_CALL = 64; // well below IOV_MAX on all sane systems
+
+    uint64_t totalWritten = 0;
+
+    uint32_t blockIndex = 0;
+    while (blockIndex < blocks.size())
+    {
+        // gather as many blocks as we can into one system call
+        struct iovec vecs[MAX_BLOCKS_PER_CALL];
+        uint32_t numVecs = 0;
+        uint64_t expectedSize = 0;
+        while (blockIndex < blocks.size() && numVecs < MAX_BLOCKS_PER_CALL)
+        {
+            const auto& block = blocks[blockIndex++];
+            vecs[numVecs].iov_base = (void*)block.data();
+            vecs[numVecs].iov_len = block.size();
+            expectedSize += block.size();
+            numVecs += 1;
+        }
+
+        // write all gathered blocks, partial writes are normal for big writes so we continue from where the system stopped
+        struct iovec* vecPtr = vecs;
+        uint64_t leftToWrite = expectedSize;
+        while (leftToWrite > 0)
+        {
+            const auto numWritten = writev(m_fileHandle, vecPtr, numVecs);
+            if (numWritten < 0 && errno == EINTR)
+                continue;
+
+            if (numWritten <= 0)
+            {
+                TRACE_ERROR("Vectored write failed for '{}', written {} instead of {} ({} blocks): error: {}",
+                    m_origin, expectedSize - leftToWrite, expectedSize, numVecs, errno);
+                return totalWritten;
+            }
+
+            totalWritten += numWritten;
+            leftToWrite -= numWritten;
+
+            // skip blocks that were fully written and move into the one that was written partially
+            auto numBytes = (uint64_t)numWritten;
+            while (numVecs > 0 && numBytes >= vecPtr->iov_len)
+            {
+                numBytes -= vecPtr->iov_len;
+                vecPtr += 1;
+                numVecs -= 1;
+            }
+
+            if (numBytes > 0)
+            {
+                vecPtr->iov_base = (uint8_t*)vecPtr->iov_base + numBytes;
+                vecPtr->iov_len -= numBytes;
+            }
+        }
+    }
+
+    return totalWritten;
+}
+
+bool WriteFileHandle::flushSync(bool toDisk)
+{
+    // there's no user-space buffering on the descriptor, only the OS cache may need flushing
+    if (!toDisk)
+        return true;
+
+    // NOTE: we only care about the data, metadata (like modification time) can be lazily updated
+    if (0 != fdatasync(m_fileHandle))
+    {
+        TRACE_WARNING("Failed to flush '{}' to disk: error: {}", m_origin, errno);
+        return false;
+    }
+
+    return true;
+}
+
 //--
 
 WriteTempFileHandle::WriteTempFileHandle(const StringBuf& targetPath, const StringBuf& tempFilePath, const FileWriterPtr& tempFileWriter)
@@ -420,6 +581,7 @@ uint64_t AsyncFileHandle::readAsync(uint64_t offset, uint64_t size, void* readBu
 //--
 
 DirectoryWatcher::DirectoryWatcher(StringView rootPath)
+    : m_rootPath(rootPath)
 {
     // create the notify interface
     m_masterHandle = inotify_init1(IN_NONBLOCK);
@@ -432,60 +594,48 @@ DirectoryWatcher::DirectoryWatcher(StringView rootPath)
         TRACE_ERROR("Failed to create directory watcher");
     }
 
-    // create the watcher thread
+    // create the watcher thread, it starts by monitoring the root path so we don't walk the whole tree here
     ThreadSetup setup;
     setup.m_name = "DirectoryWatcher";
     setup.m_priority = ThreadPriority::AboveNormal;
     setup.m_function = [this]() { watch(); };
     m_localThread.init(setup);
-
-    // start monitoring the root path
-    monitorPath(rootPath);
 }
 
 DirectoryWatcher::~DirectoryWatcher()
 {
+    // stop thread
+    m_requestExit = true;
+    m_localThread.close();
+
     // close the master handle
     if (m_masterHandle >= 0)
     {
-        // unmonitor all paths
-        {
-            ScopeLock<SpinLock> lock(m_mapLock);
-
-            for (auto watchId : m_handleToPath.keys())
-                inotify_rm_watch(m_masterHandle, watchId);
+        unmonitorAll();
 
-            m_handleToPath.clear();
-            m_pathToHandle.clear();
-        }
-
-        // close the master handle
         close(m_masterHandle);
         m_masterHandle = -1;
     }
-
-    // stop thread
-    m_localThread.close();
 }
 
-void DirectoryWatcher::attachListener(IDirectoryWatcherListener* listener)
+static uint64_t GetFileModificationStamp(const char* path)
 {
-    ScopeLock<Mutex> lock(m_listenersLock);
-    m_listeners.pushBack(listener);
+    struct stat st;
+    if (0 != stat(path, &st))
+        return 0;
+
+    return ((uint64_t)st.st_mtim.tv_sec * 1000000000ULL + st.st_mtim.tv_nsec) ^ ((uint64_t)st.st_size << 1);
 }
 
-void DirectoryWatcher::dettachListener(IDirectoryWatcherListener* listener)
+void DirectoryWatcher::rememberFile(const StringBuf& path)
 {
-    ScopeLock<Mutex> lock(m_listenersLock);
-    auto index = m_listeners.find(listener);
-    if (index != -1)
-        m_listeners[index] = nullptr;
+    m_knownFiles.set(path, GetFileModificationStamp(path.c_str()));
 }
 
 void DirectoryWatcher::monitorPath(StringView str)
 {
-    // we can create the watch only if we are initialized properly
-    if (m_masterHandle >= 0)
+    // we can create the watch only if we are initialized properly, don't bother if we are closing
+    if (m_masterHandle >= 0 && !m_requestExit.load())
     {
         StringBuf path(str);
 
@@ -502,6 +652,10 @@ void DirectoryWatcher::monitorPath(StringView str)
                 m_pathToHandle.set(str.calcCRC64(), watcherId);
             }
 
+            // remember existing files so we can tell what changed if we ever loose events
+            for (FileIterator it(path.c_str(), "*.*", true, false); it; ++it)
+                rememberFile(TempString("{}{}", str, it.fileName()));
+
             // monitor the existing sub directories as well
             for (FileIterator it(path.c_str(), "*.", false, true); it; ++it)
                 monitorPath(TempString("{}{}/", str, it.fileName()));
@@ -534,189 +688,233 @@ void DirectoryWatcher::unmonitorPath(StringView str)
     }
 }
 
-void DirectoryWatcher::watch()
+void DirectoryWatcher::unmonitorAll()
 {
-    for (;;)
+    ScopeLock<SpinLock> lock(m_mapLock);
+
+    for (auto watchId : m_handleToPath.keys())
+        inotify_rm_watch(m_masterHandle, watchId);
+
+    m_handleToPath.clear();
+    m_pathToHandle.clear();
+}
+
+void DirectoryWatcher::rescan()
+{
+    PC_SCOPE_LVL1(DirectoryWatcherRescan);
+
+    TRACE_WARNING("[FILE] Directory watcher event queue for '{}' overflowed, rescanning", m_rootPath);
+
+    // capture what we knew before
+    auto oldFiles = std::move(m_knownFiles);
+    HashMap<StringBuf, bool> oldDirectories;
     {
-        // nothing to read
-        if (m_masterHandle <= 0)
-            break;
+        ScopeLock<SpinLock> lock(m_mapLock);
+        for (const auto& path : m_handleToPath.values())
+            oldDirectories.set(path, true);
+    }
 
-        // read data from the crap
-        auto dataSize = read(m_masterHandle, m_buffer, BUF_LEN);
-        if (dataSize < 0)
-        {
-            if (errno == EAGAIN)
-            {
-                Thread::Sleep(10);
-                continue;
-            }
+    // recreate all watches, this also collects current state of all files
+    unmonitorAll();
+    m_filesNotYetClosed.clear();
+    m_knownFiles.clear();
+    monitorPath(m_rootPath);
 
-            TRACE_ERROR("Read error in the directory watcher data stream: {}", errno);
-            break;
-        }
+    // report differences
+    for (const auto& pair : m_knownFiles.pairs())
+    {
+        uint64_t oldStamp = 0;
+        if (!oldFiles.find(pair.key, oldStamp))
+            m_coalescer.push(DirectoryWatcherEventType::FileAdded, pair.key);
+        else if (oldStamp != pair.value)
+            m_coalescer.push(DirectoryWatcherEventType::FileContentChanged, pair.key);
+    }
 
-        // prepare tables
-        m_tempEvents.reset();
-        m_tempAddedDirectories.reset();
-        m_tempRemovedDirectories.reset();
+    for (const auto& path : oldFiles.keys())
+        if (!m_knownFiles.contains(path))
+            m_coalescer.push(DirectoryWatcherEventType::FileRemoved, path);
 
-        // process data
-        auto cur = &m_buffer[0];
-        auto end = &m_buffer[dataSize];
-        while (cur < end)
-        {
-            // get event
-            auto& evt = *(struct inotify_event*)cur;
+    {
+        ScopeLock<SpinLock> lock(m_mapLock);
 
-            // prevent modifications of the map table
-            m_mapLock.acquire();
+        for (const auto& path : m_handleToPath.values())
+            if (!oldDirectories.contains(path))
+                m_coalescer.push(DirectoryWatcherEventType::DirectoryAdded, path);
 
-            // identify the target path entry
-            auto pathEntry = m_handleToPath.find(evt.wd);
-            if (!pathEntry)
-            {
-                TRACE_INFO("IO event at unrecognized path, ID {}, '{}'", evt.wd, (const char*)evt.name);
-                m_mapLock.release();
-                break;
-            }
+        for (const auto& path : oldDirectories.keys())
+            if (!m_pathToHandle.contains(path.view().calcCRC64()))
+                m_coalescer.push(DirectoryWatcherEventType::DirectoryRemoved, path);
+    }
+}
 
-            TRACE_INFO("IO watcher: '{}' '{}' {}", pathEntry->c_str(), (const char*)evt.name, Hex(evt.mask));
+void DirectoryWatcher::processEvent(const struct inotify_event& evt)
+{
+    // identify the target path entry
+    StringBuf dirPath;
+    {
+        ScopeLock<SpinLock> lock(m_mapLock);
 
-            // self deleted
-            if (evt.mask & (IN_DELETE_SELF | IN_MOVE_SELF))
-            {
-                // find path
-                TRACE_INFO("Observed directory '{}' self deleted", pathEntry->c_str());
-                auto& info = m_tempEvents.emplaceBack();
-                info.type = DirectoryWatcherEventType::DirectoryRemoved;
-                info.path = *pathEntry;
-
-                // unmap
-                m_pathToHandle.remove(pathEntry->view().calcCRC64());
-                m_handleToPath.remove(evt.wd);
-                m_mapLock.release();
-            }
-            else
-            {
-                // format full path
-                bool isDir = (0 != (evt.mask & IN_ISDIR));
-                auto shortPath = &evt.name[0];
-                m_mapLock.release();
-
-                // format path
-                auto fullPath = isDir 
-                    ? StringBuf(TempString("{}{}/", pathEntry->view(), shortPath))
-                    : StringBuf(TempString("{}{}", pathEntry->view(), shortPath));
-
-                // stuff was created
-                if (evt.mask & IN_CREATE)
-                {
-                    // if a directory is added make sure to monitor it as well
-                    if (isDir)
-                    {
-                        m_tempAddedDirectories.pushBack(fullPath);
+        const auto* pathEntry = m_handleToPath.find(evt.wd);
+        if (!pathEntry)
+        {
+            // events for already removed watches are still in the queue
+            if (!(evt.mask & IN_IGNORED))
+                TRACE_SPAM("IO event at unrecognized path, ID {}, '{}'", evt.wd, (const char*)evt.name);
+            return;
+        }
 
-                        auto& evt = m_tempEvents.emplaceBack();
-                        evt.type = isDir ? DirectoryWatcherEventType::DirectoryAdded : DirectoryWatcherEventType::FileAdded;
-                        evt.path = fullPath;
-                    }
-                    else
-                    {
-                        // remember the file around
-                        m_filesCreatedButNotYetClosed.pushBackUnique(fullPath);
-                    }
-                }
+        dirPath = *pathEntry;
+    }
 
-                // writable file was closed
-                if (evt.mask & IN_CLOSE_WRITE)
-                {
-                    // report event only if the fle was previously modified
-                    if (m_filesCreatedButNotYetClosed.remove(fullPath))
-                    {
-                        auto& evt = m_tempEvents.emplaceBack();
-                        evt.type = DirectoryWatcherEventType::FileAdded;
-                        evt.path = fullPath;
-                    }
+    // self deleted
+    if (evt.mask & (IN_DELETE_SELF | IN_MOVE_SELF))
+    {
+        TRACE_SPAM("Observed directory '{}' self deleted", dirPath);
+        m_coalescer.push(DirectoryWatcherEventType::DirectoryRemoved, dirPath);
 
-                    // just modified
-                    if (m_filesModifiedButNotYetClosed.remove(fullPath))
-                    {
-                        auto& evt = m_tempEvents.emplaceBack();
-                        evt.type = DirectoryWatcherEventType::FileContentChanged;
-                        evt.path = fullPath;
-                    }
-                }
+        ScopeLock<SpinLock> lock(m_mapLock);
+        m_pathToHandle.remove(dirPath.view().calcCRC64());
+        m_handleToPath.remove(evt.wd);
+        return;
+    }
 
-                // file was moved
-                if (evt.mask & IN_MOVED_TO)
-                {
-                    // if a directory is added make sure to monitor it as well
-                    if (isDir)
-                        m_tempAddedDirectories.pushBack(fullPath);
-
-                    // create direct event
-                    auto& evt = m_tempEvents.emplaceBack();
-                    evt.type = isDir ? DirectoryWatcherEventType::DirectoryAdded : DirectoryWatcherEventType::FileAdded;
-                    evt.path = fullPath;
-                }
+    // format full path
+    const bool isDir = (0 != (evt.mask & IN_ISDIR));
+    const auto fullPath = isDir
+        ? StringBuf(TempString("{}{}/", dirPath, (const char*)evt.name))
+        : StringBuf(TempString("{}{}", dirPath, (const char*)evt.name));
 
-                // stuff was removed
-                if (evt.mask & (IN_DELETE | IN_MOVED_FROM))
-                {
-                    // if a directory is added make sure to monitor it as well
-                    if (isDir)
-                        m_tempRemovedDirectories.pushBack(fullPath);
-
-                    // create event
-                    auto& evt = m_tempEvents.emplaceBack();
-                    evt.type = isDir ? DirectoryWatcherEventType::DirectoryRemoved : DirectoryWatcherEventType::FileRemoved;
-                    evt.path = fullPath;
-                }
+    if (isDir)
+    {
+        // directories are reported right away, new ones must be monitored asap so we don't miss their content
+        if (evt.mask & (IN_CREATE | IN_MOVED_TO))
+        {
+            m_tempAddedDirectories.pushBack(fullPath);
+            m_coalescer.push(DirectoryWatcherEventType::DirectoryAdded, fullPath);
+        }
 
-                // stuff was changed
-                if (evt.mask & (IN_MODIFY))
-                {
-                    if (!isDir)
-                        m_filesModifiedButNotYetClosed.pushBackUnique(fullPath);
-                }
+        if (evt.mask & (IN_DELETE | IN_MOVED_FROM))
+        {
+            m_tempRemovedDirectories.pushBack(fullPath);
+            m_coalescer.push(DirectoryWatcherEventType::DirectoryRemoved, fullPath);
+        }
 
-                // metadata changed
-                if (evt.mask & (IN_ATTRIB))
-                {
-                    auto& evt = m_tempEvents.emplaceBack();
-                    evt.type = DirectoryWatcherEventType::FileMetadataChanged;
-                    evt.path = fullPath;
-                }
-            }
+        return;
+    }
+
+    // file was created, report it once it's closed
+    if (evt.mask & IN_CREATE)
+        m_filesNotYetClosed.set(fullPath, DirectoryWatcherEventType::FileAdded);
 
-            // advance
-            cur += sizeof(struct inotify_event) + evt.len;
+    // file was modified, report it once it's closed
+    if (evt.mask & IN_MODIFY)
+    {
+        if (!m_filesNotYetClosed.contains(fullPath))
+            m_filesNotYetClosed.set(fullPath, DirectoryWatcherEventType::FileContentChanged);
+    }
+
+    // writable file was closed
+    if (evt.mask & IN_CLOSE_WRITE)
+    {
+        DirectoryWatcherEventType type;
+        if (m_filesNotYetClosed.find(fullPath, type))
+        {
+            m_filesNotYetClosed.remove(fullPath);
+            m_coalescer.push(type, fullPath);
         }
 
-        // unmonitor directories that got removed
-        for (auto& path : m_tempRemovedDirectories)
-            unmonitorPath(path);
+        rememberFile(fullPath);
+    }
+
+    // file was moved in (temp file renamed over the target, etc), replacing a file we already knew about is just a change of its content
+    if (evt.mask & IN_MOVED_TO)
+    {
+        const auto replaced = m_knownFiles.contains(fullPath);
+        m_coalescer.push(replaced ? DirectoryWatcherEventType::FileContentChanged : DirectoryWatcherEventType::FileAdded, fullPath);
+        rememberFile(fullPath);
+    }
+
+    // file was removed
+    if (evt.mask & (IN_DELETE | IN_MOVED_FROM))
+    {
+        DirectoryWatcherEventType type;
+        if (m_filesNotYetClosed.find(fullPath, type))
+            m_filesNotYetClosed.remove(fullPath);
+
+        m_coalescer.push(DirectoryWatcherEventType::FileRemoved, fullPath);
+        m_knownFiles.remove(fullPath);
+    }
 
-        // start monitoring directories that go added
-        for (auto& path : m_tempAddedDirectories)
-            monitorPath(path);
+    // metadata changed
+    if (evt.mask & IN_ATTRIB)
+        m_coalescer.push(DirectoryWatcherEventType::FileMetadataChanged, fullPath);
+}
+
+void DirectoryWatcher::watch()
+{
+    // start monitoring the root path, this adds watches for the whole tree and stats all files in it
+    monitorPath(m_rootPath);
+
+    while (!m_requestExit.load())
+    {
+        // nothing to read
+        if (m_masterHandle < 0)
+            break;
+
+        // read data from the crap
+        auto dataSize = read(m_masterHandle, m_buffer, BUF_LEN);
+        if (dataSize < 0 && errno != EAGAIN)
+        {
+            TRACE_ERROR("Read error in the directory watcher data stream: {}", errno);
+            break;
+        }
 
-        // lock access to this thread only
-        ScopeLock<Mutex> lock(m_listenersLock);
+        // prepare tables
+        m_tempAddedDirectories.reset();
+        m_tempRemovedDirectories.reset();
 
-        // send events to the listeners
-        for (auto& evt : m_tempEvents)
+        // process data
+        bool overflow = false;
+        if (dataSize > 0)
         {
-            for (auto listener : m_listeners)
+            auto cur = &m_buffer[0];
+            auto end = &m_buffer[dataSize];
+            while (cur < end)
             {
-                if (listener != nullptr)
-                    listener->handleEvent(evt);
+                const auto& evt = *(const struct inotify_event*)cur;
+                cur += sizeof(struct inotify_event) + evt.len;
+
+                if (evt.mask & IN_Q_OVERFLOW)
+                    overflow = true;
+                else
+                    processEvent(evt);
             }
         }
 
-        // remove the empty listeners
-        m_listeners.remove(nullptr);
+        // we've lost events, the only way to recover is to compare the state of the disk with what we knew
+        if (overflow)
+        {
+            rescan();
+        }
+        else
+        {
+            // unmonitor directories that got removed
+            for (auto& path : m_tempRemovedDirectories)
+                unmonitorPath(path);
+
+            // start monitoring directories that go added
+            for (auto& path : m_tempAddedDirectories)
+                monitorPath(path);
+        }
+
+        // send whatever settled down to the listeners in one batch
+        m_tempEvents.reset();
+        if (m_coalescer.flush(m_tempEvents))
+            dispatchEvents(m_tempEvents);
+
+        // limit CPU usage when there's nothing to read
+        if (dataSize <= 0)
+            Thread::Sleep(10);
     }
 }
 
@@ -993,13 +1191,6 @@ bool FileSystem::moveFile(StringView srcAbsolutePath, StringView destAbsolutePat
     const prv::TempPathStringBuffer srcFilePath(srcAbsolutePath);
     const prv::TempPathStringBuffer destFilePath(destAbsolutePath);
 
-    // Delete destination file
-    if (-1 != access(destFilePath, F_OK))
-    {
-        TRACE_ERROR("Unable to move file \"{}\" to \"{}\" - destination file already exists", srcAbsolutePath, destAbsolutePath);
-        return false;
-    }
-
     // create target path
     if (!createPath(destAbsolutePath))
     {
@@ -1007,7 +1198,7 @@ bool FileSystem::moveFile(StringView srcAbsolutePath, StringView destAbsolutePat
         return false;
     }
 
-    // Move the file
+    // Move the file, NOTE: rename() atomically replaces the destination file if it exists
     if (0 != rename(srcFilePath, destFilePath))
     {
         auto err = errno;
@@ -11,8 +11,10 @@
 #include "fileFormat.h"
 #include "fileSystem.h"
 #include "fileReader.h"
+#include "fileMapping.h"
 #include "fileAsyncHandle.h"
 #include "fileDirectoryWatcher.h"
+#include "fileDirectoryWatcherCoalescer.h"
 
 #include "bm/core/memory/include/structurePool.h"
 #include "bm/core/containers/include/queue.h"
@@ -41,12 +43,28 @@ public:
     virtual uint64_t pos() const override final;
     virtual bool pos(uint64_t newPosition) override final;
     virtual uint64_t readSync(void* data, uint64_t size) override final;
+    virtual void accessHint(FileAbsoluteRange range, FileAccessHint hint) override final;
+    virtual FileMappingPtr createMapping(FileAbsoluteRange range) override final;
 
 protected:
     int m_fileHandle = -1;
     StringBuf m_origin;
 };
 
+// mmap based view of part of the file
+class MemoryMappedView : public IFileMapping
+{
+public:
+    MemoryMappedView(StringBuf info, void* mappedPtr, uint64_t mappedSize, uint64_t dataOffset, uint64_t size);
+    virtual ~MemoryMappedView();
+
+    virtual void accessHint(uint64_t offset, uint64_t size, FileAccessHint hint) const override final;
+
+protected:
+    void* m_mappedPtr = nullptr; // page aligned start of the mapping
+    uint64_t m_mappedSize = 0;
+};
+
 // POSIX based file handle
 class WriteFileHandle : public IFileWriter
 {
@@ -61,6 +79,8 @@ public:
     virtual uint64_t pos() const override final;
     virtual bool pos(uint64_t newPosition) override final;
     virtual uint64_t writeSync(const void* data, uint64_t size) override final;
+    virtual uint64_t writeVectorSync(ArrayView<BufferView> blocks) override final;
+    virtual bool flushSync(bool toDisk) override final;
     virtual void discardContent() override final;
 
 protected:
@@ -132,42 +152,45 @@ private:
 //--
 
  /// POSIX implementation of the watcher
+/// Raw inotify events are coalesced and debounced, listeners get them in batches
 class DirectoryWatcher : public IDirectoryWatcher
 {
 public:
     DirectoryWatcher(StringView rootPath);
     virtual ~DirectoryWatcher();
 
-    //! attach listener
-    virtual void attachListener(IDirectoryWatcherListener* listener) override;
-    virtual void dettachListener(IDirectoryWatcherListener* listener) override;
-
 private:
     static const uint32_t BUF_LEN = 1024 * 64;
 
     int m_masterHandle;
-
-    Mutex m_listenersLock;
-    Array<IDirectoryWatcherListener*> m_listeners;
+    StringBuf m_rootPath;
 
     SpinLock m_mapLock;
     HashMap<int, StringBuf> m_handleToPath;
     HashMap<uint64_t, int> m_pathToHandle;
 
     Thread m_localThread;
+    std::atomic<bool> m_requestExit = false;
+
+    DirectoryWatcherEventCoalescer m_coalescer;
 
     Array<DirectoryWatcherEvent> m_tempEvents;
     Array<StringBuf> m_tempAddedDirectories;
     Array<StringBuf> m_tempRemovedDirectories;
 
-    Array<StringBuf> m_filesCreatedButNotYetClosed;
-    Array<StringBuf> m_filesModifiedButNotYetClosed;
+    HashMap<StringBuf, DirectoryWatcherEventType> m_filesNotYetClosed; // files that were created/modified but are still open for writing
+    HashMap<StringBuf, uint64_t> m_knownFiles; // file -> modification stamp, used to recover from event queue overflow
 
     uint8_t m_buffer[BUF_LEN];
 
     void monitorPath(StringView path);
     void unmonitorPath(StringView path);
+    void unmonitorAll();
+
+    void rememberFile(const StringBuf& path);
+    void rescan();
 
+    void processEvent(const struct inotify_event& evt);
     void watch();
 };
 
@@ -26,6 +26,29 @@ FileMemoryMappedView::~FileMemoryMappedView()
 	UnmapViewOfFile(m_rawPtr);
 }
 
+void FileMemoryMappedView::accessHint(uint64_t offset, uint64_t size, FileAccessHint hint) const
+{
+	DEBUG_CHECK_RETURN_EX(offset <= m_size && size <= m_size - offset, "Invalid range of mapped memory");
+
+	if (!size)
+		return;
+
+	if (hint == FileAccessHint::WillNeed)
+	{
+		WIN32_MEMORY_RANGE_ENTRY entry;
+		entry.VirtualAddress = (void*)(m_data + offset);
+		entry.NumberOfBytes = size;
+
+		if (!PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0))
+			TRACE_WARNING("[FILE] Failed to prefetch {} of '{}', error: {}", MemSize(size), m_info, GetLastError());
+	}
+	else if (hint == FileAccessHint::DontNeed)
+	{
+		// unlocking pages that are not locked removes them from the working set, pages stay in the standby list
+		VirtualUnlock((void*)(m_data + offset), size);
+	}
+}
+
 //--
 
 END_INFERNO_NAMESPACE_EX(windows)
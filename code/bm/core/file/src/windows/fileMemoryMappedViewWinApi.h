@@ -21,6 +21,8 @@ class FileMemoryMappedView : public IFileMapping
 public:
     FileMemoryMappedView(StringBuf info, HANDLE hMemoryMapped, void* ptr, uint64_t size);
     virtual ~FileMemoryMappedView();
+
+    virtual void accessHint(uint64_t offset, uint64_t size, FileAccessHint hint) const override final;
     
 protected:
     HANDLE m_hMemoryMappedHandle = nullptr;
@@ -139,6 +139,34 @@ FileMappingPtr FileReader::createMapping(FileAbsoluteRange range)
     return RefNew<FileMemoryMappedView>(m_info, m_hMemoryMappedHandle, ptr, range.size());
 }
 
+void FileReader::accessHint(FileAbsoluteRange range, FileAccessHint hint)
+{
+    // there's no equivalent of fadvise on Windows, access pattern can only be specified when file is opened
+    // we can however pull the data into the file cache by prefetching a temporary mapped view
+    if (hint != FileAccessHint::WillNeed || !m_hMemoryMappedHandle || !range || !fullRange().contains(range))
+        return;
+
+    static const uint64_t allocationGranularity = []() {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        return (uint64_t)info.dwAllocationGranularity;
+    }();
+
+    const auto alignedStart = range.absoluteStart() & ~(allocationGranularity - 1);
+    const auto alignedSize = range.absoluteEnd() - alignedStart;
+
+    void* ptr = MapViewOfFile(m_hMemoryMappedHandle, FILE_MAP_READ, (DWORD)(alignedStart >> 32), (DWORD)(alignedStart & 0xFFFFFFFF), alignedSize);
+    if (!ptr)
+        return;
+
+    WIN32_MEMORY_RANGE_ENTRY entry;
+    entry.VirtualAddress = ptr;
+    entry.NumberOfBytes = alignedSize;
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &entry, 0);
+
+    UnmapViewOfFile(ptr);
+}
+
 //--
 
 
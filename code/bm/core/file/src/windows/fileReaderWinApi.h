@@ -39,6 +39,8 @@ public:
 	virtual FileViewPtr createView(FileAbsoluteRange range) override;
 	virtual FileMappingPtr createMapping(FileAbsoluteRange range) override;
 
+    virtual void accessHint(FileAbsoluteRange range, FileAccessHint hint) override;
+
     //--
     
     void releaseSyncHandle(HANDLE handle);
@@ -432,6 +432,18 @@ bool FileSystem::moveFile(StringView srcAbsolutePath, StringView destAbsolutePat
     TempPathStringBufferUTF16 backupDestStr(destAbsolutePath);
     backupDestStr.append(L".bak");
 
+    // ReplaceFile requires the destination to exist, plain move is enough otherwise
+    if (!fileInfo(destAbsolutePath))
+    {
+        if (!MoveFileExW(srcStr, destStr, MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+        {
+            TRACE_WARNING("[FILE] Failed to move file '{}' into '{}': 0x{}", srcAbsolutePath, destAbsolutePath, Hex(GetLastError()));
+            return false;
+        }
+
+        return true;
+    }
+
     DWORD flags = REPLACEFILE_IGNORE_MERGE_ERRORS | REPLACEFILE_IGNORE_ACL_ERRORS;
     if (!ReplaceFileW(destStr, srcStr, backupDestStr, flags, NULL, NULL))
     {
@@ -439,6 +451,7 @@ bool FileSystem::moveFile(StringView srcAbsolutePath, StringView destAbsolutePat
         return false;
     }
 
+    DeleteFileW(backupDestStr);
     return true;
 }
 
@@ -91,6 +91,12 @@ uint64_t FileUnbufferedDiskView::readSync(void* readBuffer, uint64_t size)
 	return actualRead;
 }
 
+void FileUnbufferedDiskView::accessHint(FileAbsoluteRange range, FileAccessHint hint)
+{
+	if (auto owner = m_owner.lock())
+		owner->accessHint(range, hint);
+}
+
 //--
 
 END_INFERNO_NAMESPACE_EX(windows)
@@ -30,6 +30,7 @@ public:
 	virtual uint64_t offset() const override;
 	virtual void seek(uint64_t offset) override;
     virtual uint64_t readSync(void* readBuffer, uint64_t size) override;
+    virtual void accessHint(FileAbsoluteRange range, FileAccessHint hint) override;
 
     //--
     
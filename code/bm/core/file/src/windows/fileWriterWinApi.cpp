@@ -107,6 +107,21 @@ uint64_t FileWriter::writeSync(const void* ptr, uint64_t size)
 	return actualWrite;
 }
 
+bool FileWriter::flushSync(bool toDisk)
+{
+	// there's no user-space buffering on the handle, only the OS cache may need flushing
+	if (!toDisk)
+		return true;
+
+	if (!FlushFileBuffers(m_hSyncHandle))
+	{
+		TRACE_WARNING("[FILE] Failed to flush '{}' to disk, error: 0x{}", m_info, Hex(GetLastError()));
+		return false;
+	}
+
+	return true;
+}
+
 //--
 
 END_INFERNO_NAMESPACE_EX(windows)
@@ -29,6 +29,7 @@ public:
 
 	virtual uint64_t readSync(void* ptr, uint64_t size) override final;
 	virtual uint64_t writeSync(const void* ptr, uint64_t size) override final;
+	virtual bool flushSync(bool toDisk) override final;
 
 	//--
 
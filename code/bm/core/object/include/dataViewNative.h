@@ -34,6 +34,11 @@ public:
     virtual DataViewResult readDataView(StringView viewPath, void* targetData, Type targetType) const override;
     virtual DataViewResult writeDataView(StringView viewPath, const void* sourceData, Type sourceType) const override;
 
+    // access via precompiled path, see IObject::readCompiledDataView
+    DataViewResult describeCompiledDataView(const DataViewPath& path, DataViewInfo& outInfo) const;
+    DataViewResult readCompiledDataView(const DataViewPath& path, void* targetData, Type targetType) const;
+    DataViewResult writeCompiledDataView(const DataViewPath& path, const void* sourceData, Type sourceType) const;
+
     // IDataView - actions
     virtual DataViewActionResult actionValueWrite(StringView viewPath, const void* sourceData, Type sourceType) const override;
     virtual DataViewActionResult actionValueReset(StringView viewPath) const override;
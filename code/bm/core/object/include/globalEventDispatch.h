@@ -15,6 +15,8 @@ BEGIN_INFERNO_NAMESPACE()
 ///--
 
 /// listener/dispatcher that is capable of listening for particular event on particular object
+/// NOTE: events are dispatched without any lock held so dispatch() of the same listener may be called concurrently from different threads
+/// NOTE: a listener that is unregistered while an event is being dispatched may still receive that one event
 class BM_CORE_OBJECT_API IGlobalEventListener : public IReferencable
 {
 public:
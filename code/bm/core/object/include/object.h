@@ -114,6 +114,10 @@ struct BM_CORE_OBJECT_API ObjectLoadingContext : public NoCopy
 	// [optimization] when loading from a buffer that we can persist all embedded buffers can be effectively just views into the parent
 	Buffer dataOwnerToInheritOtherUncompressedBuffers;
 
+	// [optimization] when loading from a memory mapped file the embedded buffers can be views into the mapping instead of copies
+	// NOTE: this keeps the file mapped for as long as any of the buffers is alive, on Windows the file can't be replaced (saved) until then
+	bool keepFileMapped = false;
+
     //--
 
     ObjectLoadingContext();
@@ -139,6 +143,7 @@ struct BM_CORE_OBJECT_API ObjectSavingContext : public NoCopy
     bool decompressAllBuffer = false;
     bool inlineAllBuffer = false;
     bool inlineAllResources = false;
+    bool singleThreaded = false; // never save objects in parallel, output is exactly the same either way
 
     PrintFlags textPrintFlags;
 
@@ -209,12 +214,15 @@ public:
     //---
 
     // Called after object and all child objects were loaded and before the object is returned from job
+    // NOTE: always called on the loading thread, in the order objects were saved in
     virtual void onPostLoad();
 
     // Load object from binary stream
+    // NOTE: objects from bigger files are read in parallel, the implementation must not access other objects (even the ones it points to) - use onPostLoad for that
     virtual void onReadBinary(SerializationReader& reader);
 
     // Save object to binary stream
+    // NOTE: objects from bigger graphs are written in parallel, the implementation must not modify any shared state (including other objects)
     virtual void onWriteBinary(SerializationWriter& writer) const;
 
 	// We are reading object from binary stream and previously serialized property is no longer in the object and the type does not exist
@@ -246,6 +254,16 @@ public:
     /// Write data to memory
     virtual DataViewResult writeDataView(StringView viewPath, const void* sourceData, Type sourceType);
 
+    /// Describe data using precompiled path, falls back to the text path if path was compiled for different class
+    /// NOTE: compiled paths go directly to the class data, overrides of the describeDataView/readDataView/writeDataView are only used in the fallback
+    DataViewResult describeCompiledDataView(const DataViewPath& path, DataViewInfo& outInfo) const;
+
+    /// Read data from memory using precompiled path, falls back to the text path if path was compiled for different class
+    DataViewResult readCompiledDataView(const DataViewPath& path, void* targetData, Type targetType) const;
+
+    /// Write data to memory using precompiled path, falls back to the text path if path was compiled for different class
+    DataViewResult writeCompiledDataView(const DataViewPath& path, const void* sourceData, Type sourceType);
+
     //---
 
 	/// Write object into XML node (note: node must exist before, the "class" attribute is not written, it's responsibility of the parent)
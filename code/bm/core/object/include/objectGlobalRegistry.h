@@ -39,16 +39,20 @@ public:
 
     ///---
 
+    /// capture weak pointers to all currently registered objects (optionally only of given class), ordered by creation
+    /// NOTE: registry is not locked while the snapshot is used, objects may be already gone when we get to them
+    void collectObjects(Array<ObjectWeakPtr>& outObjects, ClassType objectClass = nullptr) const;
+
     /// visit all objects with a function on EACH OBJECT, do I have to say it will be slow ? :) 
-    /// NOTE: registry is locked during this update 
+    /// NOTE: function is called on a snapshot, objects can be freely created and destroyed in it
     bool iterateAllObjects(const std::function<bool(IObject*)>& enumFunc);
 
     /// visit all objects of specific class with a function, still slow
-    /// NOTE: registry is locked during this update 
+    /// NOTE: function is called on a snapshot, objects can be freely created and destroyed in it
     bool iterateObjectsOfClass(ClassType objectClass, const std::function<bool(IObject*)>& enumFunc);
 
     /// visit all objects of specific class with a function, still slow
-    /// NOTE: registry is locked during this update 
+    /// NOTE: function is called on a snapshot, objects can be freely created and destroyed in it
     template< typename T >
     INLINE bool iterateObjectsOfClass(const std::function<bool(T*)>& enumFunc)
     {
@@ -66,26 +70,48 @@ protected:
 
     //--
 
+    static const uint32_t NUM_SHARDS = 32; // objects are spread by ID, consecutive IDs land in different shards
     static const uint32_t MAX_BUCKETS = 16 * 1024;
+    static const uint32_t MAX_BUCKETS_PER_SHARD = MAX_BUCKETS / NUM_SHARDS;
 
     struct ObjectEntry
     {
         uint32_t id = 0;
+        const IClassType* cls = nullptr;
         ObjectWeakPtr ptr;
         ObjectEntry* nextBucket = nullptr;
         ObjectEntry* nextAll = nullptr;
         ObjectEntry* prevAll = nullptr;
     };
 
-    SpinLock m_objectsLock;
-    ObjectEntry* m_objectListHead = nullptr;
-    ObjectEntry* m_objectListTail = nullptr;
+    struct alignas(64) Shard
+    {
+        mutable SpinLock lock;
+        ObjectEntry* listHead = nullptr;
+        ObjectEntry* listTail = nullptr;
+
+        SimpleStructurePool<ObjectEntry> entryPool;
+        ObjectEntry* hashBuckets[MAX_BUCKETS_PER_SHARD];
+
+        Shard();
+    };
+
+    struct SnapshotEntry
+    {
+        uint32_t id = 0;
+        const IClassType* cls = nullptr;
+        ObjectWeakPtr ptr;
+    };
 
-    SimpleStructurePool<ObjectEntry> m_objectEntryPool;
-    ObjectEntry* m_objectHashBuckets[MAX_BUCKETS];
+    Shard m_shards[NUM_SHARDS];
 
     std::atomic<uint32_t> m_objectCount = 0;
 
+    INLINE static uint32_t ShardIndex(uint32_t id) { return id % NUM_SHARDS; }
+    INLINE static uint32_t BucketIndex(uint32_t id) { return (id / NUM_SHARDS) % MAX_BUCKETS_PER_SHARD; }
+
+    void collectEntries(Array<SnapshotEntry>& outEntries) const;
+
 
     //--
 
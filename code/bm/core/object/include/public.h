@@ -72,6 +72,9 @@ typedef RefPtr<IDataView> DataViewPtr;
 class DataViewNative;
 typedef RefPtr<DataViewNative> DataViewNativePtr;
 
+/// precompiled path in the data view
+class DataViewPath;
+
 // actions
 class IAction;
 typedef RefPtr<IAction> ActionPtr;
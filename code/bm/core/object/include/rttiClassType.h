@@ -35,6 +35,29 @@ struct BM_CORE_OBJECT_API TemplateProperty
     ~TemplateProperty();
 };
 
+/// compiled layout of class properties used by copy/compare/serialization
+/// adjacent plain data properties (no constructor/destructor, simple copy/compare) are merged into single memory ranges
+struct BM_CORE_OBJECT_API ClassPropertyPlan
+{
+    struct DataRange
+    {
+        uint32_t offset = 0;
+        uint32_t size = 0;
+    };
+
+    struct SerializedProperty
+    {
+        const Property* prop = nullptr;
+        bool plainData = false; // can be compared with memcmp
+    };
+
+    Array<DataRange> dataRanges; // merged plain data properties, copied with memcpy and compared with memcmp
+    Array<const Property*> complexProperties; // properties that require full copy()/compare() of their type
+    Array<SerializedProperty> serializedProperties; // non transient properties, in the same order as allProperties()
+
+    static bool IsPlainData(const Property* prop);
+};
+
 /// type describing a class, can be a native or abstract class, depends
 class BM_CORE_OBJECT_API IClassType : public IType
 {
@@ -113,6 +136,9 @@ public:
     typedef Array<TemplateProperty> TConstTemplateProperties;
     const TConstTemplateProperties& allTemplateProperties() const;
 
+    // get compiled property plan for fast copy/compare/serialization
+    const ClassPropertyPlan& propertyPlan() const;
+
     // find property with given name (recursive)
     const Property* findProperty(StringID propertyName) const;
 
@@ -234,6 +260,8 @@ protected:
     mutable std::atomic<TConstNativeFunctions*> m_allNativeFunctions = nullptr;
     mutable std::atomic<TConstScriptFunctions*> m_allScriptFunctions = nullptr;
 
+    mutable std::atomic<ClassPropertyPlan*> m_propertyPlan = nullptr;
+
     SpinLock m_listBuildLock;
 
     //--
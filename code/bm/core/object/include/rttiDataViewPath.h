@@ -0,0 +1,77 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: rtti\view #]
+***/
+
+#pragma once
+
+#include "bm/core/containers/include/stringBuf.h"
+#include "bm/core/containers/include/inplaceArray.h"
+
+#include "rttiTypeRef.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+/// Precompiled data view path, property names and array indices are resolved for given root type only once
+/// Reading/writing through the compiled path only follows the property offsets, no parsing or property lookup is done
+/// Anything that can't be resolved statically (object pointers, special "__xxx" members, etc) is left as a text remainder
+/// that is evaluated the normal way at the end of the chain
+class BM_CORE_OBJECT_API DataViewPath
+{
+public:
+    DataViewPath();
+    DataViewPath(Type rootType, StringView path);
+
+    //--
+
+    // type the path was compiled for, path can only be used with data of that type
+    INLINE Type rootType() const { return m_rootType; }
+
+    // original path
+    INLINE const StringBuf& path() const { return m_path; }
+
+    // part of the path that could not be compiled, usually empty
+    INLINE StringView remainder() const { return m_path.view().subString(m_remainderOffset); }
+
+    // number of resolved steps
+    INLINE uint32_t numSteps() const { return m_steps.size(); }
+
+    //--
+
+    /// Get metadata for view - describe what we will find here: flags, list of members, size of array, etc
+    DataViewResult describe(const void* rootData, DataViewInfo& outInfo) const;
+
+    /// Read data from memory
+    DataViewResult read(const void* rootData, void* targetData, Type targetType) const;
+
+    /// Write data to memory
+    DataViewResult write(void* rootData, const void* sourceData, Type sourceType) const;
+
+private:
+    struct Step
+    {
+        const Property* prop = nullptr; // step into property (offset)
+        const IArrayType* arrayType = nullptr; // step into array element
+        uint32_t arrayIndex = 0;
+        uint32_t pathOffset = 0; // where this step starts in the path
+        Type type; // type we end up in after this step
+    };
+
+    Type m_rootType;
+    StringBuf m_path;
+    InplaceArray<Step, 4> m_steps;
+    uint32_t m_remainderOffset = 0;
+
+    void compile();
+
+    DataViewResult resolve(const void* rootData, uint32_t numSteps, Type& outType, const void*& outData) const;
+};
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -16,6 +16,7 @@
 #include "rttiTypeRef.h"
 
 #include <functional>
+#include <atomic>
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -159,6 +160,19 @@ protected:
 
     bool m_fullyInitialized;
 
+    //--
+
+    // append-only table of the type names used by the lock-free lookups
+    struct TypeLookupTable;
+
+    std::atomic<const TypeLookupTable*> m_lookupTable;
+    Array<const TypeLookupTable*> m_retiredLookupTables; // outgrown tables, readers may still be using them, freed in deinit
+
+    Type findTypeInLookupTable(StringID name) const;
+    void insertIntoLookupTable_NoLock(StringID name, Type type, bool overrideExisting);
+
+    //--
+
     Type createDynamicType_NoLock(const char* typeName);
 };
 
@@ -52,7 +52,7 @@ public:
 
 	// get the memory where variant data is stored
     // NOTE: changes are not monitored
-	INLINE void* data() const { return m_data; }
+	INLINE void* data() const { return isInline() ? (void*)m_inlineData : m_data; }
 
     // check if we are of given type
     template< typename T >
@@ -132,12 +132,29 @@ public:
 
     //--
 
+    // can values of given type be stored directly inside the variant ?
+    // NOTE: variants are moved around with memcpy (ie. in arrays) so only types that don't care where they live qualify
+    static INLINE bool CanStoreInline(Type type)
+    {
+        const auto& traits = type->traits();
+        return !traits.requiresDestructor && traits.size <= INTERNAL_STORAGE_SIZE && traits.alignment <= 8;
+    }
+
 private:
     Type m_type = nullptr;
-    void* m_data = nullptr; // owned
+
+    union
+    {
+        void* m_data = nullptr; // owned, used when value does not fit inside
+        uint8_t m_inlineData[INTERNAL_STORAGE_SIZE];
+    };
+
+    INLINE bool isInline() const { return m_type && CanStoreInline(m_type); }
+
+    void moveFrom(Variant& other);
 
     static void* AllocateVariantMemory(Type type);
-    void FreeVariantMemory(void* data);
+    static void FreeVariantMemory(Type type, void* data);
 };
 
 //--
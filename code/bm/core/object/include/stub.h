@@ -96,17 +96,29 @@ struct StubPseudoArray : public MainPoolData<NoCopy>
 
 struct StubHeader
 {
-	static const uint32_t MAGIC = 'STUB';
+	static const uint32_t MAGIC = 'STUB'; // legacy, single compressed blob, header ends at numChunks
+	static const uint32_t MAGIC_CHUNKED = 'STBC'; // data compressed in independent chunks, followed by chunk table
+
+	static const uint32_t CHUNK_SIZE = 256 << 10; // size of uncompressed data in each chunk
 		
 	uint32_t magic = 0;
 	uint32_t version = 0;
 	uint32_t uncompressedSize = 0;
 	uint32_t additionalDataSize = 0;
-	uint32_t compressedCRC = 0;
+	uint32_t compressedCRC = 0; // CRC of the chunk table (or of the whole compressed blob in legacy format)
 
 	uint32_t numStrings = 0;
 	uint32_t numNames = 0;
 	uint32_t numStubs = 0;
+
+	uint32_t numChunks = 0;
+};
+
+struct StubChunkHeader
+{
+	uint32_t compressedSize = 0;
+	uint32_t uncompressedSize = 0;
+	uint32_t compressedCRC = 0;
 };
 
 //---
@@ -34,6 +34,9 @@ public:
 	// same as unpack but takes buffer
 	const IStub* unpack(const Buffer& buffer);
 
+	// unpack stubs stored in a file, memory mapped files are decompressed directly from the mapping without loading them first
+	const IStub* unpack(IFileReader* file);
+
 private:
 	const StubFactory& m_factory;
 
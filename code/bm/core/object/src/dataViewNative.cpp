@@ -91,6 +91,33 @@ DataViewResult DataViewNative::writeDataView(StringView viewPath, const void* so
     return DataViewResultCode::ErrorNullObject;
 }
 
+DataViewResult DataViewNative::describeCompiledDataView(const DataViewPath& path, DataViewInfo& outInfo) const
+{
+    if (m_object)
+        return m_object->describeCompiledDataView(path, outInfo);
+
+    return DataViewResultCode::ErrorNullObject;
+}
+
+DataViewResult DataViewNative::readCompiledDataView(const DataViewPath& path, void* targetData, Type targetType) const
+{
+    if (m_object)
+        return m_object->readCompiledDataView(path, targetData, targetType);
+
+    return DataViewResultCode::ErrorNullObject;
+}
+
+DataViewResult DataViewNative::writeCompiledDataView(const DataViewPath& path, const void* sourceData, Type sourceType) const
+{
+    if (m_readOnly)
+        return DataViewResultCode::ErrorReadOnly;
+
+    if (m_object)
+        return m_object->writeCompiledDataView(path, sourceData, sourceType);
+
+    return DataViewResultCode::ErrorNullObject;
+}
+
 DataViewResult DataViewNative::resetToDefaultValue(StringView viewPath, void* targetData, Type targetType) const
 {
     return writeDataView(viewPath, targetData, targetType);
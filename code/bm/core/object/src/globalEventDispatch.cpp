@@ -29,189 +29,206 @@ IGlobalEventListener::~IGlobalEventListener()
 
 namespace prv
 {
-    struct DispatchList : public IReferencable
+    // immutable list of listeners registered in one bucket of the registry
+    // NOTE: never modified after being published, changes create a new copy
+    struct ListenerSnapshot : public MainPoolData<NoCopy>
     {
-        DispatchList(StringID name)
-            : m_name(name)
-        {}
-
-        INLINE StringID name() const
-        {
-            return m_name;
-        }
-
-        void dispatch(IObject* source, const void* data, Type dataType)
-        {
-            InplaceArray<RefWeakPtr<IGlobalEventListener>, 20> validListeners;
-
-            for (auto entry : m_list)
-                if (entry && !entry.expired())
-                    validListeners.pushBack(entry);
-
-            for (auto entry : validListeners)
-                if (auto listener = entry.lock())
-                    listener->dispatch(source, data, dataType);
-        }
-
-        void add(IGlobalEventListener* listener)
-        {
-            if (listener)
-                m_list.pushBackUnique(listener);
-        }
-
-        bool remove(IGlobalEventListener* listener)
+        struct Entry
         {
-            m_list.remove(listener);
-            return m_list.empty();
-        }
+            GlobalEventKeyType key = 0;
+            StringID name;
+            const IGlobalEventListener* ptr = nullptr; // used only for comparison, listener may be already dead
+            RefWeakPtr<IGlobalEventListener> listener;
+        };
 
-    private:
-        Array<RefWeakPtr<IGlobalEventListener>> m_list;
-        StringID m_name;
+        Array<Entry> entries;
     };
 
-    struct KeyEntry : public IReferencable
+    class GlobalEventRegistry : public ISingleton
     {
-        KeyEntry(GlobalEventKey key)
-        {}
+        DECLARE_SINGLETON(GlobalEventRegistry);
 
-        virtual ~KeyEntry()
-        {
-            auto entries = std::move(m_lists);
-            for (auto* entry : entries)
-                entry->releaseRef();
-        }
+    public:
+        GlobalEventRegistry()
+        {}
 
-        void dispatch(StringID name, IObject* source, const void* data, Type dataType)
+        void registerListener(IGlobalEventListener* listener)
         {
-            for (auto index : m_lists.indexRange().reversed())
+            if (listener && listener->key() && listener->name())
             {
-                auto list = m_lists.typedData()[index];
-                if (list && list->name() == name)
+                const auto key = listener->key().rawValue();
+                const auto name = listener->name();
+
+                auto& bucket = m_buckets[BucketIndex(listener->key())];
+                auto lock = CreateLock(bucket.lock);
+
+                const auto* current = bucket.snapshot.load();
+                if (current)
                 {
-                    list->addRef();
-                    list->dispatch(source, data, dataType);
-                    list->releaseRef();
-                    break;
+                    for (const auto& entry : current->entries)
+                        if (entry.ptr == listener && entry.key == key && entry.name == name)
+                            return;
                 }
-            }
 
-            m_lists.removeUnorderedAll(nullptr);
+                auto* snapshot = CopySnapshot(current, nullptr);
+
+                auto& entry = snapshot->entries.emplaceBack();
+                entry.key = key;
+                entry.name = name;
+                entry.ptr = listener;
+                entry.listener = listener;
+
+                publish(bucket, snapshot);
+            }
         }
 
-        void add(StringID name, IGlobalEventListener* listener)
+        void unregisterListener(IGlobalEventListener* listener)
         {
-            for (auto* list : m_lists)
+            if (listener && listener->key() && listener->name())
             {
-                if (list && list->name() == name)
+                auto& bucket = m_buckets[BucketIndex(listener->key())];
+                auto lock = CreateLock(bucket.lock);
+
+                const auto* current = bucket.snapshot.load();
+                if (current)
                 {
-                    list->add(listener);
-                    return;
+                    bool found = false;
+                    for (const auto& entry : current->entries)
+                    {
+                        if (entry.ptr == listener)
+                        {
+                            found = true;
+                            break;
+                        }
+                    }
+
+                    if (found)
+                        publish(bucket, CopySnapshot(current, listener));
                 }
             }
-
-            auto list = new DispatchList(name);
-            m_lists.pushBack(list);
-            list->add(listener);
         }
-            
-        bool remove(StringID name, IGlobalEventListener* listener)
+
+        void dispatch(GlobalEventKey keyName, StringID eventName, IObject* source, const void* data /*= nullptr*/, Type dataType /*= Type()*/)
         {
-            for (auto index : m_lists.indexRange().reversed())
+            if (keyName && eventName)
             {
-                auto list = m_lists.typedData()[index];
-                if (list->name() == name)
+                // collect listeners from current snapshot, no locks are taken
+                InplaceArray<RefPtr<IGlobalEventListener>, 20> validListeners;
                 {
-                    if (list->remove(listener))
+                    const auto key = keyName.rawValue();
+
+                    auto& bucket = m_buckets[BucketIndex(keyName)];
+                    ++bucket.readers;
+
+                    if (const auto* snapshot = bucket.snapshot.load())
                     {
-                        m_lists.eraseUnordered(index);
-                        list->releaseRef();
+                        for (const auto& entry : snapshot->entries)
+                        {
+                            if (entry.key == key && entry.name == eventName)
+                            {
+                                if (auto listener = entry.listener.lock())
+                                    validListeners.pushBack(listener);
+                            }
+                        }
+                    }
+
+                    // last reader out frees the snapshots that were replaced while it was reading
+                    if (--bucket.readers == 0 && bucket.hasRetiredSnapshots.load())
+                    {
+                        auto lock = CreateLock(bucket.lock);
+                        freeRetiredSnapshots_NoLock(bucket);
                     }
-                    break;
                 }
-            }
 
-            return m_lists.empty();
+                // listeners are called without holding anything so they can freely bind/unbind other listeners
+                if (!validListeners.empty())
+                {
+                    TRACE_INFO("GlobalEvent: Dispatching {} from {}", eventName, keyName);
+                    for (const auto& listener : validListeners)
+                        listener->dispatch(source, data, dataType);
+                }
+            }
         }
 
     private:
-        GlobalEventKey m_key;
-        Array<DispatchList*> m_lists;
-    };
+        static const uint32_t NUM_BUCKETS = 1024;
 
-    class GlobalEventRegistry : public ISingleton
-    {
-        DECLARE_SINGLETON(GlobalEventRegistry);
+        struct alignas(64) Bucket
+        {
+            std::atomic<const ListenerSnapshot*> snapshot = nullptr;
+            std::atomic<uint32_t> readers = 0; // number of dispatches currently looking at the snapshot
+            std::atomic<bool> hasRetiredSnapshots = false;
 
-    public:
-        GlobalEventRegistry()
+            SpinLock lock; // guards modifications only
+            Array<const ListenerSnapshot*> retiredSnapshots; // replaced snapshots that may still be used by dispatches
+        };
+
+        Bucket m_buckets[NUM_BUCKETS];
+
+        static INLINE uint32_t BucketIndex(const GlobalEventKey& key)
         {
-            m_keyMaps.reserve(1024);
+            return GlobalEventKey::CalcHash(key) % NUM_BUCKETS;
         }
 
-        void registerListener(IGlobalEventListener* listener)
+        // copy all live entries into new snapshot, dead listeners are dropped
+        static ListenerSnapshot* CopySnapshot(const ListenerSnapshot* current, const IGlobalEventListener* removedListener)
         {
-            if (listener && listener->key() && listener->name())
-            {
-                auto lock = CreateLock(m_lock);
+            auto* snapshot = new ListenerSnapshot();
 
-                KeyEntry* key = nullptr;
-                if (!m_keyMaps.find(listener->key(), key))
-                {
-                    key = new KeyEntry(listener->key());
-                    m_keyMaps[listener->key()] = key;
-                }
+            if (current)
+            {
+                snapshot->entries.reserve(current->entries.size() + 1);
 
-                key->add(listener->name(), listener);
+                for (const auto& entry : current->entries)
+                    if (entry.ptr != removedListener && !entry.listener.expired())
+                        snapshot->entries.pushBack(entry);
             }
+
+            return snapshot;
         }
 
-        void unregisterListener(IGlobalEventListener* listener)
+        // publish new snapshot, old snapshot is freed right away if no dispatch is using this bucket or by the last dispatch that does
+        static void publish(Bucket& bucket, const ListenerSnapshot* snapshot)
         {
-            if (listener && listener->key() && listener->name())
+            if (snapshot->entries.empty())
             {
-                auto lock = CreateLock(m_lock);
-                auto listenerKey = listener->key();
-                auto listenerName = listener->name();
+                delete snapshot;
+                snapshot = nullptr;
+            }
 
-                KeyEntry* key = nullptr;
-                if (m_keyMaps.find(listenerKey, key))
-                {
-                    if (key->remove(listenerName, listener))
-                    {
-                        m_keyMaps.remove(listenerKey);
-                        key->releaseRef();
-                    }
-                }
+            if (const auto* old = bucket.snapshot.exchange(snapshot))
+            {
+                bucket.retiredSnapshots.pushBack(old);
+                bucket.hasRetiredSnapshots = true;
             }
+
+            // NOTE: any dispatch that starts after this point will see the new snapshot
+            // NOTE: the flag is set before the readers are checked (and the other way around in dispatch) so at least one side frees the retired snapshots
+            freeRetiredSnapshots_NoLock(bucket);
         }
 
-        void dispatch(GlobalEventKey keyName, StringID eventName, IObject* source, const void* data /*= nullptr*/, Type dataType /*= Type()*/)
+        static void freeRetiredSnapshots_NoLock(Bucket& bucket)
         {
-            if (keyName && eventName)
+            if (bucket.readers.load() == 0 && bucket.hasRetiredSnapshots.load())
             {
-                auto lock = CreateLock(m_lock);
-
-                KeyEntry* key = nullptr;
-                if (m_keyMaps.find(keyName, key))
-                {
-                    TRACE_INFO("GlobalEvent: Dispatching {} from {}", eventName, keyName);
-                    key->addRef();
-                    key->dispatch(eventName, source, data, dataType);
-                    key->releaseRef();
-                }
+                for (const auto* retired : bucket.retiredSnapshots)
+                    delete retired;
+                bucket.retiredSnapshots.reset();
+                bucket.hasRetiredSnapshots = false;
             }
         }
 
-    private:
-        Mutex m_lock;
-        HashMap<GlobalEventKey, KeyEntry*> m_keyMaps;
-
         virtual void deinit() override
         {
-            for (auto* entry : m_keyMaps.values())
-                entry->releaseRef();
-            m_keyMaps.clear();
+            for (auto& bucket : m_buckets)
+            {
+                delete bucket.snapshot.exchange(nullptr);
+
+                for (const auto* retired : bucket.retiredSnapshots)
+                    delete retired;
+                bucket.retiredSnapshots.clear();
+                bucket.hasRetiredSnapshots = false;
+            }
         }
     };
 
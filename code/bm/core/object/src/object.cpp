@@ -17,6 +17,7 @@
 #include "rttiNativeClassType.h"
 #include "rttiMetadata.h"
 #include "rttiDataView.h"
+#include "rttiDataViewPath.h"
 #include "rttiProperty.h"
 #include "rttiArrayType.h"
 #include "rttiHandleType.h"
@@ -82,7 +83,13 @@ struct ObjectCloneContext
 
     void cloneProperties(ClassType cls, void* dest, const void* src)
     {
-        for (const auto* prop : cls->allProperties().values())
+        const auto& plan = cls->propertyPlan();
+
+        // plain data can't reference any objects, copy it in as few blocks as possible
+        for (const auto& range : plan.dataRanges)
+            memcpy(OffsetPtr<void>(dest, range.offset), OffsetPtr<void>(src, range.offset), range.size);
+
+        for (const auto* prop : plan.complexProperties)
         {
             const void* srcData = prop->offsetPtr(src);
             void* destData = prop->offsetPtr(dest);
@@ -486,6 +493,39 @@ DataViewResult IObject::writeDataView(StringView viewPath, const void* sourceDat
     return DataViewResultCode::OK;
 }
 
+DataViewResult IObject::describeCompiledDataView(const DataViewPath& path, DataViewInfo& outInfo) const
+{
+    // object itself is described with some extra info
+    if (path.rootType() != cls() || path.path().empty())
+        return describeDataView(path.path(), outInfo);
+
+    return path.describe(this, outInfo);
+}
+
+DataViewResult IObject::readCompiledDataView(const DataViewPath& path, void* targetData, Type targetType) const
+{
+    if (path.rootType() != cls())
+        return readDataView(path.path(), targetData, targetType);
+
+    return path.read(this, targetData, targetType);
+}
+
+DataViewResult IObject::writeCompiledDataView(const DataViewPath& path, const void* sourceData, Type sourceType)
+{
+    if (path.rootType() != cls())
+        return writeDataView(path.path(), sourceData, sourceType);
+
+    if (!onPropertyChanging(path.path(), sourceData, sourceType))
+        return DataViewResultCode::ErrorIllegalOperation;
+
+    auto ret = path.write(this, sourceData, sourceType);
+    if (!ret.valid())
+        return ret;
+
+    onPropertyChanged(path.path());
+    return DataViewResultCode::OK;
+}
+
 //--
 
 DataViewPtr IObject::createDataView(bool forceReadOnly) const
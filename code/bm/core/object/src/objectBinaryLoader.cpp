@@ -16,12 +16,18 @@
 
 #include "bm/core/file/include/fileReader.h"
 #include "bm/core/file/include/fileView.h"
+#include "bm/core/file/include/fileMapping.h"
+#include "bm/core/file/include/filePrefetcher.h"
 #include "bm/core/parser/include/xmlReader.h"
 #include "bm/core/object/include/serializationReader.h"
 #include "bm/core/object/include/object.h"
 #include "serializationBufferFactory.h"
 #include "serializationStream.h"
 
+#include "bm/core/task/include/taskBuilder.h"
+#include "bm/core/task/include/taskSignal.h"
+#include "bm/core/task/include/taskUtils.h"
+
 BEGIN_INFERNO_NAMESPACE()
 
 //--
@@ -232,7 +238,7 @@ void ObjectBinaryLoader::ResolveExports(const SerializationBinaryFileTables& tab
     }
 }
 
-void ObjectBinaryLoader::ResolveBuffers(const SerializationBinaryFileTables& tables, const ObjectLoadingContext& context, SerializationResolvedReferences& resolvedReferences, BufferView data)
+void ObjectBinaryLoader::ResolveBuffers(const SerializationBinaryFileTables& tables, const ObjectLoadingContext& context, SerializationResolvedReferences& resolvedReferences, BufferView data, const Buffer& dataOwner)
 {
 	const auto numBuffers = tables.chunkCount(SerializationBinaryFileTables::ChunkType::Buffers);
 	//resolvedReferences.buffers.resize(numBuffers);
@@ -253,10 +259,10 @@ void ObjectBinaryLoader::ResolveBuffers(const SerializationBinaryFileTables& tab
             // use external factory
             loader = context.bufferFactory->createAsyncBufferLoader(info);
         }
-        else if (context.dataOwnerToInheritOtherUncompressedBuffers)
+        else if (dataOwner)
         {
 			// create a SUB BUFFER of the original buffer (this will keep the original buffer alive as well but that's what we wanted)
-			const auto compressedData = context.dataOwnerToInheritOtherUncompressedBuffers.createSubBuffer(ptr->dataOffset, ptr->compressedSize);
+			const auto compressedData = dataOwner.createSubBuffer(ptr->dataOffset, ptr->compressedSize);
 			DEBUG_CHECK_EX(compressedData, "Failed to create sub-buffer");
 
 			// wrap it in a async loader that will decompress the data on request
@@ -378,7 +384,7 @@ public:
         // if we have the owned buffer it would be best just to keep it
         if (context.dataOwnerToInheritOtherUncompressedBuffers)
             if (auto ret = createLoaderForBufferEntryFromOwnedBuffer(context, tables, bufferEntry))
-                return nullptr;
+                return ret;
 
         // we don't own the source data so we need to make a copy of it
         const auto compressedDataView = data.subView(bufferEntry.dataOffset, bufferEntry.compressedSize);
@@ -413,6 +419,110 @@ private:
 //--
 
 bool ObjectBinaryLoader::LoadObjects(const ObjectLoadingContext& context, BufferView data, ObjectPtr& outRoot)
+{
+    return LoadObjectsInternal(context, data, context.dataOwnerToInheritOtherUncompressedBuffers, outRoot);
+}
+
+bool ObjectBinaryLoader::LoadObjects(const ObjectLoadingContext& context, const Buffer& data, ObjectPtr& outRoot)
+{
+    // explicit owner from the context takes precedence
+    const auto& dataOwner = context.dataOwnerToInheritOtherUncompressedBuffers ? context.dataOwnerToInheritOtherUncompressedBuffers : data;
+    return LoadObjectsInternal(context, data, dataOwner, outRoot);
+}
+
+//--
+
+// files with fewer objects are loaded on the calling thread only, it's not worth the overhead
+static const uint32_t MIN_OBJECTS_FOR_PARALLEL_LOADING = 64;
+
+// number of objects deserialized by single loading task
+static const uint32_t OBJECTS_PER_LOADING_BLOCK = 16;
+
+// forwards errors reported from multiple loading threads to the actual reporter
+class SerializationErrorReporterLockProxy : public ISerializationErrorReporter
+{
+public:
+    SerializationErrorReporterLockProxy(ISerializationErrorReporter& target)
+        : m_target(target)
+    {}
+
+    virtual void reportTypeMissing(const StringBuf& serializationContextName, StringID missingTypeName) override
+    {
+        auto lock = CreateLock(m_lock);
+        m_target.reportTypeMissing(serializationContextName, missingTypeName);
+    }
+
+    virtual void reportPropertyMissing(const StringBuf& serializationContextName, StringID classType, StringID missingPropertyName, StringID propertyType, bool handled) override
+    {
+        auto lock = CreateLock(m_lock);
+        m_target.reportPropertyMissing(serializationContextName, classType, missingPropertyName, propertyType, handled);
+    }
+
+    virtual void reportPropertyTypeMissing(const StringBuf& serializationContextName, StringID classType, StringID propertyName, StringID previousType, bool handled) override
+    {
+        auto lock = CreateLock(m_lock);
+        m_target.reportPropertyTypeMissing(serializationContextName, classType, propertyName, previousType, handled);
+    }
+
+    virtual void reportPropertyTypeChanged(const StringBuf& serializationContextName, StringID classType, StringID propertyName, StringID previousType, StringID currentType, bool handled) override
+    {
+        auto lock = CreateLock(m_lock);
+        m_target.reportPropertyTypeChanged(serializationContextName, classType, propertyName, previousType, currentType, handled);
+    }
+
+    virtual void reportPropertyReadFailed(const StringBuf& serializationContextName, StringID classType, StringID propertyName, StringID propertyType) override
+    {
+        auto lock = CreateLock(m_lock);
+        m_target.reportPropertyReadFailed(serializationContextName, classType, propertyName, propertyType);
+    }
+
+    virtual void reportPropertyEnumMissing(const StringBuf& serializationContextName, StringID classType, StringID propertyName, StringID enumType, StringID enumOptionName) override
+    {
+        auto lock = CreateLock(m_lock);
+        m_target.reportPropertyEnumMissing(serializationContextName, classType, propertyName, enumType, enumOptionName);
+    }
+
+    virtual void reportPropertyBitflagMissing(const StringBuf& serializationContextName, StringID classType, StringID propertyName, StringID enumType, StringID enumOptionName) override
+    {
+        auto lock = CreateLock(m_lock);
+        m_target.reportPropertyBitflagMissing(serializationContextName, classType, propertyName, enumType, enumOptionName);
+    }
+
+private:
+    SpinLock m_lock;
+    ISerializationErrorReporter& m_target;
+};
+
+// deserialize content of single exported object
+static bool ReadObject(const SerializationBinaryFileTables& tables, const ObjectLoadingContext& context, const SerializationResolvedReferences& resolvedReferences, BufferView data, ISerializationErrorReporter& errors, uint32_t index)
+{
+    // do not consider objects that were disabled from loading
+    auto* object = resolvedReferences.objects[index].get();
+    if (!object)
+        return true;
+
+    // get the memory range in the loaded buffer where the object content is
+    const auto& objectEntry = tables.exportTable()[index];
+
+    // get object data in the buffer
+    const auto* objectData = OffsetPtr<void>(data.data(), objectEntry.dataOffset);
+    const auto objectDataView = BufferView(objectData, objectEntry.dataSize);
+
+    // invalid data loaded ?
+#ifndef BUILD_RELEASE
+    {
+        const auto crc = CRC32().append(objectData, objectEntry.dataSize).crc();
+        DEBUG_CHECK_RETURN_EX_V(crc == objectEntry.crc, "Object data corruption", false);
+    }
+#endif
+
+    // read the crap
+    SerializationReader reader(*context.pool, resolvedReferences, objectDataView, tables.header()->version, context.contextPath, errors);
+    object->onReadBinary(reader);
+    return true;
+}
+
+bool ObjectBinaryLoader::LoadObjectsInternal(const ObjectLoadingContext& context, BufferView data, const Buffer& dataOwner, ObjectPtr& outRoot)
 {
     if (data.size() < sizeof(SerializationBinaryFileTables::Header))
         return false;
@@ -439,99 +549,151 @@ bool ObjectBinaryLoader::LoadObjects(const ObjectLoadingContext& context, Buffer
     // we have no buffer factory yet we have not enough data for buffer
     DEBUG_CHECK_RETURN_EX_V(context.bufferFactory || data.size() >= tables.header()->buffersEnd, "No buffer loader factory yet given data does not contain buffers", false);
 
-    // resolve references
+    auto& errors = context.collectedErrors ? *context.collectedErrors : ISerializationErrorReporter::DefaultErrorReporter();
+
+    // small files are loaded serially
+    const auto numObjects = tables.chunkCount(SerializationBinaryFileTables::ChunkType::Exports);
+    if (numObjects < MIN_OBJECTS_FOR_PARALLEL_LOADING)
+    {
+        // resolve references
+        SerializationResolvedReferences resolvedReferences;
+        ResolveStringIDs(tables, context, resolvedReferences);
+        ResolveTypes(tables, context, resolvedReferences);
+        ResolveProperties(tables, context, resolvedReferences);
+        ResolveImports(tables, context, resolvedReferences);
+        ResolveExports(tables, context, resolvedReferences, outRoot);
+        ResolveBuffers(tables, context, resolvedReferences, data, dataOwner);
+
+        // load data and process it
+        for (uint32_t i = 0; i < numObjects; ++i)
+            if (!ReadObject(tables, context, resolvedReferences, data, errors, i))
+                return false;
+
+        // post load objects
+        for (auto i : resolvedReferences.objects.indexRange())
+            if (auto obj = resolvedReferences.objects[i])
+                obj->onPostLoad();
+
+        return true;
+    }
+
+    PC_SCOPE_LVL1(LoadObjectsParallel);
+
+    // resolve references, buffers don't depend on anything so they are resolved in the background
     SerializationResolvedReferences resolvedReferences;
+    auto buffersResolved = TaskBuilder("ResolveBuffers"_id) << [&tables, &context, &resolvedReferences, data, &dataOwner](TaskContext& tc)
+    {
+        ResolveBuffers(tables, context, resolvedReferences, data, dataOwner);
+    };
+
     ResolveStringIDs(tables, context, resolvedReferences);
     ResolveTypes(tables, context, resolvedReferences);
-    ResolveProperties(tables, context, resolvedReferences);
-    ResolveImports(tables, context, resolvedReferences);
-    ResolveExports(tables, context, resolvedReferences, outRoot);
-    ResolveBuffers(tables, context, resolvedReferences, data);
 
-    // load data and process it
-    const auto* objectTable = tables.exportTable();
-    const auto numObjects = tables.chunkCount(SerializationBinaryFileTables::ChunkType::Exports);
-    for (uint32_t i=0; i<numObjects; ++i)
     {
-        // do not consider objects that were disabled from loading
-        if (auto object = resolvedReferences.objects[i])
+        // imports and properties only depend on types
+        auto importsResolved = TaskBuilder("ResolveImports"_id) << [&tables, &context, &resolvedReferences](TaskContext& tc)
         {
-            // get the memory range in the loaded buffer where the object content is
-            const auto& objectEntry = objectTable[i];
+            ResolveImports(tables, context, resolvedReferences);
+        };
 
-            // get object data in the buffer
-            const auto* objectData = OffsetPtr<void>(data.data(), objectEntry.dataOffset);
-            const auto objectDataView = BufferView(objectData, objectEntry.dataSize);
+        ResolveProperties(tables, context, resolvedReferences);
+        importsResolved.waitSpinInfinite();
+    }
 
-            // invalid data loaded ?
-#ifndef BUILD_RELEASE
-            {
-                const auto crc = CRC32().append(objectData, objectEntry.dataSize).crc();
-                DEBUG_CHECK_RETURN_EX_V(crc == objectEntry.crc, "Object data corruption", false);
-            }
-#endif
+    // objects are created serially so they are created in the same order as with serial loading
+    ResolveExports(tables, context, resolvedReferences, outRoot);
+    buffersResolved.waitSpinInfinite();
 
-            // read the crap
-            {
-                SerializationReader reader(*context.pool, resolvedReferences, objectDataView, tables.header()->version, context.contextPath, *context.collectedErrors);
-                object->onReadBinary(reader);
-            }
-        }
+    // deserialize objects in parallel, objects only read their own data and don't touch other objects until post load
+    // NOTE: this is why onReadBinary must not access other objects, see IObject::onReadBinary
+    {
+        PC_SCOPE_LVL1(ReadObjects);
+
+        SerializationErrorReporterLockProxy errorsProxy(errors);
+        std::atomic<bool> valid = true;
+
+        TaskParallelFor(IndexRange(0, numObjects)).block(OBJECTS_PER_LOADING_BLOCK) << [&](IndexRange range)
+        {
+            for (auto i : range)
+                if (!ReadObject(tables, context, resolvedReferences, data, errorsProxy, i))
+                    valid = false;
+        };
+
+        if (!valid)
+            return false;
     }
 
-    // post load objects
-    //for (auto i : resolvedReferences.objects.indexRange().reversed())
-    for (auto i : resolvedReferences.objects.indexRange())
-        if (auto obj = resolvedReferences.objects[i])
-            obj->onPostLoad();
+    // post load objects on the calling thread in the file order, exactly as in serial loading
+    // NOTE: all objects in a file are reachable from the single root so there are no independent groups to process in parallel
+    {
+        PC_SCOPE_LVL1(PostLoadObjects);
+
+        for (auto i : resolvedReferences.objects.indexRange())
+            if (auto obj = resolvedReferences.objects[i])
+                obj->onPostLoad();
+    }
 
     // loaded
     return true;
 }
 
-bool ObjectBinaryLoader::LoadFileContent(IFileView* file, Buffer& outData, FileLoadMode loadMode)
+static bool ReadFileHeader(IFileView* file, uint64_t fileSize, ObjectBinaryLoader::FileLoadMode loadMode, SerializationBinaryFileTables::Header& outHeader, uint64_t& outLoadSize)
 {
-    DEBUG_CHECK_RETURN_EX_V(file, "Invalid file", false);
-
-    SerializationBinaryFileTables::Header header;
-    memzero(&header, sizeof(header));
+    memzero(&outHeader, sizeof(outHeader));
 
     {
-        const auto numRead = file->readSync(&header, sizeof(header));
-        if (numRead != sizeof(header))
+        const auto numRead = file->readSync(&outHeader, sizeof(outHeader));
+        if (numRead != sizeof(outHeader))
             return false;
     }
 
-    if (header.magic != SerializationBinaryFileTables::FILE_MAGIC)
+    if (outHeader.magic != SerializationBinaryFileTables::FILE_MAGIC)
         return false;
-    if (header.version < SerializationBinaryFileTables::FILE_VERSION_MIN)
+    if (outHeader.version < SerializationBinaryFileTables::FILE_VERSION_MIN)
         return false;
-    if (header.version > SerializationBinaryFileTables::FILE_VERSION_MAX)
+    if (outHeader.version > SerializationBinaryFileTables::FILE_VERSION_MAX)
         return false;
 
-    if (loadMode == FileLoadMode::DepsOnly)
+    if (loadMode == ObjectBinaryLoader::FileLoadMode::DepsOnly)
     {
-        if (header.headersEnd > file->size())
+        if (outHeader.headersEnd > fileSize)
             return false;
 
-        outData = Buffer::CreateEmpty(MainPool(), header.headersEnd);
+        outLoadSize = outHeader.headersEnd;
     }
-    else if (loadMode == FileLoadMode::NoBuffers)
+    else if (loadMode == ObjectBinaryLoader::FileLoadMode::NoBuffers)
     {
-        if (header.objectsEnd > file->size())
+        if (outHeader.objectsEnd > fileSize)
             return false;
 
-        outData = Buffer::CreateEmpty(MainPool(), header.headersEnd);
+        outLoadSize = outHeader.headersEnd;
     }
     else
     {
-        outData = Buffer::CreateEmpty(MainPool(), file->size());
+        outLoadSize = fileSize;
     }
 
+    return true;
+}
+
+bool ObjectBinaryLoader::LoadFileContent(IFileView* file, Buffer& outData, FileLoadMode loadMode)
+{
+    DEBUG_CHECK_RETURN_EX_V(file, "Invalid file", false);
+
+    SerializationBinaryFileTables::Header header;
+    uint64_t loadSize = 0;
+    if (!ReadFileHeader(file, file->size(), loadMode, header, loadSize))
+        return false;
+
+    outData = Buffer::CreateEmpty(MainPool(), loadSize);
     DEBUG_CHECK_RETURN_EX_V(outData, "Unable to allocate memory for file loading", false);
     memcpy(outData.data(), &header, sizeof(header));
 
     {
+        // rest of the data is read in one go
+        const auto dataStart = file->range().absoluteStart() + sizeof(header);
+        file->accessHint(FileAbsoluteRange(dataStart, dataStart + outData.size() - sizeof(header)), FileAccessHint::Sequential);
+
         const auto expectedSize = outData.size() - sizeof(header);
         const auto numRead = file->readSync(outData.data() + sizeof(header), expectedSize);
         DEBUG_CHECK_RETURN_EX_V(numRead == expectedSize, "Unexpected IO error loading data", false);
@@ -540,6 +702,42 @@ bool ObjectBinaryLoader::LoadFileContent(IFileView* file, Buffer& outData, FileL
     return true;
 }
 
+bool ObjectBinaryLoader::LoadFileContent(IFileReader* file, Buffer& outData, FileLoadMode loadMode)
+{
+    DEBUG_CHECK_RETURN_EX_V(file, "Invalid file", false);
+
+    // files that can't be mapped are read the usual way
+    if (!file->flags().test(FileFlagBit::MemoryMapped) && !file->flags().test(FileFlagBit::MemoryBacked))
+    {
+        auto view = file->createView(file->fullRange());
+        DEBUG_CHECK_RETURN_EX_V(view, "Unable to open file for reading", false);
+        return LoadFileContent(view, outData, loadMode);
+    }
+
+    // validate the header and determine how much of the file we need
+    SerializationBinaryFileTables::Header header;
+    uint64_t loadSize = 0;
+    {
+        auto view = file->createView(file->fullRange().rangeAtStart(std::min<uint64_t>(sizeof(header), file->size())));
+        if (!view || !ReadFileHeader(view, file->size(), loadMode, header, loadSize))
+            return false;
+    }
+
+    // map the data instead of copying it, the buffer keeps the mapping alive
+    auto mapping = file->createMapping(file->fullRange().rangeAtStart(loadSize));
+    DEBUG_CHECK_RETURN_EX_V(mapping, "Unable to map file content", false);
+
+    mapping->accessHint(FileAccessHint::Sequential);
+
+    // tables and objects are needed right away, embedded buffers only later - read them in the background while objects are being created
+    if (loadMode == FileLoadMode::Full && header.objectsEnd < loadSize)
+        FilePrefetcher::GetInstance().prefetch(file, FileAbsoluteRange(header.objectsEnd, loadSize));
+
+    outData = mapping->createBuffer();
+    DEBUG_CHECK_RETURN_EX_V(outData, "Unable to map file content", false);
+    return true;
+}
+
 bool ObjectBinaryLoader::LoadDependencies(const ObjectLoadingContext& context, BufferView data, HashSet<ResourceID>& outDependencies)
 {
     // validate the file tables
@@ -31,7 +31,9 @@ public:
     };
 
     static bool LoadObjects(const ObjectLoadingContext& context, BufferView data, ObjectPtr& outRoot);
+    static bool LoadObjects(const ObjectLoadingContext& context, const Buffer& data, ObjectPtr& outRoot); // embedded buffers become views into the data
     static bool LoadFileContent(IFileView* file, Buffer& outData, FileLoadMode loadMode);
+    static bool LoadFileContent(IFileReader* file, Buffer& outData, FileLoadMode loadMode); // maps the file if possible instead of copying it
     static bool LoadDependencies(const ObjectLoadingContext& context, BufferView data, HashSet<ResourceID>& outDependencies);
 
     static bool LocateBufferPlacement(BufferView data, uint64_t crc, ISerializationBufferFactory::BufferInfo& outInfo);
@@ -42,8 +44,9 @@ private:
     static void ResolveProperties(const SerializationBinaryFileTables& tables, const ObjectLoadingContext& context, SerializationResolvedReferences& resolvedReferences);
     static void ResolveImports(const SerializationBinaryFileTables& tables, const ObjectLoadingContext& context, SerializationResolvedReferences& resolvedReferences);
     static void ResolveExports(const SerializationBinaryFileTables& tables, const ObjectLoadingContext& context, SerializationResolvedReferences& resolvedReferences, ObjectPtr& outResult);
-    static void ResolveBuffers(const SerializationBinaryFileTables& tables, const ObjectLoadingContext& context, SerializationResolvedReferences& resolvedReferences, BufferView data);
-};
+    static void ResolveBuffers(const SerializationBinaryFileTables& tables, const ObjectLoadingContext& context, SerializationResolvedReferences& resolvedReferences, BufferView data, const Buffer& dataOwner);
+
+    static bool LoadObjectsInternal(const ObjectLoadingContext& context, BufferView data, const Buffer& dataOwner, ObjectPtr& outRoot);};
 
 //--
 
@@ -18,20 +18,39 @@
 
 #include "bm/core/file/include/fileReader.h"
 #include "bm/core/file/include/fileWriter.h"
+#include "bm/core/file/include/fileMemoryWriter.h"
 #include "bm/core/containers/include/queue.h"
 #include "bm/core/memory/include/localAllocator.h"
+#include "bm/core/task/include/taskUtils.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
 //--
 
+// objects are serialized and packed in batches, smaller saves are done without any parallelism
+static const uint32_t OBJECTS_PER_BATCH = 64;
+static const uint32_t MAX_PACKING_BATCHES = 16;
+
 struct SerializedObject : public MainPoolData<NoCopy>
 {
     ObjectPtr object;
     SerializationStream stream;
+    Array<IObject*> strongReferences; // in order of first use
 	bool root = false;
 };
 
+// memory and collected references for a batch of objects serialized on one thread
+struct SerializedObjectBatch : public MainPoolData<NoCopy>
+{
+    LocalAllocator mem;
+    SerializationStreamAllocator streamAllocator;
+    SerializationWriterReferences references;
+
+    SerializedObjectBatch()
+        : streamAllocator(mem)
+    {}
+};
+
 //--
 
 class SerializedObjectCollection : public MainPoolData<NoCopy>
@@ -61,6 +80,8 @@ public:
 
     SerializedObject* pop();
 
+    bool popAll(Array<SerializedObject*>& outObjects);
+
 private:
     Queue<SerializedObject*> m_objectsToSave;
     HashSet<const SerializedObject*> m_visitedObjects;
@@ -119,9 +140,69 @@ SerializedObject* SerializedObjectQueue::pop()
     return ret;
 }
 
+bool SerializedObjectQueue::popAll(Array<SerializedObject*>& outObjects)
+{
+    outObjects.reset();
+
+    while (!m_objectsToSave.empty())
+    {
+        outObjects.pushBack(m_objectsToSave.top());
+        m_objectsToSave.pop();
+    }
+
+    return !outObjects.empty();
+}
+
 //----
 
-bool ObjectBinarySaver::CollectObjects(LocalAllocator& mem, const ObjectSavingContext& context, ObjectPtr object, SerializedObjectCollection& outCollection, SerializationWriterReferences& outReferences)
+bool ObjectBinarySaver::SerializeObject(SerializedObject* obj, SerializationStreamAllocator& streamAllocator, SerializationWriterReferences& references, HashSet<IObject*>& localStrongReferences)
+{
+    if (localStrongReferences.size() <= 256)
+    {
+        localStrongReferences.reset();
+    }
+    else
+    {
+        localStrongReferences.clear();
+        localStrongReferences.reserve(256);
+    }
+
+    // serialize object to opcodes
+    {
+        SerializationWriter writer(obj->stream, streamAllocator, references, localStrongReferences);
+        obj->object->onWriteBinary(writer);
+
+        // if we had serialization errors exit now
+        if (writer.errors())
+        {
+            TRACE_WARNING("Opcode stream corruption at object '{}' 0x{}. Possible OOM.", obj->object->cls()->name(), Hex(obj->object.get()));
+            return false;
+        }
+    }
+
+    // remember objects referenced by a strong pointers, they must also be serialized
+    obj->strongReferences = localStrongReferences.keys();
+    return true;
+}
+
+void ObjectBinarySaver::MergeReferences(const SerializationWriterReferences& references, SerializationWriterReferences& outReferences)
+{
+    // NOTE: insertion order is preserved so the tables are exactly the same as if the objects were serialized one by one
+    for (const auto& name : references.stringIds.keys())
+        outReferences.stringIds.insert(name);
+    for (const auto& type : references.types.keys())
+        outReferences.types.insert(type);
+    for (const auto* prop : references.properties.keys())
+        outReferences.properties.insert(prop);
+    for (const auto& key : references.resources.keys())
+        outReferences.resources.insert(key);
+    for (const auto& buffer : references.asyncBuffers.keys())
+        outReferences.asyncBuffers.insert(buffer);
+    for (const auto& object : references.allObjects.keys())
+        outReferences.allObjects.insert(object);
+}
+
+bool ObjectBinarySaver::CollectObjects(LocalAllocator& mem, const ObjectSavingContext& context, ObjectPtr object, SerializedObjectCollection& outCollection, SerializationWriterReferences& outReferences, Array<UniquePtr<SerializedObjectBatch>>& outBatches)
 {
     ScopeTimer timer;
     SerializedObjectQueue objectQueue;
@@ -146,45 +227,70 @@ bool ObjectBinarySaver::CollectObjects(LocalAllocator& mem, const ObjectSavingCo
 	HashSet<IObject*> localStrongReferences;
     localStrongReferences.reserve(256);
 
-    // save objects
+    // save objects, all objects currently in the queue are saved together (in parallel if there's enough of them)
+    // NOTE: queue order and the order in which references are merged is exactly the same as when saving objects one by one
     uint32_t numSavedObjects = 0;
-    SerializationStreamAllocator streamAllocator(mem);    
-    while (auto* obj = objectQueue.pop())
+    SerializationStreamAllocator streamAllocator(mem);
+    Array<SerializedObject*> objectsToSave;
+    while (objectQueue.popAll(objectsToSave))
     {
-        if (localStrongReferences.size() <= 256)
+        if (context.singleThreaded || objectsToSave.size() <= OBJECTS_PER_BATCH)
         {
-            localStrongReferences.reset();
+            for (auto* obj : objectsToSave)
+            {
+                if (!SerializeObject(obj, streamAllocator, outReferences, localStrongReferences))
+                    return false;
+
+                for (auto* referencedObject : obj->strongReferences)
+                    objectQueue.push(outCollection.mapObject(referencedObject));
+            }
         }
         else
         {
-            localStrongReferences.clear();
-            localStrongReferences.reserve(256);
-        }
-
-        // serialize object to opcodes
-        {
-            SerializationWriter writer(obj->stream, streamAllocator, outReferences, localStrongReferences);
-            obj->object->onWriteBinary(writer);
+            const auto numBatches = (objectsToSave.size() + OBJECTS_PER_BATCH - 1) / OBJECTS_PER_BATCH;
+            const auto firstBatch = outBatches.size();
+            for (uint32_t i = 0; i < numBatches; ++i)
+                outBatches.emplaceBack(CreateUniquePtr<SerializedObjectBatch>());
 
-            // if we had serialization errors exit now
-            if (writer.errors())
+            std::atomic<uint32_t> numFailedBatches = 0;
+            TaskParallelForEach(IndexRange(0, numBatches)) << [&objectsToSave, &outBatches, &numFailedBatches, firstBatch](uint32_t batchIndex)
             {
-                TRACE_WARNING("Opcode stream corruption at object '{}' 0x{}. Possible OOM.", obj->object->cls()->name(), Hex(obj->object.get()));
+                auto& batch = *outBatches[firstBatch + batchIndex];
+
+                HashSet<IObject*> batchStrongReferences;
+                batchStrongReferences.reserve(256);
+
+                const auto firstObject = batchIndex * OBJECTS_PER_BATCH;
+                const auto lastObject = std::min<uint32_t>(firstObject + OBJECTS_PER_BATCH, objectsToSave.size());
+                for (uint32_t i = firstObject; i < lastObject; ++i)
+                {
+                    if (!SerializeObject(objectsToSave[i], batch.streamAllocator, batch.references, batchStrongReferences))
+                    {
+                        ++numFailedBatches;
+                        break;
+                    }
+                }
+            };
+
+            if (numFailedBatches)
                 return false;
-            }
-        }
 
-        // all objects referenced by a strong pointers must also be serialized
-		for (const auto& referencedObject : localStrongReferences.keys())
-            objectQueue.push(outCollection.mapObject(referencedObject));
+            // merge in the same order as the objects were queued
+            for (uint32_t i = 0; i < numBatches; ++i)
+                MergeReferences(outBatches[firstBatch + i]->references, outReferences);
+
+            for (auto* obj : objectsToSave)
+                for (auto* referencedObject : obj->strongReferences)
+                    objectQueue.push(outCollection.mapObject(referencedObject));
+        }
 
         // count saved object
-        numSavedObjects += 1;
+        numSavedObjects += objectsToSave.size();
     }
 
     // final stats
-    TRACE_SPAM("Serialized {} objects in {} ({} opcodes, {} in opcodes)",
-        numSavedObjects, timer,  streamAllocator.totalBlocksAllocated(), MemSize(streamAllocator.totalBytesAllocator()));
+    TRACE_SPAM("Serialized {} objects in {} ({} batches, {} opcodes, {} in opcodes)",
+        numSavedObjects, timer, outBatches.size(), streamAllocator.totalBlocksAllocated(), MemSize(streamAllocator.totalBytesAllocator()));
     return true;
 }
 
@@ -271,35 +377,91 @@ void ObjectBinarySaver::BuildFileTables(const Array<SerializedObject*>& objects,
     }
 }
 
-void ObjectBinarySaver::WriteObjects(const ObjectSavingContext& context, const SerializedObjectCollection& objects, const SerializationMappedReferences& mappedReferences, SerializationBinaryFileTablesBuilder& tables, uint64_t baseOffset, IFileWriter* file)
+bool ObjectBinarySaver::WriteObjects(const ObjectSavingContext& context, const SerializedObjectCollection& objects, const SerializationMappedReferences& mappedReferences, SerializationBinaryFileTablesBuilder& tables, uint64_t baseOffset, IFileWriter* file)
 {
     ScopeTimer timer;
 
-    // write all objects
-    uint64_t totalDataSize = 0;
-    for (auto i : objects.objects().indexRange())
-    {
-        const auto* object = objects.objects()[i];
+    const auto& objectList = objects.objects();
+    const auto totalDataStart = file->pos();
 
-        // write binary opcode stream to file
-        const auto objectStartPos = file->pos();
+    // small object lists are written directly
+    if (context.singleThreaded || objectList.size() <= OBJECTS_PER_BATCH)
+    {
+        for (auto i : objectList.indexRange())
         {
-            SerializationBinaryPacker fileWriter(file);
-            WriteOpcodes(object->stream, mappedReferences, fileWriter);
-            fileWriter.flush();
+            const auto* object = objectList[i];
+
+            // write binary opcode stream to file
+            const auto objectStartPos = file->pos();
+            {
+                SerializationBinaryPacker fileWriter(file);
+                WriteOpcodes(object->stream, mappedReferences, fileWriter);
+                fileWriter.flush();
 
-            tables.exportTable[i].crc = fileWriter.crc();
+                tables.exportTable[i].crc = fileWriter.crc();
+            }
+
+            // patch object entry
+            tables.exportTable[i].dataOffset = objectStartPos - baseOffset;
+            tables.exportTable[i].dataSize = file->pos() - objectStartPos;
         }
+    }
+    else
+    {
+        // pack continuous ranges of objects into memory in parallel, packed data does not depend on the placement in file
+        const auto numBatches = std::min<uint32_t>(MAX_PACKING_BATCHES, (objectList.size() + OBJECTS_PER_BATCH - 1) / OBJECTS_PER_BATCH);
+        const auto objectsPerBatch = (objectList.size() + numBatches - 1) / numBatches;
 
-        // count data size
-        totalDataSize += file->pos() - objectStartPos;
+        Array<RefPtr<FileMemoryWriter>> packedBatches;
+        packedBatches.resize(numBatches);
 
-        // patch object entry
-        tables.exportTable[i].dataOffset = objectStartPos - baseOffset;
-        tables.exportTable[i].dataSize = file->pos() - objectStartPos;
+        TaskParallelForEach(IndexRange(0, numBatches)) << [&objectList, &mappedReferences, &tables, &packedBatches, &context, objectsPerBatch](uint32_t batchIndex)
+        {
+            auto batchWriter = RefNew<FileMemoryWriter>("ObjectBinarySaver", context.pagedPool);
+
+            const auto firstObject = batchIndex * objectsPerBatch;
+            const auto lastObject = std::min<uint32_t>(firstObject + objectsPerBatch, objectList.size());
+            for (uint32_t i = firstObject; i < lastObject; ++i)
+            {
+                const auto objectStartPos = batchWriter->pos();
+                {
+                    SerializationBinaryPacker fileWriter(batchWriter.get());
+                    WriteOpcodes(objectList[i]->stream, mappedReferences, fileWriter);
+                    fileWriter.flush();
+
+                    tables.exportTable[i].crc = fileWriter.crc();
+                }
+
+                // offset is local to the batch until the batch is written
+                tables.exportTable[i].dataOffset = objectStartPos;
+                tables.exportTable[i].dataSize = batchWriter->pos() - objectStartPos;
+            }
+
+            packedBatches[batchIndex] = batchWriter;
+        };
+
+        // write batches in order
+        for (auto batchIndex : packedBatches.indexRange())
+        {
+            const auto& batchWriter = packedBatches[batchIndex];
+            const auto batchStartPos = file->pos();
+
+            const auto batchSize = batchWriter->size();
+            if (batchWriter->exportDataToFile(0, batchSize, file) != batchSize)
+            {
+                TRACE_WARNING("Failed to save {} of packed object data", MemSize(batchSize));
+                return false;
+            }
+
+            const auto firstObject = batchIndex * objectsPerBatch;
+            const auto lastObject = std::min<uint32_t>(firstObject + objectsPerBatch, objectList.size());
+            for (uint32_t i = firstObject; i < lastObject; ++i)
+                tables.exportTable[i].dataOffset += batchStartPos - baseOffset;
+        }
     }
 
-    TRACE_SPAM("Written {} objects in {} ({} written)", objects.objects().size(), timer, MemSize(totalDataSize));    
+    TRACE_SPAM("Written {} objects in {} ({} written)", objectList.size(), timer, MemSize(file->pos() - totalDataStart));
+    return true;
 }
 
 uint32_t ObjectBinarySaver::HeaderFlags(const ObjectSavingContext& context)
@@ -321,9 +483,11 @@ bool ObjectBinarySaver::SaveObjects(IFileWriter* file, const ObjectSavingContext
 
     {
 		// collect objects to save and build local serialization streams
+        // NOTE: batches own the memory of the serialized streams so they must outlive the collection
+        Array<UniquePtr<SerializedObjectBatch>> objectBatches;
         SerializedObjectCollection objectCollection(mem);
         SerializationWriterReferences objectReferences;
-        if (!CollectObjects(mem, context, object, objectCollection, objectReferences))
+        if (!CollectObjects(mem, context, object, objectCollection, objectReferences, objectBatches))
             return false;
 
         // merge reference tables
@@ -338,7 +502,8 @@ bool ObjectBinarySaver::SaveObjects(IFileWriter* file, const ObjectSavingContext
             return false;
 
         // write objects
-        WriteObjects(context, objectCollection, mappedReferences, fileTables, baseOffset, file);
+        if (!WriteObjects(context, objectCollection, mappedReferences, fileTables, baseOffset, file))
+            return false;
 
         // extract dependencies
         if (context.extractedResources)
@@ -20,6 +20,7 @@ class SerializationBinaryFileTables;
 class SerializationBinaryFileTablesBuilder;
 
 struct SerializedObject;
+struct SerializedObjectBatch;
 struct SerializationResourceKey;
 class SerializedObjectCollection;
 
@@ -33,9 +34,11 @@ public:
     static void ExtractUsedResources(const IObject* object, HashMap<ResourceID, uint32_t>& outResourceCounts);
 
 private:
-    static bool CollectObjects(LocalAllocator& mem, const ObjectSavingContext& context, ObjectPtr object, SerializedObjectCollection& outCollection, SerializationWriterReferences& outReferences);
+    static bool CollectObjects(LocalAllocator& mem, const ObjectSavingContext& context, ObjectPtr object, SerializedObjectCollection& outCollection, SerializationWriterReferences& outReferences, Array<UniquePtr<SerializedObjectBatch>>& outBatches);
+    static bool SerializeObject(SerializedObject* obj, SerializationStreamAllocator& streamAllocator, SerializationWriterReferences& references, HashSet<IObject*>& localStrongReferences);
+    static void MergeReferences(const SerializationWriterReferences& references, SerializationWriterReferences& outReferences);
     static void BuildFileTables(const Array<SerializedObject*>& objects, const SerializationWriterReferences& collectedReferences, SerializationBinaryFileTablesBuilder& outTables, SerializationMappedReferences& outMappedReferences);
-    static void WriteObjects(const ObjectSavingContext& context, const SerializedObjectCollection& objects, const SerializationMappedReferences& mappedReferences, SerializationBinaryFileTablesBuilder& tables, uint64_t baseOffset, IFileWriter* file);
+    static bool WriteObjects(const ObjectSavingContext& context, const SerializedObjectCollection& objects, const SerializationMappedReferences& mappedReferences, SerializationBinaryFileTablesBuilder& tables, uint64_t baseOffset, IFileWriter* file);
     static uint32_t HeaderFlags(const ObjectSavingContext& context);
 };
 
@@ -17,10 +17,14 @@ BEGIN_INFERNO_NAMESPACE()
 
 ///--
 
+ObjectGlobalRegistry::Shard::Shard()
+    : entryPool(16384 / sizeof(ObjectEntry))
+{
+    memset(hashBuckets, 0, sizeof(hashBuckets));
+}
+
 ObjectGlobalRegistry::ObjectGlobalRegistry()
-    : m_objectEntryPool(65536 / sizeof(ObjectEntry))
 {
-    memset(m_objectHashBuckets, 0, sizeof(m_objectHashBuckets));
 }
 
 void ObjectGlobalRegistry::deinit()
@@ -30,11 +34,11 @@ void ObjectGlobalRegistry::deinit()
 
 ObjectPtr ObjectGlobalRegistry::findObject(uint32_t id)
 {
-    auto lock = CreateLock(m_objectsLock);
+    const auto& shard = m_shards[ShardIndex(id)];
+    auto lock = CreateLock(shard.lock);
 
     // locate the entry
-    const auto bucketIndex = id % MAX_BUCKETS;
-    auto* curEntry = m_objectHashBuckets[bucketIndex];
+    auto* curEntry = shard.hashBuckets[BucketIndex(id)];
     while (curEntry)
     {
         if (curEntry->id == id)
@@ -46,23 +50,63 @@ ObjectPtr ObjectGlobalRegistry::findObject(uint32_t id)
     return nullptr;
 }
 
-bool ObjectGlobalRegistry::iterateAllObjects(const std::function<bool(IObject*)>& enumFunc)
+void ObjectGlobalRegistry::collectEntries(Array<SnapshotEntry>& outEntries) const
 {
-    Array<ObjectWeakPtr> allObjects;
+    outEntries.reserve(m_objectCount.load() + 64);
 
-    // extract objects
+    // each shard is locked only for the time of copying it out so object creation is never blocked for long
+    for (const auto& shard : m_shards)
     {
-        auto lock = CreateLock(m_objectsLock);
-        allObjects.reserve(m_objectCount);
+        auto lock = CreateLock(shard.lock);
 
-        auto cur = m_objectListTail;
+        auto cur = shard.listTail;
         while (cur)
         {
-            allObjects.pushBack(cur->ptr);
+            auto& entry = outEntries.emplaceBack();
+            entry.id = cur->id;
+            entry.cls = cur->cls;
+            entry.ptr = cur->ptr;
             cur = cur->prevAll;
         }
     }
 
+    // IDs are allocated incrementally, restore the creation order across shards
+    outEntries.sort([](const SnapshotEntry& a, const SnapshotEntry& b) { return a.id < b.id; });
+}
+
+void ObjectGlobalRegistry::collectObjects(Array<ObjectWeakPtr>& outObjects, ClassType objectClass) const
+{
+    Array<SnapshotEntry> entries;
+    collectEntries(entries);
+
+    outObjects.reserve(outObjects.size() + entries.size());
+    for (auto& entry : entries)
+    {
+        if (objectClass)
+        {
+            // class is known from the moment object is created, if it's not we need to ask the object
+            if (entry.cls)
+            {
+                if (!entry.cls->is(objectClass))
+                    continue;
+            }
+            else
+            {
+                auto obj = entry.ptr.lock();
+                if (!obj || !obj->is(objectClass))
+                    continue;
+            }
+        }
+
+        outObjects.pushBack(std::move(entry.ptr));
+    }
+}
+
+bool ObjectGlobalRegistry::iterateAllObjects(const std::function<bool(IObject*)>& enumFunc)
+{
+    Array<ObjectWeakPtr> allObjects;
+    collectObjects(allObjects);
+
     // run enumerator
     for (auto& objPtr : allObjects)
         if (auto obj = objPtr.lock())
@@ -74,63 +118,62 @@ bool ObjectGlobalRegistry::iterateAllObjects(const std::function<bool(IObject*)>
 
 bool ObjectGlobalRegistry::iterateObjectsOfClass(ClassType objectClass, const std::function<bool(IObject*)>& enumFunc)
 {
-    auto lock = CreateLock(m_objectsLock);
-
-    auto cur = m_objectListTail;
-    while (cur)
-    {
-        if (auto obj = cur->ptr.lock())
-            if (obj->is(objectClass))
-                if (enumFunc(obj))
-                    return true;
+    Array<ObjectWeakPtr> allObjects;
+    collectObjects(allObjects, objectClass);
 
-        cur = cur->prevAll;
-    }
+    // run enumerator
+    for (auto& objPtr : allObjects)
+        if (auto obj = objPtr.lock())
+            if (enumFunc(obj))
+                return true;
 
     return false;
 }
 
 void ObjectGlobalRegistry::registerObject(uint32_t id, IObject* object)
 {
-    auto lock = CreateLock(m_objectsLock);
+    auto& shard = m_shards[ShardIndex(id)];
+    auto lock = CreateLock(shard.lock);
 
     // allocate entry
     m_objectCount += 1;
-    auto* entry = m_objectEntryPool.alloc();
+    auto* entry = shard.entryPool.alloc();
     memset(entry, 0, sizeof(ObjectEntry));
     entry->id = id;
+    entry->cls = object->cls().ptr();
     entry->ptr = object;
     entry->nextAll = nullptr;
     entry->prevAll= nullptr;
     entry->nextBucket  = nullptr;
 
-    // link in the global list
-    if (m_objectListHead != nullptr)
+    // link in the shard's list
+    if (shard.listHead != nullptr)
     {
-        m_objectListHead->prevAll = entry;
-        entry->nextAll = m_objectListHead;
+        shard.listHead->prevAll = entry;
+        entry->nextAll = shard.listHead;
     }
     else
     {
-        m_objectListTail = entry;
+        shard.listTail = entry;
     }
 
-    m_objectListHead = entry;
+    shard.listHead = entry;
 
     // add entry to the hash buckets
-    const auto bucketIndex = id % MAX_BUCKETS;
-    entry->nextBucket = m_objectHashBuckets[bucketIndex];
-    m_objectHashBuckets[bucketIndex] = entry;
+    const auto bucketIndex = BucketIndex(id);
+    entry->nextBucket = shard.hashBuckets[bucketIndex];
+    shard.hashBuckets[bucketIndex] = entry;
 }
 
 void ObjectGlobalRegistry::unregisterObject(uint32_t id, IObject* object)
 {
-    auto lock = CreateLock(m_objectsLock);
+    auto& shard = m_shards[ShardIndex(id)];
+    auto lock = CreateLock(shard.lock);
 
     // locate the entry
-    const auto bucketIndex = id % MAX_BUCKETS;
-    auto* prevLink = &m_objectHashBuckets[bucketIndex];
-    auto* curEntry = m_objectHashBuckets[bucketIndex];
+    const auto bucketIndex = BucketIndex(id);
+    auto* prevLink = &shard.hashBuckets[bucketIndex];
+    auto* curEntry = shard.hashBuckets[bucketIndex];
     while (curEntry)
     {
         if (curEntry->id == id)
@@ -153,29 +196,29 @@ void ObjectGlobalRegistry::unregisterObject(uint32_t id, IObject* object)
     // remove from object list
     if (curEntry->nextAll)
     {
-        DEBUG_CHECK(curEntry != m_objectListTail);
+        DEBUG_CHECK(curEntry != shard.listTail);
         curEntry->nextAll->prevAll = curEntry->prevAll;
     }
     else
     {
-        DEBUG_CHECK(curEntry == m_objectListTail);
-        m_objectListTail = curEntry->prevAll;
+        DEBUG_CHECK(curEntry == shard.listTail);
+        shard.listTail = curEntry->prevAll;
     }
 
     if (curEntry->prevAll)
     {
-        DEBUG_CHECK(curEntry != m_objectListHead);
+        DEBUG_CHECK(curEntry != shard.listHead);
         curEntry->prevAll->nextAll = curEntry->nextAll;
     }
     else
     {
-        DEBUG_CHECK(curEntry == m_objectListHead);
-        m_objectListHead = curEntry->nextAll;
+        DEBUG_CHECK(curEntry == shard.listHead);
+        shard.listHead = curEntry->nextAll;
     }
 
     // release entry to memory pool
     curEntry->ptr.reset();
-    m_objectEntryPool.release(curEntry);
+    shard.entryPool.release(curEntry);
     m_objectCount -= 1;
 }
 
@@ -12,6 +12,7 @@
 #include "bm/core/memory/include/bufferView.h"
 #include "bm/core/file/include/fileReader.h"
 #include "bm/core/file/include/fileMemoryWriter.h"
+#include "bm/core/file/include/fileBufferedWriter.h"
 #include "objectBinaryLoader.h"
 #include "serializationBufferFactory.h"
 
@@ -79,8 +80,19 @@ bool IObject::SaveObject(SerializationFormat format, const ObjectSavingContext&
 
 bool IObject::SaveObject(SerializationFormat format, const ObjectSavingContext& ctx, const IObject* object, StringView absoluteFilePath, IFileSystem& fs /*= FileSystem()*/)
 {
-	if (auto writer = fs.openForWriting(absoluteFilePath, FileWriteMode::WriteOnly))
-		return SaveObject(format, ctx, object, writer);
+	// serialization emits a lot of small writes, coalesce them and write in the background while we serialize
+	// NOTE: existing file is replaced only once everything was written correctly
+	FileBufferedWriterSetup setup;
+	setup.writeBehind = true;
+	setup.atomicCommit = true;
+
+	if (auto writer = FileBufferedWriter::Open(absoluteFilePath, setup, fs))
+	{
+		if (SaveObject(format, ctx, object, writer))
+			return writer->commit();
+
+		writer->discard();
+	}
 
 	return false;
 }
@@ -146,20 +158,48 @@ ObjectPtr IObject::LoadObject(SerializationFormat format, const ObjectLoadingCon
 	return LoadObject(format, ctx, txt.bufferView());
 }
 
+static ObjectPtr LoadObjectFromOwnedBuffer(SerializationFormat format, const ObjectLoadingContext& ctx, const Buffer& data, bool mapped)
+{
+	// binary data we own can be referenced directly by the embedded buffers, a file mapping only if the caller wants to keep it
+	// NOTE: otherwise the embedded buffers are copied out and the mapping is released once we are done loading
+	if (format == SerializationFormat::RawBinary && (!mapped || ctx.keepFileMapped))
+	{
+		ObjectPtr ptr;
+		if (!ObjectBinaryLoader::LoadObjects(ctx, data, ptr))
+			return nullptr;
+
+		return ptr;
+	}
+
+	return IObject::LoadObject(format, ctx, data.view());
+}
+
 ObjectPtr IObject::LoadObject(SerializationFormat format, const ObjectLoadingContext& ctx, IFileReader* file)
 {
-	auto data = file->loadToBuffer(MainPool(), file->fullRange());
-	DEBUG_CHECK_RETURN_EX_V(data, "Failed to load data to buffer", nullptr);
+	DEBUG_CHECK_RETURN_EX_V(file, "Invalid file", nullptr);
+
+	Buffer data;
+	if (format == SerializationFormat::RawBinary)
+	{
+		if (!ObjectBinaryLoader::LoadFileContent(file, data, ObjectBinaryLoader::FileLoadMode::Full))
+			return nullptr;
+	}
+	else
+	{
+		data = file->loadToBuffer(MainPool(), file->fullRange());
+		DEBUG_CHECK_RETURN_EX_V(data, "Failed to load data to buffer", nullptr);
+	}
 
-	return LoadObject(format, ctx, data);
+	return LoadObjectFromOwnedBuffer(format, ctx, data, file->flags().test(FileFlagBit::MemoryMapped));
 }
 
 ObjectPtr IObject::LoadObject(SerializationFormat format, const ObjectLoadingContext& ctx, StringView absoluteFilePath, IFileSystem& fs /*= FileSystem()*/)
 {
+	// NOTE: file is loaded with memory mapping if possible
 	auto data = fs.loadFileToBuffer(absoluteFilePath);
 	DEBUG_CHECK_RETURN_EX_V(data, "Failed to load data to buffer", nullptr);
 
-	return LoadObject(format, ctx, data);
+	return LoadObjectFromOwnedBuffer(format, ctx, data, true);
 }
 
 //--
@@ -49,6 +49,17 @@ TemplateProperty::~TemplateProperty()
 
 //--
 
+bool ClassPropertyPlan::IsPlainData(const Property* prop)
+{
+    if (prop->externalBuffer())
+        return false;
+
+    const auto& traits = prop->type()->traits();
+    return traits.simpleCopyCompare && !traits.requiresConstructor && !traits.requiresDestructor;
+}
+
+//--
+
 IClassType::IClassType(StringID name, uint32_t size, uint32_t alignment)
     : IType(name)
     , m_userIndex(INDEX_NONE)
@@ -69,7 +80,13 @@ IClassType::~IClassType()
 
 bool IClassType::compare(const void* data1, const void* data2) const
 {
-    for (auto prop  : allProperties().values())
+    const auto& plan = propertyPlan();
+
+    for (const auto& range : plan.dataRanges)
+        if (0 != memcmp(OffsetPtr<void>(data1, range.offset), OffsetPtr<void>(data2, range.offset), range.size))
+            return false;
+
+    for (const auto* prop : plan.complexProperties)
         if (!prop->type()->compare(prop->offsetPtr(data1), prop->offsetPtr(data2)))
             return false;
 
@@ -78,7 +95,12 @@ bool IClassType::compare(const void* data1, const void* data2) const
 
 void IClassType::copy(void* dest, const void* src) const
 {
-    for (auto prop  : allProperties().values())
+    const auto& plan = propertyPlan();
+
+    for (const auto& range : plan.dataRanges)
+        memcpy(OffsetPtr<void>(dest, range.offset), OffsetPtr<void>(src, range.offset), range.size);
+
+    for (const auto* prop : plan.complexProperties)
         prop->type()->copy(prop->offsetPtr(dest), prop->offsetPtr(src));
 }
         
@@ -91,11 +113,9 @@ void IClassType::writeBinary(TypeSerializationContext& typeContext, Serializatio
         defaultData = defaultObject();
 
     // save properties
-    for (const auto* prop  : allProperties().values())
+    for (const auto& entry : propertyPlan().serializedProperties)
     {
-        // skip transient properties
-        if (prop->flags().test(PropertyFlagBit::Transient))
-            continue;
+        const auto* prop = entry.prop;
 
         // ask object if we want to save this property
         auto propData = prop->offsetPtr(data);
@@ -110,8 +130,17 @@ void IClassType::writeBinary(TypeSerializationContext& typeContext, Serializatio
         {
             // compare the property value with default, do not save if the same
             if (propDefaultData)
-                if (prop->type()->compare(propData, propDefaultData))
+            {
+                if (entry.plainData)
+                {
+                    if (0 == memcmp(propData, propDefaultData, prop->type()->size()))
+                        continue;
+                }
+                else if (prop->type()->compare(propData, propDefaultData))
+                {
                     continue;
+                }
+            }
         }
 
         // write the reference to the property (it'll be mapped to an index as it's much faster to load it like that compared to ie. finding it by name every time)
@@ -614,6 +643,65 @@ const IClassType::TConstTemplateProperties& IClassType::allTemplateProperties()
     return *propList;
 }
 
+const ClassPropertyPlan& IClassType::propertyPlan() const
+{
+    if (auto* plan = m_propertyPlan.load())
+        return *plan;
+
+    auto* plan = new ClassPropertyPlan();
+
+    // collect plain data properties in memory order so we can merge the adjacent ones
+    Array<const Property*> plainProperties;
+    for (const auto* prop : allProperties().values())
+    {
+        if (ClassPropertyPlan::IsPlainData(prop))
+            plainProperties.pushBack(prop);
+        else
+            plan->complexProperties.pushBack(prop);
+
+        if (!prop->flags().test(PropertyFlagBit::Transient))
+        {
+            auto& entry = plan->serializedProperties.emplaceBack();
+            entry.prop = prop;
+            entry.plainData = ClassPropertyPlan::IsPlainData(prop);
+        }
+    }
+
+    plainProperties.sort([](const Property* a, const Property* b) { return a->offset() < b->offset(); });
+
+    // merge properties that touch each other, gaps (padding) are never copied or compared
+    for (const auto* prop : plainProperties)
+    {
+        const auto size = prop->type()->size();
+        if (!size)
+            continue;
+
+        if (!plan->dataRanges.empty())
+        {
+            auto& last = plan->dataRanges.back();
+            if (prop->offset() <= last.offset + last.size)
+            {
+                last.size = std::max<uint32_t>(last.size, prop->offset() + size - last.offset);
+                continue;
+            }
+        }
+
+        auto& range = plan->dataRanges.emplaceBack();
+        range.offset = prop->offset();
+        range.size = size;
+    }
+
+    // store, someone else may have been faster
+    ClassPropertyPlan* existingPlan = nullptr;
+    if (!m_propertyPlan.compare_exchange_strong(existingPlan, plan))
+    {
+        delete plan;
+        return *existingPlan;
+    }
+
+    return *plan;
+}
+
 const IMetadata* IClassType::metadata(ClassType metadataType) const
 {
     // check the whole class hierarchy
@@ -640,6 +728,7 @@ void IClassType::collectMetadataList(Array<const IMetadata*>& outMetadataList) c
 
 void IClassType::clearCachedData()
 {
+    delete m_propertyPlan.exchange(nullptr);
     delete m_allScriptFunctions.exchange(nullptr);
     delete m_allNativeFunctions.exchange(nullptr);
     delete m_allProperties.exchange(nullptr);
@@ -681,6 +770,7 @@ void IClassType::addProperty(Property* property)
 
     m_localProperties.pushBack(property);
 
+    delete m_propertyPlan.exchange(nullptr);
     delete m_allProperties.exchange(nullptr);
     delete m_allTemplateProperties.exchange(nullptr);
 }
@@ -731,6 +821,7 @@ void IClassType::addScriptFunction(IScriptFunction* function)
 
 void IClassType::resetCachedLists()
 {
+    delete m_propertyPlan.exchange(nullptr);
     delete m_allProperties.exchange(nullptr);
     delete m_allTemplateProperties.exchange(nullptr);
     delete m_allNativeFunctions.exchange(nullptr);
@@ -824,6 +915,10 @@ void IClassType::cacheTypeData()
         m_shortName = StringID(metadata->shortName());
     else
         m_shortName = StringID(name().view().afterLast("::", StringCaseComparisonMode::NoCase, StringFindFallbackMode::Full).afterLast("_", StringCaseComparisonMode::NoCase, StringFindFallbackMode::Full));
+
+    // compile the property plan now that all the types are known
+    delete m_propertyPlan.exchange(nullptr);
+    propertyPlan();
 }
 
 void IClassType::releaseTypeReferences()
@@ -0,0 +1,171 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: rtti\view #]
+***/
+
+#include "build.h"
+#include "rttiDataViewPath.h"
+#include "rttiDataView.h"
+#include "rttiClassType.h"
+#include "rttiArrayType.h"
+#include "rttiProperty.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+DataViewPath::DataViewPath()
+{}
+
+DataViewPath::DataViewPath(Type rootType, StringView path)
+    : m_rootType(rootType)
+    , m_path(path)
+{
+    compile();
+}
+
+void DataViewPath::compile()
+{
+    const auto fullPath = m_path.view();
+
+    auto type = m_rootType;
+    auto viewPath = fullPath;
+    while (type && !viewPath.empty())
+    {
+        const auto stepOffset = (uint32_t)(viewPath.data() - fullPath.data());
+
+        // follows the IClassType::readDataView
+        if (type->metaType() == MetaType::Class)
+        {
+            auto tempViewPath = viewPath;
+
+            StringView propertyName;
+            if (!ParsePropertyName(tempViewPath, propertyName))
+                break;
+
+            const auto* prop = type.toClass()->findProperty(StringID::Find(propertyName));
+            if (!prop)
+                break;
+
+            auto& step = m_steps.emplaceBack();
+            step.prop = prop;
+            step.pathOffset = stepOffset;
+            step.type = prop->type();
+
+            type = prop->type();
+            viewPath = tempViewPath;
+        }
+
+        // follows the IArrayType::readDataView
+        else if (type->metaType() == MetaType::Array)
+        {
+            auto tempViewPath = viewPath;
+
+            uint32_t index = 0;
+            if (!ParseArrayIndex(tempViewPath, index))
+                break;
+
+            const auto* arrayType = static_cast<const IArrayType*>(type.ptr());
+
+            auto& step = m_steps.emplaceBack();
+            step.arrayType = arrayType;
+            step.arrayIndex = index;
+            step.pathOffset = stepOffset;
+            step.type = arrayType->innerType();
+
+            type = arrayType->innerType();
+            viewPath = tempViewPath;
+        }
+
+        // other types interpret the path on their own
+        else
+        {
+            break;
+        }
+    }
+
+    m_remainderOffset = (uint32_t)(viewPath.data() - fullPath.data());
+}
+
+DataViewResult DataViewPath::resolve(const void* rootData, uint32_t numSteps, Type& outType, const void*& outData) const
+{
+    DEBUG_CHECK_RETURN_EX_V(m_rootType, "Data view path was not compiled", DataViewResultCode::ErrorIllegalAccess);
+    DEBUG_CHECK_RETURN_EX_V(rootData, "No data to resolve path on", DataViewResultCode::ErrorNullObject);
+
+    auto type = m_rootType;
+    auto data = rootData;
+
+    for (uint32_t i = 0; i < numSteps; ++i)
+    {
+        const auto& step = m_steps[i];
+
+        if (step.prop)
+        {
+            data = step.prop->offsetPtr(data);
+        }
+        else
+        {
+            if (step.arrayIndex >= step.arrayType->arraySize(data))
+                return DataViewResultCode::ErrorIndexOutOfRange;
+
+            data = step.arrayType->arrayElementData(data, step.arrayIndex);
+        }
+
+        type = step.type;
+    }
+
+    outType = type;
+    outData = data;
+    return DataViewResultCode::OK;
+}
+
+DataViewResult DataViewPath::describe(const void* rootData, DataViewInfo& outInfo) const
+{
+    // the class that owns the last property reports the property's metadata so let it handle the last property step (and a direct index into it)
+    auto numSteps = m_steps.size();
+    if (m_remainderOffset == m_path.length() && numSteps > 0)
+    {
+        if (m_steps[numSteps - 1].prop)
+            numSteps -= 1;
+        else if (numSteps >= 2 && m_steps[numSteps - 2].prop)
+            numSteps -= 2;
+    }
+
+    Type type;
+    const void* data = nullptr;
+    const auto ret = resolve(rootData, numSteps, type, data);
+    if (!ret.valid())
+        return ret;
+
+    const auto pathOffset = (numSteps < m_steps.size()) ? m_steps[numSteps].pathOffset : m_remainderOffset;
+    return type->describeDataView(m_path.view().subString(pathOffset), data, outInfo);
+}
+
+DataViewResult DataViewPath::read(const void* rootData, void* targetData, Type targetType) const
+{
+    Type type;
+    const void* data = nullptr;
+    const auto ret = resolve(rootData, m_steps.size(), type, data);
+    if (!ret.valid())
+        return ret;
+
+    return type->readDataView(remainder(), data, targetData, targetType);
+}
+
+DataViewResult DataViewPath::write(void* rootData, const void* sourceData, Type sourceType) const
+{
+    Type type;
+    const void* data = nullptr;
+    const auto ret = resolve(rootData, m_steps.size(), type, data);
+    if (!ret.valid())
+        return ret;
+
+    return type->writeDataView(remainder(), const_cast<void*>(data), sourceData, sourceType);
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -135,6 +135,8 @@ namespace prv
 			case '}':
 			case '\'':
 			case '`':
+			case ',':
+			case ':':
 				return true;
 
 			default:
@@ -171,25 +173,19 @@ namespace prv
 			case '/':
 				f.append("\\/");
 				break;
-			case '\b':
-				f.append("\\b");
-				break;
 			case '\t':
 				f.append("\\t");
 				break;
 			case '\n':
 				f.append("\\n");
 				break;
-			case '\f':
-				f.append("\\f");
-				break;
 			case '\r':
 				f.append("\\r");
 				break;
 			default:
-				if (ch < ' ') {
-					uint16_t code = ch;
-					f.appendf("\\{}", Hex(code));
+				if ((uint8_t)ch < ' ') {
+					// NOTE: \b and \f are written as \u0008 and \u000C as well so they are never confused with the legacy "\XXXX" escapes
+					f.appendf("\\u{}", PaddedHex<4, '0'>((uint8_t)ch));
 				}
 				else
 				{
@@ -28,6 +28,88 @@
 
 BEGIN_INFERNO_NAMESPACE()
 
+//--
+
+// all known type names (including the alternative ones), open addressing with linear probing
+// NOTE: entries are only added (under the types lock) and never removed so the table can be read without any locks
+struct TypeSystem::TypeLookupTable : public MainPoolData<NoCopy>
+{
+    struct Entry
+    {
+        std::atomic<uint32_t> name = 0; // index of the StringID, 0 - empty
+        std::atomic<const IType*> type = nullptr;
+    };
+
+    static const uint32_t MIN_CAPACITY = 1024;
+
+    uint32_t mask = 0;
+    uint32_t count = 0; // modified only under the lock
+    Entry* entries = nullptr;
+
+    TypeLookupTable(uint32_t capacity)
+        : mask(capacity - 1)
+    {
+        entries = new Entry[capacity];
+    }
+
+    ~TypeLookupTable()
+    {
+        delete[] entries;
+    }
+
+    INLINE uint32_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    INLINE bool full() const
+    {
+        return (count + 1) * 2 > capacity(); // keep it at most half full so probing stays short
+    }
+
+    INLINE static uint32_t Hash(uint32_t name)
+    {
+        return name * 2654435761U;
+    }
+
+    const IType* find(uint32_t name) const
+    {
+        for (uint32_t i = Hash(name) & mask;; i = (i + 1) & mask)
+        {
+            const auto entryName = entries[i].name.load(std::memory_order_acquire);
+            if (entryName == name)
+                return entries[i].type.load(std::memory_order_acquire);
+            if (entryName == 0)
+                return nullptr;
+        }
+    }
+
+    void insert(uint32_t name, const IType* type, bool overrideExisting)
+    {
+        for (uint32_t i = Hash(name) & mask;; i = (i + 1) & mask)
+        {
+            const auto entryName = entries[i].name.load(std::memory_order_relaxed);
+            if (entryName == name)
+            {
+                if (overrideExisting)
+                    entries[i].type.store(type, std::memory_order_release);
+                return;
+            }
+
+            if (entryName == 0)
+            {
+                // type must be visible before the name that makes the entry findable
+                entries[i].type.store(type, std::memory_order_relaxed);
+                entries[i].name.store(name, std::memory_order_release);
+                count += 1;
+                return;
+            }
+        }
+    }
+};
+
+//--
+
 extern void RegisterFundamentalTypes(TypeSystem& typeSystem);
 extern void RegisterObjectTypes(TypeSystem& typeSystem);
 
@@ -80,6 +162,7 @@ ClassType TypeSystem::findFactoryClass(StringID name, ClassType requiredBaseClas
 
 TypeSystem::TypeSystem()
     : m_fullyInitialized(false)
+    , m_lookupTable(nullptr)
 {   
 }
 
@@ -111,6 +194,12 @@ void TypeSystem::deinit()
 {
     ScopeLock<> lock(m_typesLock);
 
+    // release lookup tables, no lookups are expected past this point
+    delete m_lookupTable.exchange(nullptr, std::memory_order_acq_rel);
+    for (const auto* table : m_retiredLookupTables)
+        delete table;
+    m_retiredLookupTables.clear();
+
     // release default objects for classes
     for (auto ptr : m_classes)
         ptr->destroyDefaultObject();
@@ -159,12 +248,52 @@ void TypeSystem::enumGlobalFunctions(TGlobalFunctionList& outAllGlobalFunctions)
     outAllGlobalFunctions = m_globalFunctions;
 }
 
+Type TypeSystem::findTypeInLookupTable(StringID name) const
+{
+    if (const auto* table = m_lookupTable.load(std::memory_order_acquire))
+        return table->find(name.index());
+
+    return nullptr;
+}
+
+void TypeSystem::insertIntoLookupTable_NoLock(StringID name, Type type, bool overrideExisting)
+{
+    auto* table = const_cast<TypeLookupTable*>(m_lookupTable.load(std::memory_order_relaxed));
+
+    // out of space, move everything to a bigger table
+    if (!table || table->full())
+    {
+        const auto capacity = table ? table->capacity() * 2 : TypeLookupTable::MIN_CAPACITY;
+        auto* newTable = new TypeLookupTable(capacity);
+
+        if (table)
+        {
+            for (uint32_t i = 0; i < table->capacity(); ++i)
+                if (const auto entryName = table->entries[i].name.load(std::memory_order_relaxed))
+                    newTable->insert(entryName, table->entries[i].type.load(std::memory_order_relaxed), true);
+
+            // the old table can't be deleted as other threads may still be reading it
+            // NOTE: tables only grow by doubling so all the retired ones together are smaller than the current one
+            m_retiredLookupTables.pushBack(table);
+        }
+
+        m_lookupTable.store(newTable, std::memory_order_release);
+        table = newTable;
+    }
+
+    table->insert(name.index(), type.ptr(), overrideExisting);
+}
+
 Type TypeSystem::findType(StringID typeName)
 {
     // nullptr type?
     if (typeName.empty())
         return nullptr;
 
+    // fast path, most of the lookups end here
+    if (auto type = findTypeInLookupTable(typeName))
+        return type;
+
     ScopeLock<> lock(m_typesLock);
 
     Type type = nullptr;
@@ -198,11 +327,15 @@ Type TypeSystem::findType(StringID typeName)
 
 ClassType TypeSystem::findClass(StringID name)
 {
-    ScopeLock<> lock(m_typesLock);
-
     if (!name)
         return nullptr;
 
+    // fast path, most of the lookups end here
+    if (auto type = findTypeInLookupTable(name))
+        return type.toClass();
+
+    ScopeLock<> lock(m_typesLock);
+
     Type type = nullptr;
     if (m_types.find(name, type))
         return type.toClass();
@@ -226,9 +359,17 @@ ClassType TypeSystem::findClass(StringID name)
 
 const EnumType* TypeSystem::findEnum(StringID name)
 {
+    // NOTE: the lookup table contains alternative names as well, those are not used for enums
+    Type type = findTypeInLookupTable(name);
+    if (type && type->name() == name)
+    {
+        if (type->metaType() == MetaType::Enum)
+            return static_cast<const EnumType*>(type.ptr());
+        return nullptr;
+    }
+
     ScopeLock<> lock(m_typesLock);
 
-    Type type = nullptr;
     if (m_types.find(name, type))
     {
         if (type->metaType() == MetaType::Enum)
@@ -316,6 +457,7 @@ void TypeSystem::registerAlternativeTypeName(Type type, StringID alternativeName
     else
     {
         m_alternativeTypes.set(alternativeName, type);
+        insertIntoLookupTable_NoLock(alternativeName, type, false); // proper type names take precedence
     }
 }
 
@@ -334,6 +476,7 @@ void TypeSystem::registerType(Type type)
 
     m_types.set(type->name(), type);
     m_typeList.pushBack(type);
+    insertIntoLookupTable_NoLock(type->name(), type, true);
 
     if (auto classType = type.toClass())
         m_classes.pushBack(classType);
@@ -15,7 +15,7 @@
 #include "textSerializationWriterXML.h"
 #include "textSerializationReaderXML.h"
 #include "textSerializationWriterJson.h"
-//#include "textSerializationReaderJson.h"
+#include "textSerializationReaderJson.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -109,7 +109,11 @@ bool TypedMemory::LoadData(SerializationFormat format, const ObjectLoadingContex
 	}
 	else if (format == SerializationFormat::Json)
 	{
-		return false;
+		TextSerializationReaderJSON reader(txt, ctx, err);
+		TypeSerializationContext localContext;
+		data.rawType()->readText(localContext, reader, data.rawData());
+
+		return true;
 	}
 
 	return false;
@@ -20,15 +20,110 @@ BEGIN_INFERNO_NAMESPACE()
 
 //--
 
-static bool MustAllocateVariantMemory(Type type)
+namespace prv
 {
-    if (type->traits().requiresConstructor || type->traits().requiresDestructor)
-        return true;
-    if (type->alignment() > 4 || type->size() > Variant::INTERNAL_STORAGE_SIZE)
-        return true;
+    // thread local cache of blocks for variant payloads that don't fit in the inline storage
+    // NOTE: blocks are never shared between size classes, block freed on different thread simply ends up in that thread's cache
+    struct VariantMemoryCache
+    {
+        static const uint32_t NUM_SIZE_CLASSES = 4; // 32, 64, 128, 256
+        static const uint32_t MIN_BLOCK_SIZE = 32;
+        static const uint32_t MAX_BLOCK_SIZE = MIN_BLOCK_SIZE << (NUM_SIZE_CLASSES - 1);
+        static const uint32_t BLOCK_ALIGNMENT = 16;
+        static const uint32_t MAX_CACHED_BLOCKS = 32; // per size class, anything above goes back to the pool
 
-    //return false;
-    return true;
+        struct FreeBlock
+        {
+            FreeBlock* next;
+        };
+
+        FreeBlock* freeLists[NUM_SIZE_CLASSES];
+        uint32_t numFree[NUM_SIZE_CLASSES];
+        bool destroyed = false; // thread is exiting, variants freed from now on go directly to the pool
+
+        VariantMemoryCache()
+        {
+            memzero(freeLists, sizeof(freeLists));
+            memzero(numFree, sizeof(numFree));
+        }
+
+        // return cached blocks to the pool when the thread exits
+        ~VariantMemoryCache()
+        {
+            for (uint32_t i = 0; i < NUM_SIZE_CLASSES; ++i)
+            {
+                while (auto* block = freeLists[i])
+                {
+                    freeLists[i] = block->next;
+                    Memory::FreeBlock(block);
+                }
+
+                numFree[i] = 0;
+            }
+
+            destroyed = true;
+        }
+
+        // find size class for given type, -1 if type is too big for the cache
+        static INLINE int SizeClass(uint32_t size, uint32_t alignment)
+        {
+            if (size > MAX_BLOCK_SIZE || alignment > BLOCK_ALIGNMENT)
+                return -1;
+
+            int sizeClass = 0;
+            uint32_t blockSize = MIN_BLOCK_SIZE;
+            while (blockSize < size)
+            {
+                blockSize <<= 1;
+                sizeClass += 1;
+            }
+
+            return sizeClass;
+        }
+    };
+
+    static thread_local VariantMemoryCache GVariantMemoryCache;
+
+} // prv
+
+//--
+
+void* Variant::AllocateVariantMemory(Type type)
+{
+    const auto sizeClass = prv::VariantMemoryCache::SizeClass(type->size(), type->alignment());
+    if (sizeClass < 0)
+        return Memory::AllocateBlock(type->size(), type->alignment(), "Variant");
+
+    // NOTE: free lists are empty once the cache is destroyed so blocks come straight from the pool
+    auto& cache = prv::GVariantMemoryCache;
+    if (auto* block = cache.freeLists[sizeClass])
+    {
+        cache.freeLists[sizeClass] = block->next;
+        cache.numFree[sizeClass] -= 1;
+        return block;
+    }
+
+    const auto blockSize = prv::VariantMemoryCache::MIN_BLOCK_SIZE << sizeClass;
+    return Memory::AllocateBlock(blockSize, prv::VariantMemoryCache::BLOCK_ALIGNMENT, "Variant");
+}
+
+void Variant::FreeVariantMemory(Type type, void* data)
+{
+    const auto sizeClass = prv::VariantMemoryCache::SizeClass(type->size(), type->alignment());
+    if (sizeClass >= 0)
+    {
+        auto& cache = prv::GVariantMemoryCache;
+        if (!cache.destroyed && cache.numFree[sizeClass] < prv::VariantMemoryCache::MAX_CACHED_BLOCKS)
+        {
+            auto* block = (prv::VariantMemoryCache::FreeBlock*)data;
+            block->next = cache.freeLists[sizeClass];
+            cache.freeLists[sizeClass] = block;
+            cache.numFree[sizeClass] += 1;
+            return;
+        }
+    }
+
+    Memory::FreeBlock(data);
 }
 
 //--
@@ -40,11 +135,8 @@ Variant::Variant(const Variant& other)
 }
 
 Variant::Variant(Variant&& other)
-    : m_type(other.m_type)
-    , m_data(other.m_data)
 {
-    other.m_type = nullptr;
-    other.m_data = nullptr;
+    moveFrom(other);
 }
 
 Variant::~Variant()
@@ -52,10 +144,26 @@ Variant::~Variant()
     reset();
 }
 
+void Variant::moveFrom(Variant& other)
+{
+    // inline values are trivially relocatable, for the rest we just take over the pointer
+    m_type = other.m_type;
+    memcpy(m_inlineData, other.m_inlineData, INTERNAL_STORAGE_SIZE);
+
+    other.m_type = nullptr;
+    other.m_data = nullptr;
+}
+
 Variant& Variant::operator=(const Variant& other)
 {
     if (this != &other)
-        reset(other.type(), other.data());
+    {
+        if (other)
+            reset(other.type(), other.data());
+        else
+            reset();
+    }
+
     return *this;
 }
 
@@ -63,10 +171,8 @@ Variant& Variant::operator=(Variant&& other)
 {
     if (this != &other)
     {
-        m_data = other.m_data;
-        m_type = other.m_type;
-		other.m_type = nullptr;
-		other.m_data = nullptr;
+        reset();
+        moveFrom(other);
     }
 
     return *this;
@@ -90,70 +196,53 @@ bool Variant::operator!=(const Variant& other) const
     return !operator==(other);
 }
 
-void* Variant::AllocateVariantMemory(Type type)
-{
-    // TODO: custom pool for variants
-    return Memory::AllocateBlock(type->size(), type->alignment(), "Variant");
-}
-
-void Variant::FreeVariantMemory(void* data)
-{
-    Memory::FreeBlock(data);
-}
-
 void Variant::reset()
 {
-    if (m_data)
+    if (m_type)
     {
-        m_type->destruct(m_data);
+        if (isInline())
+        {
+            m_type->destruct(m_inlineData);
+        }
+        else if (m_data)
+        {
+            m_type->destruct(m_data);
+            FreeVariantMemory(m_type, m_data);
+        }
 
-        FreeVariantMemory(m_data);
+        m_type = nullptr;
         m_data = nullptr;
     }
 }
 
-static bool IsAligned(const void* ptr, uint32_t alignemnt)
-{
-    return AlignPtr(ptr, alignemnt) == ptr;
-}
-
 bool Variant::reset(Type type, const void* data)
 {
-    ASSERT_EX(!m_type, "Variant should be empty before initialization");
     DEBUG_CHECK_EX(type, "Trying to create variant from non existing type");
 
     // change type of the container
     if (type != m_type)
     {
         // destroy current value
-        if (m_type)
-        {
-            m_type->destruct(m_data);
-            m_type = m_type;
+        reset();
 
-            FreeVariantMemory(m_data);
-            m_data = nullptr;
-        }
-
-        // change type
-        ASSERT(!m_data)
-        m_type = type;
-
-        // allocate new storage
+        // allocate new storage, small values don't need any
         if (type)
         {
-            auto* data = AllocateVariantMemory(type);
-            DEBUG_CHECK_RETURN_EX_V(data, "OOM in variant", false);
+            if (!CanStoreInline(type))
+            {
+                m_data = AllocateVariantMemory(type);
+                DEBUG_CHECK_RETURN_EX_V(m_data, "OOM in variant", false);
+            }
 
-            m_data = data;
-            m_type->construct(m_data);
+            m_type = type;
+            m_type->construct(this->data());
         }
     }
 
     // copy new value
     ASSERT(m_type == type);
-    if (data)
-        m_type->copy(m_data, data);
+    if (data && m_type)
+        m_type->copy(this->data(), data);
 
     return true;
 }
@@ -170,18 +259,18 @@ bool Variant::get(Type destType, void* destData) const
 
 void Variant::print(IFormatStream& f) const
 {
-    IType::PrintToString(m_type, m_data, f);
+    IType::PrintToString(m_type, data(), f);
 }
 
 bool Variant::fromString(StringView txt)
 {
-    return IType::ParseFromString(m_type, m_data, txt);
+    return IType::ParseFromString(m_type, data(), txt);
 }
 
 StringBuf Variant::toString() const
 {
     StringBuilder txt;
-    IType::PrintToString(m_type, m_data, txt);
+    IType::PrintToString(m_type, data(), txt);
     return StringBuf(txt);
 }
 
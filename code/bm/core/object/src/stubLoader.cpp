@@ -11,21 +11,55 @@
 #include "stubFactory.h"
 #include "stubLoader.h"
 #include "bm/core/containers/include/crc.h"
+#include "bm/core/file/include/fileReader.h"
+#include "bm/core/file/include/fileMapping.h"
+#include "bm/core/task/include/taskUtils.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
 //--
 
+// NOTE: tables are placed in the tail of the decompression buffer, no separate allocations are made
 struct StubDataReaderTables
 {
-	Array<StringID> names;
-	Array<StringView> strings;
-	Array<IStub*> stubs;
-	Array<StubTypeValue> stubTypes;
+	ArrayView<StringView> strings;
+	ArrayView<IStub*> stubs;
+	ArrayView<StringID> names;
+	ArrayView<StubTypeValue> stubTypes;
 
 	uint32_t totalStubMemory = 0;
 };
 
+template< typename T >
+static ArrayView<T> PlaceTable(uint8_t*& ptr, uint32_t count)
+{
+	auto* elements = AlignPtr((T*)ptr, alignof(T));
+	for (uint32_t i = 0; i < count; ++i)
+		new (elements + i) T();
+
+	ptr = (uint8_t*)(elements + count);
+	return ArrayView<T>(elements, count);
+}
+
+static uint32_t CalcTablesMemorySize(const StubHeader& header)
+{
+	uint32_t size = 0;
+	size = Align<uint32_t>(size, alignof(StringView)) + sizeof(StringView) * header.numStrings;
+	size = Align<uint32_t>(size, alignof(IStub*)) + sizeof(IStub*) * header.numStubs;
+	size = Align<uint32_t>(size, alignof(StringID)) + sizeof(StringID) * header.numNames;
+	size = Align<uint32_t>(size, alignof(StubTypeValue)) + sizeof(StubTypeValue) * header.numStubs;
+	return size;
+}
+
+struct StubCompressedChunk
+{
+	const uint8_t* compressedData = nullptr;
+	uint32_t compressedSize = 0;
+	uint32_t compressedCRC = 0;
+	uint32_t uncompressedOffset = 0;
+	uint32_t uncompressedSize = 0;
+};
+
 //--
 
 template< typename T >
@@ -368,6 +402,27 @@ const IStub* StubLoader::unpack(const Buffer& buffer)
 	return unpack(buffer.data(), buffer.size());
 }
 
+const IStub* StubLoader::unpack(IFileReader* file)
+{
+	DEBUG_CHECK_RETURN_EX_V(file, "Invalid file", nullptr);
+	DEBUG_CHECK_RETURN_EX_V(file->size() <= std::numeric_limits<uint32_t>::max(), "Stub file is too big", nullptr);
+
+	// packed data is only needed during unpacking so we don't have to keep the mapping
+	if (file->flags().test(FileFlagBit::MemoryMapped) || file->flags().test(FileFlagBit::MemoryBacked))
+	{
+		if (auto mapping = file->createMapping(file->fullRange()))
+		{
+			mapping->accessHint(FileAccessHint::Sequential);
+			return unpack(mapping->data(), (uint32_t)mapping->size());
+		}
+	}
+
+	const auto data = file->loadToBuffer(MainPool(), file->fullRange());
+	DEBUG_CHECK_RETURN_EX_V(data, "Failed to load stub data", nullptr);
+
+	return unpack(data);
+}
+
 const IStub* StubLoader::unpack(const void* packedData, uint32_t packedDataSize)
 {
 	PC_SCOPE_LVL1(UnpackStubs);
@@ -379,24 +434,61 @@ const IStub* StubLoader::unpack(const void* packedData, uint32_t packedDataSize)
 
 	ScopeTimer timer;
 
-	static const auto headerSize = sizeof(StubHeader);
-	DEBUG_CHECK_RETURN_EX_V(packedDataSize > headerSize, "Not enough data for even a header", nullptr);
+	static const auto legacyHeaderSize = offsetof(StubHeader, numChunks);
+	DEBUG_CHECK_RETURN_EX_V(packedDataSize > legacyHeaderSize, "Not enough data for even a header", nullptr);
 
 	const auto* header = (const StubHeader*) packedData;
+	DEBUG_CHECK_RETURN_EX_V(header->magic == StubHeader::MAGIC || header->magic == StubHeader::MAGIC_CHUNKED, "Invalid stub data header", nullptr);
 	DEBUG_CHECK_RETURN_EX_V(header->version >= m_minVersion, TempString("Shader blob is in version {} but minimal supported version is {}", header->version, m_minVersion), nullptr);
 
-	const auto crc = CRC32().append((uint8_t*)packedData + headerSize, packedDataSize - headerSize).crc();
-	DEBUG_CHECK_RETURN_EX_V(header->compressedCRC == crc, "Shader blob has invalid CRC than in the header. Data is possible corrupted. Loading would be unsafe.", nullptr);
-
-	const auto packedDataView = BufferView(header + 1, packedDataSize - headerSize);
-	auto unpackedMem = Buffer::CreateDecompressed(MainPool(), CompressionType::LZ4HC, packedDataView, header->uncompressedSize);
-	DEBUG_CHECK_RETURN_EX_V(unpackedMem, "Failed to allocate buffer for decompress shader data.", nullptr);
-	TRACE_SPAM("Unpacked stub blob {} -> {}", MemSize(packedDataSize), MemSize(header->uncompressedSize));
-
 	DEBUG_CHECK_RETURN_EX_V(header->numNames >= 1, "Invalid header counts", nullptr);
 	DEBUG_CHECK_RETURN_EX_V(header->numStrings >= 1, "Invalid header counts", nullptr);
 	DEBUG_CHECK_RETURN_EX_V(header->numStubs >= 1, "Invalid header counts", nullptr);
 
+	// gather compressed chunks, legacy data is one big chunk without the chunk table
+	InplaceArray<StubCompressedChunk, 64> chunks;
+	{
+		const auto* packedDataEnd = (const uint8_t*)packedData + packedDataSize;
+
+		if (header->magic == StubHeader::MAGIC_CHUNKED)
+		{
+			const auto chunkTableSize = sizeof(StubChunkHeader) * (uint64_t)header->numChunks;
+			DEBUG_CHECK_RETURN_EX_V(sizeof(StubHeader) + chunkTableSize <= packedDataSize, "Not enough data for chunk table", nullptr);
+
+			const auto* chunkTable = (const StubChunkHeader*)(header + 1);
+			const auto crc = CRC32().append(chunkTable, chunkTableSize).crc();
+			DEBUG_CHECK_RETURN_EX_V(header->compressedCRC == crc, "Stub blob has invalid chunk table CRC. Data is possible corrupted. Loading would be unsafe.", nullptr);
+
+			const auto* compressedPtr = (const uint8_t*)(chunkTable + header->numChunks);
+			uint32_t uncompressedOffset = 0;
+			for (uint32_t i = 0; i < header->numChunks; ++i)
+			{
+				const auto& chunkHeader = chunkTable[i];
+				DEBUG_CHECK_RETURN_EX_V(compressedPtr + chunkHeader.compressedSize <= packedDataEnd, "Compressed chunk goes outside the packed data", nullptr);
+
+				auto& chunk = chunks.emplaceBack();
+				chunk.compressedData = compressedPtr;
+				chunk.compressedSize = chunkHeader.compressedSize;
+				chunk.compressedCRC = chunkHeader.compressedCRC;
+				chunk.uncompressedOffset = uncompressedOffset;
+				chunk.uncompressedSize = chunkHeader.uncompressedSize;
+
+				compressedPtr += chunkHeader.compressedSize;
+				uncompressedOffset += chunkHeader.uncompressedSize;
+			}
+
+			DEBUG_CHECK_RETURN_EX_V(uncompressedOffset == header->uncompressedSize, "Chunk table does not match uncompressed size", nullptr);
+		}
+		else
+		{
+			auto& chunk = chunks.emplaceBack();
+			chunk.compressedData = (const uint8_t*)packedData + legacyHeaderSize;
+			chunk.compressedSize = packedDataSize - legacyHeaderSize;
+			chunk.compressedCRC = header->compressedCRC;
+			chunk.uncompressedSize = header->uncompressedSize;
+		}
+	}
+
 	//--
 
 	// empty object case - legal
@@ -405,11 +497,59 @@ const IStub* StubLoader::unpack(const void* packedData, uint32_t packedDataSize)
 
 	//--
 
+	// one allocation for the unpacked data and all the tables we need to unpack the stubs
+	const auto tablesOffset = Align<uint32_t>(header->uncompressedSize, 16);
+	auto unpackedMem = Buffer::CreateEmpty(MainPool(), tablesOffset + CalcTablesMemorySize(*header), 16);
+	DEBUG_CHECK_RETURN_EX_V(unpackedMem, "Failed to allocate buffer for decompress shader data.", nullptr);
+
+	// validate and decompress chunks in parallel, each chunk is independent
+	{
+		PC_SCOPE_LVL1(DecompressStubs);
+
+		std::atomic<uint32_t> numFailedChunks = 0;
+		auto* unpackedPtr = unpackedMem.data();
+
+		const auto decompressChunk = [&chunks, &numFailedChunks, unpackedPtr](uint32_t index)
+		{
+			const auto& chunk = chunks[index];
+
+			const auto crc = CRC32().append(chunk.compressedData, chunk.compressedSize).crc();
+			if (crc != chunk.compressedCRC)
+			{
+				TRACE_ERROR("Stub blob chunk {} has invalid CRC. Data is possible corrupted.", index);
+				++numFailedChunks;
+				return;
+			}
+
+			BufferOutputStream<uint8_t> output(unpackedPtr + chunk.uncompressedOffset, chunk.uncompressedSize);
+			const auto compressedView = BufferView(chunk.compressedData, chunk.compressedSize);
+			if (!compressedView.decompress(CompressionType::LZ4HC, output) || output.size() != chunk.uncompressedSize)
+			{
+				TRACE_ERROR("Failed to decompress stub blob chunk {}", index);
+				++numFailedChunks;
+			}
+		};
+
+		if (chunks.size() > 1)
+			TaskParallelForEach(chunks.indexRange()) << decompressChunk;
+		else if (!chunks.empty())
+			decompressChunk(0);
+
+		DEBUG_CHECK_RETURN_EX_V(numFailedChunks == 0, "Stub blob has invalid data. Loading would be unsafe.", nullptr);
+	}
+	TRACE_SPAM("Unpacked stub blob {} -> {} ({} chunks)", MemSize(packedDataSize), MemSize(header->uncompressedSize), chunks.size());
+
+	//--
+
 	StubDataReaderTables tables;
-	tables.names.resizeWith(header->numNames, StringID());
-	tables.strings.resizeWith(header->numStrings, StringView());
-	tables.stubs.resizeWith(header->numStubs, nullptr);
-	tables.stubTypes.resizeWith(header->numStubs, 0);
+	{
+		auto* tablesPtr = unpackedMem.data() + tablesOffset;
+		tables.strings = PlaceTable<StringView>(tablesPtr, header->numStrings);
+		tables.stubs = PlaceTable<IStub*>(tablesPtr, header->numStubs);
+		tables.names = PlaceTable<StringID>(tablesPtr, header->numNames);
+		tables.stubTypes = PlaceTable<StubTypeValue>(tablesPtr, header->numStubs);
+		ASSERT(tablesPtr <= unpackedMem.data() + unpackedMem.size());
+	}
 	TRACE_SPAM("Found {} strings, {} names and {} stubs in the blob", header->numStrings, header->numNames, header->numStubs);
 
 	const uint8_t* dataPtr = (const uint8_t*)unpackedMem.data();
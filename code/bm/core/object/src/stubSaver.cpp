@@ -12,6 +12,7 @@
 
 #include "bm/core/containers/include/hashSet.h"
 #include "bm/core/containers/include/pagedBuffer.h"
+#include "bm/core/task/include/taskUtils.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -356,26 +357,65 @@ Buffer IStub::pack(uint32_t version) const
 		TRACE_SPAM("Saved {} stubs to {} in {}", mapper.m_stubs.size(), MemSize(uncompressedData.dataSize()), timer);
 	}
 
-	// compress data
-	auto compressedData = Buffer::CreateCompressed(MainPool(), CompressionType::LZ4HC, uncompressedData.toBuffer(MainPool()));
-	DEBUG_CHECK_RETURN_EX_V(compressedData, "Failed to compress stub data", nullptr);
+	// compress data in independent chunks so they can be validated and decompressed in parallel when loading
+	const auto uncompressedBuffer = uncompressedData.toBuffer(MainPool());
+	const auto uncompressedSize = (uint32_t)uncompressedBuffer.size();
+	const auto numChunks = (uncompressedSize + StubHeader::CHUNK_SIZE - 1) / StubHeader::CHUNK_SIZE;
+
+	Array<StubChunkHeader> chunks;
+	chunks.resize(numChunks);
+
+	Array<Buffer> compressedChunks;
+	compressedChunks.resize(numChunks);
+
+	{
+		PC_SCOPE_LVL1(Compress);
+
+		TaskParallelForEach(chunks.indexRange()) << [&chunks, &compressedChunks, &uncompressedBuffer, uncompressedSize](uint32_t index)
+		{
+			const auto offset = index * StubHeader::CHUNK_SIZE;
+			const auto size = std::min<uint32_t>(StubHeader::CHUNK_SIZE, uncompressedSize - offset);
+
+			const auto& compressed = compressedChunks[index] = Buffer::CreateCompressed(MainPool(), CompressionType::LZ4HC, BufferView(uncompressedBuffer.data() + offset, size));
+			chunks[index].uncompressedSize = size;
+			chunks[index].compressedSize = compressed.size();
+			chunks[index].compressedCRC = CRC32().append(compressed.data(), compressed.size()).crc();
+		};
+	}
+
+	uint64_t totalCompressedSize = 0;
+	for (const auto& compressed : compressedChunks)
+	{
+		DEBUG_CHECK_RETURN_EX_V(compressed, "Failed to compress stub data", nullptr);
+		totalCompressedSize += compressed.size();
+	}
 
 	// assemble final buffer
-	auto finalData = Buffer::CreateEmpty(MainPool(), sizeof(StubHeader) + compressedData.size());
+	const auto chunkTableSize = chunks.dataSize();
+	auto finalData = Buffer::CreateEmpty(MainPool(), sizeof(StubHeader) + chunkTableSize + totalCompressedSize);
 
 	// save header
 	auto* header = (StubHeader*)finalData.data();
 	header->version = version;
-	header->magic = StubHeader::MAGIC;
+	header->magic = StubHeader::MAGIC_CHUNKED;
 	header->numNames = mapper.m_names.size();
 	header->numStrings = mapper.m_strings.size();
 	header->numStubs = mapper.m_stubs.size();
+	header->numChunks = numChunks;
 	header->additionalDataSize = mapper.m_additionalMemoryNeeded;
-	header->compressedCRC = CRC32().append(compressedData.data(), compressedData.size()).crc();
-	header->uncompressedSize = uncompressedData.dataSize();
+	header->compressedCRC = CRC32().append(chunks.data(), chunkTableSize).crc();
+	header->uncompressedSize = uncompressedSize;
 
-	// copy data
-	memcpy(finalData.data() + sizeof(StubHeader), compressedData.data(), compressedData.size());
+	// copy chunk table and data
+	auto* writePtr = finalData.data() + sizeof(StubHeader);
+	memcpy(writePtr, chunks.data(), chunkTableSize);
+	writePtr += chunkTableSize;
+
+	for (const auto& compressed : compressedChunks)
+	{
+		memcpy(writePtr, compressed.data(), compressed.size());
+		writePtr += compressed.size();
+	}
 
 	TRACE_SPAM("Packed {} stubs to {} final compressed buffer in {}", mapper.m_stubs.size(), MemSize(finalData.size()), timer);
 	return finalData;
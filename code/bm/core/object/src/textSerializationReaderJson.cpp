@@ -0,0 +1,744 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "textSerializationReaderJson.h"
+#include "serializationStream.h"
+
+#include "resourceReference.h"
+#include "resourcePromise.h"
+#include "resource.h"
+#include "resourceId.h"
+
+#include "bm/core/parser/include/textToken.h"
+#include "bm/core/containers/include/utf8StringFunctions.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+namespace helper
+{
+	static INLINE bool IsWhitespace(char ch)
+	{
+		return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+	}
+
+	static INLINE bool IsTokenEnd(char ch, bool memberName)
+	{
+		switch (ch)
+		{
+		case ',':
+		case '{':
+		case '}':
+		case '[':
+		case ']':
+		case '"':
+			return true;
+
+		case ':':
+			return memberName;
+
+		default:
+			return ch <= ' ';
+		}
+	}
+
+	static const char* SkipString(const char* pos, const char* end)
+	{
+		pos += 1; // opening quote
+
+		while (pos < end)
+		{
+			const auto ch = *pos++;
+			if (ch == '\\')
+				pos += 1;
+			else if (ch == '"')
+				return pos;
+		}
+
+		return end;
+	}
+
+	static bool ParseHex4(const char* pos, const char* end, uint32_t& outValue)
+	{
+		if (pos + 4 > end)
+			return false;
+
+		uint32_t value = 0;
+		for (uint32_t i = 0; i < 4; ++i)
+		{
+			const auto ch = pos[i];
+
+			value <<= 4;
+			if (ch >= '0' && ch <= '9')
+				value |= ch - '0';
+			else if (ch >= 'a' && ch <= 'f')
+				value |= 10 + (ch - 'a');
+			else if (ch >= 'A' && ch <= 'F')
+				value |= 10 + (ch - 'A');
+			else
+				return false;
+		}
+
+		outValue = value;
+		return true;
+	}
+
+	// count elements of the array that starts at given position (just after the '['), the nested blocks and strings are skipped without being parsed
+	static uint32_t CountArrayElements(const char* pos, const char* end)
+	{
+		uint32_t count = 0;
+		uint32_t depth = 0;
+		bool insideElement = false;
+
+		while (pos < end)
+		{
+			const auto ch = *pos;
+
+			if (ch == '"')
+			{
+				if (depth == 0 && !insideElement)
+				{
+					insideElement = true;
+					count += 1;
+				}
+
+				pos = SkipString(pos, end);
+				continue;
+			}
+
+			if (depth == 0)
+			{
+				if (ch == ']' || ch == '}')
+					break;
+
+				if (ch == ',' || IsWhitespace(ch))
+				{
+					insideElement = false;
+					pos += 1;
+					continue;
+				}
+
+				if (!insideElement)
+				{
+					insideElement = true;
+					count += 1;
+				}
+			}
+
+			if (ch == '{' || ch == '[')
+				depth += 1;
+			else if (ch == '}' || ch == ']')
+				depth -= 1;
+
+			pos += 1;
+		}
+
+		return count;
+	}
+
+} // helper
+
+//--
+
+TextSerializationReaderJSON::TextSerializationReaderJSON(StringView txt, const ObjectLoadingContext& context, ITextErrorReporter& err)
+	: m_start(txt.data())
+	, m_pos(txt.data())
+	, m_end(txt.data() + txt.length())
+	, m_context(context)
+	, m_err(err)
+{
+}
+
+TextSerializationReaderJSON::~TextSerializationReaderJSON()
+{}
+
+void TextSerializationReaderJSON::reportError(StringView txt)
+{
+	uint32_t line = 1;
+	const char* lineStart = m_start;
+
+	for (const char* pos = m_start; pos < m_pos; ++pos)
+	{
+		if (*pos == '\n')
+		{
+			line += 1;
+			lineStart = pos + 1;
+		}
+	}
+
+	TextTokenLocation loc(m_context.contextPath, line, 1 + (uint32_t)(m_pos - lineStart));
+	m_err.reportError(loc, txt);
+}
+
+//--
+
+void TextSerializationReaderJSON::skipWhitespaces()
+{
+	while (m_pos < m_end && helper::IsWhitespace(*m_pos))
+		m_pos += 1;
+}
+
+void TextSerializationReaderJSON::skipSeparators()
+{
+	while (m_pos < m_end && (*m_pos == ',' || helper::IsWhitespace(*m_pos)))
+		m_pos += 1;
+}
+
+void TextSerializationReaderJSON::skipBlock()
+{
+	uint32_t depth = 0;
+
+	while (m_pos < m_end)
+	{
+		const auto ch = *m_pos;
+
+		if (ch == '"')
+		{
+			m_pos = helper::SkipString(m_pos, m_end);
+			continue;
+		}
+
+		m_pos += 1;
+
+		if (ch == '{' || ch == '[')
+		{
+			depth += 1;
+		}
+		else if (ch == '}' || ch == ']')
+		{
+			if (depth == 0)
+				return;
+			depth -= 1;
+		}
+	}
+}
+
+void TextSerializationReaderJSON::skipValue()
+{
+	skipWhitespaces();
+
+	if (m_pos < m_end)
+	{
+		const auto ch = *m_pos;
+
+		if (ch == '"')
+		{
+			m_pos = helper::SkipString(m_pos, m_end);
+		}
+		else if (ch == '{' || ch == '[')
+		{
+			m_pos += 1;
+			skipBlock();
+		}
+		else
+		{
+			while (m_pos < m_end && !helper::IsTokenEnd(*m_pos, false))
+				m_pos += 1;
+		}
+	}
+
+	m_valueConsumed = true;
+}
+
+//--
+
+bool TextSerializationReaderJSON::parseString(StringView& outText)
+{
+	const auto* start = m_pos + 1;
+	const auto* pos = start;
+
+	// fast path - string without any escapes is just a view of the source text
+	while (pos < m_end && *pos != '"' && *pos != '\\')
+		pos += 1;
+
+	if (pos < m_end && *pos == '"')
+	{
+		outText = StringView(start, pos);
+		m_pos = pos + 1;
+		return true;
+	}
+
+	// slow path - unescape the string into our own storage
+	InplaceArray<char, 256> chars;
+	chars.pushBackMany(ArrayView<char>(start, pos - start));
+
+	while (pos < m_end)
+	{
+		const auto ch = *pos++;
+
+		if (ch == '"')
+		{
+			outText = m_unescapedStrings.emplaceBack(StringView(chars.typedData(), chars.size()));
+			m_pos = pos;
+			return true;
+		}
+		else if (ch != '\\')
+		{
+			chars.pushBack(ch);
+			continue;
+		}
+
+		if (pos >= m_end)
+			break;
+
+		const auto code = *pos++;
+		switch (code)
+		{
+			case '"': chars.pushBack('"'); break;
+			case '\\': chars.pushBack('\\'); break;
+			case '/': chars.pushBack('/'); break;
+			case 'b': chars.pushBack('\b'); break;
+			case 'f': chars.pushBack('\f'); break;
+			case 'n': chars.pushBack('\n'); break;
+			case 'r': chars.pushBack('\r'); break;
+			case 't': chars.pushBack('\t'); break;
+
+			default:
+			{
+				// NOTE: older files were written with "\XXXX" (without the 'u') for non-ASCII characters
+				// NOTE: only escapes that can't be confused with the standard ones are decoded that way, "\bXXXX" and "\fXXXX" are always "\b" and "\f"
+				const auto* hex = (code == 'u') ? pos : pos - 1;
+
+				uint32_t value = 0;
+				if (!helper::ParseHex4(hex, m_end, value))
+				{
+					m_pos = pos;
+					reportError(TempString("Invalid escape sequence '\\{}' in string", code));
+					chars.pushBack(code);
+					break;
+				}
+
+				pos = hex + 4;
+
+				// combine surrogate pairs
+				if (value >= 0xD800 && value <= 0xDBFF && pos + 2 <= m_end && pos[0] == '\\' && pos[1] == 'u')
+				{
+					uint32_t low = 0;
+					if (helper::ParseHex4(pos + 2, m_end, low) && low >= 0xDC00 && low <= 0xDFFF)
+					{
+						value = 0x10000 + ((value - 0xD800) << 10) + (low - 0xDC00);
+						pos += 6;
+					}
+				}
+
+				char utf[6];
+				const auto length = utf8::ConvertChar(utf, value);
+				chars.pushBackMany(ArrayView<char>(utf, length));
+				break;
+			}
+		}
+	}
+
+	m_pos = m_end;
+	reportError("Unterminated string");
+	return false;
+}
+
+bool TextSerializationReaderJSON::parseToken(StringView& outText, bool memberName)
+{
+	const auto* start = m_pos;
+
+	while (m_pos < m_end && !helper::IsTokenEnd(*m_pos, memberName))
+		m_pos += 1;
+
+	outText = StringView(start, m_pos);
+	return true;
+}
+
+bool TextSerializationReaderJSON::parseScalar(StringView& outText)
+{
+	skipWhitespaces();
+
+	if (m_pos >= m_end)
+		return false;
+
+	const auto ch = *m_pos;
+	if (ch == '"')
+		return parseString(outText);
+	else if (ch == '{' || ch == '[' || ch == '}' || ch == ']' || ch == ',')
+		return false;
+	else
+		return parseToken(outText, false);
+}
+
+bool TextSerializationReaderJSON::parseMemberName(StringView& outName)
+{
+	skipSeparators();
+
+	if (m_pos >= m_end || *m_pos == '}' || *m_pos == ']')
+		return false;
+
+	if (*m_pos == '"')
+	{
+		if (!parseString(outName))
+			return false;
+	}
+	else
+	{
+		parseToken(outName, true);
+	}
+
+	skipWhitespaces();
+
+	if (m_pos >= m_end || *m_pos != ':')
+	{
+		reportError(TempString("Expected ':' after member '{}'", outName));
+		return false;
+	}
+
+	m_pos += 1;
+	skipWhitespaces();
+	return true;
+}
+
+//--
+
+bool TextSerializationReaderJSON::beingArray(uint32_t& outCount)
+{
+	if (m_valueConsumed)
+		return false;
+
+	skipWhitespaces();
+	if (m_pos >= m_end || *m_pos != '[')
+		return false;
+
+	m_pos += 1;
+	outCount = helper::CountArrayElements(m_pos, m_end);
+	return true;
+}
+
+void TextSerializationReaderJSON::endArray()
+{
+	skipBlock();
+	m_valueConsumed = true;
+}
+
+bool TextSerializationReaderJSON::beingArrayElement()
+{
+	skipSeparators();
+
+	if (m_pos >= m_end || *m_pos == ']' || *m_pos == '}')
+		return false;
+
+	m_valueConsumed = false;
+	return true;
+}
+
+void TextSerializationReaderJSON::endArrayElement()
+{
+	if (!m_valueConsumed)
+		skipValue();
+}
+
+bool TextSerializationReaderJSON::beginStruct()
+{
+	if (m_valueConsumed)
+		return false;
+
+	skipWhitespaces();
+	if (m_pos >= m_end || *m_pos != '{')
+		return false;
+
+	m_pos += 1;
+
+	// empty structures are consumed right away
+	skipWhitespaces();
+	if (m_pos < m_end && *m_pos == '}')
+	{
+		m_pos += 1;
+		m_valueConsumed = true;
+		return false;
+	}
+
+	return true;
+}
+
+void TextSerializationReaderJSON::endStruct()
+{
+	skipBlock();
+	m_valueConsumed = true;
+}
+
+bool TextSerializationReaderJSON::beginStructElement(StringView& outName)
+{
+	while (parseMemberName(outName))
+	{
+		// object headers ("#class", "#id") are not members
+		if (outName.beginsWith("#"))
+		{
+			skipValue();
+			continue;
+		}
+
+		m_valueConsumed = false;
+		return true;
+	}
+
+	return false;
+}
+
+void TextSerializationReaderJSON::endStructElement()
+{
+	if (!m_valueConsumed)
+		skipValue();
+}
+
+bool TextSerializationReaderJSON::readValueText(StringView& outValue)
+{
+	if (m_valueConsumed)
+		return false;
+
+	if (!parseScalar(outValue))
+		return false;
+
+	m_valueConsumed = true;
+	return true;
+}
+
+bool TextSerializationReaderJSON::readValueBytes(Buffer& outData)
+{
+	StringView txt;
+	if (!readValueText(txt))
+		return false;
+
+	if (txt.empty())
+	{
+		outData = Buffer();
+		return true;
+	}
+
+	outData = txt.decode(m_context.pool ? *m_context.pool : MainPool(), EncodingType::Base64);
+	if (!outData)
+	{
+		reportError("Invalid Base64 data");
+		return false;
+	}
+
+	return true;
+}
+
+bool TextSerializationReaderJSON::readInlinedObject(ObjectPtr& outObject)
+{
+	// peek the object header without consuming anything, the object itself will read the members
+	const auto* objectStart = m_pos;
+
+	StringView className;
+	StringView idText;
+	{
+		m_pos += 1;
+
+		StringView memberName;
+		while (parseMemberName(memberName))
+		{
+			if (memberName == "#class")
+			{
+				if (!parseScalar(className))
+					break;
+			}
+			else if (memberName == "#id")
+			{
+				if (!parseScalar(idText))
+					break;
+			}
+			else
+			{
+				break;
+			}
+		}
+
+		m_pos = objectStart;
+	}
+
+	if (!className)
+	{
+		reportError("Incomplete object definition");
+		return false;
+	}
+
+	auto classType = RTTI::GetInstance().findClass(StringID(className));
+	if (!classType)
+	{
+		reportError(TempString("Object uses unknown class '{}'", className));
+		return false;
+	}
+
+	if (classType->isAbstract())
+	{
+		reportError(TempString("Object uses abstract class '{}'", className));
+		return false;
+	}
+
+	ObjectPtr ptr = classType->create<IObject>();
+	if (!ptr)
+	{
+		reportError(TempString("Failed to create object of class '{}'", className));
+		return false;
+	}
+
+	if (idText)
+	{
+		uint32_t id = 0;
+		if (!idText.match(id))
+		{
+			reportError(TempString("Object of class '{}' has invalid id '{}'", classType, idText));
+		}
+		else if (m_definedObjects.contains(id))
+		{
+			reportError(TempString("Object of class '{}' at id '{}' was already defined", classType, id));
+		}
+		else
+		{
+			m_definedObjects[id] = ptr;
+		}
+	}
+
+	ptr->readText(*this);
+
+	outObject = ptr;
+	return true;
+}
+
+bool TextSerializationReaderJSON::readValueObject(ObjectPtr& outObject)
+{
+	if (m_valueConsumed)
+		return false;
+
+	skipWhitespaces();
+	if (m_pos < m_end && *m_pos == '{')
+		return readInlinedObject(outObject);
+
+	StringView txt;
+	if (!readValueText(txt))
+		return false;
+
+	if (txt == "null")
+	{
+		outObject = nullptr;
+		return true;
+	}
+	else if (txt.beginsWith("#ref(") && txt.endsWith(")"))
+	{
+		const auto idText = txt.subString(5, txt.length() - 6);
+
+		uint32_t id = 0;
+		if (!idText.match(id))
+		{
+			reportError(TempString("Invalid reference id '{}'", idText));
+			return false;
+		}
+
+		ObjectPtr ptr;
+		if (!m_definedObjects.find(id, ptr))
+		{
+			reportError(TempString("Object reference ID {} is not defined", id));
+			return false;
+		}
+
+		outObject = ptr;
+		return true;
+	}
+
+	reportError("Incomplete object definition");
+	return false;
+}
+
+bool TextSerializationReaderJSON::readValueResource(BaseReference& outRef)
+{
+	if (m_valueConsumed)
+		return false;
+
+	skipWhitespaces();
+	if (m_pos < m_end && *m_pos == '{')
+	{
+		ObjectPtr ptr;
+		if (!readInlinedObject(ptr))
+			return false;
+
+		outRef = BaseReference(rtti_cast<IResource>(ptr));
+		return true;
+	}
+
+	StringView txt;
+	if (!readValueText(txt))
+		return false;
+
+	if (txt.empty() || txt == "null")
+	{
+		outRef = BaseReference();
+		return true;
+	}
+
+	// external reference is written as "Class:{GUID}"
+	const auto separator = txt.findLastChar(':');
+	if (separator <= 0)
+	{
+		reportError("Incomplete resource definition");
+		return false;
+	}
+
+	const auto className = txt.leftPart(separator);
+	const auto guidText = txt.subString(separator + 1);
+
+	const auto resourceClass = RTTI::GetInstance().findClass(StringID(className));
+	if (!resourceClass)
+	{
+		reportError(TempString("Resource used unknown class '{}'", className));
+		return false;
+	}
+
+	if (!resourceClass->is<IResource>())
+	{
+		reportError(TempString("Object uses class '{}' that is not a resource class", className));
+		return false;
+	}
+
+	SerializationResourceKey key;
+	key.className = resourceClass->name();
+
+	if (!GUID::Parse(guidText.data(), guidText.length(), key.id))
+	{
+		reportError(TempString("Failed to parse ID for resource '{}' from '{}'", resourceClass, guidText));
+		return false;
+	}
+
+	auto promise = createResourcePromise(key);
+	if (!promise)
+	{
+		reportError(TempString("Failed to create promise for resource '{}' ID '{}'", resourceClass, key.id));
+		return false;
+	}
+
+	outRef = BaseReference(promise);
+	return true;
+}
+
+//--
+
+ResourcePromisePtr TextSerializationReaderJSON::createResourcePromise(const SerializationResourceKey& key)
+{
+	DEBUG_CHECK_RETURN_EX_V(key.className && key.id, "Invalid resource key", nullptr);
+
+	ResourcePromisePtr ptr;
+	if (m_resourcePromises.find(key, ptr))
+		return ptr;
+
+	ptr = ResourcePromise::CreateEmptyPromise(key);
+	DEBUG_CHECK_RETURN_EX_V(ptr, "Failed to create promise", nullptr);
+
+	if (m_context.resourcePromises)
+		m_context.resourcePromises->pushBack(ptr);
+	else
+		ptr->fulfill(nullptr); // never going to be fullfilled
+
+	m_resourcePromises[key] = ptr;
+	return ptr;
+}
+
+//--
+
+END_INFERNO_NAMESPACE();
@@ -0,0 +1,77 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "textSerializationReader.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+///---
+
+/// streaming reader for JSON text, values are pulled directly from the source text without building any intermediate document
+/// NOTE: strings without escapes are returned as views into the source text, the source text must outlive the reader
+class BM_CORE_OBJECT_API TextSerializationReaderJSON : public ITextSerializationReader
+{
+public:
+	TextSerializationReaderJSON(StringView txt, const ObjectLoadingContext& context, ITextErrorReporter& err);
+	~TextSerializationReaderJSON();
+
+	//--
+
+	virtual bool beingArray(uint32_t& outCount) override final;
+	virtual void endArray() override final;
+
+	virtual bool beingArrayElement() override final;
+	virtual void endArrayElement() override final;
+
+	virtual bool beginStruct() override final;
+	virtual void endStruct() override final;
+
+	virtual bool beginStructElement(StringView& outName) override final;
+	virtual void endStructElement() override final;
+
+	virtual bool readValueText(StringView& outValue) override final;
+	virtual bool readValueBytes(Buffer& outData) override final;
+	virtual bool readValueObject(ObjectPtr& outObject) override final;
+	virtual bool readValueResource(BaseReference& outRef) override final;
+
+	virtual void reportError(StringView txt) override final;
+
+	//--
+
+private:
+	const char* m_start = nullptr;
+	const char* m_pos = nullptr;
+	const char* m_end = nullptr;
+
+	bool m_valueConsumed = false; // value at current position was already read (or skipped)
+
+	const ObjectLoadingContext& m_context;
+	ITextErrorReporter& m_err;
+
+	Array<StringBuf> m_unescapedStrings; // storage for strings that had escape sequences in them
+	HashMap<uint32_t, ObjectPtr> m_definedObjects;
+	HashMap<SerializationResourceKey, ResourcePromisePtr> m_resourcePromises;
+
+	void skipWhitespaces();
+	void skipSeparators();
+	void skipValue();
+	void skipBlock();
+
+	bool parseString(StringView& outText);
+	bool parseToken(StringView& outText, bool memberName);
+	bool parseScalar(StringView& outText);
+	bool parseMemberName(StringView& outName);
+
+	bool readInlinedObject(ObjectPtr& outObject);
+
+	ResourcePromisePtr createResourcePromise(const SerializationResourceKey& key);
+};
+
+///---
+
+END_INFERNO_NAMESPACE()
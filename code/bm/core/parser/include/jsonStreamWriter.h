@@ -0,0 +1,96 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "bm/core/containers/include/inplaceArray.h"
+#include "bm/core/containers/include/uniquePtr.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+// Forward-only JSON writer, the content is printed directly to the output as the values are added
+// Produces the same text as JSONWriter::printToText but only the stack of opened objects/arrays is kept in memory
+// NOTE: the key is only used when writing inside an object
+class BM_CORE_PARSER_API JSONStreamWriter : public MainPoolData<NoCopy>
+{
+public:
+	JSONStreamWriter(IFormatStream& f, PrintFlags flags = PrintFlags());
+	JSONStreamWriter(IFileWriter* file, PrintFlags flags = PrintFlags());
+	~JSONStreamWriter(); // closes all opened objects and arrays
+
+	//--
+
+	// number of currently opened objects and arrays
+	INLINE uint32_t depth() const { return m_stack.size(); }
+
+	//--
+
+	// open new object ("Compound")
+	void beginObject(StringView key = StringView());
+
+	// open new array
+	void beginArray(StringView key = StringView());
+
+	// close current object or array
+	void end();
+
+	// write a text value
+	void value(StringView key, StringView text);
+
+	// write a text value into an array
+	INLINE void value(StringView text) { value(StringView(), text); }
+
+	// write a whole binary value as base64
+	void data(StringView key, BufferView data);
+
+	//--
+
+	// start a binary value that will be written in pieces
+	void beginData(StringView key = StringView());
+
+	// write piece of the binary value
+	void appendData(BufferView data);
+
+	// finish the binary value
+	void endData();
+
+	//--
+
+	// close all opened objects and arrays and flush the output
+	void finish();
+
+	//--
+
+private:
+	IFormatStream* m_stream = nullptr;
+	UniquePtr<TextFileWriter> m_fileWriter;
+
+	bool m_prettyText = false;
+	bool m_relaxed = false;
+	bool m_inData = false;
+
+	struct Level
+	{
+		bool object = false;
+		bool needsSeparator = false;
+	};
+
+	InplaceArray<Level, 32> m_stack;
+
+	uint8_t m_dataCarry[3]; // base64 encoding of data written in pieces
+	uint8_t m_dataCarrySize = 0;
+
+	void init(PrintFlags flags);
+	void beginElement(StringView key);
+	void endElement();
+	void newLine();
+};
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -94,6 +94,9 @@ public:
 	// write document to file in text format
 	static void SaveToTextFile(const JSONWriter* ptr, NodeHandle node, IFileWriter* writer, PrintFlags flags = PrintFlags());
 
+	// print text as JSON string (quoted and escaped if needed) the same way the values are printed
+	static void PrintText(IFormatStream& f, StringView txt, bool relaxed);
+
 	//---
 
 private:
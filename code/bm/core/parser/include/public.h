@@ -33,6 +33,7 @@ enum class TextTokenType : uint8_t
 
 class Token;
 class TokenList;
+struct FlatToken;
 
 class ITextCommentEater;
 class ITextLanguageDefinition;
@@ -41,6 +42,8 @@ class ITextErrorReporter;
 class SimpleLanguageDefinitionBuilder;
 
 class TextParser;
+class TextFileWriter;
+class TextIncludeCache;
 class TextTokenLocation;
 class TextTokenWalker;
 
@@ -99,6 +102,12 @@ typedef RefPtr<XMLReader> XMLReaderPtr;
 class XMLWriter;
 typedef RefPtr<XMLWriter> XMLWriterPtr;
 
+// streaming XML reader
+class XMLStreamReader;
+
+// streaming XML writer
+class XMLStreamWriter;
+
 // XML header string
 static const inline StringView XML_HEADER_TEXT = "<?xml version=\"1.0\" standalone=\"yes\"?>";
 
@@ -120,6 +129,9 @@ typedef RefPtr<JSONReader> JSONReaderPtr;
 class JSONWriter;
 typedef RefPtr<JSONWriter> JSONWriterPtr;
 
+// streaming JSON writer
+class JSONStreamWriter;
+
 //------
 
 enum class PrintFlagBit : uint8_t
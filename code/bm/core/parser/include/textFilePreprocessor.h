@@ -10,6 +10,7 @@
 
 #include "textToken.h"
 #include "textLanguageDefinition.h"
+#include "textIncludeCache.h"
 
 #include "bm/core/memory/include/localAllocator.h"
 #include "bm/core/containers/include/hashMap.h"
@@ -20,12 +21,31 @@ BEGIN_INFERNO_NAMESPACE()
 
 ///----
 
+class TextFilePreprocessor;
+
+/// single file to preprocess as part of a batch, see TextFilePreprocessor::ProcessMany
+struct BM_CORE_PARSER_API TextFilePreprocessorJob : public NoCopy
+{
+    StringView m_content; // text to process, must be alive until the job is done with
+    StringBuf m_contextPath; // path of the file
+    HashMap<StringBuf, StringBuf> m_defines; // symbols to define before processing (ie. shader permutation)
+
+    //--
+
+    LocalAllocator m_allocator; // memory for the tokens
+    UniquePtr<TextFilePreprocessor> m_preprocessor; // preprocessor that processed the file, owns the final tokens
+    bool m_valid = false; // processing succeeded
+};
+
+///----
+
 // helper class for "C style" processing text
 // optionally can eat the comments as well
+// NOTE: single preprocessor is not thread safe but many of them can run in parallel (as long as the include handler and error reporter are thread safe)
 class BM_CORE_PARSER_API TextFilePreprocessor : public MainPoolData<NoCopy>
 {
 public:
-    TextFilePreprocessor(LocalAllocator& mem, ITextIncludeHandler& includeHandler, ITextErrorReporter& errorHandler, ITextCommentEater& commentEater, const ITextLanguageDefinition& parentLanguage);
+    TextFilePreprocessor(LocalAllocator& mem, ITextIncludeHandler& includeHandler, ITextErrorReporter& errorHandler, ITextCommentEater& commentEater, const ITextLanguageDefinition& parentLanguage, TextIncludeCache* includeCache = nullptr);
     ~TextFilePreprocessor();
 
     //--
@@ -41,6 +61,15 @@ public:
     /// process provided text content
     bool processContent(StringView content, StringView contextPath);
 
+    //--
+
+    /// tokenize file content (including the preprocessor directives) without doing any preprocessing
+    static bool TokenizeContent(StringView content, StringView contextPath, const ITextLanguageDefinition& parentLanguage, ITextCommentEater& commentEater, ITextErrorReporter& errorHandler, Array<FlatToken>& outTokens);
+
+    /// preprocess many files in parallel on the task system, returns true if all files were processed successfully
+    /// NOTE: include handler and error reporter must be thread safe, sharing an include cache is recommended
+    static bool ProcessMany(ArrayView<TextFilePreprocessorJob*> jobs, ITextIncludeHandler& includeHandler, ITextErrorReporter& errorHandler, ITextCommentEater& commentEater, const ITextLanguageDefinition& parentLanguage, TextIncludeCache* includeCache = nullptr);
+
 protected:
     LocalAllocator& m_allocator;
 
@@ -50,7 +79,11 @@ protected:
 
     const ITextLanguageDefinition& m_parentLanguage;
 
+    TextIncludeCache* m_includeCache = nullptr;
+
     bool processFileContent(StringView content, StringView contextPath, TokenList& outTokenList);
+    bool processTokens(TokenList& tokens);
+    bool processCachedInclude(const Token* head, const TextIncludeCacheEntryPtr& entry);
 
     bool processPreprocessorDeclaration(TokenList& line, bool& keepProcessing);
     bool processDefine(const Token* head, TokenList& line);
@@ -65,11 +98,12 @@ protected:
     bool processError(const Token* head, TokenList& line);
     bool processMessage(const Token* head, TokenList& line);
 
-    bool extractArgumentList(TokenList& line, Array<StringBuf>& outArguments) const;
+    bool extractArgumentList(TokenList& line, Array<StringView>& outArguments) const;
 
     HashSet<StringBuf> m_pragmaOnceFilePaths;
     Array<StringBuf> m_currentIncludeStack;
     Array<Buffer> m_loadedIncludeBuffers;
+    Array<TextIncludeCacheEntryPtr> m_usedCachedIncludes;
 
     TokenList m_finalTokens;
 
@@ -77,23 +111,28 @@ protected:
 
     struct MacroDefinition
     {
+        uint32_t m_id = 0; // interned ID of the name, index in the m_defineList
         StringBuf m_name;
         TextTokenLocation m_definedAt;
-        Array<StringBuf> m_arguments;
+        Array<StringView> m_arguments;
         Array<StringBuf> m_values;
         TokenList m_replacement;
+        Array<short> m_replacementArguments; // index of the argument each of the replacement tokens refers to, -1 for normal tokens
         bool m_hasArguments = false;
+        bool m_hasOperators = false; // replacement uses # or ##, needs the full expansion
+        bool m_hasIdentifiers = false; // replacement has identifiers that may expand further
         bool m_defined = false;
     };
 
-    HashMap<StringBuf, MacroDefinition*> m_defineMap;
+    HashMap<StringView, uint32_t> m_defineIds; // interned macro names, key points to the name in the MacroDefinition
     Array<MacroDefinition*> m_defineList;
+    uint64_t m_defineFirstChars[2] = { 0, 0 }; // first chars of all macro names, rejects most identifiers without a hash lookup
 
     //--
 
     struct MacroArgument
     {
-        StringBuf m_name;
+        StringView m_name;
         TokenList m_tokens;
     };
 
@@ -110,6 +149,7 @@ protected:
 
     bool expandAllPossibleMacros(TokenList& list, TokenList& outputList, bool fromParamsOnly=false);
     bool expandMacro(const MacroPlacement& macro, TokenList& outputList);
+    bool expandSimpleMacro(const MacroPlacement& macro, TokenList& outputList);
     bool evaluateExpression(TokenList& list, bool& result);
 
     bool extractReplacementListForArgument(const Token* start, TokenList& list, TokenList& outputList, bool& outEnd);
@@ -139,10 +179,13 @@ protected:
 
     MacroDefinition* define(StringView name) const;
     MacroDefinition* createDefine(StringView name);
+    bool isDefined(StringView name) const;
+    void analyzeReplacement(MacroDefinition* macro) const;
 
     Token* copyToken(const Token* source, const Token* baseLocataion = nullptr);
     void copyTokens(const TokenList& list, TokenList& outList, const Token* baseLocataion = nullptr, bool isMacroArgument = false);
     bool createTokens(const Token* baseLocataion, StringView text, TokenList& outList);
+    void instantiateTokens(const StringBuf& contextPath, ArrayView<FlatToken> tokens, TokenList& outList);
 
     //--
 };
@@ -0,0 +1,87 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [#filter: parser #]
+***/
+
+#pragma once
+
+#include "textToken.h"
+#include "textLanguageDefinition.h"
+
+#include "bm/core/containers/include/hashMap.h"
+#include "bm/core/system/include/mutex.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+///----
+
+/// pre-tokenized content of an included file
+/// NOTE: entry is immutable once created so it can be freely shared between preprocessors running on different threads
+class BM_CORE_PARSER_API TextIncludeCacheEntry : public IReferencable
+{
+public:
+    StringBuf m_path; // resolved path of the file, used as the context name for tokens
+    Buffer m_content; // file content, keeps the token text alive
+    uint64_t m_contentHash = 0;
+    Array<FlatToken> m_tokens; // all tokens in the file, no preprocessing done
+
+    StringBuf m_guardMacro; // name of the macro used in the include guard (#ifndef X/#define X ... #endif around whole file), empty if none
+    bool m_pragmaOnce = false; // file contains the #pragma once
+};
+
+typedef RefPtr<TextIncludeCacheEntry> TextIncludeCacheEntryPtr;
+
+///----
+
+/// shared cache of tokenized include files, allows many preprocessors to skip the tokenization of files that were already seen
+/// there's one entry per path, it's replaced when the content hash changes so files changed on disk are tokenized again without growing the cache
+/// NOTE: cache is bound to the language and comment handling it was created with, it's thread safe
+class BM_CORE_PARSER_API TextIncludeCache : public MainPoolData<NoCopy>
+{
+public:
+    TextIncludeCache(const ITextLanguageDefinition& language, ITextCommentEater& commentEater);
+    ~TextIncludeCache();
+
+    //--
+
+    /// language the files are tokenized with
+    INLINE const ITextLanguageDefinition& language() const { return m_language; }
+
+    /// comment handling the files are tokenized with
+    INLINE ITextCommentEater& commentEater() const { return m_commentEater; }
+
+    /// number of times the tokenized file was reused
+    INLINE uint32_t numHits() const { return m_numHits.load(); }
+
+    /// number of times the file had to be tokenized
+    INLINE uint32_t numMisses() const { return m_numMisses.load(); }
+
+    /// number of cached files
+    uint32_t numEntries() const;
+
+    //--
+
+    /// get the tokenized content of the file, tokenizes it if not cached yet
+    /// NOTE: returns null if content could not be tokenized, errors are reported to the given reporter
+    TextIncludeCacheEntryPtr findOrCreate(StringView path, const Buffer& content, ITextErrorReporter& errorReporter);
+
+    /// remove all cached entries, entries still used by preprocessors are kept alive by them
+    void clear();
+
+private:
+    const ITextLanguageDefinition& m_language;
+    ITextCommentEater& m_commentEater;
+
+    mutable Mutex m_lock;
+    HashMap<StringBuf, TextIncludeCacheEntryPtr> m_entries; // path -> latest tokenized content
+
+    std::atomic<uint32_t> m_numHits = 0;
+    std::atomic<uint32_t> m_numMisses = 0;
+};
+
+///----
+
+END_INFERNO_NAMESPACE()
@@ -51,6 +51,10 @@ public:
     /// look at the stream of chars and decide what it is, if nothing is found return false, if something is found it should return true
     /// NOTE: we always try to eat the longest sequence, so for example += will be parser preferably to just +, etc
     virtual bool eatToken(const char*& str, const char* endStr, Token& outToken) const = 0;
+
+    /// same as eatToken() but outputs the compact token used by the bulk tokenization, only the type, text and keyword ID are filled
+    /// NOTE: default implementation goes through the full Token, languages should override it if they can do better
+    virtual bool eatFlatToken(const char*& str, const char* endStr, FlatToken& outToken) const;
 };
 
 ///---
@@ -140,6 +140,11 @@ public:
     // parse a general token using a language definition, will capture strings and numbers as well
     Token parseToken(const ITextLanguageDefinition& language);
 
+    // tokenize all of the remaining content into a flat array of compact tokens, much faster than calling parseToken() in a loop
+    // NOTE: tokens are appended to the array and reference the parsed text directly
+    // NOTE: parsing stops at first content that can't be tokenized, an error is reported and false is returned
+    bool parseTokens(const ITextLanguageDefinition& language, Array<FlatToken>& outTokens);
+
     //--
 
     // push state onto the stack, allows for speculative parsing
@@ -195,6 +195,36 @@ public:
 
 ///----
 
+/// compact token produced by the bulk tokenization (TextParser::parseTokens), meant to be stored by value in a flat array
+/// NOTE: the token text is NOT copied, the parsed buffer must outlive the tokens
+struct BM_CORE_PARSER_API FlatToken
+{
+    const char* m_str = nullptr; // start of token text
+    uint32_t m_length = 0; // length of token text
+    uint32_t m_line = 0; // line index in the file
+    uint32_t m_charPos = 0; // char position in the line
+    short m_keywordID = -1; // keyword ID (as registered previously in the parser)
+    TextTokenType m_type = TextTokenType::Invalid;
+
+    //--
+
+    /// is this a valid token ?
+    INLINE bool valid() const { return m_type != TextTokenType::Invalid; }
+
+    /// get the string view
+    INLINE StringView view() const { return StringView(m_str, m_length); }
+
+    /// get the single character (usually used for the Char tokens)
+    INLINE char ch() const { return (m_type == TextTokenType::Char && m_length) ? *m_str : 0; }
+
+    //--
+
+    /// convert to a full token with a location, allows to use the numerical conversions, etc
+    Token token(const StringBuf& contextName = StringBuf()) const;
+};
+
+///----
+
 /// list of tokens
 class BM_CORE_PARSER_API TokenList
 {
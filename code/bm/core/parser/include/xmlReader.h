@@ -43,7 +43,7 @@ public:
     // get node value as text
     StringView nodeValueText(NodeHandle id) const;
 
-    // decode node's value as base64 buffer
+    // decode node's value as base64 buffer, for binary XML the raw data is returned without copying
     Buffer nodeValueBuffer(NodeHandle id, IPoolUnmanaged* pool = nullptr) const;
 
     //---
@@ -115,12 +115,20 @@ private:
     void* m_doc = nullptr;; // rapidXML document
 	void* m_root = nullptr; // rapidXML root
 
+	const void* m_binary = nullptr; // binary XML header, the document is used directly from the data buffer
+
 	Array<uint32_t> m_sourceLineStarts; // starting positions of each line, sorted
     StringBuf m_sourceContext; // source file name or other context, needed mostly for debug
 
 	//--
 
 	static void SaveToTextFileNode(const void* node, IFormatStream& f, uint32_t depth, bool prettyText);
+
+	// parse zero terminated text in place, the buffer is kept alive by the document
+	static XMLReaderPtr ParseText(ITextErrorReporter& err, StringView contextName, Buffer data, IPoolUnmanaged& pool);
+
+	// validate binary XML and use it in place, the buffer is kept alive by the document
+	static XMLReaderPtr LoadBinary(ITextErrorReporter& err, StringView contextName, Buffer data, IPoolUnmanaged& pool);
 };
 
 //--
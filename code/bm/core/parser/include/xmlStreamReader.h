@@ -0,0 +1,126 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "bm/core/containers/include/stringBuf.h"
+#include "bm/core/containers/include/array.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+// event produced by the streaming XML reader
+enum class XMLStreamEvent : uint8_t
+{
+	StartElement, // element was opened, name() is valid
+	Attribute, // attribute of the last opened element, name() and value() are valid
+	Text, // text (or CDATA) content of current element, value() is valid
+	EndElement, // element was closed (also for the self-closing elements), name() is valid
+	EndOfDocument, // no more data
+	Error, // parsing failed, error was reported
+};
+
+// forward-only pull reader for XML text, reads the data incrementally in chunks without building any document
+// memory use is bounded by the chunk size, the longest single token and the nesting depth, not by the document size
+// NOTE: the name() and value() are valid only until next call to next()
+class BM_CORE_PARSER_API XMLStreamReader : public MainPoolData<NoCopy>
+{
+public:
+	// read from file, the data is read sequentially in chunks of given size
+	XMLStreamReader(ITextErrorReporter& err, StringView contextName, IFileReader* file, uint32_t chunkSize = DEFAULT_CHUNK_SIZE);
+
+	// read directly from memory buffer, no copy is made
+	XMLStreamReader(ITextErrorReporter& err, StringView contextName, Buffer data);
+
+	~XMLStreamReader();
+
+	//--
+
+	static const uint32_t DEFAULT_CHUNK_SIZE = 64 << 10;
+
+	//--
+
+	// name of the element or attribute
+	INLINE StringView name() const { return m_name; }
+
+	// value of the attribute or text, entities are already decoded
+	INLINE StringView value() const { return m_value; }
+
+	// number of currently opened elements (including the one that was just opened)
+	INLINE uint32_t depth() const { return m_stack.size(); }
+
+	// line number in the source text
+	INLINE uint32_t line() const { return m_line; }
+
+	//--
+
+	// read next event from the stream
+	XMLStreamEvent next();
+
+	// skip all events until the current element is closed (ie. after StartElement or Attribute)
+	bool skipElement();
+
+	//--
+
+private:
+	ITextErrorReporter& m_err;
+	StringBuf m_contextName;
+
+	FileViewPtr m_file; // source when reading from file
+	Buffer m_data; // source when reading from memory, kept alive
+
+	Array<char> m_window; // chunk of the file data we are currently parsing
+	const char* m_pos = nullptr;
+	const char* m_end = nullptr;
+	bool m_eof = false;
+	bool m_started = false;
+	bool m_failed = false;
+
+	uint32_t m_line = 1;
+
+	enum class State : uint8_t
+	{
+		Content, // between tags
+		Tag, // inside the start tag, attributes are returned
+		Done, // end of document or error
+	};
+
+	State m_state = State::Content;
+
+	Array<uint32_t> m_stack; // offsets of the names of opened elements in m_stackNames
+	Array<char> m_stackNames;
+
+	Array<char> m_scratch; // decoded values
+	Array<char> m_nameScratch; // name of the attribute or closed element
+	StringView m_name;
+	StringView m_value;
+
+	//--
+
+	bool refill();
+	bool ensure(uint32_t count);
+	bool find(StringView pattern, uint32_t& outOffset);
+	uint32_t scanName();
+	void skipWhiteSpaces();
+	void consume(uint32_t count);
+
+	StringView decode(const char* str, uint32_t length);
+
+	XMLStreamEvent nextInContent();
+	XMLStreamEvent nextInTag();
+
+	XMLStreamEvent openElement(uint32_t nameLength);
+	XMLStreamEvent closeElement(StringView name);
+
+	StringView copyName(const char* str, uint32_t length);
+
+	XMLStreamEvent reportError(StringView txt);
+};
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -0,0 +1,78 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "bm/core/containers/include/array.h"
+#include "bm/core/containers/include/uniquePtr.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+// Forward-only XML writer, the content is printed directly to the output as the nodes are created
+// Produces the same text as XMLWriter::printToText but nothing except the names of the opened nodes is kept in memory
+class BM_CORE_PARSER_API XMLStreamWriter : public MainPoolData<NoCopy>
+{
+public:
+	XMLStreamWriter(IFormatStream& f, PrintFlags flags = PrintFlags());
+	XMLStreamWriter(IFileWriter* file, PrintFlags flags = PrintFlags());
+	~XMLStreamWriter(); // closes all opened nodes
+
+	//--
+
+	// number of currently opened nodes
+	INLINE uint32_t depth() const { return m_stack.size(); }
+
+	//--
+
+	// open new node, it becomes the current one
+	void beginNode(StringView name);
+
+	// add attribute to current node, must be done before any content is written
+	void attribute(StringView name, StringView value);
+
+	// write text content of current node
+	void text(StringView value);
+
+	// write binary content of current node as base64, can be called multiple times to write large data in pieces
+	void appendData(BufferView data);
+
+	// close current node
+	void endNode();
+
+	// close all opened nodes and flush the output
+	void finish();
+
+	//--
+
+private:
+	IFormatStream* m_stream = nullptr;
+	UniquePtr<TextFileWriter> m_fileWriter;
+
+	bool m_prettyText = false;
+	bool m_tagOpen = false; // start tag of the current node was not yet closed with '>'
+
+	struct Level
+	{
+		uint32_t nameOffset = 0;
+		uint32_t nameLength = 0;
+		bool hasChildren = false;
+	};
+
+	Array<Level> m_stack;
+	Array<char> m_stackNames;
+
+	uint8_t m_dataCarry[3]; // base64 encoding of data written in pieces
+	uint8_t m_dataCarrySize = 0;
+
+	void init(PrintFlags flags);
+	void closeStartTag();
+};
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -112,6 +112,10 @@ public:
 	// save text to buffer
 	Buffer printToBuffer(NodeHandle id, PrintFlags flags = PrintFlags(), IPoolUnmanaged& pool = MainPool()) const;
 
+	// save node (and all it's children) in the binary XML format, names are interned and data values are stored raw
+	// NOTE: the result can be loaded with XMLReader::LoadFromBuffer and used directly without parsing
+	Buffer saveToBinaryBuffer(NodeHandle id, IPoolUnmanaged& pool = MainPool()) const;
+
 	//---
 
 	// create empty document
@@ -125,6 +129,9 @@ public:
 	// write document to file in text format
 	static void SaveToTextFile(const XMLWriter* ptr, NodeHandle node, IFileWriter* writer, PrintFlags flags = PrintFlags());
 
+	// print text escaped the same way node values and attributes are printed
+	static void PrintText(IFormatStream& f, StringView txt);
+
 	//---
 
 private:
@@ -0,0 +1,59 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+BEGIN_INFERNO_NAMESPACE()
+
+namespace prv
+{
+	//--
+
+	// incremental BASE64 encoding, data can be provided in pieces of any size
+	// whole 3 byte groups are encoded directly into the output, only the leftover bytes are carried between calls
+	INLINE void AppendBase64(IFormatStream& f, BufferView data, uint8_t* carry, uint8_t& carrySize)
+	{
+		const auto* ptr = data.data();
+		const auto* end = ptr + data.size();
+
+		if (carrySize)
+		{
+			while (carrySize < 3 && ptr < end)
+				carry[carrySize++] = *ptr++;
+
+			if (carrySize < 3)
+				return;
+
+			BufferView(carry, 3).encode(EncodingType::Base64, f);
+			carrySize = 0;
+		}
+
+		const auto fullSize = ((end - ptr) / 3) * 3;
+		if (fullSize)
+		{
+			BufferView(ptr, fullSize).encode(EncodingType::Base64, f);
+			ptr += fullSize;
+		}
+
+		while (ptr < end)
+			carry[carrySize++] = *ptr++;
+	}
+
+	// encode the leftover bytes (with padding)
+	INLINE void FinishBase64(IFormatStream& f, uint8_t* carry, uint8_t& carrySize)
+	{
+		if (carrySize)
+		{
+			BufferView(carry, carrySize).encode(EncodingType::Base64, f);
+			carrySize = 0;
+		}
+	}
+
+	//--
+
+} // prv
+
+END_INFERNO_NAMESPACE()
@@ -0,0 +1,177 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "jsonStreamWriter.h"
+#include "jsonWriter.h"
+#include "textFileWriter.h"
+#include "base64StreamEncoding.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+JSONStreamWriter::JSONStreamWriter(IFormatStream& f, PrintFlags flags /*= PrintFlags()*/)
+	: m_stream(&f)
+{
+	init(flags);
+}
+
+JSONStreamWriter::JSONStreamWriter(IFileWriter* file, PrintFlags flags /*= PrintFlags()*/)
+{
+	m_fileWriter = CreateUniquePtr<TextFileWriter>(file);
+	m_stream = m_fileWriter.get();
+	init(flags);
+}
+
+JSONStreamWriter::~JSONStreamWriter()
+{
+	finish();
+}
+
+void JSONStreamWriter::init(PrintFlags flags)
+{
+	m_prettyText = flags.test(PrintFlagBit::PrettyText);
+	m_relaxed = flags.test(PrintFlagBit::Relaxed);
+}
+
+//--
+
+void JSONStreamWriter::newLine()
+{
+	if (m_prettyText)
+	{
+		m_stream->append("\n");
+		m_stream->appendPadding(' ', m_stack.size() * 4);
+	}
+}
+
+void JSONStreamWriter::beginElement(StringView key)
+{
+	DEBUG_CHECK_EX(!m_inData, "Binary value was not finished");
+
+	if (m_stack.empty())
+		return;
+
+	auto& level = m_stack.back();
+	if (level.needsSeparator)
+	{
+		if (m_relaxed)
+			m_stream->append(" ");
+		else
+			m_stream->append(m_prettyText ? "," : ", ");
+	}
+
+	newLine();
+
+	if (level.object)
+	{
+		DEBUG_CHECK_EX(key, "Values in JSON object require a key");
+		JSONWriter::PrintText(*m_stream, key, m_relaxed);
+		m_stream->append(m_relaxed ? ":" : ": ");
+	}
+}
+
+void JSONStreamWriter::endElement()
+{
+	if (!m_stack.empty())
+		m_stack.back().needsSeparator = true;
+}
+
+//--
+
+void JSONStreamWriter::beginObject(StringView key)
+{
+	beginElement(key);
+	m_stream->append("{");
+	m_stack.emplaceBack().object = true;
+}
+
+void JSONStreamWriter::beginArray(StringView key)
+{
+	beginElement(key);
+	m_stream->append("[");
+	m_stack.emplaceBack().object = false;
+}
+
+void JSONStreamWriter::end()
+{
+	DEBUG_CHECK_RETURN_EX(!m_stack.empty(), "Nothing to close");
+
+	if (m_inData)
+		endData();
+
+	const auto object = m_stack.back().object;
+	m_stack.popBack();
+
+	newLine();
+	m_stream->append(object ? "}" : "]");
+
+	endElement();
+}
+
+void JSONStreamWriter::value(StringView key, StringView text)
+{
+	beginElement(key);
+	JSONWriter::PrintText(*m_stream, text, m_relaxed);
+	endElement();
+}
+
+void JSONStreamWriter::data(StringView key, BufferView data)
+{
+	beginData(key);
+	appendData(data);
+	endData();
+}
+
+//--
+
+void JSONStreamWriter::beginData(StringView key)
+{
+	beginElement(key);
+
+	if (!m_relaxed)
+		m_stream->append("\"");
+
+	m_inData = true;
+}
+
+void JSONStreamWriter::appendData(BufferView data)
+{
+	DEBUG_CHECK_RETURN_EX(m_inData, "Binary value not started");
+	prv::AppendBase64(*m_stream, data, m_dataCarry, m_dataCarrySize);
+}
+
+void JSONStreamWriter::endData()
+{
+	DEBUG_CHECK_RETURN_EX(m_inData, "Binary value not started");
+
+	prv::FinishBase64(*m_stream, m_dataCarry, m_dataCarrySize);
+
+	if (!m_relaxed)
+		m_stream->append("\"");
+
+	m_inData = false;
+	endElement();
+}
+
+//--
+
+void JSONStreamWriter::finish()
+{
+	if (m_inData)
+		endData();
+
+	while (!m_stack.empty())
+		end();
+
+	if (m_fileWriter)
+		m_fileWriter->flush();
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -233,6 +233,8 @@ static bool JSonNeedsQuotes(StringView view)
 		case '}':
 		case '\'':
 		case '`':
+		case ',':
+		case ':':
 			return true;
 
 		default:
@@ -264,18 +266,19 @@ static void WriteString(IFormatStream& f, StringView txt, bool relaxed)
 			f.append("\\\\");
 		else if (ch == '/')
 			f.append("\\/");
-		else if (ch == '\b')
-			f.append("\\b");
-		else if (ch == '\f')
-			f.append("\\f");
 		else if (ch == '\n')
 			f.append("\\n");
 		else if (ch == '\r')
 			f.append("\\r");
 		else if (ch == '\t')
 			f.append("\\t");
+		else if (ch > 0xFFFF)
+		{
+			const auto code = ch - 0x10000;
+			f.appendf("\\u{}\\u{}", PaddedHex<4, '0'>(0xD800 + (code >> 10)), PaddedHex<4, '0'>(0xDC00 + (code & 0x3FF)));
+		}
 		else if (ch < 32 || ch > 127)
-			f.appendf("\\{}", PaddedHex<4, '0'>(ch));
+			f.appendf("\\u{}", PaddedHex<4, '0'>(ch));
 		else
 		{
 			char str[2] = { ch, 0 };
@@ -287,6 +290,11 @@ static void WriteString(IFormatStream& f, StringView txt, bool relaxed)
 		f << "\"";
 }
 
+void JSONWriter::PrintText(IFormatStream& f, StringView txt, bool relaxed)
+{
+	WriteString(f, txt, relaxed);
+}
+
 void JSONWriter::MakeNewLine(IFormatStream& f, PrintState& state)
 {
 	if (state.prettyText)
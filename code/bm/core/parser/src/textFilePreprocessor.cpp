@@ -10,6 +10,8 @@
 #include "textFilePreprocessor.h"
 #include "textFilePreprocessorExpressionParser.h"
 
+#include "bm/core/task/include/taskUtils.h"
+
 //#define TRACE_DEEP(txt, ...) TRACE_INFO(txt, __VA_ARGS__)
 #define TRACE_DEEP(txt, ...) 
 
@@ -45,15 +47,41 @@ static UniquePtr<ITextLanguageDefinition> BuildPreprocessorLanguageDefinition()
     return langBuilder.buildLanguageDefinition();
 }
 
+// preprocessor directives take precedence over the parent language
+class PreprocessorChainedLanguageDefinition : public ITextLanguageDefinition
+{
+public:
+    PreprocessorChainedLanguageDefinition(const ITextLanguageDefinition& preprocessorLanguage, const ITextLanguageDefinition& parentLanguage)
+        : m_preprocessorLanguage(preprocessorLanguage)
+        , m_parentLanguage(parentLanguage)
+    {}
+
+    virtual bool eatToken(const char*& str, const char* endStr, Token& outToken) const override final
+    {
+        return m_preprocessorLanguage.eatToken(str, endStr, outToken) || m_parentLanguage.eatToken(str, endStr, outToken);
+    }
+
+    virtual bool eatFlatToken(const char*& str, const char* endStr, FlatToken& outToken) const override final
+    {
+        return m_preprocessorLanguage.eatFlatToken(str, endStr, outToken) || m_parentLanguage.eatFlatToken(str, endStr, outToken);
+    }
+
+private:
+    const ITextLanguageDefinition& m_preprocessorLanguage;
+    const ITextLanguageDefinition& m_parentLanguage;
+};
+
 //---
 
-TextFilePreprocessor::TextFilePreprocessor(LocalAllocator& allocator, ITextIncludeHandler& includeHandler, ITextErrorReporter& errorHandler, ITextCommentEater& commentEater, const ITextLanguageDefinition& parentLanguage)
+TextFilePreprocessor::TextFilePreprocessor(LocalAllocator& allocator, ITextIncludeHandler& includeHandler, ITextErrorReporter& errorHandler, ITextCommentEater& commentEater, const ITextLanguageDefinition& parentLanguage, TextIncludeCache* includeCache)
     : m_allocator(allocator)
     , m_includeHandler(includeHandler)
     , m_errorHandler(errorHandler)
     , m_commentEater(commentEater)
     , m_parentLanguage(parentLanguage)
+    , m_includeCache(includeCache)
 {
+    DEBUG_CHECK_EX(!includeCache || (&includeCache->language() == &parentLanguage && &includeCache->commentEater() == &commentEater), "Include cache was created for different language");
 }
 
 TextFilePreprocessor::~TextFilePreprocessor()
@@ -87,6 +115,7 @@ bool TextFilePreprocessor::defineSymbol(StringView name, StringView value)
     macro->m_arguments.clear();
     macro->m_replacement = std::move(replacements);
     macro->m_values.pushBack(valueStr);
+    analyzeReplacement(macro);
 
     //TRACE_INFO("Defined '{}' = '{}'", name, macro->m_replacement);
     return true;
@@ -150,43 +179,35 @@ bool TextFilePreprocessor::createTokens(const Token* baseLocataion, StringView t
     return true;
 }
 
-bool TextFilePreprocessor::processFileContent(StringView content, StringView contextPath, TokenList& outTokenList)
+bool TextFilePreprocessor::TokenizeContent(StringView content, StringView contextPath, const ITextLanguageDefinition& parentLanguage, ITextCommentEater& commentEater, ITextErrorReporter& errorHandler, Array<FlatToken>& outTokens)
 {
     static auto lang  = BuildPreprocessorLanguageDefinition();
+    const PreprocessorChainedLanguageDefinition chainedLanguage(*lang, parentLanguage);
 
-    TextParser parser(contextPath, m_errorHandler, m_commentEater);
+    TextParser parser(contextPath, errorHandler, commentEater);
     parser.reset(content);
 
-    while (parser.findNextContent())
-    {
-        auto token  = parser.parseToken(m_allocator, *lang);
-        if (!token)
-            token = parser.parseToken(m_allocator, m_parentLanguage);
-
-        if (token)
-        {
-            outTokenList.pushBack(token);
-        }
-        else
-        {
-            TextTokenLocation location(parser.contextName(), parser.line(), 0);
-
-            auto lookAhead = parser.view().leftPart(20).trim()
-                .beforeFirst(" ", StringCaseComparisonMode::WithCase, StringFindFallbackMode::Full)
-                .beforeFirst("\n", StringCaseComparisonMode::WithCase, StringFindFallbackMode::Full)
-                .beforeFirst("\r", StringCaseComparisonMode::WithCase, StringFindFallbackMode::Full)
-                .beforeFirst("\t", StringCaseComparisonMode::WithCase, StringFindFallbackMode::Full);
-
-            if (outTokenList.empty())
-                m_errorHandler.reportError(location, TempString("Unable to parse text at this location: '{}'", lookAhead));
-            else
-                m_errorHandler.reportError(location, TempString("Unable to parse text at this location: '{}', last valid token: '{}'", lookAhead, *outTokenList.tail()));
+    return parser.parseTokens(chainedLanguage, outTokens) && !parser.hasErrors();
+}
 
-            return false;
-        }
+void TextFilePreprocessor::instantiateTokens(const StringBuf& contextPath, ArrayView<FlatToken> tokens, TokenList& outList)
+{
+    for (const auto& flat : tokens)
+    {
+        auto token = m_allocator.createWithoutDestruction<Token>(flat.m_type, flat.m_str, flat.m_str + flat.m_length, flat.m_keywordID);
+        token->assignLocation(TextTokenLocation(contextPath, flat.m_line, flat.m_charPos));
+        outList.pushBack(token);
     }
+}
+
+bool TextFilePreprocessor::processFileContent(StringView content, StringView contextPath, TokenList& outTokenList)
+{
+    Array<FlatToken> tokens;
+    if (!TokenizeContent(content, contextPath, m_parentLanguage, m_commentEater, m_errorHandler, tokens))
+        return false;
 
-    return !parser.hasErrors();
+    instantiateTokens(StringBuf(contextPath), tokens, outTokenList);
+    return true;
 }
 
 static bool HasArgumentList(const Token* identToken, const Token* nextToken)
@@ -200,7 +221,7 @@ static bool HasArgumentList(const Token* identToken, const Token* nextToken)
     return expectedEnd == nextCharPos;
 }
 
-bool TextFilePreprocessor::extractArgumentList(TokenList& line, Array<StringBuf>& outArguments) const
+bool TextFilePreprocessor::extractArgumentList(TokenList& line, Array<StringView>& outArguments) const
 {
     if (line.empty())
         return true;
@@ -243,8 +264,8 @@ bool TextFilePreprocessor::extractArgumentList(TokenList& line, Array<StringBuf>
             return false;
         }
 
-        TRACE_DEEP("{}: macro has argument '{}'", start->location(), cur->string());
-        outArguments.pushBack(cur->string());
+        TRACE_DEEP("{}: macro has argument '{}'", start->location(), cur->view());
+        outArguments.pushBack(cur->view());
         eatSeparator = true;
     }
 
@@ -280,7 +301,7 @@ bool TextFilePreprocessor::processDefine(const Token* head, TokenList& line)
         return false;
     }
 
-    auto ident = identToken->string();
+    auto ident = identToken->view();
     auto macro  = createDefine(ident);
     if (!macro)
     {
@@ -298,6 +319,7 @@ bool TextFilePreprocessor::processDefine(const Token* head, TokenList& line)
     macro->m_arguments.clear();
     macro->m_replacement.clear();
     macro->m_hasArguments = false;
+    analyzeReplacement(macro);
 
     if (!line.empty())
     {
@@ -317,6 +339,7 @@ bool TextFilePreprocessor::processDefine(const Token* head, TokenList& line)
 
         // replacements
         macro->m_replacement = std::move(line);
+        analyzeReplacement(macro);
 
         if (GTracePreprocessor)
             m_errorHandler.reportWarning(head->location(), TempString("Macro '{}' defined as '{}'", ident, macro->m_replacement));
@@ -334,7 +357,7 @@ bool TextFilePreprocessor::processUndef(const Token* head, TokenList& line)
         return false;
     }
 
-    auto ident = identToken->string();
+    auto ident = identToken->view();
     auto macro  = define(ident);
     if (!macro)
     {
@@ -347,6 +370,7 @@ bool TextFilePreprocessor::processUndef(const Token* head, TokenList& line)
     macro->m_arguments.clear();
     macro->m_replacement.clear();
     macro->m_hasArguments = false;
+    analyzeReplacement(macro);
     return true;
 }
 
@@ -395,6 +419,16 @@ bool TextFilePreprocessor::processInclude(const Token* head, TokenList& line)
             return false;
         }
 
+        // use the pre-tokenized content if we have it
+        if (m_includeCache && loadedContent)
+        {
+            auto entry = m_includeCache->findOrCreate(loadedContentContextPath, loadedContent, m_errorHandler);
+            if (!entry)
+                return false;
+
+            return processCachedInclude(head, entry);
+        }
+
         m_currentIncludeStack.pushBack(loadedContentContextPath);
 
         StringView includedContent;
@@ -421,6 +455,39 @@ bool TextFilePreprocessor::processInclude(const Token* head, TokenList& line)
     return true;
 }
 
+bool TextFilePreprocessor::processCachedInclude(const Token* head, const TextIncludeCacheEntryPtr& entryPtr)
+{
+    const auto& entry = *entryPtr;
+
+    // whole file is guarded by a macro that is already defined, nothing would be emitted
+    if (entry.m_guardMacro)
+    {
+        const auto* guard = define(entry.m_guardMacro);
+        if (guard && guard->m_defined)
+        {
+            TRACE_DEEP("{}: skipped include of '{}' guarded by '{}'", head->location(), entry.m_path, entry.m_guardMacro);
+            return true;
+        }
+    }
+
+    // file with the #pragma once that was already included
+    if (entry.m_pragmaOnce && m_pragmaOnceFilePaths.contains(entry.m_path))
+    {
+        TRACE_DEEP("{}: skipped include of '{}' that was already processed", head->location(), entry.m_path);
+        return true;
+    }
+
+    m_usedCachedIncludes.pushBack(entryPtr);
+    m_currentIncludeStack.pushBack(entry.m_path);
+
+    TokenList tokens;
+    instantiateTokens(entry.m_path, entry.m_tokens, tokens);
+
+    const auto valid = processTokens(tokens);
+    m_currentIncludeStack.popBack();
+    return valid;
+}
+
 bool TextFilePreprocessor::processIf(const Token* head, TokenList& line)
 {
     if (!evalFilterFlag())
@@ -481,9 +548,8 @@ bool TextFilePreprocessor::processIfdef(const Token* head, TokenList& line, bool
         return false;
     }
 
-    auto ident = identToken->string();
-    auto macro  = define(ident);
-    auto valid = macro && macro->m_defined;
+    auto ident = identToken->view();
+    auto valid = isDefined(ident);
 
     if (GTracePreprocessor)
     {
@@ -708,12 +774,17 @@ bool TextFilePreprocessor::processPreprocessorDeclaration(TokenList& line, bool&
 
 bool TextFilePreprocessor::processContent(StringView content, StringView contextPath)
 {
-    bool status = true;
-
     TokenList tokens;
     if (!processFileContent(content, contextPath, tokens))
         return false;
 
+    return processTokens(tokens);
+}
+
+bool TextFilePreprocessor::processTokens(TokenList& tokens)
+{
+    bool status = true;
+
     bool keepProcessing = true;
     while (tokens.head() && keepProcessing)
     {
@@ -764,26 +835,102 @@ bool TextFilePreprocessor::processContent(StringView content, StringView context
     return status;
 }
 
+bool TextFilePreprocessor::ProcessMany(ArrayView<TextFilePreprocessorJob*> jobs, ITextIncludeHandler& includeHandler, ITextErrorReporter& errorHandler, ITextCommentEater& commentEater, const ITextLanguageDefinition& parentLanguage, TextIncludeCache* includeCache)
+{
+    std::atomic<uint32_t> numFailedJobs = 0;
+
+    // each job has its own preprocessor and memory, only the language definitions, include cache and handlers are shared
+    TaskParallelForEach(jobs.indexRange()) << [&](uint32_t index)
+    {
+        auto* job = jobs[index];
+        job->m_preprocessor = CreateUniquePtr<TextFilePreprocessor>(job->m_allocator, includeHandler, errorHandler, commentEater, parentLanguage, includeCache);
+
+        bool valid = true;
+        for (const auto& pair : job->m_defines.pairs())
+            valid &= job->m_preprocessor->defineSymbol(pair.key, pair.value);
+
+        job->m_valid = valid && job->m_preprocessor->processContent(job->m_content, job->m_contextPath);
+        if (!job->m_valid)
+            ++numFailedJobs;
+    };
+
+    return numFailedJobs == 0;
+}
+
 //---
 
 TextFilePreprocessor::MacroDefinition* TextFilePreprocessor::define(StringView name) const
 {
-    MacroDefinition* ret = nullptr;
-    m_defineMap.find(name, ret);
-    return ret;
+    if (name.empty())
+        return nullptr;
+
+    // most of the identifiers are not macros, reject them without hashing
+    const auto firstChar = (uint8_t)name.data()[0];
+    if (firstChar >= 128 || !(m_defineFirstChars[firstChar / 64] & (1ULL << (firstChar % 64))))
+        return nullptr;
+
+    uint32_t id = 0;
+    if (!m_defineIds.find(name, id))
+        return nullptr;
+
+    return m_defineList[id];
+}
+
+bool TextFilePreprocessor::isDefined(StringView name) const
+{
+    const auto* macro = define(name);
+    return macro && macro->m_defined;
 }
 
 TextFilePreprocessor::MacroDefinition* TextFilePreprocessor::createDefine(StringView name)
 {
-    MacroDefinition* ret = nullptr;
-    if (!m_defineMap.find(name, ret))
+    if (auto* ret = define(name))
+        return ret;
+
+    auto* ret = m_allocator.createWithoutDestruction<MacroDefinition>();
+    ret->m_id = m_defineList.size();
+    ret->m_name = StringBuf(name);
+    m_defineIds[ret->m_name.view()] = ret->m_id;
+    m_defineList.pushBack(ret);
+
+    const auto firstChar = (uint8_t)name.data()[0];
+    if (firstChar < 128)
+        m_defineFirstChars[firstChar / 64] |= (1ULL << (firstChar % 64));
+
+    return ret;
+}
+
+void TextFilePreprocessor::analyzeReplacement(MacroDefinition* macro) const
+{
+    macro->m_replacementArguments.reset();
+    macro->m_hasOperators = false;
+    macro->m_hasIdentifiers = false;
+
+    for (const auto* token = macro->m_replacement.head(); token; token = token->next())
     {
-        ret = m_allocator.createWithoutDestruction<MacroDefinition>();
-        ret->m_name = StringBuf(name);
-        m_defineMap[ret->m_name] = ret;
-        m_defineList.pushBack(ret);
+        short argumentIndex = -1;
+
+        if (token->isIdentifier())
+        {
+            macro->m_hasIdentifiers = true;
+
+            const auto name = token->view();
+            for (uint32_t i = 0; i < macro->m_arguments.size(); ++i)
+            {
+                if (macro->m_arguments[i] == name)
+                {
+                    argumentIndex = (short)i;
+                    break;
+                }
+            }
+        }
+        else if (token->ch() == '#' || token->view() == "##")
+        {
+            macro->m_hasOperators = true;
+        }
+
+        macro->m_replacementArguments.pushBack(argumentIndex);
     }
-    return ret;
 }
 
 bool TextFilePreprocessor::evaluateExpression(TokenList& list, bool& result)
@@ -791,7 +938,7 @@ bool TextFilePreprocessor::evaluateExpression(TokenList& list, bool& result)
     DEBUG_CHECK_RETURN_EX_V(!list.empty(), "Empty token list", false);
 
     auto definedFunc = [this](StringView name) -> bool {
-        return m_defineMap.contains(name);
+        return isDefined(name);
     };
 
     TextFilePreprocessorExpressionContext parser(list, m_errorHandler, definedFunc);
@@ -952,7 +1099,7 @@ bool TextFilePreprocessor::expandAllPossibleMacros(TokenList& list, TokenList& o
                 return false;
             }
 
-            const char* text = m_defineMap.contains(ident->view()) ? "1" : "0";
+            const char* text = isDefined(ident->view()) ? "1" : "0";
 
             auto* token = m_allocator.createWithoutDestruction<Token>(TextTokenType::IntNumber, text, text+1, -1);
             outputList.pushBack(token);
@@ -1127,9 +1274,52 @@ bool TextFilePreprocessor::macroConcatenate(const MacroPlacement& macro, TokenLi
     return status;
 }
 
+bool TextFilePreprocessor::expandSimpleMacro(const MacroPlacement& macro, TokenList& outputList)
+{
+    const auto* def = macro.m_def;
+
+    // nothing in the replacement can expand further (ie. #define PI 3.14), instantiate it directly into the output
+    if (!def->m_hasArguments && !def->m_hasIdentifiers)
+    {
+        for (const auto* token = def->m_replacement.head(); token; token = token->next())
+            outputList.pushBack(copyToken(token, macro.m_placementRef));
+        return true;
+    }
+
+    // 0+2) Instantiate the replacement and substitute the parameters in one go using the argument indices computed when macro was defined
+    TokenList list;
+    uint32_t index = 0;
+    for (const auto* token = def->m_replacement.head(); token; token = token->next(), ++index)
+    {
+        const auto argumentIndex = def->m_replacementArguments[index];
+        if (argumentIndex >= 0 && argumentIndex < (int)macro.m_arguments.size())
+            copyTokens(macro.m_arguments[argumentIndex].m_tokens, list, macro.m_placementRef, true);
+        else
+            list.pushBack(copyToken(token, macro.m_placementRef));
+    }
+
+    bool status = true;
+
+    // 4) Tokens originating from parameters are expanded.
+    if (def->m_hasArguments)
+    {
+        TokenList expandedList;
+        status &= expandAllPossibleMacros(list, expandedList, true);
+        list = std::move(expandedList);
+    }
+
+    // 5) The resulting tokens are expanded as normal.
+    status &= expandAllPossibleMacros(list, outputList);
+    return status;
+}
+
 // https://en.wikipedia.org/wiki/C_preprocessor#Order_of_expansion
 bool TextFilePreprocessor::expandMacro(const MacroPlacement& macro, TokenList& outputList)
 {
+    // without the # and ## operators the stringification and concatenation phases are no-ops
+    if (!macro.m_def->m_hasOperators)
+        return expandSimpleMacro(macro, outputList);
+
     bool status = true;
 
     TRACE_DEEP("Expanding tokens for macro '{}'", macro.m_def->m_name);
@@ -0,0 +1,148 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: parser #]
+***/
+
+#include "build.h"
+#include "textIncludeCache.h"
+#include "textFilePreprocessor.h"
+
+#include "bm/core/containers/include/crc.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+static bool IsDirective(const FlatToken& token, StringView name)
+{
+    return token.m_type == TextTokenType::Preprocessor && token.view() == name;
+}
+
+static bool IsDirectiveWithIdent(ArrayView<FlatToken> tokens, uint32_t index, StringView name, StringView ident)
+{
+    if (index + 1 >= tokens.size() || !IsDirective(tokens[index], name))
+        return false;
+
+    const auto& identToken = tokens[index + 1];
+    return identToken.m_type == TextTokenType::Identifier && identToken.m_line == tokens[index].m_line && identToken.view() == ident;
+}
+
+static StringView DetectIncludeGuard(ArrayView<FlatToken> tokens)
+{
+    // #ifndef X
+    // #define X
+    // ...
+    // #endif
+    if (tokens.size() < 5 || !IsDirective(tokens[0], "#ifndef") || tokens[1].m_type != TextTokenType::Identifier)
+        return StringView();
+
+    const auto guard = tokens[1].view();
+    if (!IsDirectiveWithIdent(tokens, 2, "#define", guard) || !IsDirective(tokens[tokens.size() - 1], "#endif"))
+        return StringView();
+
+    // the final #endif must close the first #ifndef, no #else at the top level is allowed as it would emit content when guard is defined
+    int depth = 0;
+    for (uint32_t i = 0; i < tokens.size(); ++i)
+    {
+        const auto& token = tokens[i];
+        if (token.m_type != TextTokenType::Preprocessor)
+            continue;
+
+        const auto name = token.view();
+        if (name == "#if" || name == "#ifdef" || name == "#ifndef")
+        {
+            depth += 1;
+        }
+        else if (name == "#endif")
+        {
+            depth -= 1;
+            if (depth == 0 && i != tokens.size() - 1)
+                return StringView();
+        }
+        else if ((name == "#else" || name == "#elif") && depth == 1)
+        {
+            return StringView();
+        }
+    }
+
+    return (depth == 0) ? guard : StringView();
+}
+
+static bool DetectPragmaOnce(ArrayView<FlatToken> tokens)
+{
+    for (uint32_t i = 0; i + 1 < tokens.size(); ++i)
+        if (IsDirective(tokens[i], "#pragma") && tokens[i + 1].m_line == tokens[i].m_line && tokens[i + 1].view() == "once")
+            return true;
+
+    return false;
+}
+
+//--
+
+TextIncludeCache::TextIncludeCache(const ITextLanguageDefinition& language, ITextCommentEater& commentEater)
+    : m_language(language)
+    , m_commentEater(commentEater)
+{}
+
+TextIncludeCache::~TextIncludeCache()
+{}
+
+TextIncludeCacheEntryPtr TextIncludeCache::findOrCreate(StringView path, const Buffer& content, ITextErrorReporter& errorReporter)
+{
+    const auto contentHash = CRC64().append(content.data(), content.size()).crc();
+
+    {
+        auto lock = CreateLock(m_lock);
+
+        TextIncludeCacheEntryPtr ret;
+        if (m_entries.find(path, ret) && ret->m_contentHash == contentHash)
+        {
+            ++m_numHits;
+            return ret;
+        }
+    }
+
+    // tokenize outside the lock, if two threads race for the same file the first one to finish wins
+    auto entry = RefNew<TextIncludeCacheEntry>();
+    entry->m_path = StringBuf(path);
+    entry->m_content = content;
+    entry->m_contentHash = contentHash;
+
+    const auto text = StringView((const char*)content.data(), content.size());
+    if (!TextFilePreprocessor::TokenizeContent(text, path, m_language, m_commentEater, errorReporter, entry->m_tokens))
+        return nullptr;
+
+    entry->m_guardMacro = StringBuf(DetectIncludeGuard(entry->m_tokens));
+    entry->m_pragmaOnce = DetectPragmaOnce(entry->m_tokens);
+
+    ++m_numMisses;
+
+    auto lock = CreateLock(m_lock);
+
+    TextIncludeCacheEntryPtr existing;
+    if (m_entries.find(path, existing) && existing->m_contentHash == contentHash)
+        return existing;
+
+    // replaces the entry for the older content (if any), it's still kept alive by the preprocessors that use it
+    m_entries[entry->m_path] = entry;
+    return entry;
+}
+
+uint32_t TextIncludeCache::numEntries() const
+{
+    auto lock = CreateLock(m_lock);
+    return m_entries.size();
+}
+
+void TextIncludeCache::clear()
+{
+    auto lock = CreateLock(m_lock);
+    m_entries.clear();
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -9,6 +9,7 @@
 #include "build.h"
 #include "textToken.h"
 #include "textLanguageDefinition.h"
+#include "textScanHelpers.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -23,14 +24,7 @@ namespace prv
     public:
         virtual void eatWhiteSpaces(const char*& str, const char* endStr, uint32_t& lineIndex) const override
         {
-            while (str < endStr)
-            {
-                if (*str > ' ')
-                    break;
-                if (*str == '\n')
-                    lineIndex += 1;
-                ++str;
-            }
+            str = SkipWhiteSpaces(str, endStr, lineIndex);
         }
     };
 
@@ -52,28 +46,32 @@ namespace prv
                 if (str[0] == '/' && str[1] == '/')
                 {
                     // eat until the end of line or end of file
-                    str += 2;
-                    while (str < endStr)
+                    const auto* lineEnd = (const char*)memchr(str + 2, '\n', endStr - (str + 2));
+                    if (lineEnd)
                     {
-                        if (*str == '\n')
-                        {
-                            lineIndex += 1; // we've consumed the '\n' so we have to increment the line counter
-                            str += 1; // eat the new line
-                            break;
-                        }
-                        ++str;
+                        lineIndex += 1; // we've consumed the '\n' so we have to increment the line counter
+                        str = lineEnd + 1; // eat the new line
+                    }
+                    else
+                    {
+                        str = endStr;
                     }
                 }
                     // a block comment ?
                 else if (str[0] == '/' && str[1] == '*')
                 {
-                    // eat until the end of line or end of file
-                    while (str + 1 < endStr)
+                    // jump from star to star until we find the closing one, new lines are counted in bulk on the way
+                    str += 2;
+                    for (;;)
                     {
-                        if (str[0] == '\n')
-                            lineIndex += 1; // we've consumed the '\n' so we have to increment the line counter
+                        str = FindCharCountingLines(str, endStr, '*', lineIndex);
+                        if (str + 1 >= endStr)
+                        {
+                            str = endStr;
+                            break;
+                        }
 
-                        if (str[0] == '*' && str[1] == '/')
+                        if (str[1] == '/')
                         {
                             str += 2;
                             break;
@@ -157,16 +155,8 @@ namespace prv
                 if (str[0] == '-' && str[1] == '-')
                 {
                     // eat until the end of line or end of file
-                    str += 2;
-                    while (str < endStr)
-                    {
-                        if (*str == '\n')
-                        {
-                            lineIndex += 1; // we've consumed the '\n' so we have to increment the line counter
-                            break;
-                        }
-                        ++str;
-                    }
+                    const auto* lineEnd = (const char*)memchr(str + 2, '\n', endStr - (str + 2));
+                    str = lineEnd ? lineEnd : endStr;
                 }
             }
         }
@@ -180,6 +170,9 @@ namespace prv
     public:
         virtual void eatWhiteSpaces(const char*& str, const char* endStr, uint32_t& lineIndex) const override
         {
+            // eat basic white spaces
+            NoCommentsParserCommentEater::eatWhiteSpaces(str, endStr, lineIndex);
+
             // we need at least 2 chars :)
             if (str < endStr)
             {
@@ -187,16 +180,8 @@ namespace prv
                 if (str[0] == '#')
                 {
                     // eat until the end of line or end of file
-                    str += 1;
-                    while (str < endStr)
-                    {
-                        if (*str == '\n')
-                        {
-                            lineIndex += 1; // we've consumed the '\n' so we have to increment the line counter
-                            break;
-                        }
-                        ++str;
-                    }
+                    const auto* lineEnd = (const char*)memchr(str + 1, '\n', endStr - (str + 1));
+                    str = lineEnd ? lineEnd : endStr;
                 }
             }
         }
@@ -243,6 +228,20 @@ ITextLanguageDefinition::ITextLanguageDefinition()
 ITextLanguageDefinition::~ITextLanguageDefinition()
 {}
 
+bool ITextLanguageDefinition::eatFlatToken(const char*& str, const char* endStr, FlatToken& outToken) const
+{
+    Token token;
+    if (!eatToken(str, endStr, token))
+        return false;
+
+    const auto view = token.view();
+    outToken.m_str = view.data();
+    outToken.m_length = view.length();
+    outToken.m_keywordID = (short)token.keywordID();
+    outToken.m_type = token.type();
+    return true;
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
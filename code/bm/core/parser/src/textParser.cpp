@@ -593,6 +593,60 @@ Token TextParser::parseToken(const ITextLanguageDefinition& language)
     return token;
 }
 
+static const char* FindLineStart(const char* pos, const char* docStart)
+{
+    while (pos > docStart)
+    {
+        if (pos[-1] == '\r' || pos[-1] == '\n')
+            break;
+        --pos;
+    }
+
+    return pos;
+}
+
+bool TextParser::parseTokens(const ITextLanguageDefinition& language, Array<FlatToken>& outTokens)
+{
+    // rough guess of the token density so we don't grow the array too often
+    outTokens.reserve(outTokens.size() + range_cast<uint32_t>((m_end - m_pos) / 6) + 16);
+
+    auto lineIndex = m_lineIndex;
+    auto lineStart = FindLineStart(m_pos, m_start);
+    while (findNextContent())
+    {
+        // we only need to look for the new line start if we've moved to a different line, the search is limited to what we just skipped
+        if (lineIndex != m_lineIndex)
+        {
+            lineIndex = m_lineIndex;
+            lineStart = FindLineStart(m_pos, m_start);
+        }
+
+        auto& token = outTokens.emplaceBack();
+        auto cur = m_pos;
+        if (!language.eatFlatToken(cur, m_end, token))
+        {
+            outTokens.popBack();
+
+            auto lookAhead = view().leftPart(20).trim()
+                .beforeFirst(" ", StringCaseComparisonMode::WithCase, StringFindFallbackMode::Full)
+                .beforeFirst("\n", StringCaseComparisonMode::WithCase, StringFindFallbackMode::Full)
+                .beforeFirst("\r", StringCaseComparisonMode::WithCase, StringFindFallbackMode::Full)
+                .beforeFirst("\t", StringCaseComparisonMode::WithCase, StringFindFallbackMode::Full);
+
+            if (outTokens.empty())
+                return error(TempString("Unable to parse text at this location: '{}'", lookAhead));
+
+            return error(TempString("Unable to parse text at this location: '{}', last valid token: '{}'", lookAhead, outTokens.back().view()));
+        }
+
+        token.m_line = m_lineIndex;
+        token.m_charPos = range_cast<uint32_t>(token.m_str - lineStart);
+        m_pos = cur;
+    }
+
+    return true;
+}
+
 bool TextParser::findDjangoTag(StringView& outSkipped, StringView& outTag, char& outTagType, TextTokenLocation& outLocation)
 {
     const auto* start = m_pos;
@@ -8,6 +8,7 @@
 
 #include "build.h"
 #include "textParsingTreeBuilder.h"
+#include "textScanHelpers.h"
 #include "bm/core/containers/include/inplaceArray.h"
 #include "bm/core/containers/include/hashMap.h"
 #include "bm/core/containers/include/stringBuilder.h"
@@ -665,6 +666,7 @@ namespace prv
             short m_emitKeywordID;
             uint16_t m_firstContinuationIndex;
             uint16_t m_numContinuationIndices;
+            uint16_t m_runIndex; // 1-based index of the char run that loops on this node, 0 if none
 
             INLINE CompiledNode()
                 : m_emitType(TextTokenType::Invalid)
@@ -672,6 +674,7 @@ namespace prv
                 , m_emitKeywordID(-1)
                 , m_firstContinuationIndex(0)
                 , m_numContinuationIndices(0)
+                , m_runIndex(0)
             {}
 
             INLINE bool transitionIndex(char ch, uint16_t& outNextStateIndex) const
@@ -694,8 +697,9 @@ namespace prv
 
         Array<CompiledNode> m_nodes;
         Array<uint16_t> m_continuationIndices;
+        Array<CharRunRanges> m_runs;
 
-        virtual bool eatToken(const char*& str, const char* endStr, Token& outToken) const override final
+        INLINE const CompiledNode& walk(const char* str, const char* endStr, const char*& outEnd) const
         {
             uint32_t curStateIndex = 0;
 
@@ -705,6 +709,14 @@ namespace prv
             {
                 auto& curState = m_nodes[curStateIndex];
 
+                // chars that loop back to the same state (identifiers, numbers, string content) are skipped in bulk
+                if (curState.m_runIndex)
+                {
+                    cur = SkipCharRuns(cur, endStr, m_runs[curState.m_runIndex - 1]);
+                    if (cur == endStr)
+                        break;
+                }
+
                 // get the index of the transition
                 uint16_t transitionIndex = 0;
                 if (!curState.transitionIndex(*cur, transitionIndex))
@@ -720,8 +732,16 @@ namespace prv
                 cur += 1;
             }
 
+            outEnd = cur;
+            return m_nodes[curStateIndex];
+        }
+
+        virtual bool eatToken(const char*& str, const char* endStr, Token& outToken) const override final
+        {
+            const char* cur = nullptr;
+            auto& finalState = walk(str, endStr, cur);
+
             // we've reached end of input, if the final state has anything to emit we will emit it, if not, we are done
-            auto& finalState = m_nodes[curStateIndex];
             if (finalState.m_emitType == TextTokenType::Invalid)
                 return false; // nothing to emit
 
@@ -733,8 +753,53 @@ namespace prv
             str = cur; // advance the stream state
             return true;
         }
+
+        virtual bool eatFlatToken(const char*& str, const char* endStr, FlatToken& outToken) const override final
+        {
+            const char* cur = nullptr;
+            auto& finalState = walk(str, endStr, cur);
+            if (finalState.m_emitType == TextTokenType::Invalid)
+                return false; // nothing to emit
+
+            // emit what we have parsed, strings and names are emitted without the quotes
+            const auto quoted = (finalState.m_emitType == TextTokenType::String || finalState.m_emitType == TextTokenType::Name);
+            outToken.m_str = quoted ? str + 1 : str;
+            outToken.m_length = range_cast<uint32_t>(cur - str) - (quoted ? 2 : 0);
+            outToken.m_keywordID = finalState.m_emitKeywordID;
+            outToken.m_type = finalState.m_emitType;
+            str = cur; // advance the stream state
+            return true;
+        }
     };
 
+    static bool BuildSelfLoopRuns(const ParsingNode* node, CharRunRanges& outRuns)
+    {
+        uint32_t numChars = 0;
+        for (uint32_t i = 1; i < ARRAY_COUNT(node->m_continuation); ++i) // 0 is never transitioned on
+        {
+            if (node->m_continuation[i].m_node != node)
+                continue;
+
+            numChars += 1;
+            if (outRuns.m_numRanges && outRuns.m_last[outRuns.m_numRanges - 1] == (char)(i - 1))
+            {
+                outRuns.m_last[outRuns.m_numRanges - 1] = (char)i;
+            }
+            else
+            {
+                if (outRuns.m_numRanges == CharRunRanges::MAX_RANGES)
+                    return false; // too fragmented to be scanned in bulk
+
+                outRuns.m_first[outRuns.m_numRanges] = (char)i;
+                outRuns.m_last[outRuns.m_numRanges] = (char)i;
+                outRuns.m_numRanges += 1;
+            }
+        }
+
+        // single char loops are not worth it
+        return numChars > 1;
+    }
+
     static uint32_t CountContinuations(const ParsingNode* node, uint8_t* firstIndex = nullptr)
     {
         uint32_t minIndex = ARRAY_COUNT(node->m_continuation);
@@ -823,6 +888,14 @@ namespace prv
                 targetNode.m_firstContinuationIndex = range_cast<uint16_t>(curContinuationIndex);
                 CopyContinuations(node, curContinuationIndex, ret->m_continuationIndices);
             }
+
+            // extract the chars that loop on the node so they can be skipped in bulk
+            CharRunRanges runs;
+            if (BuildSelfLoopRuns(node, runs))
+            {
+                ret->m_runs.pushBack(runs);
+                targetNode.m_runIndex = range_cast<uint16_t>(ret->m_runs.size());
+            }
         }
 
         // return the compiled tables
@@ -0,0 +1,160 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+*
+* [# filter: parser #]
+***/
+
+#pragma once
+
+#include "bm/core/containers/include/bitUtils.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+namespace prv
+{
+    //---
+
+    // count bits in the 16-bit mask produced by the byte compares
+    ALWAYS_INLINE uint32_t CountScanMaskBits(uint32_t mask)
+    {
+        uint32_t count = 0;
+        while (mask)
+        {
+            mask &= mask - 1;
+            count += 1;
+        }
+        return count;
+    }
+
+    // skip white spaces (everything <= ' ', including the non-ASCII bytes, as the classic parser does), counts the new lines on the way
+    ALWAYS_INLINE const char* SkipWhiteSpaces(const char* str, const char* endStr, uint32_t& lineIndex)
+    {
+#ifdef PLATFORM_SSE2
+        const auto spaceChar = _mm_set1_epi8(' ');
+        const auto newLineChar = _mm_set1_epi8('\n');
+        while (str + 16 <= endStr)
+        {
+            const auto chars = _mm_loadu_si128((const __m128i*)str);
+            const auto contentMask = (uint32_t)_mm_movemask_epi8(_mm_cmpgt_epi8(chars, spaceChar));
+            const auto newLineMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newLineChar));
+            if (contentMask)
+            {
+                const auto offset = __builtin_ctz(contentMask);
+                lineIndex += CountScanMaskBits(newLineMask & ((1U << offset) - 1));
+                return str + offset;
+            }
+
+            lineIndex += CountScanMaskBits(newLineMask);
+            str += 16;
+        }
+#endif
+
+        while (str < endStr)
+        {
+            if (*str > ' ')
+                break;
+            if (*str == '\n')
+                lineIndex += 1;
+            ++str;
+        }
+
+        return str;
+    }
+
+    // find first occurrence of given char, counts the new lines on the way, returns endStr if not found
+    ALWAYS_INLINE const char* FindCharCountingLines(const char* str, const char* endStr, char ch, uint32_t& lineIndex)
+    {
+#ifdef PLATFORM_SSE2
+        const auto searchChar = _mm_set1_epi8(ch);
+        const auto newLineChar = _mm_set1_epi8('\n');
+        while (str + 16 <= endStr)
+        {
+            const auto chars = _mm_loadu_si128((const __m128i*)str);
+            const auto foundMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, searchChar));
+            const auto newLineMask = (uint32_t)_mm_movemask_epi8(_mm_cmpeq_epi8(chars, newLineChar));
+            if (foundMask)
+            {
+                const auto offset = __builtin_ctz(foundMask);
+                lineIndex += CountScanMaskBits(newLineMask & ((1U << offset) - 1));
+                return str + offset;
+            }
+
+            lineIndex += CountScanMaskBits(newLineMask);
+            str += 16;
+        }
+#endif
+
+        while (str < endStr)
+        {
+            if (*str == ch)
+                break;
+            if (*str == '\n')
+                lineIndex += 1;
+            ++str;
+        }
+
+        return str;
+    }
+
+    //---
+
+    // set of up to 4 char ranges (all within 1-127) that can be skipped in bulk
+    struct CharRunRanges
+    {
+        static const uint32_t MAX_RANGES = 4;
+
+        uint8_t m_numRanges = 0;
+        char m_first[MAX_RANGES];
+        char m_last[MAX_RANGES];
+
+        INLINE bool contains(char ch) const
+        {
+            for (uint32_t i = 0; i < m_numRanges; ++i)
+                if (ch >= m_first[i] && ch <= m_last[i])
+                    return true;
+            return false;
+        }
+    };
+
+    // skip all chars that are in the given ranges, returns the first char that is not
+    ALWAYS_INLINE const char* SkipCharRuns(const char* str, const char* endStr, const CharRunRanges& ranges)
+    {
+#ifdef PLATFORM_SSE2
+        __m128i firstChars[CharRunRanges::MAX_RANGES];
+        __m128i lastChars[CharRunRanges::MAX_RANGES];
+        for (uint32_t i = 0; i < ranges.m_numRanges; ++i)
+        {
+            firstChars[i] = _mm_set1_epi8(ranges.m_first[i] - 1); // ranges start at 1 so this never wraps
+            lastChars[i] = _mm_set1_epi8(ranges.m_last[i]);
+        }
+
+        while (str + 16 <= endStr)
+        {
+            const auto chars = _mm_loadu_si128((const __m128i*)str);
+
+            // signed compares, bytes >= 0x80 are never part of any range
+            auto inside = _mm_setzero_si128();
+            for (uint32_t i = 0; i < ranges.m_numRanges; ++i)
+                inside = _mm_or_si128(inside, _mm_andnot_si128(_mm_cmpgt_epi8(chars, lastChars[i]), _mm_cmpgt_epi8(chars, firstChars[i])));
+
+            const auto outsideMask = ~(uint32_t)_mm_movemask_epi8(inside) & 0xFFFF;
+            if (outsideMask)
+                return str + __builtin_ctz(outsideMask);
+
+            str += 16;
+        }
+#endif
+
+        while (str < endStr && ranges.contains(*str))
+            ++str;
+
+        return str;
+    }
+
+    //---
+
+} // prv
+
+END_INFERNO_NAMESPACE()
@@ -30,6 +30,15 @@ void TextTokenLocation::print(IFormatStream& f) const
 
 //--
 
+Token FlatToken::token(const StringBuf& contextName) const
+{
+    Token ret(m_type, m_str, m_str + m_length, m_keywordID);
+    ret.assignLocation(TextTokenLocation(contextName, m_line, m_charPos));
+    return ret;
+}
+
+//--
+
 StringBuf Token::string() const
 {
     if (m_end == m_str)
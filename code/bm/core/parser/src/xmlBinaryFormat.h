@@ -0,0 +1,74 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+BEGIN_INFERNO_NAMESPACE()
+
+namespace prv
+{
+	//--
+
+	// Binary XML layout, everything is stored in one continuous block that can be used directly from (mapped) memory:
+	//  header | string table | node table | attribute table | string characters | data blobs
+	// All tables are referenced by index, strings (names and values) are interned and zero terminated
+	// Node data blobs are stored raw (no base64), aligned to 16 bytes
+
+	static const uint32_t BINARY_XML_VERSION = 1;
+	static const uint32_t BINARY_XML_INVALID = ~0U;
+	static const uint32_t BINARY_XML_BLOB_ALIGNMENT = 16;
+
+	struct BinaryXMLHeader
+	{
+		char magic[6]; // BINXML
+		uint16_t version;
+		uint32_t totalSize;
+		uint32_t numStrings;
+		uint32_t numNodes;
+		uint32_t numAttributes;
+		uint32_t stringTableOffset;
+		uint32_t nodeTableOffset;
+		uint32_t attributeTableOffset;
+		uint32_t charactersOffset;
+		uint32_t charactersSize;
+		uint32_t blobsOffset;
+		uint32_t blobsSize;
+	};
+
+	struct BinaryXMLString
+	{
+		uint32_t offset; // in the characters block
+		uint32_t length; // without the terminator
+	};
+
+	struct BinaryXMLNode
+	{
+		uint32_t name; // string index
+		uint32_t parent; // node index, BINARY_XML_INVALID for root
+		uint32_t firstChild; // node index
+		uint32_t nextSibling; // node index
+		uint32_t firstAttribute; // attribute index, attributes of a node are continuous
+		uint32_t numAttributes;
+		uint32_t text; // string index of the text value
+		uint32_t blobOffset; // offset in the blobs block
+		uint32_t blobSize; // size of the raw data value, zero if node has no data
+	};
+
+	struct BinaryXMLAttribute
+	{
+		uint32_t node; // owning node index
+		uint32_t name; // string index
+		uint32_t value; // string index
+	};
+
+	static_assert(sizeof(BinaryXMLHeader) == 52, "Binary XML header layout changed");
+	static_assert(sizeof(BinaryXMLNode) == 36, "Binary XML node layout changed");
+
+	//--
+
+} // prv
+
+END_INFERNO_NAMESPACE()
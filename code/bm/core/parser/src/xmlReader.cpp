@@ -6,12 +6,14 @@
 
 #include "build.h"
 #include "xmlReader.h"
+#include "xmlBinaryFormat.h"
 #include "textToken.h"
 #include "textErrorReporter.h"
 
 #include "rapidxml/rapidxml.hpp"
 #include "bm/core/file/include/fileReader.h"
 #include "bm/core/file/include/fileMapping.h"
+#include "bm/core/file/include/fileView.h"
 #include "textFileWriter.h"
 
 BEGIN_INFERNO_NAMESPACE()
@@ -48,6 +50,78 @@ static const RapidAttr* FromAttributeID(AttributeHandle id)
 
 //---
 
+static const prv::BinaryXMLHeader* BinaryHeader(const void* ptr)
+{
+	return (const prv::BinaryXMLHeader*)ptr;
+}
+
+static const prv::BinaryXMLNode* BinaryNodes(const prv::BinaryXMLHeader* header)
+{
+	return (const prv::BinaryXMLNode*)((const uint8_t*)header + header->nodeTableOffset);
+}
+
+static const prv::BinaryXMLAttribute* BinaryAttributes(const prv::BinaryXMLHeader* header)
+{
+	return (const prv::BinaryXMLAttribute*)((const uint8_t*)header + header->attributeTableOffset);
+}
+
+static StringView BinaryString(const prv::BinaryXMLHeader* header, uint32_t index)
+{
+	if (index == prv::BINARY_XML_INVALID)
+		return StringView();
+
+	const auto& entry = ((const prv::BinaryXMLString*)((const uint8_t*)header + header->stringTableOffset))[index];
+	return StringView((const char*)header + header->charactersOffset + entry.offset, entry.length);
+}
+
+static const prv::BinaryXMLNode* FromBinaryNodeId(NodeHandle id)
+{
+	return (const prv::BinaryXMLNode*)id;
+}
+
+static const prv::BinaryXMLAttribute* FromBinaryAttributeID(AttributeHandle id)
+{
+	return (const prv::BinaryXMLAttribute*)id;
+}
+
+static NodeHandle BinaryFindNode(const prv::BinaryXMLHeader* header, uint32_t index, StringView name)
+{
+	const auto* nodes = BinaryNodes(header);
+	while (index != prv::BINARY_XML_INVALID)
+	{
+		if (!name || BinaryString(header, nodes[index].name) == name)
+			return ToNodeID(nodes + index);
+
+		index = nodes[index].nextSibling;
+	}
+
+	return 0;
+}
+
+static AttributeHandle BinaryFindAttribute(const prv::BinaryXMLHeader* header, uint32_t index, uint32_t endIndex, StringView name)
+{
+	const auto* attributes = BinaryAttributes(header);
+	for (; index < endIndex; ++index)
+	{
+		if (!name || BinaryString(header, attributes[index].name) == name)
+			return ToAttributeID(attributes + index);
+	}
+
+	return 0;
+}
+
+static bool BinaryTableValid(const prv::BinaryXMLHeader* header, uint32_t offset, uint32_t count, uint32_t elementSize)
+{
+	return !(offset & 3) && ((uint64_t)offset + (uint64_t)count * elementSize) <= header->totalSize;
+}
+
+static bool BinaryIndexValid(uint32_t index, uint32_t count)
+{
+	return (index == prv::BINARY_XML_INVALID) || (index < count);
+}
+
+//---
+
 XMLReader::XMLReader(IPoolUnmanaged& pool, Buffer data, void* doc, void* root)
     : m_data(data)
     , m_pool(pool)
@@ -58,7 +132,8 @@ XMLReader::XMLReader(IPoolUnmanaged& pool, Buffer data, void* doc, void* root)
 
 XMLReader::~XMLReader()
 {
-    PoolDelete(m_pool, m_doc);
+    if (m_doc)
+        PoolDelete(m_pool, m_doc);
 }
 
 namespace helper
@@ -107,6 +182,14 @@ XMLReaderPtr XMLReader::LoadFromText(ITextErrorReporter& err, StringView context
     bufferBase[text.length() + 0] = 0;
     bufferBase[text.length() + 1] = 0;
 
+    return ParseText(err, contextName, data, pool);
+}
+
+XMLReaderPtr XMLReader::ParseText(ITextErrorReporter& err, StringView contextName, Buffer data, IPoolUnmanaged& pool)
+{
+    // parsing is done in place (RapidXML inserts string terminators into the text)
+    auto bufferBase = (char*)data.data();
+
     // create XML document wrapper
     auto* doc = PoolNew<RapidDoc>(pool);
 
@@ -135,6 +218,78 @@ XMLReaderPtr XMLReader::LoadFromText(ITextErrorReporter& err, StringView context
 	return RefNew<XMLReader>(pool, data, doc, root);
 }
 
+XMLReaderPtr XMLReader::LoadBinary(ITextErrorReporter& err, StringView contextName, Buffer data, IPoolUnmanaged& pool)
+{
+    auto reportError = [&err, contextName](const char* txt)
+    {
+        err.reportError(TextTokenLocation(StringBuf(contextName), 1, 1), txt);
+    };
+
+    if (data.size() < sizeof(prv::BinaryXMLHeader))
+    {
+        reportError("Binary XML data is truncated");
+        return nullptr;
+    }
+
+    // tables are accessed in place, make sure the data is aligned (mapped files always are)
+    if ((uint64_t)data.data() & 15)
+    {
+        data = Buffer::CreateFromCopy(pool, data.view());
+        DEBUG_CHECK_RETURN_EX_V(data, "Out of memory", nullptr);
+    }
+
+    const auto* header = BinaryHeader(data.data());
+    if (header->version != prv::BINARY_XML_VERSION)
+    {
+        reportError("Unsupported binary XML version");
+        return nullptr;
+    }
+
+    // validate the layout, this is just a linear scan over the tables without any allocations
+    bool valid = header->totalSize <= data.size() && header->numNodes > 0
+        && BinaryTableValid(header, header->stringTableOffset, header->numStrings, sizeof(prv::BinaryXMLString))
+        && BinaryTableValid(header, header->nodeTableOffset, header->numNodes, sizeof(prv::BinaryXMLNode))
+        && BinaryTableValid(header, header->attributeTableOffset, header->numAttributes, sizeof(prv::BinaryXMLAttribute))
+        && BinaryTableValid(header, header->charactersOffset, header->charactersSize, 1)
+        && BinaryTableValid(header, header->blobsOffset, header->blobsSize, 1);
+
+    if (valid)
+    {
+        const auto* strings = (const prv::BinaryXMLString*)(data.data() + header->stringTableOffset);
+        for (uint32_t i = 0; valid && i < header->numStrings; ++i)
+            valid = ((uint64_t)strings[i].offset + strings[i].length) < header->charactersSize;
+
+        // nodes are stored breadth first, links always point forward so traversal can't loop
+        const auto* nodes = BinaryNodes(header);
+        for (uint32_t i = 0; valid && i < header->numNodes; ++i)
+        {
+            const auto& node = nodes[i];
+            valid = (node.name < header->numStrings)
+                && BinaryIndexValid(node.text, header->numStrings)
+                && (i ? (node.parent < i) : (node.parent == prv::BINARY_XML_INVALID))
+                && BinaryIndexValid(node.firstChild, header->numNodes) && (node.firstChild > i)
+                && BinaryIndexValid(node.nextSibling, header->numNodes) && (node.nextSibling > i)
+                && ((uint64_t)node.firstAttribute + node.numAttributes) <= header->numAttributes
+                && ((uint64_t)node.blobOffset + node.blobSize) <= header->blobsSize;
+        }
+
+        const auto* attributes = BinaryAttributes(header);
+        for (uint32_t i = 0; valid && i < header->numAttributes; ++i)
+            valid = (attributes[i].node < header->numNodes) && (attributes[i].name < header->numStrings) && (attributes[i].value < header->numStrings);
+    }
+
+    if (!valid)
+    {
+        reportError("Binary XML data is corrupted");
+        return nullptr;
+    }
+
+    // no parsing needed, the root is the first node
+    auto ret = RefNew<XMLReader>(pool, data, nullptr, (void*)BinaryNodes(header));
+    ret->m_binary = header;
+    return ret;
+}
+
 //---
 
 NodeHandle XMLReader::root() const
@@ -144,6 +299,12 @@ NodeHandle XMLReader::root() const
 
 NodeHandle XMLReader::firstChild(NodeHandle id, StringView childName /*= nullptr*/) const
 {
+    if (m_binary)
+    {
+        const auto* binaryNode = FromBinaryNodeId(id);
+        return binaryNode ? BinaryFindNode(BinaryHeader(m_binary), binaryNode->firstChild, childName) : 0;
+    }
+
     auto node  = FromNodeId(id);
     if (!node)
         return 0;
@@ -161,6 +322,12 @@ NodeHandle XMLReader::firstChild(NodeHandle id, StringView childName /*= nullptr
 
 NodeHandle XMLReader::nextChild(NodeHandle id, StringView siblingName /*= nullptr*/) const
 {
+    if (m_binary)
+    {
+        const auto* binaryNode = FromBinaryNodeId(id);
+        return binaryNode ? BinaryFindNode(BinaryHeader(m_binary), binaryNode->nextSibling, siblingName) : 0;
+    }
+
     auto node  = FromNodeId(id);
     if (!node)
         return 0;
@@ -178,6 +345,15 @@ NodeHandle XMLReader::nextChild(NodeHandle id, StringView siblingName /*= nullpt
 
 NodeHandle XMLReader::nodeParent(NodeHandle id) const
 {
+    if (m_binary)
+    {
+        const auto* binaryNode = FromBinaryNodeId(id);
+        if (!binaryNode || binaryNode->parent == prv::BINARY_XML_INVALID)
+            return 0;
+
+        return ToNodeID(BinaryNodes(BinaryHeader(m_binary)) + binaryNode->parent);
+    }
+
     auto node = FromNodeId(id);
     if (!node)
         return 0;
@@ -187,6 +363,10 @@ NodeHandle XMLReader::nodeParent(NodeHandle id) const
 
 uint32_t XMLReader::nodeLine(NodeHandle id) const
 {
+    // binary XML does not store source locations
+    if (m_binary)
+        return 1;
+
 	auto node = FromNodeId(id);
     if (node)
         return node->location().line();
@@ -198,6 +378,12 @@ uint32_t XMLReader::nodeLine(NodeHandle id) const
 
 StringView XMLReader::nodeValueText(NodeHandle id) const
 {
+    if (m_binary)
+    {
+        const auto* binaryNode = FromBinaryNodeId(id);
+        return binaryNode ? BinaryString(BinaryHeader(m_binary), binaryNode->text) : StringView();
+    }
+
     auto node  = FromNodeId(id);
     if (!node)
         return StringBuf::EMPTY();
@@ -207,6 +393,24 @@ StringView XMLReader::nodeValueText(NodeHandle id) const
 
 Buffer XMLReader::nodeValueBuffer(NodeHandle id, IPoolUnmanaged* pool) const
 {
+    if (m_binary)
+    {
+        const auto* binaryNode = FromBinaryNodeId(id);
+        if (!binaryNode)
+            return nullptr;
+
+        // raw data is shared with the document, no decoding or copying
+        const auto* header = BinaryHeader(m_binary);
+        if (binaryNode->blobSize)
+            return m_data.createSubBuffer(header->blobsOffset + binaryNode->blobOffset, binaryNode->blobSize);
+
+        const auto valueStr = BinaryString(header, binaryNode->text);
+        if (!valueStr)
+            return nullptr;
+
+        return valueStr.decode(pool ? *pool : m_pool, EncodingType::Base64);
+    }
+
     auto node = FromNodeId(id);
     if (!node || !node->value_size())
         return nullptr;
@@ -219,6 +423,12 @@ Buffer XMLReader::nodeValueBuffer(NodeHandle id, IPoolUnmanaged* pool) const
 
 StringView XMLReader::nodeName(NodeHandle id) const
 {
+    if (m_binary)
+    {
+        const auto* binaryNode = FromBinaryNodeId(id);
+        return binaryNode ? BinaryString(BinaryHeader(m_binary), binaryNode->name) : StringView();
+    }
+
     auto node  = FromNodeId(id);
     if (!node)
         return StringBuf::EMPTY();
@@ -228,6 +438,16 @@ StringView XMLReader::nodeName(NodeHandle id) const
 
 StringView XMLReader::attributeValue(NodeHandle id, StringView name, StringView defaultVal) const
 {
+    if (m_binary)
+    {
+        const auto* binaryNode = FromBinaryNodeId(id);
+        if (!binaryNode)
+            return defaultVal;
+
+        const auto* attr = FromBinaryAttributeID(BinaryFindAttribute(BinaryHeader(m_binary), binaryNode->firstAttribute, binaryNode->firstAttribute + binaryNode->numAttributes, name));
+        return attr ? BinaryString(BinaryHeader(m_binary), attr->value) : defaultVal;
+    }
+
     auto node  = FromNodeId(id);
     if (!node)
         return defaultVal;
@@ -241,6 +461,15 @@ StringView XMLReader::attributeValue(NodeHandle id, StringView name, StringView
 
 AttributeHandle XMLReader::firstAttribute(NodeHandle id, StringView name /*= nullptr*/) const
 {
+    if (m_binary)
+    {
+        const auto* binaryNode = FromBinaryNodeId(id);
+        if (!binaryNode)
+            return 0;
+
+        return BinaryFindAttribute(BinaryHeader(m_binary), binaryNode->firstAttribute, binaryNode->firstAttribute + binaryNode->numAttributes, name);
+    }
+
     auto node  = FromNodeId(id);
     if (!node)
         return 0;
@@ -252,6 +481,12 @@ AttributeHandle XMLReader::firstAttribute(NodeHandle id, StringView name /*= nul
 
 StringView XMLReader::attributeName(AttributeHandle id) const
 {
+    if (m_binary)
+    {
+        const auto* binaryAttr = FromBinaryAttributeID(id);
+        return binaryAttr ? BinaryString(BinaryHeader(m_binary), binaryAttr->name) : StringView();
+    }
+
     auto attr  = FromAttributeID(id);
     if (!attr)
         return StringView();
@@ -261,6 +496,12 @@ StringView XMLReader::attributeName(AttributeHandle id) const
 
 StringView XMLReader::attributeValue(AttributeHandle id) const
 {
+    if (m_binary)
+    {
+        const auto* binaryAttr = FromBinaryAttributeID(id);
+        return binaryAttr ? BinaryString(BinaryHeader(m_binary), binaryAttr->value) : StringView();
+    }
+
     auto attr  = FromAttributeID(id);
     if (!attr)
         return StringView();
@@ -270,6 +511,18 @@ StringView XMLReader::attributeValue(AttributeHandle id) const
 
 AttributeHandle XMLReader::nextAttribute(AttributeHandle id, StringView name /*= nullptr*/) const
 {
+    if (m_binary)
+    {
+        const auto* binaryAttr = FromBinaryAttributeID(id);
+        if (!binaryAttr)
+            return 0;
+
+        const auto* header = BinaryHeader(m_binary);
+        const auto& owner = BinaryNodes(header)[binaryAttr->node];
+        const auto index = (uint32_t)(binaryAttr - BinaryAttributes(header));
+        return BinaryFindAttribute(header, index + 1, owner.firstAttribute + owner.numAttributes, name);
+    }
+
     auto attr  = FromAttributeID(id);
     if (!attr)
         return 0;
@@ -281,24 +534,64 @@ AttributeHandle XMLReader::nextAttribute(AttributeHandle id, StringView name /*=
 
 XMLReaderPtr XMLReader::LoadFromFile(ITextErrorReporter& ctx, StringView absoluteFilePath, TimeStamp* outTimeStamp/*= nullptr*/, IPoolUnmanaged& pool /*= MainPool()*/)
 {
+	// file is memory mapped, the only copy made is the one for the in-place parsing
 	Buffer buffer;
-	if (!FileSystem().loadFileToBuffer(absoluteFilePath, MainPool(), buffer, outTimeStamp))
+	if (!FileSystem().loadFileToBuffer(absoluteFilePath, pool, buffer, outTimeStamp, FileReadMode::MemoryMapped))
 		return nullptr;
 
-	return LoadFromBuffer(ctx, absoluteFilePath, buffer);
+	return LoadFromBuffer(ctx, absoluteFilePath, buffer, pool);
 }
 
 XMLReaderPtr XMLReader::LoadFromFile(ITextErrorReporter& err, StringView contextName, IFileReader* file, IPoolUnmanaged& pool /*= MainPool()*/)
 {
 	DEBUG_CHECK_RETURN_EX_V(file, "Invalid file", nullptr);
 
-	const auto data = file->createMapping(file->fullRange());
-	DEBUG_CHECK_RETURN_EX_V(data, "Read failed", nullptr);
+	// mapped (or already in memory) content can be parsed directly from the mapping without loading it first
+	if (file->flags().test(FileFlagBit::MemoryMapped) || file->flags().test(FileFlagBit::MemoryBacked))
+	{
+		const auto data = file->createMapping(file->fullRange());
+		DEBUG_CHECK_RETURN_EX_V(data, "Read failed", nullptr);
+
+		data->accessHint(FileAccessHint::Sequential);
+
+		const auto buffer = data->createBuffer();
+		DEBUG_CHECK_RETURN_EX_V(buffer, "Read failed", nullptr);
+
+		return LoadFromBuffer(err, contextName, buffer, pool);
+	}
+
+	// otherwise read the file straight into the zero terminated parsing buffer, no extra copy needed
+	const auto size = file->size();
+	if (size < 7)
+		return nullptr;
+
+	auto data = Buffer::CreateEmpty(pool, size + 2);
+	DEBUG_CHECK_RETURN_EX_V(data, "Out of memory", nullptr);
+
+	{
+		auto view = file->createView(file->fullRange());
+		DEBUG_CHECK_RETURN_EX_V(view, "Read failed", nullptr);
+
+		view->accessHint(FileAccessHint::Sequential);
 
-	const auto buffer = data->createBuffer();
-	DEBUG_CHECK_RETURN_EX_V(buffer, "Read failed", nullptr);
+		const auto numRead = view->readSync(data.data(), size);
+		DEBUG_CHECK_RETURN_EX_V(numRead == size, "Read failed", nullptr);
+	}
 
-	return LoadFromBuffer(err, contextName, buffer);
+	auto bufferBase = (char*)data.data();
+	bufferBase[size + 0] = 0;
+	bufferBase[size + 1] = 0;
+
+	if (0 == strncmp(bufferBase, "BINXML", 6))
+		return LoadBinary(err, contextName, data, pool);
+
+	if (0 != strncmp(bufferBase, "<?xml ", 6))
+	{
+		TRACE_ERROR("Unable to load XML data from file '{}'", contextName);
+		return nullptr;
+	}
+
+	return ParseText(err, contextName, data, pool);
 }
 
 XMLReaderPtr XMLReader::LoadFromBuffer(ITextErrorReporter& ctx, StringView contextName, Buffer mem, IPoolUnmanaged& pool /*= MainPool()*/)
@@ -311,12 +604,11 @@ XMLReaderPtr XMLReader::LoadFromBuffer(ITextErrorReporter& ctx, StringView conte
 	auto header = (const char*)mem.data();
 	if (0 == strncmp(header, "<?xml ", 6))
 	{
-		return XMLReader::LoadFromText(ctx, StringBuf(contextName), StringView(mem));
+		return XMLReader::LoadFromText(ctx, StringBuf(contextName), StringView(mem), pool);
 	}
 	else if (0 == strncmp(header, "BINXML", 6))
 	{
-		//return StaticBinaryXMLDocument::Load(ctx, mem);
-		return nullptr;
+		return LoadBinary(ctx, contextName, mem, pool);
 	}
 	else
 	{
@@ -412,6 +704,70 @@ void XMLReader::SaveToTextFileNode(const void* ptr, IFormatStream& f, uint32_t d
 	}
 }
 
+static void SaveBinaryNodeToText(const prv::BinaryXMLHeader* header, const prv::BinaryXMLNode* node, IFormatStream& f, uint32_t depth, bool prettyText)
+{
+	const auto name = BinaryString(header, node->name);
+
+	// entry
+	if (prettyText)
+		f.appendPadding(' ', depth * 2);
+	f.append("<");
+	f << name;
+
+	// emit attributes
+	const auto* attributes = BinaryAttributes(header) + node->firstAttribute;
+	for (uint32_t i = 0; i < node->numAttributes; ++i)
+	{
+		f.append(" ");
+		f << BinaryString(header, attributes[i].name);
+		f.append("=\"");
+		WriteString(f, BinaryString(header, attributes[i].value));
+		f.append("\"");
+	}
+
+	// write text value
+	bool writeClosingTag = true;
+	if (node->firstChild != prv::BINARY_XML_INVALID)
+	{
+		f.append(">");
+		if (prettyText)
+			f.append("\n");
+
+		const auto* nodes = BinaryNodes(header);
+		for (auto index = node->firstChild; index != prv::BINARY_XML_INVALID; index = nodes[index].nextSibling)
+			SaveBinaryNodeToText(header, nodes + index, f, depth + 1, prettyText);
+
+		if (prettyText)
+			f.appendPadding(' ', depth * 2);
+	}
+	else if (node->text != prv::BINARY_XML_INVALID)
+	{
+		f.append(">");
+		WriteString(f, BinaryString(header, node->text));
+	}
+	else if (node->blobSize)
+	{
+		f.append(">");
+		BufferView((const uint8_t*)header + header->blobsOffset + node->blobOffset, node->blobSize).encode(EncodingType::Base64, f);
+	}
+	else
+	{
+		writeClosingTag = false;
+		f.append("/>");
+		if (prettyText)
+			f.append("\n");
+	}
+
+	if (writeClosingTag)
+	{
+		f.append("</");
+		f << name;
+		f.append(">");
+		if (prettyText)
+			f.append("\n");
+	}
+}
+
 void XMLReader::printToText(NodeHandle id, IFormatStream& f, PrintFlags flags /*= PrintFlags()*/) const
 {
 	DEBUG_CHECK_RETURN_EX(id, "Invalid node");
@@ -423,7 +779,10 @@ void XMLReader::printToText(NodeHandle id, IFormatStream& f, PrintFlags flags /*
 			f.append("\n");
 	}
 
-	SaveToTextFileNode((const void*)id, f, 0, flags.test(PrintFlagBit::PrettyText));
+	if (m_binary)
+		SaveBinaryNodeToText(BinaryHeader(m_binary), FromBinaryNodeId(id), f, 0, flags.test(PrintFlagBit::PrettyText));
+	else
+		SaveToTextFileNode((const void*)id, f, 0, flags.test(PrintFlagBit::PrettyText));
 }
 
 void XMLReader::printToFile(NodeHandle id, IFileWriter* writer, PrintFlags flags /*= PrintFlags()*/) const
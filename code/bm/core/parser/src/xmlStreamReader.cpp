@@ -0,0 +1,524 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "xmlStreamReader.h"
+#include "textToken.h"
+#include "textErrorReporter.h"
+
+#include "bm/core/file/include/fileReader.h"
+#include "bm/core/file/include/fileView.h"
+#include "bm/core/containers/include/utf8StringFunctions.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+static bool IsXMLWhiteSpace(char ch)
+{
+	return ch == ' ' || ch == '\t' || ch == '\n' || ch == '\r';
+}
+
+static bool IsXMLNameDelimiter(char ch)
+{
+	return IsXMLWhiteSpace(ch) || ch == '/' || ch == '>' || ch == '<' || ch == '=' || ch == '\"' || ch == '\'';
+}
+
+static bool IsXMLWhiteSpace(const char* str, uint32_t length)
+{
+	for (uint32_t i = 0; i < length; ++i)
+		if (!IsXMLWhiteSpace(str[i]))
+			return false;
+
+	return true;
+}
+
+//--
+
+XMLStreamReader::XMLStreamReader(ITextErrorReporter& err, StringView contextName, IFileReader* file, uint32_t chunkSize /*= DEFAULT_CHUNK_SIZE*/)
+	: m_err(err)
+	, m_contextName(contextName)
+{
+	m_window.resize(std::max<uint32_t>(chunkSize, 16));
+	m_pos = m_window.typedData();
+	m_end = m_pos;
+
+	if (file)
+	{
+		m_file = file->createView(file->fullRange());
+		if (m_file)
+			m_file->accessHint(FileAccessHint::Sequential);
+	}
+
+	m_eof = !m_file;
+}
+
+XMLStreamReader::XMLStreamReader(ITextErrorReporter& err, StringView contextName, Buffer data)
+	: m_err(err)
+	, m_contextName(contextName)
+	, m_data(data)
+	, m_eof(true)
+{
+	m_pos = (const char*)data.data();
+	m_end = m_pos + data.size();
+}
+
+XMLStreamReader::~XMLStreamReader()
+{
+}
+
+//--
+
+bool XMLStreamReader::refill()
+{
+	if (m_eof)
+		return false;
+
+	// move the unparsed data to the front of the window, grow it only if a single token does not fit
+	// NOTE: resizing may move the window so only the offset of the unparsed data is valid after it
+	const auto remaining = (uint32_t)(m_end - m_pos);
+	const auto offset = (uint32_t)(m_pos - m_window.typedData());
+	if (remaining == m_window.size())
+		m_window.resize(m_window.size() * 2);
+
+	auto* base = m_window.typedData();
+	if (remaining && offset)
+		memmove(base, base + offset, remaining);
+
+	const auto numRead = m_file->readSync(base + remaining, m_window.size() - remaining);
+	m_pos = base;
+	m_end = base + remaining + numRead;
+
+	if (!numRead)
+	{
+		m_eof = true;
+		return false;
+	}
+
+	return true;
+}
+
+bool XMLStreamReader::ensure(uint32_t count)
+{
+	while ((uint32_t)(m_end - m_pos) < count)
+		if (!refill())
+			return false;
+
+	return true;
+}
+
+bool XMLStreamReader::find(StringView pattern, uint32_t& outOffset)
+{
+	// NOTE: offsets are relative to m_pos since the window can move when refilled
+	uint32_t searchStart = 0;
+	for (;;)
+	{
+		const auto available = (uint32_t)(m_end - m_pos);
+		if (available >= pattern.length())
+		{
+			const auto* cur = m_pos + searchStart;
+			const auto* last = m_end - pattern.length();
+			while (cur <= last)
+			{
+				cur = (const char*)memchr(cur, pattern.data()[0], (last - cur) + 1);
+				if (!cur)
+					break;
+
+				if (0 == memcmp(cur, pattern.data(), pattern.length()))
+				{
+					outOffset = (uint32_t)(cur - m_pos);
+					return true;
+				}
+
+				++cur;
+			}
+
+			searchStart = available - pattern.length() + 1;
+		}
+
+		if (!refill())
+			return false;
+	}
+}
+
+uint32_t XMLStreamReader::scanName()
+{
+	uint32_t length = 0;
+	for (;;)
+	{
+		if (m_pos + length == m_end && !refill())
+			break;
+
+		if (IsXMLNameDelimiter(m_pos[length]))
+			break;
+
+		length += 1;
+	}
+
+	return length;
+}
+
+void XMLStreamReader::skipWhiteSpaces()
+{
+	while (ensure(1) && IsXMLWhiteSpace(*m_pos))
+	{
+		if (*m_pos == '\n')
+			m_line += 1;
+		m_pos += 1;
+	}
+}
+
+void XMLStreamReader::consume(uint32_t count)
+{
+	const auto* end = m_pos + count;
+	while (const auto* lineEnd = (const char*)memchr(m_pos, '\n', end - m_pos))
+	{
+		m_line += 1;
+		m_pos = lineEnd + 1;
+	}
+
+	m_pos = end;
+}
+
+StringView XMLStreamReader::decode(const char* str, uint32_t length)
+{
+	const auto* end = str + length;
+
+	// most of the values have no entities in them
+	const auto* amp = (const char*)memchr(str, '&', length);
+	if (!amp)
+		return StringView(str, length);
+
+	m_scratch.reset();
+	m_scratch.reserve(length);
+
+	while (str < end)
+	{
+		if (*str != '&')
+		{
+			m_scratch.pushBack(*str++);
+			continue;
+		}
+
+		const auto* entityEnd = (const char*)memchr(str, ';', end - str);
+		if (!entityEnd)
+		{
+			m_scratch.pushBack(*str++);
+			continue;
+		}
+
+		const auto entity = StringView(str + 1, entityEnd);
+		if (entity == "lt")
+			m_scratch.pushBack('<');
+		else if (entity == "gt")
+			m_scratch.pushBack('>');
+		else if (entity == "amp")
+			m_scratch.pushBack('&');
+		else if (entity == "quot")
+			m_scratch.pushBack('\"');
+		else if (entity == "apos")
+			m_scratch.pushBack('\'');
+		else if (entity.length() > 1 && entity.data()[0] == '#')
+		{
+			uint32_t code = 0;
+			if (entity.data()[1] == 'x' || entity.data()[1] == 'X')
+			{
+				for (auto ch : entity.subString(2))
+					code = (code << 4) + ((ch >= '0' && ch <= '9') ? (ch - '0') : ((ch | 0x20) - 'a' + 10));
+			}
+			else
+			{
+				for (auto ch : entity.subString(1))
+					code = (code * 10) + (ch - '0');
+			}
+
+			char utf[8];
+			const auto size = utf8::ConvertChar(utf, code);
+			for (uint32_t i = 0; i < size; ++i)
+				m_scratch.pushBack(utf[i]);
+		}
+		else
+		{
+			// unknown entity, keep as is
+			for (const auto* ch = str; ch <= entityEnd; ++ch)
+				m_scratch.pushBack(*ch);
+		}
+
+		str = entityEnd + 1;
+	}
+
+	return StringView(m_scratch.typedData(), m_scratch.size());
+}
+
+StringView XMLStreamReader::copyName(const char* str, uint32_t length)
+{
+	m_nameScratch.reset();
+	m_nameScratch.resize(length);
+	memcpy(m_nameScratch.typedData(), str, length);
+	return StringView(m_nameScratch.typedData(), length);
+}
+
+//--
+
+XMLStreamEvent XMLStreamReader::reportError(StringView txt)
+{
+	m_err.reportError(TextTokenLocation(m_contextName, m_line, 1), txt);
+	m_state = State::Done;
+	m_failed = true;
+	return XMLStreamEvent::Error;
+}
+
+XMLStreamEvent XMLStreamReader::openElement(uint32_t nameLength)
+{
+	const auto offset = m_stackNames.size();
+	m_stack.pushBack(offset);
+	m_stackNames.resize(offset + nameLength);
+	memcpy(m_stackNames.typedData() + offset, m_pos, nameLength);
+	consume(nameLength);
+
+	m_name = StringView(m_stackNames.typedData() + offset, nameLength);
+	m_value = StringView();
+	m_state = State::Tag;
+	return XMLStreamEvent::StartElement;
+}
+
+XMLStreamEvent XMLStreamReader::closeElement(StringView name)
+{
+	if (m_stack.empty())
+		return reportError(TempString("Unexpected closing tag '{}'", name));
+
+	const auto offset = m_stack.back();
+	const auto openedName = StringView(m_stackNames.typedData() + offset, m_stackNames.size() - offset);
+	if (name && name != openedName)
+		return reportError(TempString("Closing tag '{}' does not match the opened element '{}'", name, openedName));
+
+	m_name = copyName(openedName.data(), openedName.length());
+	m_value = StringView();
+
+	m_stack.popBack();
+	m_stackNames.resize(offset);
+	return XMLStreamEvent::EndElement;
+}
+
+XMLStreamEvent XMLStreamReader::nextInTag()
+{
+	skipWhiteSpaces();
+
+	if (!ensure(1))
+		return reportError("Unexpected end of file inside the element tag");
+
+	// end of the start tag, element's content follows
+	if (*m_pos == '>')
+	{
+		consume(1);
+		m_state = State::Content;
+		return nextInContent();
+	}
+
+	// self closing element
+	if (*m_pos == '/')
+	{
+		if (!ensure(2) || m_pos[1] != '>')
+			return reportError("Expected '/>'");
+
+		consume(2);
+		m_state = State::Content;
+		return closeElement(StringView());
+	}
+
+	// attribute, name is copied since the window may move while we look for the value
+	const auto nameLength = scanName();
+	if (!nameLength)
+		return reportError("Expected attribute name");
+
+	const auto name = copyName(m_pos, nameLength);
+	consume(nameLength);
+
+	skipWhiteSpaces();
+	if (!ensure(1) || *m_pos != '=')
+		return reportError(TempString("Expected '=' after attribute '{}'", name));
+	consume(1);
+
+	skipWhiteSpaces();
+	if (!ensure(1) || (*m_pos != '\"' && *m_pos != '\''))
+		return reportError(TempString("Expected quoted value of attribute '{}'", name));
+
+	const char quote[2] = { *m_pos, 0 };
+	consume(1);
+
+	uint32_t length = 0;
+	if (!find(quote, length))
+		return reportError(TempString("Unterminated value of attribute '{}'", name));
+
+	m_name = name;
+	m_value = decode(m_pos, length);
+	consume(length + 1);
+	return XMLStreamEvent::Attribute;
+}
+
+XMLStreamEvent XMLStreamReader::nextInContent()
+{
+	for (;;)
+	{
+		if (!ensure(1))
+		{
+			if (!m_stack.empty())
+				return reportError(TempString("Unexpected end of file, element '{}' was not closed", StringView(m_stackNames.typedData() + m_stack.back(), m_stackNames.size() - m_stack.back())));
+
+			m_state = State::Done;
+			return XMLStreamEvent::EndOfDocument;
+		}
+
+		// text
+		if (*m_pos != '<')
+		{
+			uint32_t length = 0;
+			if (!find("<", length))
+				length = (uint32_t)(m_end - m_pos);
+
+			const auto* text = m_pos;
+			consume(length);
+
+			if (IsXMLWhiteSpace(text, length))
+				continue;
+
+			if (m_stack.empty())
+				return reportError("Unexpected text outside of the root element");
+
+			m_name = StringView();
+			m_value = decode(text, length);
+			return XMLStreamEvent::Text;
+		}
+
+		if (!ensure(2))
+			return reportError("Unexpected end of file");
+
+		// processing instruction, ie. <?xml ... ?>
+		if (m_pos[1] == '?')
+		{
+			uint32_t offset = 0;
+			if (!find("?>", offset))
+				return reportError("Unterminated processing instruction");
+
+			consume(offset + 2);
+			continue;
+		}
+
+		// comments, CDATA and DOCTYPE
+		if (m_pos[1] == '!')
+		{
+			ensure(9);
+
+			const auto available = (uint32_t)(m_end - m_pos);
+			if (available >= 4 && 0 == memcmp(m_pos, "<!--", 4))
+			{
+				uint32_t offset = 0;
+				if (!find("-->", offset))
+					return reportError("Unterminated comment");
+
+				consume(offset + 3);
+				continue;
+			}
+			else if (available >= 9 && 0 == memcmp(m_pos, "<![CDATA[", 9))
+			{
+				uint32_t offset = 0;
+				if (!find("]]>", offset))
+					return reportError("Unterminated CDATA section");
+
+				const auto* text = m_pos + 9;
+				consume(offset + 3);
+
+				m_name = StringView();
+				m_value = StringView(text, offset - 9);
+				return XMLStreamEvent::Text;
+			}
+			else
+			{
+				uint32_t offset = 0;
+				if (!find(">", offset))
+					return reportError("Unterminated declaration");
+
+				consume(offset + 1);
+				continue;
+			}
+		}
+
+		// closing tag
+		if (m_pos[1] == '/')
+		{
+			consume(2);
+
+			const auto nameLength = scanName();
+			const auto ret = closeElement(StringView(m_pos, nameLength));
+			if (ret == XMLStreamEvent::Error)
+				return ret;
+
+			consume(nameLength);
+			skipWhiteSpaces();
+
+			if (!ensure(1) || *m_pos != '>')
+				return reportError(TempString("Expected '>' after closing tag '{}'", m_name));
+
+			consume(1);
+			return ret;
+		}
+
+		// opening tag
+		consume(1);
+
+		const auto nameLength = scanName();
+		if (!nameLength)
+			return reportError("Expected element name");
+
+		return openElement(nameLength);
+	}
+}
+
+XMLStreamEvent XMLStreamReader::next()
+{
+	if (!m_started)
+	{
+		m_started = true;
+
+		// skip the UTF-8 BOM
+		if (ensure(3) && 0 == memcmp(m_pos, "\xEF\xBB\xBF", 3))
+			m_pos += 3;
+	}
+
+	switch (m_state)
+	{
+		case State::Content:
+			return nextInContent();
+
+		case State::Tag:
+			return nextInTag();
+
+		case State::Done:
+			break;
+	}
+
+	return m_failed ? XMLStreamEvent::Error : XMLStreamEvent::EndOfDocument;
+}
+
+bool XMLStreamReader::skipElement()
+{
+	const auto depth = m_stack.size();
+	DEBUG_CHECK_RETURN_EX_V(depth > 0, "No element to skip", false);
+
+	for (;;)
+	{
+		const auto ret = next();
+		if (ret == XMLStreamEvent::Error || ret == XMLStreamEvent::EndOfDocument)
+			return false;
+
+		if (ret == XMLStreamEvent::EndElement && m_stack.size() < depth)
+			return true;
+	}
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -0,0 +1,168 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "xmlStreamWriter.h"
+#include "xmlWriter.h"
+#include "textFileWriter.h"
+#include "base64StreamEncoding.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+XMLStreamWriter::XMLStreamWriter(IFormatStream& f, PrintFlags flags /*= PrintFlags()*/)
+	: m_stream(&f)
+{
+	init(flags);
+}
+
+XMLStreamWriter::XMLStreamWriter(IFileWriter* file, PrintFlags flags /*= PrintFlags()*/)
+{
+	m_fileWriter = CreateUniquePtr<TextFileWriter>(file);
+	m_stream = m_fileWriter.get();
+	init(flags);
+}
+
+XMLStreamWriter::~XMLStreamWriter()
+{
+	finish();
+}
+
+void XMLStreamWriter::init(PrintFlags flags)
+{
+	m_prettyText = flags.test(PrintFlagBit::PrettyText);
+
+	if (!flags.test(PrintFlagBit::NoHeader))
+	{
+		m_stream->append("<?xml version=\"1.0\" standalone=\"yes\"?>");
+		if (m_prettyText)
+			m_stream->append("\n");
+	}
+}
+
+//--
+
+void XMLStreamWriter::closeStartTag()
+{
+	prv::FinishBase64(*m_stream, m_dataCarry, m_dataCarrySize);
+
+	if (m_tagOpen)
+	{
+		m_stream->append(">");
+		m_tagOpen = false;
+	}
+}
+
+void XMLStreamWriter::beginNode(StringView name)
+{
+	DEBUG_CHECK_RETURN_EX(name, "Invalid node name");
+
+	if (!m_stack.empty())
+	{
+		auto& parent = m_stack.back();
+		if (m_tagOpen)
+		{
+			closeStartTag();
+			if (m_prettyText)
+				m_stream->append("\n");
+		}
+		else
+		{
+			prv::FinishBase64(*m_stream, m_dataCarry, m_dataCarrySize);
+		}
+
+		parent.hasChildren = true;
+	}
+
+	if (m_prettyText)
+		m_stream->appendPadding(' ', m_stack.size() * 2);
+
+	m_stream->append("<");
+	m_stream->append(name.data(), name.length());
+
+	auto& level = m_stack.emplaceBack();
+	level.nameOffset = m_stackNames.size();
+	level.nameLength = name.length();
+
+	m_stackNames.resize(level.nameOffset + level.nameLength);
+	memcpy(m_stackNames.typedData() + level.nameOffset, name.data(), name.length());
+
+	m_tagOpen = true;
+}
+
+void XMLStreamWriter::attribute(StringView name, StringView value)
+{
+	DEBUG_CHECK_RETURN_EX(name, "Invalid attribute name");
+	DEBUG_CHECK_RETURN_EX(m_tagOpen, "Attributes must be written before the node's content");
+
+	m_stream->append(" ");
+	m_stream->append(name.data(), name.length());
+	m_stream->append("=\"");
+	XMLWriter::PrintText(*m_stream, value);
+	m_stream->append("\"");
+}
+
+void XMLStreamWriter::text(StringView value)
+{
+	DEBUG_CHECK_RETURN_EX(!m_stack.empty(), "No node opened");
+
+	closeStartTag();
+	XMLWriter::PrintText(*m_stream, value);
+}
+
+void XMLStreamWriter::appendData(BufferView data)
+{
+	DEBUG_CHECK_RETURN_EX(!m_stack.empty(), "No node opened");
+
+	if (m_tagOpen)
+		closeStartTag();
+
+	prv::AppendBase64(*m_stream, data, m_dataCarry, m_dataCarrySize);
+}
+
+void XMLStreamWriter::endNode()
+{
+	DEBUG_CHECK_RETURN_EX(!m_stack.empty(), "No node opened");
+
+	prv::FinishBase64(*m_stream, m_dataCarry, m_dataCarrySize);
+
+	const auto level = m_stack.back();
+	m_stack.popBack();
+
+	if (m_tagOpen)
+	{
+		m_stream->append("/>");
+		m_tagOpen = false;
+	}
+	else
+	{
+		if (level.hasChildren && m_prettyText)
+			m_stream->appendPadding(' ', m_stack.size() * 2);
+
+		m_stream->append("</");
+		m_stream->append(m_stackNames.typedData() + level.nameOffset, level.nameLength);
+		m_stream->append(">");
+	}
+
+	if (m_prettyText)
+		m_stream->append("\n");
+
+	m_stackNames.resize(level.nameOffset);
+}
+
+void XMLStreamWriter::finish()
+{
+	while (!m_stack.empty())
+		endNode();
+
+	if (m_fileWriter)
+		m_fileWriter->flush();
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -6,6 +6,7 @@
 
 #include "build.h"
 #include "xmlWriter.h"
+#include "xmlBinaryFormat.h"
 #include "textFileWriter.h"
 
 BEGIN_INFERNO_NAMESPACE()
@@ -410,6 +411,11 @@ static void WriteString(IFormatStream& f, StringView txt)
 	}
 }
 
+void XMLWriter::PrintText(IFormatStream& f, StringView txt)
+{
+	WriteString(f, txt);
+}
+
 void XMLWriter::SaveToTextFileNode(const Node* node, IFormatStream& f, uint32_t depth, bool prettyText)
 {
 	// get name of the node, the invalid nodes have no name
@@ -509,6 +515,135 @@ Buffer XMLWriter::printToBuffer(NodeHandle id, PrintFlags flags /*= PrintFlags()
 
 //--
 
+Buffer XMLWriter::saveToBinaryBuffer(NodeHandle id, IPoolUnmanaged& pool /*= MainPool()*/) const
+{
+	auto root = ToNodePtr(id);
+	DEBUG_CHECK_RETURN_EX_V(root, "Invalid node", nullptr);
+
+	// intern all strings, the names repeat a lot
+	HashMap<StringView, uint32_t> stringMap;
+	Array<prv::BinaryXMLString> strings;
+	uint32_t charactersSize = 0;
+
+	auto internString = [&stringMap, &strings, &charactersSize](StringView txt) -> uint32_t
+	{
+		uint32_t index = 0;
+		if (!stringMap.find(txt, index))
+		{
+			index = strings.size();
+			stringMap[txt] = index;
+
+			auto& entry = strings.emplaceBack();
+			entry.offset = charactersSize;
+			entry.length = txt.length();
+			charactersSize += txt.length() + 1;
+		}
+
+		return index;
+	};
+
+	// flatten the nodes breadth first, children of every node end up in one continuous range
+	Array<const Node*> sourceNodes;
+	Array<prv::BinaryXMLNode> nodes;
+	Array<prv::BinaryXMLAttribute> attributes;
+	Array<BufferView> blobs;
+	uint32_t blobsSize = 0;
+
+	{
+		auto& entry = nodes.emplaceBack();
+		entry.parent = prv::BINARY_XML_INVALID;
+		entry.nextSibling = prv::BINARY_XML_INVALID;
+		sourceNodes.pushBack(root);
+	}
+
+	for (uint32_t i = 0; i < sourceNodes.size(); ++i)
+	{
+		const auto* source = sourceNodes[i];
+
+		auto& node = nodes[i];
+		node.name = internString(source->name);
+		node.firstChild = source->firstChild ? sourceNodes.size() : prv::BINARY_XML_INVALID;
+		node.firstAttribute = attributes.size();
+		node.numAttributes = 0;
+		node.text = source->value.text ? internString(source->value.text) : prv::BINARY_XML_INVALID;
+		node.blobOffset = 0;
+		node.blobSize = 0;
+
+		if (source->value.data)
+		{
+			blobsSize = Align<uint32_t>(blobsSize, prv::BINARY_XML_BLOB_ALIGNMENT);
+			node.blobOffset = blobsSize;
+			node.blobSize = (uint32_t)source->value.data.size();
+			blobsSize += node.blobSize;
+			blobs.pushBack(source->value.data);
+		}
+
+		for (const auto* attr = source->firstAttribute; attr; attr = attr->next)
+		{
+			auto& entry = attributes.emplaceBack();
+			entry.node = i;
+			entry.name = internString(attr->name);
+			entry.value = internString(attr->value);
+			node.numAttributes += 1;
+		}
+
+		for (const auto* child = source->firstChild; child; child = child->nextChild)
+		{
+			auto& entry = nodes.emplaceBack();
+			entry.parent = i;
+			entry.nextSibling = child->nextChild ? nodes.size() : prv::BINARY_XML_INVALID;
+			sourceNodes.pushBack(child);
+		}
+	}
+
+	// compute layout
+	prv::BinaryXMLHeader header;
+	memzero(&header, sizeof(header));
+	memcpy(header.magic, "BINXML", 6);
+	header.version = prv::BINARY_XML_VERSION;
+	header.numStrings = strings.size();
+	header.numNodes = nodes.size();
+	header.numAttributes = attributes.size();
+	header.stringTableOffset = sizeof(header);
+	header.nodeTableOffset = header.stringTableOffset + (uint32_t)strings.dataSize();
+	header.attributeTableOffset = header.nodeTableOffset + (uint32_t)nodes.dataSize();
+	header.charactersOffset = header.attributeTableOffset + (uint32_t)attributes.dataSize();
+	header.charactersSize = charactersSize;
+	header.blobsOffset = Align<uint32_t>(header.charactersOffset + charactersSize, prv::BINARY_XML_BLOB_ALIGNMENT);
+	header.blobsSize = blobsSize;
+	header.totalSize = header.blobsOffset + blobsSize;
+
+	auto ret = Buffer::CreateEmpty(pool, header.totalSize, prv::BINARY_XML_BLOB_ALIGNMENT, BufferInitState::ClearToZero);
+	DEBUG_CHECK_RETURN_EX_V(ret, "Out of memory", nullptr);
+
+	// write everything
+	auto* base = ret.data();
+	memcpy(base, &header, sizeof(header));
+	memcpy(base + header.stringTableOffset, strings.data(), strings.dataSize());
+	memcpy(base + header.nodeTableOffset, nodes.data(), nodes.dataSize());
+	memcpy(base + header.attributeTableOffset, attributes.data(), attributes.dataSize());
+
+	for (const auto& pair : stringMap.pairs())
+	{
+		const auto& entry = strings[pair.value];
+		memcpy(base + header.charactersOffset + entry.offset, pair.key.data(), entry.length);
+	}
+
+	uint32_t blobIndex = 0;
+	for (const auto& node : nodes)
+	{
+		if (node.blobSize)
+		{
+			const auto& blob = blobs[blobIndex++];
+			memcpy(base + header.blobsOffset + node.blobOffset, blob.data(), blob.size());
+		}
+	}
+
+	return ret;
+}
+
+//--
+
 XMLWriterPtr XMLWriter::Create(StringView rootName /*= "document"*/, IPoolPaged& pool /*= LocalPagePool()*/)
 {
 	return RefNew<XMLWriter>(pool, rootName);
@@ -67,8 +67,8 @@ public:
 	// append numbers in various formats
 	static void PrintNumber(IFormatStream& f, char sign, uint64_t val, char padding=0, int wholeDigits=-1);
 	static void PrintNumberF(IFormatStream& f, char sign, double val, char padding=0, int wholeDigits= -1, int fractionDigits=-1);
-    static void PrintPreciseNumber(IFormatStream& f, float val); // prints exactly the amount of digits to preserve BIT PERFECT precision
-    static void PrintPreciseNumber(IFormatStream& f, double val); // prints exactly the amount of digits to preserve BIT PERFECT precision
+    static void PrintPreciseNumber(IFormatStream& f, float val); // prints the shortest amount of digits that preserves BIT PERFECT precision
+    static void PrintPreciseNumber(IFormatStream& f, double val); // prints the shortest amount of digits that preserves BIT PERFECT precision
     static void PrintPointer(IFormatStream& f, const void* ptr);
     static void PrintHexData(IFormatStream& f, const void* ptr, uint32_t size);
     static void PrintHexNumber(IFormatStream& f, uint64_t value, char paddingChar=0, int wholeDigits=-1);
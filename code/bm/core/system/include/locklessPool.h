@@ -10,6 +10,8 @@ BEGIN_INFERNO_NAMESPACE()
 
 //--
 
+/// Bounded lock less free list of indices, multiple producers and multiple consumers can use it at the same time
+/// Based on the bounded MPMC queue by Dmitry Vyukov: each slot has a sequence number that tells if it's ready to be read or written
 /// NOTE: will fatal assert if limits are exceeded
 template< uint32_t MAX, typename TIndex = uint32_t >
 class LockLessPoolAllocator : public NoCopy
@@ -20,23 +22,45 @@ public:
 
     //--
 
-    // reset state
+    // reset state, NOT thread safe
     INLINE void reset();
 
-    // allocate next free entry
+    // allocate next free entry, asserts if there are no free entries
     INLINE TIndex allocEntry();
 
+    // allocate next free entry, returns false if there are no free entries
+    INLINE bool tryAllocEntry(TIndex& outIndex);
+
     // return entry to pool
     INLINE void freeEntry(TIndex index);
 
     //--
 
 private:
-    static const auto SENTINEL = std::numeric_limits<TIndex>::max();
-
-    std::atomic<uint32_t> m_pushCounter;
-    std::atomic<uint32_t> m_popCounter;
-    TIndex m_freeList[MAX];
+    static constexpr uint32_t CalcCapacity()
+    {
+        uint32_t ret = 1;
+        while (ret < MAX)
+            ret <<= 1;
+        return ret;
+    }
+
+    static const uint32_t CAPACITY = CalcCapacity();
+    static const uint32_t MASK = CAPACITY - 1;
+
+    static_assert(MAX > 0, "Pool can't be empty");
+    static_assert((uint64_t)(MAX - 1) <= (uint64_t)std::numeric_limits<TIndex>::max(), "Index type is to small for the pool size");
+
+    struct Slot
+    {
+        std::atomic<uint32_t> sequence;
+        TIndex index;
+    };
+
+    // counters are on separate cache lines so allocations and frees don't fight each other
+    alignas(64) std::atomic<uint32_t> m_allocPos;
+    alignas(64) std::atomic<uint32_t> m_freePos;
+    alignas(64) Slot m_slots[CAPACITY];
 };
 
 //--
@@ -54,6 +78,9 @@ public:
     // allocate next free entry (calls constructor)
     INLINE T* alloc();
 
+    // allocate next free entry (calls constructor), returns nullptr if pool is full
+    INLINE T* tryAlloc();
+
     // deallocate entry (calls destructor)
     INLINE void free(T* ptr);
 
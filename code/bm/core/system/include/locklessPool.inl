@@ -10,63 +10,132 @@ BEGIN_INFERNO_NAMESPACE()
 
 //--
 
-template< uint32_t MAX, typename TIndex = uint32_t >
+template< uint32_t MAX, typename TIndex >
 INLINE LockLessPoolAllocator<MAX, TIndex>::LockLessPoolAllocator()
 {
     reset();
 }
 
-template< uint32_t MAX, typename TIndex = uint32_t >
+template< uint32_t MAX, typename TIndex >
 INLINE LockLessPoolAllocator<MAX, TIndex>::~LockLessPoolAllocator()
 {}
 
-template< uint32_t MAX, typename TIndex = uint32_t >
+template< uint32_t MAX, typename TIndex >
 INLINE void LockLessPoolAllocator<MAX, TIndex>::reset()
 {
-    m_popCounter = 0;
-    m_pushCounter = MAX - 1;
+    // all entries are free, slot with sequence equal to position+1 is ready to be read, slot with sequence equal to position is ready to be written
+    for (uint32_t i = 0; i < CAPACITY; ++i)
+    {
+        m_slots[i].index = (TIndex)((i < MAX) ? i : 0);
+        m_slots[i].sequence.store((i < MAX) ? (i + 1) : i, std::memory_order_relaxed);
+    }
+
+    m_allocPos.store(0, std::memory_order_relaxed);
+    m_freePos.store(MAX, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+}
 
-    for (uint32_t i = 0; i < MAX; ++i)
-        m_freeList[i] = (TIndex)i;
-    m_freeList[MAX - 1] = SENTINEL;
+template< uint32_t MAX, typename TIndex >
+INLINE bool LockLessPoolAllocator<MAX, TIndex>::tryAllocEntry(TIndex& outIndex)
+{
+    auto pos = m_allocPos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto& slot = m_slots[pos & MASK];
+        const auto seq = slot.sequence.load(std::memory_order_acquire);
+        const auto diff = (int32_t)(seq - (pos + 1));
+
+        if (diff == 0)
+        {
+            // slot is ready to be read, claim it
+            if (m_allocPos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                outIndex = slot.index;
+
+                // slot can be written again on the next lap
+                slot.sequence.store(pos + CAPACITY, std::memory_order_release);
+                return true;
+            }
+        }
+        else if (diff < 0)
+        {
+            // nothing was written here yet - pool is empty, unless some thread is just freeing an entry into this slot
+            if ((int32_t)(m_freePos.load(std::memory_order_acquire) - pos) <= 0)
+                return false;
+
+            _mm_pause();
+            pos = m_allocPos.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            // other thread got here first
+            pos = m_allocPos.load(std::memory_order_relaxed);
+        }
+    }
 }
 
-template< uint32_t MAX, typename TIndex = uint32_t >
+template< uint32_t MAX, typename TIndex >
 INLINE TIndex LockLessPoolAllocator<MAX, TIndex>::allocEntry()
 {
-    std::atomic_thread_fence(std::memory_order_acquire); // aquire needed for the current state
-    auto position = m_popCounter++ % MAX;
-    ASSERT_EX(m_freeList[position] != SENTINEL, "All elements from lock less pool were consumed");
-    auto index = m_freeList[position];
-    m_freeList[position] = SENTINEL;
-    std::atomic_thread_fence(std::memory_order_release); // release needed for the updated state
+    TIndex index = 0;
+    const auto allocated = tryAllocEntry(index);
+    ASSERT_EX(allocated, "All elements from lock less pool were consumed");
     return index;
 }
 
-template< uint32_t MAX, typename TIndex = uint32_t >
+template< uint32_t MAX, typename TIndex >
 INLINE void LockLessPoolAllocator<MAX, TIndex>::freeEntry(TIndex index)
 {
-    std::atomic_thread_fence(std::memory_order_acquire); // aquire needed for the current state
-    auto position = m_pushCounter++ % MAX; // NOTE: we don't care if we support picking up the MAX-1 element, working at 99% of capacity is not a feature if this LockLessPool anyway
-    ASSERT_EX(m_freeList[position] == SENTINEL, "Free list corruption - pushed to many elements");
-    m_freeList[position] = index;
-    std::atomic_thread_fence(std::memory_order_release);// release needed for the updated state
+    ASSERT_EX((uint32_t)index < MAX, "Index outside of the pool");
+
+    auto pos = m_freePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        auto& slot = m_slots[pos & MASK];
+        const auto seq = slot.sequence.load(std::memory_order_acquire);
+        const auto diff = (int32_t)(seq - pos);
+
+        if (diff == 0)
+        {
+            // slot is ready to be written, claim it
+            if (m_freePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+            {
+                slot.index = index;
+
+                // slot can be read now
+                slot.sequence.store(pos + 1, std::memory_order_release);
+                return;
+            }
+        }
+        else if (diff < 0)
+        {
+            // slot from previous lap is being allocated right now, there are never more free entries than the capacity so it's just a matter of time
+            ASSERT_EX((int32_t)(pos - m_allocPos.load(std::memory_order_relaxed)) < (int32_t)CAPACITY, "Free list corruption - pushed to many elements");
+            _mm_pause();
+            pos = m_freePos.load(std::memory_order_relaxed);
+        }
+        else
+        {
+            // other thread got here first
+            pos = m_freePos.load(std::memory_order_relaxed);
+        }
+    }
 }
     
 //--
 
 /// Lock less pool of static size for objects 
-template< typename T, uint32_t MAX, typename TIndex = uint32_t >
+template< typename T, uint32_t MAX, typename TIndex >
 INLINE LockLessPool<T, MAX, TIndex>::LockLessPool()
 {}
 
 
-template< typename T, uint32_t MAX, typename TIndex = uint32_t >
+template< typename T, uint32_t MAX, typename TIndex >
 INLINE LockLessPool<T, MAX, TIndex>::~LockLessPool()
 {
 }
 
-template< typename T, uint32_t MAX, typename TIndex = uint32_t >
+template< typename T, uint32_t MAX, typename TIndex >
 INLINE T* LockLessPool<T, MAX, TIndex>::alloc()
 {
     auto index = m_indices.allocEntry();
@@ -74,12 +143,23 @@ INLINE T* LockLessPool<T, MAX, TIndex>::alloc()
     return new(mem) T();
 }
 
-template< typename T, uint32_t MAX, typename TIndex = uint32_t >
+template< typename T, uint32_t MAX, typename TIndex >
+INLINE T* LockLessPool<T, MAX, TIndex>::tryAlloc()
+{
+    TIndex index = 0;
+    if (!m_indices.tryAllocEntry(index))
+        return nullptr;
+
+    auto* mem = m_storage + (index * sizeof(T));
+    return new(mem) T();
+}
+
+template< typename T, uint32_t MAX, typename TIndex >
 INLINE void LockLessPool<T, MAX, TIndex>::free(T* ptr)
 {
     ptr->~T();
     auto index = ptr - (T*)m_storage;
-    m_indices.freeEntry(index);
+    m_indices.freeEntry((TIndex)index);
 }
 
 //--
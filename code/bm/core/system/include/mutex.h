@@ -6,13 +6,24 @@
 
 #pragma once
 
+#include "atomic.h"
+
 BEGIN_INFERNO_NAMESPACE()
 
 //-----------------------------------------------------------------------------
 
 class ConditionVariable;
 
+/// Contention statistics of a lock
+struct MutexStats
+{
+	uint64_t numAcquires = 0; //!< Number of times the lock was acquired
+	uint64_t numContentions = 0; //!< Number of times the lock was already taken when we tried to acquire it
+	uint64_t numWaits = 0; //!< Number of times spinning was not enough and we had to sleep (on Windows the critical section hides that so it's equal to numContentions)
+};
+
 /// Simple critical section
+/// NOTE: the mutex is recursive, same thread can acquire it many times
 class BM_CORE_SYSTEM_API Mutex : public NoCopy
 {
 public:
@@ -25,15 +36,28 @@ public:
 	//! Releases the lock on the critical section
 	void release();
 
-	//! Set spin count for critical section
+	//! Set spin count for critical section, on POSIX it's the limit for the adaptive spinning
 	void spinCount(uint32_t spinCount);
 
+	//! Get contention statistics
+	MutexStats stats() const;
+
 private:
 	union {
 		void* handle;
 		uint8_t data[64];
 	} m_data;
 
+	//! Release the lock completely before waiting on condition variable, returns the recursion count to restore
+	uint32_t releaseForWait();
+
+	//! Acquire the lock back after waiting on condition variable
+	void acquireAfterWait(uint32_t recursion);
+
+	std::atomic<uint64_t> m_numAcquires = 0;
+	std::atomic<uint64_t> m_numContentions = 0;
+	std::atomic<uint64_t> m_numWaits = 0;
+
 	friend class ConditionVariable;
 };
 
@@ -28,6 +28,24 @@ enum class LogOutputLevel : uint8_t
 
 //-----------------------------------------------------------------------------
 
+//! what to do with a line in the async mode when the thread's buffer is full
+enum class LogAsyncOverflow : uint8_t
+{
+    Wait, // wait for the background thread to print some lines (backpressure), nothing is lost
+    Drop, // drop the line, dropped lines are counted
+    PrintDirectly, // print the line synchronously, skipping the queue (the order of lines may change)
+};
+
+//! setup of async logging
+struct BM_CORE_SYSTEM_API LogAsyncSetup
+{
+    uint32_t m_threadBufferSize = 64 << 10; // size of the per-thread line buffer
+    uint32_t m_flushInterval = 10; // how often (ms) the background thread prints the lines if the buffers are not getting full
+    LogAsyncOverflow m_overflow = LogAsyncOverflow::Wait;
+};
+
+//-----------------------------------------------------------------------------
+
 // log sink, receives lines and lines only
 class BM_CORE_SYSTEM_API ILogSink : public NoCopy
 {
@@ -95,6 +113,21 @@ public:
 
     // report fatal error
     static bool FatalError(const char* fileName, uint32_t fileLine, const char* txt);
+
+    //--
+
+    /// enable async logging: lines are written to per-thread lock-free buffers and printed to the global sinks by a background thread
+    /// NOTE: the local sinks are still called directly, the order of lines is only preserved for lines from the same thread
+    static void EnableAsync(const LogAsyncSetup& setup = LogAsyncSetup());
+
+    /// disable async logging, all pending lines are printed first
+    static void DisableAsync();
+
+    /// print all lines pending in the async buffers, done automatically before printing fatal errors and asserts
+    static void Flush();
+
+    /// number of lines dropped in the async mode because the buffers were full
+    static uint64_t NumDroppedLines();
 };
 
 END_INFERNO_NAMESPACE()
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "atomic.h"
+
 BEGIN_INFERNO_NAMESPACE()
 
 //--
@@ -48,7 +50,21 @@ private:
 
 //--
 
+/// Contention statistics of a RW lock
+/// NOTE: shared acquisitions are not counted, that would make the readers fight over one more cache line
+struct RWLockStats
+{
+	uint64_t numExclusiveAcquires = 0; //!< Number of times the lock was acquired for writing
+	uint64_t numSharedContentions = 0; //!< Number of times a reader had to wait for a writer
+	uint64_t numExclusiveContentions = 0; //!< Number of times a writer had to wait for other writer or readers
+	uint64_t numWaits = 0; //!< Number of times spinning was not enough and we had to sleep (both sides)
+};
+
+//--
+
 /// RW lock, platform specific implementation
+/// NOTE: writers have preference, once a writer is waiting new readers are not let in
+/// NOTE: the lock is NOT recursive, on either side
 class BM_CORE_SYSTEM_API RWLock : public NoCopy
 {
 public:
@@ -61,9 +77,13 @@ public:
 	void acquireExclusive();
 	void releaseExclusive();
 
-	INLINE RWLockReadProxy shared() const { return RWLockReadProxy((RWLock&)* this); }
-	INLINE RWLockWriteProxy exclusive() const { return RWLockWriteProxy((RWLock&)*this); }
+	/// get contention statistics
+	RWLockStats stats() const;
 
+	/// proxies to use with CreateLock, ie: auto lock = CreateLock(m_lock.shared());
+	/// NOTE: the proxies are members so the ScopeLock never points to a temporary
+	INLINE const RWLockReadProxy& shared() const { return m_sharedProxy; }
+	INLINE const RWLockWriteProxy& exclusive() const { return m_exclusiveProxy; }
 
 private:
 	union {
@@ -71,6 +91,14 @@ private:
 		uint8_t data[64];
 	} m_data;
 
+	RWLockReadProxy m_sharedProxy;
+	RWLockWriteProxy m_exclusiveProxy;
+
+	std::atomic<uint64_t> m_numExclusiveAcquires = 0;
+	std::atomic<uint64_t> m_numSharedContentions = 0;
+	std::atomic<uint64_t> m_numExclusiveContentions = 0;
+	std::atomic<uint64_t> m_numWaits = 0;
+
 	friend class ConditionVariable;
 };
 
@@ -95,10 +123,9 @@ INLINE void RWLockWriteProxy::acquire()
 
 INLINE void RWLockWriteProxy::release()
 {
-	m_lock.acquireExclusive();
+	m_lock.releaseExclusive();
 }
 
 //--
 
 END_INFERNO_NAMESPACE()
-
@@ -13,7 +13,7 @@ BEGIN_INFERNO_NAMESPACE()
 
 //-----------------------------------------------------------------------------
 
-/// Simple spin lock
+/// Simple spin lock, spins with exponential backoff and goes to sleep if the lock is held for too long
 /// NOTE: spin lock can't be acquired between fibers
 class BM_CORE_SYSTEM_API SpinLock : public NoCopy
 {
@@ -24,7 +24,7 @@ public:
     void release();
 
 private:
-    std::atomic<bool> lock_;
+    std::atomic<uint32_t> lock_; // 0 - unlocked, 1 - locked, 2 - locked and there may be sleeping threads
 };
 
 //-----------------------------------------------------------------------------
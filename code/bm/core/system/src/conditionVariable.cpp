@@ -8,11 +8,32 @@
 #include "private.h"
 #include "mutex.h"
 #include "conditionVariable.h"
+#include "futex.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
 //---
 
+#ifdef PLATFORM_POSIX
+namespace prv
+{
+    // futex based condition variable, waiters sleep on a sequence number that is bumped on every wake up
+    struct FutexConditionVariable
+    {
+        std::atomic<uint32_t> seq;
+        std::atomic<uint32_t> numWaiters; // wake ups are only issued when someone is actually waiting
+    };
+
+    static void WakeFutexConditionVariable(FutexConditionVariable* cv, uint32_t count)
+    {
+        cv->seq.fetch_add(1);
+        if (cv->numWaiters.load())
+            FutexWake(cv->seq, count);
+    }
+
+} // prv
+#endif
+
 ConditionVariable::ConditionVariable()
 {
 	memzero(&m_data, sizeof(m_data));
@@ -21,8 +42,10 @@ ConditionVariable::ConditionVariable()
 	static_assert(sizeof(m_data) >= sizeof(CONDITION_VARIABLE), "Critical section data to small");
 	InitializeConditionVariable((CONDITION_VARIABLE*)&m_data);
 #elif defined(PLATFORM_POSIX)
-	static_assert(sizeof(m_data) >= sizeof(pthread_mutex_t), "Critical section data to small");
-
+	static_assert(sizeof(m_data) >= sizeof(prv::FutexConditionVariable), "Condition variable data to small");
+	auto* cv = new (&m_data) prv::FutexConditionVariable();
+	cv->seq = 0;
+	cv->numWaiters = 0;
 #elif defined(PLATFORM_PSX)
 	static_assert(sizeof(m_data) >= sizeof(ScePthreadMutex), "Critical section data to small");
 #else
@@ -35,7 +58,7 @@ ConditionVariable::~ConditionVariable()
 #ifdef PLATFORM_WINDOWS
     // nothing
 #elif defined(PLATFORM_POSIX)
-    // TODO
+    DEBUG_CHECK_EX(((prv::FutexConditionVariable*)&m_data)->numWaiters.load() == 0, "Destroying condition variable that is still waited on");
 #elif defined(PLATFORM_PSX)
 	// TODO
 #else
@@ -50,7 +73,7 @@ bool ConditionVariable::waitInfinite(Mutex& m)
     auto* cs = (CRITICAL_SECTION*)&m.m_data;
     return SleepConditionVariableCS(cv, cs, INFINITE);
 #elif defined(PLATFORM_POSIX)
-	// TODO
+	return wait(m, prv::FUTEX_INFINITE);
 #elif defined(PLATFORM_PSX)
 	// TODO
 #else
@@ -65,7 +88,18 @@ bool ConditionVariable::wait(Mutex& m, uint32_t ms)
 	auto* cs = (CRITICAL_SECTION*)&m.m_data;
 	return SleepConditionVariableCS(cv, cs, ms);
 #elif defined(PLATFORM_POSIX)
-	// TODO
+	auto* cv = (prv::FutexConditionVariable*)&m_data;
+
+	// NOTE: both happen with the mutex held so no wake up can be lost
+	cv->numWaiters.fetch_add(1);
+	const auto seq = cv->seq.load();
+
+	const auto recursion = m.releaseForWait();
+	const auto ret = prv::FutexWait(cv->seq, seq, ms);
+	m.acquireAfterWait(recursion);
+
+	cv->numWaiters.fetch_sub(1);
+	return ret;
 #elif defined(PLATFORM_PSX)
 	// TODO
 #else
@@ -79,7 +113,7 @@ void ConditionVariable::wakeAll()
 	auto* cv = (CONDITION_VARIABLE*)&m_data;
 	return WakeAllConditionVariable(cv);
 #elif defined(PLATFORM_POSIX)
-	// TODO
+	prv::WakeFutexConditionVariable((prv::FutexConditionVariable*)&m_data, INT32_MAX);
 #elif defined(PLATFORM_PSX)
 	// TODO
 #else
@@ -93,7 +127,7 @@ void ConditionVariable::wakeOne()
 	auto* cv = (CONDITION_VARIABLE*)&m_data;
 	return WakeConditionVariable(cv);
 #elif defined(PLATFORM_POSIX)
-	// TODO
+	prv::WakeFutexConditionVariable((prv::FutexConditionVariable*)&m_data, 1);
 #elif defined(PLATFORM_PSX)
 	// TODO
 #else
@@ -8,6 +8,7 @@
 #include "format.h"
 
 #include <stdarg.h>
+#include <charconv>
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -57,6 +58,19 @@ namespace prv
     }
 
 	static const char* BASE10_DIGITS = "0123456789";
+
+    // all two digit numbers, allows to convert integer numbers two digits at a time
+    static const char* BASE10_DIGIT_PAIRS =
+        "00010203040506070809"
+        "10111213141516171819"
+        "20212223242526272829"
+        "30313233343536373839"
+        "40414243444546474849"
+        "50515253545556575859"
+        "60616263646566676869"
+        "70717273747576777879"
+        "80818283848586878889"
+        "90919293949596979899";
     static const char* BASE16_DIGITS_SMALL = "0123456789abcdef";
     static const char* BASE16_DIGITS_BIG =   "0123456789ABCDEF";
 
@@ -74,11 +88,26 @@ namespace prv
 
         ALWAYS_INLINE void print(uint64_t val)
         {
-            do
+            // NOTE: digits are written in reverse order
+            while (val >= 100)
             {
-                m_txt[m_pos++] = BASE10_DIGITS[val % 10];
-                val /= 10;
-            } while (val);
+                const auto* pair = BASE10_DIGIT_PAIRS + (val % 100) * 2;
+                val /= 100;
+
+                m_txt[m_pos++] = pair[1];
+                m_txt[m_pos++] = pair[0];
+            }
+
+            if (val >= 10)
+            {
+                const auto* pair = BASE10_DIGIT_PAIRS + val * 2;
+                m_txt[m_pos++] = pair[1];
+                m_txt[m_pos++] = pair[0];
+            }
+            else
+            {
+                m_txt[m_pos++] = BASE10_DIGITS[val];
+            }
         }
 
         ALWAYS_INLINE void pad(char sign, char pad, int count)
@@ -413,7 +442,12 @@ void IFormatStream::PrintNumberF(IFormatStream& f, char sign, double val, char p
 
 void IFormatStream::PrintPreciseNumber(IFormatStream& f, float val)
 {
-#if 1
+#if defined(__cpp_lib_to_chars)
+    // shortest representation that reads back to the same value, does not depend on the locale
+    char buffer[64];
+    const auto ret = std::to_chars(buffer, buffer + sizeof(buffer), val);
+    f.append(buffer, range_cast<uint32_t>(ret.ptr - buffer));
+#elif 1
     char buffer[128];
     sprintf_s(buffer, "%.9g", val);
     f << buffer;
@@ -444,7 +478,12 @@ void IFormatStream::PrintPreciseNumber(IFormatStream& f, float val)
 
 void IFormatStream::PrintPreciseNumber(IFormatStream& f, double val)
 {
-#if 1
+#if defined(__cpp_lib_to_chars)
+	// shortest representation that reads back to the same value, does not depend on the locale
+	char buffer[64];
+	const auto ret = std::to_chars(buffer, buffer + sizeof(buffer), val);
+	f.append(buffer, range_cast<uint32_t>(ret.ptr - buffer));
+#elif 1
 	char buffer[128];
 	sprintf_s(buffer, "%.17g", val);
 	f << buffer;
@@ -0,0 +1,70 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "private.h"
+
+#ifdef PLATFORM_LINUX
+    #include <linux/futex.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+    #include <errno.h>
+    #include <time.h>
+#elif defined(PLATFORM_POSIX)
+    #error "Futex wrappers are only implemented for Linux, add the platform's wait-on-address primitive"
+#endif
+
+BEGIN_INFERNO_NAMESPACE()
+
+//---
+
+namespace prv
+{
+#ifdef PLATFORM_LINUX
+
+    // sleep as long as the value of the word is equal to the expected one (may wake up spuriously)
+    INLINE void FutexWait(std::atomic<uint32_t>& word, uint32_t expected)
+    {
+        static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t), "Futex word must be a plain 32-bit integer");
+        syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAIT_PRIVATE, expected, nullptr, nullptr, 0);
+    }
+
+    static const uint32_t FUTEX_INFINITE = ~0U;
+
+    // sleep as long as the value of the word is equal to the expected one but no longer than given time, returns false on timeout
+    INLINE bool FutexWait(std::atomic<uint32_t>& word, uint32_t expected, uint32_t timeoutMs)
+    {
+        struct timespec timeout;
+        timeout.tv_sec = timeoutMs / 1000;
+        timeout.tv_nsec = (timeoutMs % 1000) * 1000000;
+
+        const auto* timeoutPtr = (timeoutMs != FUTEX_INFINITE) ? &timeout : nullptr;
+        if (0 == syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAIT_PRIVATE, expected, timeoutPtr, nullptr, 0))
+            return true;
+
+        return errno != ETIMEDOUT;
+    }
+
+    // wake up at most the given number of threads sleeping on the word
+    INLINE void FutexWake(std::atomic<uint32_t>& word, uint32_t count)
+    {
+        syscall(SYS_futex, (uint32_t*)&word, FUTEX_WAKE_PRIVATE, count, nullptr, nullptr, 0);
+    }
+
+#endif
+
+    // increment a statistic counter that is only written while the lock is held, no need for a locked instruction
+    INLINE void IncrementLockedStat(std::atomic<uint64_t>& counter)
+    {
+        counter.store(counter.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+    }
+
+} // prv
+
+//---
+
+END_INFERNO_NAMESPACE()
@@ -7,9 +7,92 @@
 #include "build.h"
 #include "mutex.h"
 #include "private.h"
+#include "futex.h"
+#include "thread.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
+#ifdef PLATFORM_POSIX
+namespace prv
+{
+    static const uint32_t MUTEX_DEFAULT_SPIN_COUNT = 100;
+
+    // futex based mutex, based on "Futexes Are Tricky" by U. Drepper, with owner tracking for recursion
+    struct FutexMutex
+    {
+        std::atomic<uint32_t> state; // 0 - unlocked, 1 - locked, 2 - locked and there may be sleeping threads
+        std::atomic<ThreadID> owner; // only ever equal to our ID if we hold the lock
+        uint32_t recursion; // number of times the owner acquired the lock
+        std::atomic<uint32_t> maxSpinCount; // limit of the spinning before going to sleep
+        std::atomic<uint32_t> spinCount; // running average of the spinning that was required to get the lock, read by any contending thread but written only with the lock held (relaxed, it's just a hint)
+    };
+
+    // thread ID without the syscall
+    static ThreadID CachedThreadID()
+    {
+        static thread_local ThreadID GThreadID = 0;
+        if (!GThreadID)
+            GThreadID = Thread::CurrentThreadID();
+        return GThreadID;
+    }
+
+    static void LockFutexMutex(FutexMutex* m, std::atomic<uint64_t>& numContentions, std::atomic<uint64_t>& numWaits)
+    {
+        uint32_t c = 0;
+        if (m->state.compare_exchange_strong(c, 1, std::memory_order_acquire))
+            return;
+
+        // adaptive spinning: spin up to twice as long as it usually takes to get the lock
+        const auto averageSpin = m->spinCount.load(std::memory_order_relaxed);
+        const auto spinLimit = std::min<uint32_t>(m->maxSpinCount.load(std::memory_order_relaxed), averageSpin * 2 + 10);
+
+        uint32_t spin = 0;
+        bool acquired = false;
+        while (spin < spinLimit)
+        {
+            ++spin;
+            _mm_pause();
+
+            c = m->state.load(std::memory_order_relaxed);
+            if (c == 0 && m->state.compare_exchange_weak(c, 1, std::memory_order_acquire))
+            {
+                acquired = true;
+                break;
+            }
+        }
+
+        bool waited = false;
+        if (!acquired)
+        {
+            // mark the lock as contended and sleep until it's released
+            if (c != 2)
+                c = m->state.exchange(2, std::memory_order_acquire);
+
+            while (c != 0)
+            {
+                waited = true;
+                FutexWait(m->state, 2);
+                c = m->state.exchange(2, std::memory_order_acquire);
+            }
+        }
+
+        // we have the lock, update the stats
+        const auto currentSpin = m->spinCount.load(std::memory_order_relaxed);
+        m->spinCount.store(currentSpin + ((int)spin - (int)currentSpin) / 8, std::memory_order_relaxed);
+        IncrementLockedStat(numContentions);
+        if (waited)
+            IncrementLockedStat(numWaits);
+    }
+
+    static void UnlockFutexMutex(FutexMutex* m)
+    {
+        if (m->state.exchange(0, std::memory_order_release) == 2)
+            FutexWake(m->state, 1);
+    }
+
+} // prv
+#endif
+
 Mutex::Mutex()
 {
     memzero(&m_data, sizeof(m_data));
@@ -18,17 +101,13 @@ Mutex::Mutex()
     static_assert(sizeof(m_data) >= sizeof(CRITICAL_SECTION), "Critical section data to small");
     InitializeCriticalSection((CRITICAL_SECTION*)&m_data);
 #elif defined(PLATFORM_POSIX)
-    static_assert(sizeof(m_data) >= sizeof(pthread_mutex_t), "Critical section data to small");
-    memset(&m_data, 0, sizeof(m_data));
-
-    pthread_mutexattr_t attr;
-    pthread_mutexattr_init(&attr);
-    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
-    pthread_mutex_init((pthread_mutex_t*)&m_data, &attr);
-    pthread_mutexattr_destroy(&attr);
-
-    pthread_mutex_lock((pthread_mutex_t*)&m_data);
-    pthread_mutex_unlock((pthread_mutex_t*)&m_data);
+    static_assert(sizeof(m_data) >= sizeof(prv::FutexMutex), "Critical section data to small");
+    auto* m = new (&m_data) prv::FutexMutex();
+    m->state = 0;
+    m->owner = 0;
+    m->recursion = 0;
+    m->maxSpinCount = prv::MUTEX_DEFAULT_SPIN_COUNT;
+    m->spinCount = 0;
 #elif defined(PLATFORM_PSX)
     static_assert(sizeof(m_data) >= sizeof(ScePthreadMutex), "Critical section data to small");
     ScePthreadMutexattr attr;
@@ -47,7 +126,7 @@ Mutex::~Mutex()
 #ifdef PLATFORM_WINDOWS
     DeleteCriticalSection((CRITICAL_SECTION*)&m_data);
 #elif defined(PLATFORM_POSIX)
-    pthread_mutex_destroy((pthread_mutex_t*)&m_data);
+    DEBUG_CHECK_EX(((prv::FutexMutex*)&m_data)->state.load() == 0, "Destroying locked mutex");
 #elif defined(PLATFORM_PSX)
     ::scePthreadMutexDestroy((ScePthreadMutex*)&m_data);
 #else
@@ -58,14 +137,38 @@ Mutex::~Mutex()
 void Mutex::acquire()
 {
 #ifdef PLATFORM_WINDOWS
-    EnterCriticalSection((CRITICAL_SECTION*)&m_data);
+    if (!TryEnterCriticalSection((CRITICAL_SECTION*)&m_data))
+    {
+        // critical section does the spinning on its own, we can't tell if it also had to sleep so every contended acquire counts as a wait
+        EnterCriticalSection((CRITICAL_SECTION*)&m_data);
+        prv::IncrementLockedStat(m_numContentions);
+        prv::IncrementLockedStat(m_numWaits);
+    }
 #elif defined(PLATFORM_POSIX)
-    pthread_mutex_lock((pthread_mutex_t*)&m_data);
+    auto* m = (prv::FutexMutex*)&m_data;
+
+    const auto self = prv::CachedThreadID();
+    if (m->owner.load(std::memory_order_relaxed) == self)
+    {
+        m->recursion += 1;
+    }
+    else
+    {
+        prv::LockFutexMutex(m, m_numContentions, m_numWaits);
+        m->owner.store(self, std::memory_order_relaxed);
+        m->recursion = 1;
+    }
 #elif defined(PLATFORM_PSX)
-    ::scePthreadMutexLock((ScePthreadMutex*)&m_data);
+    if (0 != ::scePthreadMutexTrylock((ScePthreadMutex*)&m_data))
+    {
+        ::scePthreadMutexLock((ScePthreadMutex*)&m_data);
+        prv::IncrementLockedStat(m_numContentions);
+    }
 #else
     #error "Add platform crap"
 #endif
+
+    prv::IncrementLockedStat(m_numAcquires);
 }
 
 void Mutex::release()
@@ -73,7 +176,14 @@ void Mutex::release()
 #ifdef PLATFORM_WINDOWS
     LeaveCriticalSection((CRITICAL_SECTION*)&m_data);
 #elif defined(PLATFORM_POSIX)
-    pthread_mutex_unlock((pthread_mutex_t*)&m_data);
+    auto* m = (prv::FutexMutex*)&m_data;
+    DEBUG_CHECK_EX(m->owner.load(std::memory_order_relaxed) == prv::CachedThreadID(), "Releasing mutex not owned by this thread");
+
+    if (--m->recursion == 0)
+    {
+        m->owner.store(0, std::memory_order_relaxed);
+        prv::UnlockFutexMutex(m);
+    }
 #elif defined(PLATFORM_PSX)
     ::scePthreadMutexUnlock((ScePthreadMutex*)&m_data);
 #else
@@ -85,7 +195,48 @@ void Mutex::spinCount(uint32_t spinCount)
 {
 #ifdef PLATFORM_WINDOWS
     SetCriticalSectionSpinCount((CRITICAL_SECTION*)&m_data, spinCount);
+#elif defined(PLATFORM_POSIX)
+    ((prv::FutexMutex*)&m_data)->maxSpinCount.store(spinCount, std::memory_order_relaxed);
+#endif
+}
+
+uint32_t Mutex::releaseForWait()
+{
+#if defined(PLATFORM_POSIX)
+    auto* m = (prv::FutexMutex*)&m_data;
+    DEBUG_CHECK_EX(m->owner.load(std::memory_order_relaxed) == prv::CachedThreadID(), "Waiting on mutex not owned by this thread");
+
+    const auto recursion = m->recursion;
+    m->recursion = 0;
+    m->owner.store(0, std::memory_order_relaxed);
+    prv::UnlockFutexMutex(m);
+    return recursion;
+#else
+    release();
+    return 1;
 #endif
 }
 
+void Mutex::acquireAfterWait(uint32_t recursion)
+{
+#if defined(PLATFORM_POSIX)
+    auto* m = (prv::FutexMutex*)&m_data;
+    prv::LockFutexMutex(m, m_numContentions, m_numWaits);
+    m->owner.store(prv::CachedThreadID(), std::memory_order_relaxed);
+    m->recursion = recursion;
+    prv::IncrementLockedStat(m_numAcquires);
+#else
+    acquire();
+#endif
+}
+
+MutexStats Mutex::stats() const
+{
+    MutexStats ret;
+    ret.numAcquires = m_numAcquires.load(std::memory_order_relaxed);
+    ret.numContentions = m_numContentions.load(std::memory_order_relaxed);
+    ret.numWaits = m_numWaits.load(std::memory_order_relaxed);
+    return ret;
+}
+
 END_INFERNO_NAMESPACE()
@@ -7,6 +7,7 @@
 #include "build.h"
 #include "output.h"
 #include "outputStream.h"
+#include "outputQueue.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -95,6 +96,26 @@ void Log::Print(LogOutputLevel level, const char* file, uint32_t line, const cha
     SinkTable::GetInstance().print(level, file, line, text);
 }
 
+void Log::EnableAsync(const LogAsyncSetup& setup)
+{
+    LogQueue::GetInstance().enable(setup);
+}
+
+void Log::DisableAsync()
+{
+    LogQueue::GetInstance().disable();
+}
+
+void Log::Flush()
+{
+    LogQueue::GetInstance().flush();
+}
+
+uint64_t Log::NumDroppedLines()
+{
+    return LogQueue::GetInstance().numDroppedLines();
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
@@ -0,0 +1,322 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "outputQueue.h"
+#include "outputStream.h"
+#include "scopeLock.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//---
+
+namespace prv
+{
+    // header of line in the ring, the text follows (zero terminated)
+    struct LogRecordHeader
+    {
+        uint32_t size = 0; // total size of the record, including header, aligned
+        uint32_t line = 0;
+        const char* file = nullptr;
+        LogOutputLevel level = LogOutputLevel::Info;
+        bool padding = false; // no line, just skip to the start of the ring
+    };
+
+    static const uint32_t LOG_RECORD_ALIGNMENT = 8;
+    static const uint32_t MIN_RING_SIZE = 4096;
+
+    static uint32_t RoundUpToPow2(uint32_t size)
+    {
+        uint32_t ret = 1;
+        while (ret < size)
+            ret <<= 1;
+        return ret;
+    }
+
+    // releases the ring when thread exits
+    struct LogRingOwner
+    {
+        LogRing* ring = nullptr;
+
+        ~LogRingOwner()
+        {
+            if (ring)
+                ring->m_inUse.store(false);
+        }
+    };
+
+    static thread_local LogRingOwner GThreadRing;
+
+    // set on the background thread that prints the lines, cheaper than comparing thread IDs for every line
+    static thread_local bool GIsLogThread = false;
+
+} // prv
+
+//---
+
+LogQueue::LogQueue()
+    : m_wakeUp(EventType::AutomaticReset)
+{}
+
+LogQueue& LogQueue::GetInstance()
+{
+    static LogQueue* theQueue = new LogQueue();
+    return *theQueue;
+}
+
+//---
+
+uint32_t LogQueue::ringSize() const
+{
+    return prv::RoundUpToPow2(std::max<uint32_t>(m_setup.m_threadBufferSize, prv::MIN_RING_SIZE));
+}
+
+LogRing* LogQueue::acquireRing()
+{
+    const auto ringSize = this->ringSize();
+
+    // reuse ring of a thread that has finished
+    for (auto* ring = m_rings.load(); ring; ring = ring->m_next)
+    {
+        bool expected = false;
+        if (ring->m_size == ringSize && ring->m_inUse.compare_exchange_strong(expected, true))
+            return ring;
+    }
+
+    auto* ring = new LogRing();
+    ring->m_data = new uint8_t[ringSize];
+    ring->m_size = ringSize;
+    ring->m_inUse = true;
+
+    // rings are never removed so simple push is enough
+    auto* head = m_rings.load();
+    do
+    {
+        ring->m_next = head;
+    }
+    while (!m_rings.compare_exchange_weak(head, ring));
+
+    return ring;
+}
+
+LogRing* LogQueue::threadRing()
+{
+    auto& owner = prv::GThreadRing;
+
+    // logging was enabled again with different buffer size, give back the old ring (it's still drained)
+    if (owner.ring && owner.ring->m_size != ringSize())
+    {
+        owner.ring->m_inUse.store(false);
+        owner.ring = nullptr;
+    }
+
+    if (!owner.ring)
+        owner.ring = acquireRing();
+    return owner.ring;
+}
+
+bool LogQueue::write(LogRing* ring, LogOutputLevel level, const char* file, uint32_t line, const char* text)
+{
+    // lines are not supposed to be that long, if they don't fit in half of the ring print them directly after whatever was queued before
+    const auto maxTextLength = (ring->m_size / 2) - sizeof(prv::LogRecordHeader) - 1;
+    const auto textLength = (uint32_t)strlen(text);
+    if (textLength > maxTextLength)
+    {
+        flush();
+        return false;
+    }
+    const auto recordSize = Align<uint32_t>(sizeof(prv::LogRecordHeader) + textLength + 1, prv::LOG_RECORD_ALIGNMENT);
+
+    auto writePos = ring->m_writePos.load(std::memory_order_relaxed);
+    for (;;)
+    {
+        const auto readPos = ring->m_readPos.load(std::memory_order_acquire);
+
+        // record is never split, if it does not fit till the end of the ring we skip the rest of it
+        const auto offset = (uint32_t)(writePos & (ring->m_size - 1));
+        const auto contiguous = ring->m_size - offset;
+        const auto required = recordSize + ((contiguous < recordSize) ? contiguous : 0);
+
+        if (ring->m_size - (writePos - readPos) >= required)
+            break;
+
+        // ring is full
+        if (m_setup.m_overflow == LogAsyncOverflow::Drop)
+        {
+            ++m_numDroppedLines;
+            return true;
+        }
+        else if (m_setup.m_overflow == LogAsyncOverflow::PrintDirectly)
+        {
+            return false;
+        }
+
+        // wait for the consumer to make some space
+        m_wakeUp.trigger();
+        Thread::YieldThread();
+    }
+
+    auto offset = (uint32_t)(writePos & (ring->m_size - 1));
+    const auto contiguous = ring->m_size - offset;
+    if (contiguous < recordSize)
+    {
+        // consumer skips the end of the ring on its own if there's no place even for the header
+        if (contiguous >= sizeof(prv::LogRecordHeader))
+        {
+            auto* padding = new (ring->m_data + offset) prv::LogRecordHeader();
+            padding->size = contiguous;
+            padding->padding = true;
+        }
+
+        writePos += contiguous;
+        offset = 0;
+    }
+
+    auto* header = new (ring->m_data + offset) prv::LogRecordHeader();
+    header->size = recordSize;
+    header->line = line;
+    header->file = file;
+    header->level = level;
+
+    auto* textPtr = (char*)(header + 1);
+    memcpy(textPtr, text, textLength);
+    textPtr[textLength] = 0;
+
+    writePos += recordSize;
+    ring->m_writePos.store(writePos, std::memory_order_release);
+
+    // wake up consumer earlier if the ring is getting full
+    if ((writePos - ring->m_readPos.load(std::memory_order_relaxed)) > (ring->m_size / 2))
+        m_wakeUp.trigger();
+
+    return true;
+}
+
+bool LogQueue::push(LogOutputLevel level, const char* file, uint32_t line, const char* text)
+{
+    if (!m_enabled.load(std::memory_order_relaxed))
+        return false;
+
+    // lines printed by the sinks themselves can't wait for the consumer that is calling them
+    if (prv::GIsLogThread)
+        return false;
+
+    ++m_numActiveWriters;
+
+    bool queued = false;
+    if (m_enabled.load())
+        queued = write(threadRing(), level, file, line, text);
+
+    --m_numActiveWriters;
+    return queued;
+}
+
+//---
+
+void LogQueue::drainRing(LogRing* ring)
+{
+    auto readPos = ring->m_readPos.load(std::memory_order_relaxed);
+    const auto writePos = ring->m_writePos.load(std::memory_order_acquire);
+    if (readPos == writePos)
+        return;
+
+    // all lines from the ring are printed under one lock of the sinks
+    auto& sinks = SinkTable::GetInstance();
+    sinks.beginPrinting();
+
+    while (readPos < writePos)
+    {
+        const auto offset = (uint32_t)(readPos & (ring->m_size - 1));
+        const auto contiguous = ring->m_size - offset;
+        if (contiguous < sizeof(prv::LogRecordHeader))
+        {
+            readPos += contiguous;
+            continue;
+        }
+
+        const auto* header = (const prv::LogRecordHeader*)(ring->m_data + offset);
+        if (!header->padding)
+            sinks.printUnlocked(header->level, header->file, header->line, (const char*)(header + 1));
+
+        readPos += header->size;
+    }
+
+    sinks.endPrinting();
+
+    ring->m_readPos.store(readPos, std::memory_order_release);
+}
+
+void LogQueue::drain()
+{
+    auto lock = CreateLock(m_drainLock);
+
+    for (auto* ring = m_rings.load(); ring; ring = ring->m_next)
+        drainRing(ring);
+}
+
+void LogQueue::flush()
+{
+    // we are already draining (or printing) on this thread, calling flush from a sink would deadlock
+    if (SinkTable::IsPrintingOnThisThread())
+        return;
+
+    drain();
+}
+
+//---
+
+void LogQueue::threadFunc()
+{
+    prv::GIsLogThread = true;
+
+    while (!m_exitRequested.load())
+    {
+        m_wakeUp.wait(m_setup.m_flushInterval);
+        drain();
+    }
+}
+
+void LogQueue::enable(const LogAsyncSetup& setup)
+{
+    auto lock = CreateLock(m_enableLock);
+
+    if (m_enabled.load())
+        return;
+
+    m_setup = setup;
+    m_exitRequested = false;
+
+    ThreadSetup threadSetup;
+    threadSetup.m_name = "LogThread";
+    threadSetup.m_priority = ThreadPriority::BelowNormal;
+    threadSetup.m_function = [this]() { threadFunc(); };
+    m_thread.init(threadSetup);
+
+    m_enabled = true;
+}
+
+void LogQueue::disable()
+{
+    auto lock = CreateLock(m_enableLock);
+
+    if (!m_enabled.exchange(false))
+        return;
+
+    // wait for the lines that are being written right now
+    while (m_numActiveWriters.load())
+        Thread::YieldThread();
+
+    m_exitRequested = true;
+    m_wakeUp.trigger();
+    m_thread.close();
+
+    // print whatever is left
+    drain();
+}
+
+//---
+
+END_INFERNO_NAMESPACE()
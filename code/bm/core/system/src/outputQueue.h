@@ -0,0 +1,86 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#pragma once
+
+#include "output.h"
+#include "mutex.h"
+#include "event.h"
+#include "thread.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//---
+
+/// single producer/single consumer ring buffer with log lines of one thread
+struct LogRing
+{
+    std::atomic<uint64_t> m_writePos = 0; // advanced only by the owning thread
+    std::atomic<uint64_t> m_readPos = 0; // advanced only by the consumer
+    std::atomic<bool> m_inUse = false; // owned by a thread, released when the thread exits so the ring can be reused
+
+    uint8_t* m_data = nullptr;
+    uint32_t m_size = 0; // power of two
+
+    LogRing* m_next = nullptr; // all rings ever created, never released
+};
+
+/// async log queue, the lines are written into per-thread rings and printed to the global sinks by a background thread
+class LogQueue
+{
+public:
+    LogQueue();
+
+    // try to queue the line, returns false if line should be printed directly (async mode disabled, buffer full, etc)
+    bool push(LogOutputLevel level, const char* file, uint32_t line, const char* text);
+
+    // print all queued lines synchronously
+    void flush();
+
+    // start the background printing
+    void enable(const LogAsyncSetup& setup);
+
+    // stop the background printing, all queued lines are printed
+    void disable();
+
+    // number of lines dropped because the ring was full
+    INLINE uint64_t numDroppedLines() const { return m_numDroppedLines.load(); }
+
+    //--
+
+    // queue instance
+    static LogQueue& GetInstance();
+
+private:
+    std::atomic<bool> m_enabled = false;
+    std::atomic<uint32_t> m_numActiveWriters = 0;
+    std::atomic<uint64_t> m_numDroppedLines = 0;
+
+    std::atomic<LogRing*> m_rings = nullptr;
+
+    LogAsyncSetup m_setup;
+
+    Mutex m_drainLock; // only one consumer can drain the rings at a time
+    Mutex m_enableLock;
+
+    Event m_wakeUp;
+    Thread m_thread;
+    std::atomic<bool> m_exitRequested = false;
+
+    uint32_t ringSize() const;
+    LogRing* acquireRing();
+    LogRing* threadRing();
+    bool write(LogRing* ring, LogOutputLevel level, const char* file, uint32_t line, const char* text);
+
+    void drain();
+    void drainRing(LogRing* ring);
+
+    void threadFunc();
+};
+
+//---
+
+END_INFERNO_NAMESPACE()
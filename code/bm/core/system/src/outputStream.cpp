@@ -6,6 +6,7 @@
 
 #include "build.h"
 #include "outputStream.h"
+#include "outputQueue.h"
 #include "thread.h"
 #include <assert.h>
 
@@ -13,6 +14,15 @@ BEGIN_INFERNO_NAMESPACE()
 
 //---
 
+namespace prv
+{
+    // set when the thread holds the sink lock
+    static thread_local bool GPrintingToSinks = false;
+
+} // prv
+
+//---
+
 void SinkTable::attach(ILogSink* sink)
 {
     if (sink)
@@ -43,7 +53,45 @@ void SinkTable::detach(ILogSink* sink)
 
 void SinkTable::print(LogOutputLevel level, const char* file, uint32_t line, const char* text)
 {
-    auto lock = CreateLock(m_lock);
+    // line printed by one of the sinks, we already hold the lock
+    if (prv::GPrintingToSinks)
+    {
+        printUnlocked(level, file, line, text);
+        return;
+    }
+
+    auto& queue = LogQueue::GetInstance();
+
+    // fatal errors (and asserts) are printed right away, but only after everything that was logged before them
+    if (level == LogOutputLevel::Fatal)
+        queue.flush();
+    else if (queue.push(level, file, line, text))
+        return;
+
+    beginPrinting();
+    printUnlocked(level, file, line, text);
+    endPrinting();
+}
+
+void SinkTable::beginPrinting()
+{
+    m_lock.acquire();
+    prv::GPrintingToSinks = true;
+}
+
+void SinkTable::endPrinting()
+{
+    prv::GPrintingToSinks = false;
+    m_lock.release();
+}
+
+bool SinkTable::IsPrintingOnThisThread()
+{
+    return prv::GPrintingToSinks;
+}
+
+void SinkTable::printUnlocked(LogOutputLevel level, const char* file, uint32_t line, const char* text)
+{
     for (uint32_t i = 0; i < m_numSinks; ++i)
         if (m_sinks[i]->print(level, file, line, text))
             break;
@@ -23,9 +23,21 @@ public:
     // remove a sink
     void detach(ILogSink* sink);
 
-    // print line to all sinks
+    // print line to all sinks, in async mode the line is queued instead
     void print(LogOutputLevel level, const char* file, uint32_t line, const char* text);
 
+    // print line to all sinks, must be called between beginPrinting() and endPrinting()
+    void printUnlocked(LogOutputLevel level, const char* file, uint32_t line, const char* text);
+
+    // lock the sinks for printing, lines printed by the sinks themselves (asserts, etc) go straight back to the sinks
+    void beginPrinting();
+
+    // unlock the sinks after printing
+    void endPrinting();
+
+    // are we printing to sinks on this thread right now
+    static bool IsPrintingOnThisThread();
+
     //--
 
     // sink table instance
@@ -0,0 +1,286 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "readWriteLock.h"
+#include "private.h"
+#include "futex.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//---
+
+#if defined(PLATFORM_WINDOWS) && (_WIN32_WINNT < 0x0601)
+// available since Windows 7 but not declared when targeting older versions
+extern "C" WINBASEAPI BOOLEAN WINAPI TryAcquireSRWLockShared(PSRWLOCK SRWLock);
+extern "C" WINBASEAPI BOOLEAN WINAPI TryAcquireSRWLockExclusive(PSRWLOCK SRWLock);
+#endif
+
+#ifdef PLATFORM_POSIX
+namespace prv
+{
+    static const uint32_t RWLOCK_SPIN_COUNT = 100;
+
+    // all the state is kept in one word so every transition is a single CAS
+    static const uint32_t RWLOCK_READER_ONE = 1;
+    static const uint32_t RWLOCK_READER_MASK = (1U << 20) - 1; // number of active readers
+    static const uint32_t RWLOCK_WAITER_ONE = 1U << 20;
+    static const uint32_t RWLOCK_WAITER_MASK = ((1U << 11) - 1) << 20; // number of writers waiting for the lock, readers are not let in when there are any
+    static const uint32_t RWLOCK_WRITER = 1U << 31; // locked for writing
+
+    struct FutexRWLock
+    {
+        std::atomic<uint32_t> state;
+
+        // readers and writers sleep on separate words that are bumped when it's their turn
+        std::atomic<uint32_t> readerSeq;
+        std::atomic<uint32_t> writerSeq;
+
+        // wake ups are only issued when someone is actually sleeping
+        std::atomic<uint32_t> numSleepingReaders;
+        std::atomic<uint32_t> numSleepingWriters;
+    };
+
+    static void WakeReaders(FutexRWLock* rw)
+    {
+        rw->readerSeq.fetch_add(1);
+        if (rw->numSleepingReaders.load())
+            FutexWake(rw->readerSeq, INT32_MAX);
+    }
+
+    static void WakeWriter(FutexRWLock* rw)
+    {
+        rw->writerSeq.fetch_add(1);
+        if (rw->numSleepingWriters.load())
+            FutexWake(rw->writerSeq, 1);
+    }
+
+    // sleep on the sequence word unless the lock state changed in the mean time, returns true if we actually slept
+    static bool SleepUntil(std::atomic<uint32_t>& seqWord, std::atomic<uint32_t>& numSleeping, std::atomic<uint32_t>& state, uint32_t blockingMask)
+    {
+        const auto seq = seqWord.load();
+        numSleeping.fetch_add(1);
+
+        const bool blocked = (state.load() & blockingMask) != 0;
+        if (blocked)
+            FutexWait(seqWord, seq);
+
+        numSleeping.fetch_sub(1);
+        return blocked;
+    }
+
+} // prv
+#endif
+
+//---
+
+RWLock::RWLock()
+    : m_sharedProxy(*this)
+    , m_exclusiveProxy(*this)
+{
+    memzero(&m_data, sizeof(m_data));
+
+#ifdef PLATFORM_WINDOWS
+    static_assert(sizeof(m_data) >= sizeof(SRWLOCK), "RW lock data to small");
+    InitializeSRWLock((SRWLOCK*)&m_data);
+#elif defined(PLATFORM_POSIX)
+    static_assert(sizeof(m_data) >= sizeof(prv::FutexRWLock), "RW lock data to small");
+    auto* rw = new (&m_data) prv::FutexRWLock();
+    rw->state = 0;
+    rw->readerSeq = 0;
+    rw->writerSeq = 0;
+    rw->numSleepingReaders = 0;
+    rw->numSleepingWriters = 0;
+#elif defined(PLATFORM_PSX)
+    static_assert(sizeof(m_data) >= sizeof(ScePthreadRwlock), "RW lock data to small");
+    ::scePthreadRwlockInit((ScePthreadRwlock*)&m_data, nullptr, nullptr);
+#else
+#error "Add platform crap"
+#endif
+}
+
+RWLock::~RWLock()
+{
+#ifdef PLATFORM_WINDOWS
+    // nothing
+#elif defined(PLATFORM_POSIX)
+    DEBUG_CHECK_EX(((prv::FutexRWLock*)&m_data)->state.load() == 0, "Destroying locked RW lock");
+#elif defined(PLATFORM_PSX)
+    ::scePthreadRwlockDestroy((ScePthreadRwlock*)&m_data);
+#else
+    #error "Add platform crap"
+#endif
+}
+
+void RWLock::acquireShared()
+{
+#ifdef PLATFORM_WINDOWS
+    if (!TryAcquireSRWLockShared((SRWLOCK*)&m_data))
+    {
+        AcquireSRWLockShared((SRWLOCK*)&m_data);
+        m_numSharedContentions.fetch_add(1, std::memory_order_relaxed);
+    }
+#elif defined(PLATFORM_POSIX)
+    auto* rw = (prv::FutexRWLock*)&m_data;
+
+    uint32_t spin = 0;
+    bool contended = false;
+    for (;;)
+    {
+        auto s = rw->state.load(std::memory_order_relaxed);
+        if (0 == (s & (prv::RWLOCK_WRITER | prv::RWLOCK_WAITER_MASK)))
+        {
+            DEBUG_CHECK_EX((s & prv::RWLOCK_READER_MASK) != prv::RWLOCK_READER_MASK, "Too many readers");
+            if (rw->state.compare_exchange_weak(s, s + prv::RWLOCK_READER_ONE, std::memory_order_acquire))
+                break;
+            continue;
+        }
+
+        // there's a writer inside or waiting
+        contended = true;
+        if (spin < prv::RWLOCK_SPIN_COUNT)
+        {
+            ++spin;
+            _mm_pause();
+            continue;
+        }
+
+        if (prv::SleepUntil(rw->readerSeq, rw->numSleepingReaders, rw->state, prv::RWLOCK_WRITER | prv::RWLOCK_WAITER_MASK))
+            m_numWaits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (contended)
+        m_numSharedContentions.fetch_add(1, std::memory_order_relaxed);
+#elif defined(PLATFORM_PSX)
+    if (0 != ::scePthreadRwlockTryrdlock((ScePthreadRwlock*)&m_data))
+    {
+        ::scePthreadRwlockRdlock((ScePthreadRwlock*)&m_data);
+        m_numSharedContentions.fetch_add(1, std::memory_order_relaxed);
+    }
+#else
+    #error "Add platform crap"
+#endif
+}
+
+void RWLock::releaseShared()
+{
+#ifdef PLATFORM_WINDOWS
+    ReleaseSRWLockShared((SRWLOCK*)&m_data);
+#elif defined(PLATFORM_POSIX)
+    auto* rw = (prv::FutexRWLock*)&m_data;
+
+    // NOTE: full ordering is required between the state change and the check for the sleepers (see SleepUntil)
+    const auto s = rw->state.fetch_sub(prv::RWLOCK_READER_ONE) - prv::RWLOCK_READER_ONE;
+
+    // last reader out lets the writer in
+    if (0 == (s & prv::RWLOCK_READER_MASK) && (s & prv::RWLOCK_WAITER_MASK))
+        prv::WakeWriter(rw);
+#elif defined(PLATFORM_PSX)
+    ::scePthreadRwlockUnlock((ScePthreadRwlock*)&m_data);
+#else
+    #error "Add platform crap"
+#endif
+}
+
+void RWLock::acquireExclusive()
+{
+#ifdef PLATFORM_WINDOWS
+    if (!TryAcquireSRWLockExclusive((SRWLOCK*)&m_data))
+    {
+        AcquireSRWLockExclusive((SRWLOCK*)&m_data);
+        prv::IncrementLockedStat(m_numExclusiveContentions);
+    }
+#elif defined(PLATFORM_POSIX)
+    auto* rw = (prv::FutexRWLock*)&m_data;
+
+    uint32_t s = 0;
+    if (!rw->state.compare_exchange_strong(s, prv::RWLOCK_WRITER, std::memory_order_acquire))
+    {
+        uint32_t spin = 0;
+        bool registered = false;
+        bool waited = false;
+        for (;;)
+        {
+            s = rw->state.load(std::memory_order_relaxed);
+
+            // lock is free, take it (and stop being a waiter)
+            if (0 == (s & (prv::RWLOCK_WRITER | prv::RWLOCK_READER_MASK)))
+            {
+                const auto newState = (s - (registered ? prv::RWLOCK_WAITER_ONE : 0)) | prv::RWLOCK_WRITER;
+                if (rw->state.compare_exchange_weak(s, newState, std::memory_order_acquire))
+                    break;
+                continue;
+            }
+
+            // register as a waiter right away so no new readers are let in
+            if (!registered)
+            {
+                DEBUG_CHECK_EX((s & prv::RWLOCK_WAITER_MASK) != prv::RWLOCK_WAITER_MASK, "Too many waiting writers");
+                registered = rw->state.compare_exchange_weak(s, s + prv::RWLOCK_WAITER_ONE, std::memory_order_relaxed);
+                continue;
+            }
+
+            if (spin < prv::RWLOCK_SPIN_COUNT)
+            {
+                ++spin;
+                _mm_pause();
+                continue;
+            }
+
+            waited |= prv::SleepUntil(rw->writerSeq, rw->numSleepingWriters, rw->state, prv::RWLOCK_WRITER | prv::RWLOCK_READER_MASK);
+        }
+
+        prv::IncrementLockedStat(m_numExclusiveContentions);
+        if (waited)
+            m_numWaits.fetch_add(1, std::memory_order_relaxed);
+    }
+#elif defined(PLATFORM_PSX)
+    if (0 != ::scePthreadRwlockTrywrlock((ScePthreadRwlock*)&m_data))
+    {
+        ::scePthreadRwlockWrlock((ScePthreadRwlock*)&m_data);
+        prv::IncrementLockedStat(m_numExclusiveContentions);
+    }
+#else
+    #error "Add platform crap"
+#endif
+
+    prv::IncrementLockedStat(m_numExclusiveAcquires);
+}
+
+void RWLock::releaseExclusive()
+{
+#ifdef PLATFORM_WINDOWS
+    ReleaseSRWLockExclusive((SRWLOCK*)&m_data);
+#elif defined(PLATFORM_POSIX)
+    auto* rw = (prv::FutexRWLock*)&m_data;
+
+    const auto s = rw->state.fetch_and(~prv::RWLOCK_WRITER) & ~prv::RWLOCK_WRITER;
+
+    // next writer goes first, readers are let in only when there are no writers waiting
+    if (s & prv::RWLOCK_WAITER_MASK)
+        prv::WakeWriter(rw);
+    else
+        prv::WakeReaders(rw);
+#elif defined(PLATFORM_PSX)
+    ::scePthreadRwlockUnlock((ScePthreadRwlock*)&m_data);
+#else
+    #error "Add platform crap"
+#endif
+}
+
+RWLockStats RWLock::stats() const
+{
+    RWLockStats ret;
+    ret.numExclusiveAcquires = m_numExclusiveAcquires.load(std::memory_order_relaxed);
+    ret.numSharedContentions = m_numSharedContentions.load(std::memory_order_relaxed);
+    ret.numExclusiveContentions = m_numExclusiveContentions.load(std::memory_order_relaxed);
+    ret.numWaits = m_numWaits.load(std::memory_order_relaxed);
+    return ret;
+}
+
+//---
+
+END_INFERNO_NAMESPACE()
@@ -7,35 +7,67 @@
 #include "build.h"
 #include "spinLock.h"
 #include "private.h"
+#include "futex.h"
+#include "thread.h"
 #include <assert.h>
 
 BEGIN_INFERNO_NAMESPACE()
 
 //---
 
+static const uint32_t SPIN_LOCK_MAX_BACKOFF = 64; // max number of pauses between checks of the lock
+static const uint32_t SPIN_LOCK_NUM_ROUNDS = 16; // number of checks before we go to sleep
+
 SpinLock::SpinLock()
-    : lock_(false)
+    : lock_(0)
 {
 }
 
 void SpinLock::acquire()
 {
-	for (;;)
+	// Optimistically assume the lock is free on the first try
+	uint32_t state = 0;
+	if (lock_.compare_exchange_strong(state, 1, std::memory_order_acquire))
+		return;
+
+	// Spin with exponential backoff, waiting for lock to be released without generating cache misses
+	uint32_t backoff = 1;
+	for (uint32_t round = 0; round < SPIN_LOCK_NUM_ROUNDS; ++round)
 	{
-		// Optimistically assume the lock is free on the first try
-		if (!lock_.exchange(true, std::memory_order_acquire))
+		// Issue X86 PAUSE or ARM YIELD instruction to reduce contention between
+		for (uint32_t i = 0; i < backoff; ++i)
+			_mm_pause();
+
+		backoff = std::min<uint32_t>(backoff * 2, SPIN_LOCK_MAX_BACKOFF);
+
+		state = lock_.load(std::memory_order_relaxed);
+		if (state == 0 && lock_.compare_exchange_weak(state, 1, std::memory_order_acquire))
 			return;
+	}
 
-		// Wait for lock to be released without generating cache misses
-		while (lock_.load(std::memory_order_relaxed))
-			// Issue X86 PAUSE or ARM YIELD instruction to reduce contention between
-			_mm_pause();
+	// Lock is held for long, mark it as contended and sleep until it's released
+	if (state != 2)
+		state = lock_.exchange(2, std::memory_order_acquire);
+
+	while (state != 0)
+	{
+#ifdef PLATFORM_POSIX
+		prv::FutexWait(lock_, 2);
+#else
+		Thread::YieldThread();
+#endif
+		state = lock_.exchange(2, std::memory_order_acquire);
 	}
 }
 
 void SpinLock::release()
 {
-	lock_.store(false, std::memory_order_release);
+	if (lock_.exchange(0, std::memory_order_release) == 2)
+	{
+#ifdef PLATFORM_POSIX
+		prv::FutexWake(lock_, 1);
+#endif
+	}
 }
 
 ///---
@@ -0,0 +1,288 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+
+#include "bm/core/file/include/fileBufferedWriter.h"
+#include "bm/core/file/include/fileMemoryWriter.h"
+#include "bm/core/file/include/memoryFileSystem.h"
+#include "bm/core/containers/include/inplaceArray.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+static void FillTestPattern(Array<uint8_t>& data, uint32_t size, uint32_t seed)
+{
+	data.resize(size);
+	for (uint32_t i = 0; i < size; ++i)
+		data[i] = (uint8_t)((i * 31) ^ seed);
+}
+
+static bool CompareContent(FileMemoryWriter* file, const Array<uint8_t>& data)
+{
+	if (file->size() != data.size())
+		return false;
+
+	Array<uint8_t> content;
+	content.resize(data.size());
+
+	file->seek(0);
+	if (file->readSync(content.data(), content.size()) != content.size())
+		return false;
+
+	return 0 == memcmp(content.data(), data.data(), data.size());
+}
+
+//--
+
+TEST(BufferedFileWriter, SmallWritesAreNotPassedDirectly)
+{
+	auto target = RefNew<FileMemoryWriter>();
+	auto writer = RefNew<FileBufferedWriter>(target);
+
+	uint32_t data = 0;
+	writer->writeSync(&data, sizeof(data));
+	EXPECT_EQ(4, writer->pos());
+	EXPECT_EQ(4, writer->size());
+	EXPECT_EQ(0, target->size());
+}
+
+TEST(BufferedFileWriter, FlushWritesData)
+{
+	auto target = RefNew<FileMemoryWriter>();
+	auto writer = RefNew<FileBufferedWriter>(target);
+
+	uint32_t data = 42;
+	writer->writeSync(&data, sizeof(data));
+	EXPECT_TRUE(writer->flushSync(false));
+	EXPECT_EQ(4, target->size());
+}
+
+TEST(BufferedFileWriter, CommitWritesData)
+{
+	auto target = RefNew<FileMemoryWriter>();
+	auto writer = RefNew<FileBufferedWriter>(target);
+
+	Array<uint8_t> data;
+	FillTestPattern(data, 1000, 1);
+	writer->writeSync(data.data(), data.size());
+	EXPECT_TRUE(writer->commit());
+	EXPECT_TRUE(CompareContent(target, data));
+}
+
+TEST(BufferedFileWriter, DestructorFlushesData)
+{
+	auto target = RefNew<FileMemoryWriter>();
+
+	Array<uint8_t> data;
+	FillTestPattern(data, 1000, 2);
+
+	{
+		auto writer = RefNew<FileBufferedWriter>(target);
+		writer->writeSync(data.data(), data.size());
+	}
+
+	EXPECT_TRUE(CompareContent(target, data));
+}
+
+TEST(BufferedFileWriter, ManySmallWritesCoalesced)
+{
+	auto target = RefNew<FileMemoryWriter>();
+
+	FileBufferedWriterSetup setup;
+	setup.blockSize = 4096;
+
+	auto writer = RefNew<FileBufferedWriter>(target, setup);
+
+	Array<uint8_t> data;
+	FillTestPattern(data, 100000, 3);
+
+	for (uint32_t i = 0; i < data.size(); i += 7)
+		writer->writeSync(data.typedData() + i, std::min<uint32_t>(7, data.size() - i));
+
+	EXPECT_TRUE(writer->commit());
+	EXPECT_TRUE(CompareContent(target, data));
+}
+
+TEST(BufferedFileWriter, LargeWriteAfterSmallKeepsOrder)
+{
+	auto target = RefNew<FileMemoryWriter>();
+
+	FileBufferedWriterSetup setup;
+	setup.directWriteThreshold = 1024;
+
+	auto writer = RefNew<FileBufferedWriter>(target, setup);
+
+	Array<uint8_t> data;
+	FillTestPattern(data, 10000, 4);
+
+	writer->writeSync(data.typedData(), 100);
+	writer->writeSync(data.typedData() + 100, 5000);
+	writer->writeSync(data.typedData() + 5100, 4900);
+
+	EXPECT_TRUE(writer->commit());
+	EXPECT_TRUE(CompareContent(target, data));
+}
+
+TEST(BufferedFileWriter, VectorWrite)
+{
+	auto target = RefNew<FileMemoryWriter>();
+	auto writer = RefNew<FileBufferedWriter>(target);
+
+	Array<uint8_t> data;
+	FillTestPattern(data, 3000, 5);
+
+	InplaceArray<BufferView, 3> blocks;
+	blocks.emplaceBack(data.typedData(), 1000);
+	blocks.emplaceBack(data.typedData() + 1000, 1500);
+	blocks.emplaceBack(data.typedData() + 2500, 500);
+	EXPECT_EQ(3000, writer->writeVectorSync(blocks));
+
+	EXPECT_TRUE(writer->commit());
+	EXPECT_TRUE(CompareContent(target, data));
+}
+
+TEST(BufferedFileWriter, SeekAndPatchHeader)
+{
+	auto target = RefNew<FileMemoryWriter>();
+	auto writer = RefNew<FileBufferedWriter>(target);
+
+	Array<uint8_t> data;
+	FillTestPattern(data, 5000, 6);
+
+	uint32_t header = 0;
+	writer->writeSync(&header, sizeof(header));
+	writer->writeSync(data.typedData() + 4, data.size() - 4);
+
+	writer->seek(0);
+	writer->writeSync(data.typedData(), 4);
+	writer->seek(data.size());
+	EXPECT_EQ(data.size(), writer->pos());
+
+	EXPECT_TRUE(writer->commit());
+	EXPECT_TRUE(CompareContent(target, data));
+}
+
+TEST(BufferedFileWriter, WriteBehindWritesAllData)
+{
+	auto target = RefNew<FileMemoryWriter>();
+
+	FileBufferedWriterSetup setup;
+	setup.blockSize = 4096;
+	setup.maxPendingBlocks = 2;
+	setup.writeBehind = true;
+
+	auto writer = RefNew<FileBufferedWriter>(target, setup);
+
+	Array<uint8_t> data;
+	FillTestPattern(data, 1000000, 7);
+
+	for (uint32_t i = 0; i < data.size(); i += 1000)
+		writer->writeSync(data.typedData() + i, 1000);
+
+	EXPECT_EQ(data.size(), writer->pos());
+	EXPECT_TRUE(writer->commit());
+	EXPECT_TRUE(CompareContent(target, data));
+}
+
+TEST(BufferedFileWriter, WriteBehindAtomicCommitWaitsForBlocks)
+{
+	MemoryFileSystem fs;
+	fs.createPath("/test/");
+
+	// same setup as used when saving objects, but with budget small enough that writer must wait for the background writes
+	FileBufferedWriterSetup setup;
+	setup.blockSize = 1024;
+	setup.maxPendingBlocks = 1;
+	setup.writeBehind = true;
+	setup.atomicCommit = true;
+
+	Array<uint8_t> data;
+	FillTestPattern(data, 500000, 8);
+
+	for (uint32_t round = 0; round < 3; ++round)
+	{
+		auto writer = FileBufferedWriter::Open("/test/file.bin", setup, fs);
+		ASSERT_TRUE(!!writer);
+
+		for (uint32_t i = 0; i < data.size(); i += 100)
+			writer->writeSync(data.typedData() + i, 100);
+
+		EXPECT_TRUE(writer->commit());
+	}
+
+	const auto content = fs.testLoadFileContent("/test/file.bin");
+	ASSERT_EQ(data.size(), content.size());
+	EXPECT_EQ(0, memcmp(content.data(), data.data(), data.size()));
+}
+
+TEST(BufferedFileWriter, AtomicCommitCreatesFile)
+{
+	MemoryFileSystem fs;
+	fs.createPath("/test/");
+
+	FileBufferedWriterSetup setup;
+	setup.atomicCommit = true;
+
+	auto writer = FileBufferedWriter::Open("/test/file.txt", setup, fs);
+	ASSERT_TRUE(!!writer);
+
+	writer->writeSync("Hello", 5);
+	EXPECT_FALSE(fs.testHasFile("/test/file.txt"));
+
+	EXPECT_TRUE(writer->commit());
+	EXPECT_STREQ("Hello", fs.testLoadFileContentText("/test/file.txt").c_str());
+}
+
+TEST(BufferedFileWriter, AtomicCommitReplacesFile)
+{
+	MemoryFileSystem fs;
+	fs.testStoreFileContentText("/test/file.txt", "Old");
+
+	FileBufferedWriterSetup setup;
+	setup.atomicCommit = true;
+
+	auto writer = FileBufferedWriter::Open("/test/file.txt", setup, fs);
+	ASSERT_TRUE(!!writer);
+
+	writer->writeSync("New", 3);
+	EXPECT_STREQ("Old", fs.testLoadFileContentText("/test/file.txt").c_str());
+
+	EXPECT_TRUE(writer->commit());
+	EXPECT_STREQ("New", fs.testLoadFileContentText("/test/file.txt").c_str());
+
+	Array<StringBuf> files;
+	fs.testCollectLocalFiles("/test/", "*", files);
+	EXPECT_EQ(1, files.size());
+}
+
+TEST(BufferedFileWriter, AtomicDiscardKeepsOriginalFile)
+{
+	MemoryFileSystem fs;
+	fs.testStoreFileContentText("/test/file.txt", "Old");
+
+	FileBufferedWriterSetup setup;
+	setup.atomicCommit = true;
+
+	{
+		auto writer = FileBufferedWriter::Open("/test/file.txt", setup, fs);
+		ASSERT_TRUE(!!writer);
+
+		writer->writeSync("New", 3);
+		writer->discard();
+	}
+
+	EXPECT_STREQ("Old", fs.testLoadFileContentText("/test/file.txt").c_str());
+
+	Array<StringBuf> files;
+	fs.testCollectLocalFiles("/test/", "*", files);
+	EXPECT_EQ(1, files.size());
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
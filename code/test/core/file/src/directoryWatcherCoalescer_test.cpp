@@ -0,0 +1,140 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+
+#include "bm/core/file/include/fileDirectoryWatcherCoalescer.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//--
+
+TEST(DirectoryWatcherCoalescer, EventsAreDebounced)
+{
+	DirectoryWatcherEventCoalescer coalescer(0.5, 5.0);
+
+	auto start = NativeTimePoint::Now();
+	coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/a.txt", start);
+
+	Array<DirectoryWatcherEvent> events;
+	EXPECT_FALSE(coalescer.flush(events, start + 0.1));
+	EXPECT_EQ(0, events.size());
+
+	EXPECT_TRUE(coalescer.flush(events, start + 0.6));
+	ASSERT_EQ(1, events.size());
+	EXPECT_EQ(DirectoryWatcherEventType::FileContentChanged, events[0].type);
+	EXPECT_STREQ("/test/a.txt", events[0].path.c_str());
+	EXPECT_EQ(0, coalescer.pendingCount());
+}
+
+TEST(DirectoryWatcherCoalescer, RepeatedChangesAreMerged)
+{
+	DirectoryWatcherEventCoalescer coalescer(0.5, 5.0);
+
+	auto start = NativeTimePoint::Now();
+	coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/a.txt", start);
+	coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/a.txt", start + 0.1);
+	coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/a.txt", start + 0.2);
+	EXPECT_EQ(1, coalescer.pendingCount());
+
+	// last change restarts the quiet period
+	Array<DirectoryWatcherEvent> events;
+	EXPECT_FALSE(coalescer.flush(events, start + 0.6));
+	EXPECT_TRUE(coalescer.flush(events, start + 0.8));
+	EXPECT_EQ(1, events.size());
+}
+
+TEST(DirectoryWatcherCoalescer, ConstantChangesAreReportedAfterMaxDelay)
+{
+	DirectoryWatcherEventCoalescer coalescer(0.5, 1.0);
+
+	auto start = NativeTimePoint::Now();
+	for (int i = 0; i <= 12; ++i)
+		coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/a.txt", start + (i * 0.1));
+
+	Array<DirectoryWatcherEvent> events;
+	EXPECT_TRUE(coalescer.flush(events, start + 1.2));
+	EXPECT_EQ(1, events.size());
+}
+
+TEST(DirectoryWatcherCoalescer, AddedAndModifiedFileIsReportedAsAdded)
+{
+	DirectoryWatcherEventCoalescer coalescer(0.5, 5.0);
+
+	auto start = NativeTimePoint::Now();
+	coalescer.push(DirectoryWatcherEventType::FileAdded, "/test/a.txt", start);
+	coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/a.txt", start);
+	coalescer.push(DirectoryWatcherEventType::FileMetadataChanged, "/test/a.txt", start);
+
+	Array<DirectoryWatcherEvent> events;
+	EXPECT_TRUE(coalescer.flush(events, start, true));
+	ASSERT_EQ(1, events.size());
+	EXPECT_EQ(DirectoryWatcherEventType::FileAdded, events[0].type);
+}
+
+TEST(DirectoryWatcherCoalescer, TemporaryFileIsNotReported)
+{
+	DirectoryWatcherEventCoalescer coalescer(0.5, 5.0);
+
+	auto start = NativeTimePoint::Now();
+	coalescer.push(DirectoryWatcherEventType::FileAdded, "/test/a.tmp", start);
+	coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/a.tmp", start);
+	coalescer.push(DirectoryWatcherEventType::FileRemoved, "/test/a.tmp", start);
+	EXPECT_EQ(0, coalescer.pendingCount());
+
+	Array<DirectoryWatcherEvent> events;
+	EXPECT_FALSE(coalescer.flush(events, start, true));
+}
+
+TEST(DirectoryWatcherCoalescer, ReplacedFileIsReportedAsChanged)
+{
+	DirectoryWatcherEventCoalescer coalescer(0.5, 5.0);
+
+	auto start = NativeTimePoint::Now();
+	coalescer.push(DirectoryWatcherEventType::FileRemoved, "/test/a.txt", start);
+	coalescer.push(DirectoryWatcherEventType::FileAdded, "/test/a.txt", start);
+
+	Array<DirectoryWatcherEvent> events;
+	EXPECT_TRUE(coalescer.flush(events, start, true));
+	ASSERT_EQ(1, events.size());
+	EXPECT_EQ(DirectoryWatcherEventType::FileContentChanged, events[0].type);
+}
+
+TEST(DirectoryWatcherCoalescer, ChangeAfterRemovalKeepsRemoval)
+{
+	DirectoryWatcherEventCoalescer coalescer(0.5, 5.0);
+
+	auto start = NativeTimePoint::Now();
+	coalescer.push(DirectoryWatcherEventType::FileRemoved, "/test/a.txt", start);
+	coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/a.txt", start);
+
+	Array<DirectoryWatcherEvent> events;
+	EXPECT_TRUE(coalescer.flush(events, start, true));
+	ASSERT_EQ(1, events.size());
+	EXPECT_EQ(DirectoryWatcherEventType::FileRemoved, events[0].type);
+}
+
+TEST(DirectoryWatcherCoalescer, EventsAreReportedInOrderOfFirstChange)
+{
+	DirectoryWatcherEventCoalescer coalescer(0.5, 5.0);
+
+	auto start = NativeTimePoint::Now();
+	coalescer.push(DirectoryWatcherEventType::DirectoryAdded, "/test/dir/", start);
+	coalescer.push(DirectoryWatcherEventType::FileAdded, "/test/dir/b.txt", start);
+	coalescer.push(DirectoryWatcherEventType::FileAdded, "/test/dir/a.txt", start);
+	coalescer.push(DirectoryWatcherEventType::FileContentChanged, "/test/dir/b.txt", start);
+
+	Array<DirectoryWatcherEvent> events;
+	EXPECT_TRUE(coalescer.flush(events, start, true));
+	ASSERT_EQ(3, events.size());
+	EXPECT_STREQ("/test/dir/", events[0].path.c_str());
+	EXPECT_STREQ("/test/dir/b.txt", events[1].path.c_str());
+	EXPECT_STREQ("/test/dir/a.txt", events[2].path.c_str());
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
@@ -7,12 +7,58 @@
 #include "build.h"
 
 #include "bm/core/file/include/fileMemoryReader.h"
+#include "bm/core/file/include/fileView.h"
+#include "bm/core/file/include/fileMapping.h"
+#include "bm/core/file/include/filePrefetcher.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
 //--
 
+TEST(MemoryFileReader, AccessHintsDoNotChangeViewContent)
+{
+	auto reader = IFileReader::CreateFromBuffer(StringView("Ala ma kota").toBuffer());
+	ASSERT_TRUE(!!reader);
 
+	reader->accessHint(reader->fullRange(), FileAccessHint::WillNeed);
+
+	auto view = reader->createView(reader->fullRange());
+	ASSERT_TRUE(!!view);
+
+	view->accessHint(FileAccessHint::Random);
+
+	char data[11];
+	ASSERT_EQ(11, view->readSync(data, 11));
+	EXPECT_EQ(0, memcmp(data, "Ala ma kota", 11));
+}
+
+TEST(MemoryFileReader, AccessHintsDoNotDropMappedMemory)
+{
+	auto reader = IFileReader::CreateFromBuffer(StringView("Ala ma kota").toBuffer());
+	ASSERT_TRUE(!!reader);
+
+	auto mapping = reader->createMapping(reader->fullRange());
+	ASSERT_TRUE(!!mapping);
+
+	mapping->accessHint(FileAccessHint::DontNeed);
+	EXPECT_EQ(0, memcmp(mapping->data(), "Ala ma kota", 11));
+}
+
+TEST(MemoryFileReader, PrefetchIgnoresMemoryFiles)
+{
+	auto reader = IFileReader::CreateFromBuffer(StringView("Ala ma kota").toBuffer());
+	ASSERT_TRUE(!!reader);
+
+	auto& prefetcher = FilePrefetcher::GetInstance();
+	prefetcher.waitForAll();
+
+	const auto prefetchedBefore = prefetcher.prefetchedBytes();
+	prefetcher.prefetch(reader);
+	EXPECT_EQ(0, prefetcher.pendingBytes());
+
+	prefetcher.waitForAll();
+	EXPECT_EQ(prefetchedBefore, prefetcher.prefetchedBytes());
+}
 
 //--
 
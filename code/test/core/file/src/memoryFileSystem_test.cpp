@@ -12,6 +12,8 @@
 #include "bm/core/file/include/fileWriter.h"
 #include "bm/core/file/include/fileView.h"
 #include "bm/core/file/include/fileMapping.h"
+#include "bm/core/task/include/taskBuilder.h"
+#include "bm/core/task/include/taskSignal.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -906,4 +908,126 @@ TEST(MemoryFileSystem, EnumerateFileStructureAtDirectory)
 
 //--
 
+TEST(MemoryFileSystem, CopiedFileSharesContent)
+{
+	MemoryFileSystem fs;
+	fs.testStoreFileContentText("/test/a.txt", "Ala ma kota");
+	ASSERT_TRUE(fs.copyFile("/test/a.txt", "/test/b.txt"));
+
+	auto a = fs.testLoadFileContent("/test/a.txt");
+	auto b = fs.testLoadFileContent("/test/b.txt");
+	ASSERT_TRUE(!!a);
+	EXPECT_EQ(a.data(), b.data());
+}
+
+TEST(MemoryFileSystem, WritingCopiedFileDoesNotChangeOriginal)
+{
+	MemoryFileSystem fs;
+	fs.testStoreFileContentText("/test/a.txt", "Ala ma kota");
+	ASSERT_TRUE(fs.copyFile("/test/a.txt", "/test/b.txt"));
+
+	{
+		auto writer = fs.openForWriting("/test/b.txt", FileWriteMode::ReadWrite);
+		ASSERT_TRUE(!!writer);
+		writer->seek(0);
+		writer->writeSync("Ola", 3);
+	}
+
+	EXPECT_STREQ("Ala ma kota", fs.testLoadFileContentText("/test/a.txt").c_str());
+	EXPECT_STREQ("Ola ma kota", fs.testLoadFileContentText("/test/b.txt").c_str());
+}
+
+TEST(MemoryFileSystem, MemoryUsageTracked)
+{
+	MemoryFileSystem fs;
+	EXPECT_EQ(0, fs.memoryUsage());
+
+	fs.testStoreFileContentText("/test/a.txt", "0123456789");
+	fs.testStoreFileContentText("/test/b.txt", "01234");
+	EXPECT_EQ(15, fs.memoryUsage());
+
+	fs.saveFileFromBuffer("/test/a.txt", StringView("012").toBuffer());
+	EXPECT_EQ(8, fs.memoryUsage());
+
+	fs.deleteFile("/test/b.txt");
+	EXPECT_EQ(3, fs.memoryUsage());
+}
+
+TEST(MemoryFileSystem, BudgetEvictsLeastRecentlyUsedFile)
+{
+	MemoryFileSystem fs(25);
+	fs.testStoreFileContentText("/test/a.txt", "0123456789");
+	fs.testStoreFileContentText("/test/b.txt", "0123456789");
+	EXPECT_EQ(0, fs.evictedFileCount());
+
+	fs.testStoreFileContentText("/test/c.txt", "0123456789");
+	EXPECT_EQ(1, fs.evictedFileCount());
+	EXPECT_FALSE(fs.testHasFile("/test/a.txt"));
+	EXPECT_TRUE(fs.testHasFile("/test/b.txt"));
+	EXPECT_TRUE(fs.testHasFile("/test/c.txt"));
+
+	fs.testLoadFileContent("/test/b.txt"); // b is now more recent than c
+
+	fs.testStoreFileContentText("/test/d.txt", "0123456789");
+	EXPECT_EQ(2, fs.evictedFileCount());
+	EXPECT_TRUE(fs.testHasFile("/test/b.txt"));
+	EXPECT_FALSE(fs.testHasFile("/test/c.txt"));
+	EXPECT_TRUE(fs.testHasFile("/test/d.txt"));
+	EXPECT_GE(25, fs.memoryUsage());
+}
+
+TEST(MemoryFileSystem, BudgetDoesNotEvictReadOnlyFiles)
+{
+	MemoryFileSystem fs;
+	fs.testStoreFileContentText("/test/a.txt", "0123456789");
+	fs.testStoreFileContentText("/test/b.txt", "0123456789");
+	fs.readOnlyFlag("/test/a.txt", true);
+
+	fs.memoryBudget(15);
+	EXPECT_TRUE(fs.testHasFile("/test/a.txt"));
+	EXPECT_FALSE(fs.testHasFile("/test/b.txt"));
+	EXPECT_EQ(10, fs.memoryUsage());
+}
+
+TEST(MemoryFileSystem, ConcurrentReadsAndWrites)
+{
+	MemoryFileSystem fs;
+
+	const uint32_t numFiles = 64;
+	for (uint32_t i = 0; i < numFiles; ++i)
+		fs.testStoreFileContentText(TempString("/test/dir{}/file{}.txt", i % 4, i), "initial");
+
+	std::atomic<uint32_t> numFailedReads = 0;
+
+	auto sig = TaskBuilder("FileSystemTest"_id).instances(1000) << [&fs, numFiles, &numFailedReads](TaskContext& tc, uint32_t index)
+	{
+		const auto fileIndex = (index * 7) % numFiles;
+		TempString path("/test/dir{}/file{}.txt", fileIndex % 4, fileIndex);
+
+		if (index % 4 == 0)
+		{
+			fs.saveFileFromBuffer(path, StringView(TempString("content{}", index)).toBuffer());
+		}
+		else if (index % 4 == 1)
+		{
+			fs.testStoreFileContentText(TempString("/test/new{}/file{}.txt", index % 8, index), "new");
+		}
+		else
+		{
+			if (!fs.testHasFile(path) || !fs.testLoadFileContent(path))
+				++numFailedReads;
+		}
+	};
+
+	sig.waitSpinInfinite();
+
+	EXPECT_EQ(0, numFailedReads.load());
+
+	Array<StringBuf> files;
+	fs.testCollectFiles("/test/", "*.txt", files);
+	EXPECT_EQ(numFiles + 250, files.size());
+}
+
+//--
+
 END_INFERNO_NAMESPACE()
\ No newline at end of file
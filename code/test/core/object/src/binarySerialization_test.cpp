@@ -13,6 +13,8 @@
 #include "bm/core/memory/include/pool.h"
 #include "bm/core/object/include/resourcePromise.h"
 #include "bm/core/object/include/asyncBuffer.h"
+#include "bm/core/file/include/fileBufferedWriter.h"
+#include "bm/core/file/include/fileReader.h"
 #include "testTypes.h"
 
 BEGIN_INFERNO_NAMESPACE_EX(test)
@@ -79,6 +81,25 @@ TEST(BinarySerialization, CompareSimple)
 	ptr2->Compare(ptr);
 }
 
+TEST(BinarySerialization, LoadFromFileReader)
+{
+	auto ptr = RefNew<TestObject>();
+	ptr->simple = 42.0f;
+
+	ObjectSavingContext savingCtx;
+    Buffer data;
+    EXPECT_TRUE(IObject::SaveObject(SerializationFormat::RawBinary, savingCtx, ptr, data));
+    EXPECT_TRUE(data);
+
+	// file content is mapped directly, without copying it
+	auto reader = IFileReader::CreateFromBuffer(data);
+	ASSERT_TRUE(!!reader);
+
+    auto ptr2 = IObject::LoadObject<TestObject>(SerializationFormat::RawBinary, reader);
+	ASSERT_NE(nullptr, ptr2);
+	ptr2->Compare(ptr);
+}
+
 TEST(BinarySerialization, CompareString)
 {
 	auto ptr = RefNew<TestObject>();
@@ -133,6 +154,48 @@ TEST(BinarySerialization, CompareCompoundEx)
 	ptr2->Compare(ptr);
 }
 
+TEST(BinarySerialization, PropertyPlanCopyCompare)
+{
+	const auto cls = GetTypeObject<TestTransform>().toClass();
+	ASSERT_TRUE(!!cls);
+
+	const auto& plan = cls->propertyPlan();
+	uint32_t coveredSize = 0;
+	for (const auto& range : plan.dataRanges)
+		coveredSize += range.size;
+	for (const auto* prop : plan.complexProperties)
+		coveredSize += prop->type()->size();
+	EXPECT_EQ(sizeof(TestTransform), coveredSize);
+	EXPECT_EQ(3, plan.serializedProperties.size());
+
+	TestTransform a, b;
+	a.pos.x = 1.0f;
+	a.rot.yaw = 45.0f;
+	a.scale.z = 2.0f;
+	EXPECT_FALSE(cls->compare(&a, &b));
+
+	cls->copy(&b, &a);
+	EXPECT_TRUE(cls->compare(&a, &b));
+	EXPECT_EQ(1.0f, b.pos.x);
+	EXPECT_EQ(45.0f, b.rot.yaw);
+	EXPECT_EQ(2.0f, b.scale.z);
+}
+
+TEST(BinarySerialization, PropertyPlanClone)
+{
+	auto ptr = RefNew<TestObject>();
+	ptr->trivial = true;
+	ptr->simple = 42.0f;
+	ptr->txt = "Ala ma kota";
+	ptr->compound.y = -2.0f;
+	ptr->compoundEx.max.z = 3.0f;
+	ptr->arraySimple.pushBack(1.0f);
+
+	auto ptr2 = IObject::CloneObject(ptr);
+	ASSERT_TRUE(!!ptr2);
+	ptr2->Compare(ptr);
+}
+
 TEST(BinarySerialization, CompareArraySimple)
 {
 	auto ptr = RefNew<TestObject>();
@@ -363,6 +426,156 @@ TEST(BinarySerialization, Save1000)
 	}
 }
 
+TEST(BinarySerialization, Load1000)
+{
+	bm::Random r;
+	TestLayerGenerationSettings settings;
+	settings.maxChildrenPerEntity = 2;
+	settings.maxComponentsPerEntity = 4;
+	settings.maxEntityDepth = 2;
+	settings.maxLinksPerEntity = 0;
+	settings.numEntities = 1000;
+
+	auto layer = GenerateTestLayer(r, settings);
+
+	Buffer data;
+	ObjectSavingContext savingCtx;
+	EXPECT_TRUE(IObject::SaveObject(SerializationFormat::RawBinary, savingCtx, layer, data));
+	ASSERT_TRUE(data);
+
+	// large files are loaded in parallel, result must be the same as with serial loading
+	ScopeTimer timer;
+	auto loaded = IObject::LoadObject<TestLayer>(SerializationFormat::RawBinary, data);
+	TRACE_INFO("Loading time 1000: {}", timer);
+
+	ASSERT_NE(nullptr, loaded);
+	loaded->Compare(layer);
+}
+
+// node that records the order in which nodes were post loaded
+class TestPostLoadNode : public IObject
+{
+	RTTI_DECLARE_OBJECT_CLASS(TestPostLoadNode, IObject);
+
+public:
+	uint32_t id = 0;
+	Array<RefPtr<TestPostLoadNode>> children;
+
+	static Array<uint32_t> PostLoadOrder;
+	static Array<ThreadID> PostLoadThreads;
+
+	virtual void onPostLoad() override
+	{
+		TBaseClass::onPostLoad();
+		PostLoadOrder.pushBack(id);
+		PostLoadThreads.pushBack(Thread::CurrentThreadID());
+	}
+};
+
+Array<uint32_t> TestPostLoadNode::PostLoadOrder;
+Array<ThreadID> TestPostLoadNode::PostLoadThreads;
+
+RTTI_BEGIN_TYPE_CLASS(TestPostLoadNode);
+RTTI_PROPERTY(id);
+RTTI_PROPERTY(children);
+RTTI_END_TYPE();
+
+static RefPtr<TestPostLoadNode> GeneratePostLoadTree(uint32_t& nextId, uint32_t depth, Array<uint32_t>& outParents, uint32_t parentId)
+{
+	auto node = RefNew<TestPostLoadNode>();
+	node->id = nextId++;
+	outParents.pushBack(parentId);
+
+	if (depth > 0)
+	{
+		for (uint32_t i = 0; i < 4; ++i)
+			node->children.pushBack(GeneratePostLoadTree(nextId, depth - 1, outParents, node->id));
+	}
+
+	return node;
+}
+
+TEST(BinarySerialization, LoadIndependentSubtrees)
+{
+	// root with 4 subtrees that don't know about each other, 85 objects is enough for parallel loading
+	uint32_t nextId = 0;
+	Array<uint32_t> parents;
+	auto root = GeneratePostLoadTree(nextId, 3, parents, INDEX_NONE);
+
+	Buffer data;
+	ObjectSavingContext savingCtx;
+	EXPECT_TRUE(IObject::SaveObject(SerializationFormat::RawBinary, savingCtx, root, data));
+	ASSERT_TRUE(data);
+
+	TestPostLoadNode::PostLoadOrder.reset();
+	TestPostLoadNode::PostLoadThreads.reset();
+
+	auto loaded = IObject::LoadObject<TestPostLoadNode>(SerializationFormat::RawBinary, data);
+	ASSERT_NE(nullptr, loaded);
+
+	// every object was post loaded once, on the loading thread
+	ASSERT_EQ(nextId, TestPostLoadNode::PostLoadOrder.size());
+	for (const auto threadId : TestPostLoadNode::PostLoadThreads)
+		EXPECT_EQ(Thread::CurrentThreadID(), threadId);
+
+	// parents are post loaded before their children, same as with serial loading
+	Array<int> position;
+	position.resizeWith(nextId, INDEX_NONE);
+	for (auto i : TestPostLoadNode::PostLoadOrder.indexRange())
+	{
+		const auto id = TestPostLoadNode::PostLoadOrder[i];
+		ASSERT_LT(id, nextId);
+		EXPECT_EQ(INDEX_NONE, position[id]);
+		position[id] = (int)i;
+	}
+
+	for (uint32_t id = 1; id < nextId; ++id)
+		EXPECT_LT(position[parents[id]], position[id]);
+
+	// structure was loaded correctly
+	ASSERT_EQ(4U, loaded->children.size());
+	for (const auto& child : loaded->children)
+	{
+		ASSERT_NE(nullptr, child);
+		EXPECT_EQ(loaded->id, parents[child->id]);
+		EXPECT_EQ(4U, child->children.size());
+	}
+}
+
+TEST(BinarySerialization, ParallelSaveIsDeterministic)
+{
+	bm::Random r;
+	TestLayerGenerationSettings settings;
+	settings.maxChildrenPerEntity = 2;
+	settings.maxComponentsPerEntity = 4;
+	settings.maxEntityDepth = 2;
+	settings.maxLinksPerEntity = 0;
+	settings.numEntities = 1000;
+
+	auto layer = GenerateTestLayer(r, settings);
+
+	// reference output from the serial writer
+	Buffer data;
+	ObjectSavingContext serialSavingCtx;
+	serialSavingCtx.singleThreaded = true;
+	EXPECT_TRUE(IObject::SaveObject(SerializationFormat::RawBinary, serialSavingCtx, layer, data));
+	ASSERT_TRUE(data);
+
+	// large object graphs are saved in parallel, output must be exactly the same as the serial one
+	ObjectSavingContext savingCtx;
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		Buffer otherData;
+		EXPECT_TRUE(IObject::SaveObject(SerializationFormat::RawBinary, savingCtx, layer, otherData));
+		ASSERT_EQ(data.size(), otherData.size());
+		EXPECT_EQ(0, memcmp(data.data(), otherData.data(), data.size()));
+	}
+
+	auto loaded = IObject::LoadObject<TestLayer>(SerializationFormat::RawBinary, data);
+	ASSERT_NE(nullptr, loaded);
+	loaded->Compare(layer);
+}
+
 TEST(BinarySerialization, Save10K)
 {
 	bm::Random r;
@@ -426,6 +639,51 @@ TEST(BinarySerialization, Save100K)
 		EXPECT_TRUE(data);
 	}
 }
+
+TEST(BinarySerialization, SaveToFile100K)
+{
+	bm::Random r;
+	TestLayerGenerationSettings settings;
+	settings.maxChildrenPerEntity = 3;
+	settings.maxComponentsPerEntity = 10;
+	settings.maxEntityDepth = 2;
+	settings.maxLinksPerEntity = 0;
+	settings.numEntities = 100000;
+
+	auto layer = GenerateTestLayer(r, settings);
+	const auto path = StringBuf(TempString("{}BinarySerializationBenchmark.bin", FileSystem().globalPath(FileSystemGlobalPath::SystemTempDir)));
+
+	for (uint32_t i = 0; i < 3; ++i)
+	{
+		ObjectSavingContext ctx;
+
+		// direct writes to the file
+		{
+			ScopeTimer timer;
+			auto writer = FileSystem().openForWriting(path, FileWriteMode::WriteOnly);
+			EXPECT_TRUE(IObject::SaveObject(SerializationFormat::RawBinary, ctx, layer, writer));
+			TRACE_ERROR("Saving time 100K (direct): {}", timer);
+		}
+
+		// coalesced writes
+		{
+			ScopeTimer timer;
+			auto writer = FileBufferedWriter::Open(path);
+			EXPECT_TRUE(IObject::SaveObject(SerializationFormat::RawBinary, ctx, layer, writer));
+			EXPECT_TRUE(writer->commit());
+			TRACE_ERROR("Saving time 100K (buffered): {}", timer);
+		}
+
+		// coalesced writes done in the background, atomic replace
+		{
+			ScopeTimer timer;
+			EXPECT_TRUE(IObject::SaveObject(SerializationFormat::RawBinary, ctx, layer, path));
+			TRACE_ERROR("Saving time 100K (write-behind): {}", timer);
+		}
+	}
+
+	FileSystem().deleteFile(path);
+}
 #endif
 
 //--
@@ -0,0 +1,98 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "bm/core/object/include/object.h"
+#include "bm/core/object/include/rttiDataView.h"
+#include "bm/core/object/include/rttiDataViewPath.h"
+#include "testTypes.h"
+
+BEGIN_INFERNO_NAMESPACE_EX(test)
+
+//--
+
+TEST(DataViewPath, CompilesStructMembers)
+{
+    DataViewPath path(TestObject::GetStaticClass(), "compound.y");
+    EXPECT_EQ(2, path.numSteps());
+    EXPECT_TRUE(path.remainder().empty());
+}
+
+TEST(DataViewPath, CompilesArrayElements)
+{
+    DataViewPath path(TestObject::GetStaticClass(), "arrayCompound[1].z");
+    EXPECT_EQ(3, path.numSteps());
+    EXPECT_TRUE(path.remainder().empty());
+}
+
+TEST(DataViewPath, UnknownPartIsLeftAsRemainder)
+{
+    DataViewPath path(TestObject::GetStaticClass(), "compound.__text");
+    EXPECT_EQ(1, path.numSteps());
+    EXPECT_EQ(StringView(".__text"), path.remainder());
+}
+
+TEST(DataViewPath, ReadsSameAsTextPath)
+{
+    auto obj = RefNew<TestObject>();
+    obj->compound.y = 42.0f;
+    obj->arrayCompound.emplaceBack(Vector3(1, 2, 3));
+    obj->arrayCompound.emplaceBack(Vector3(4, 5, 6));
+
+    DataViewPath path(TestObject::GetStaticClass(), "arrayCompound[1].z");
+
+    float value = 0.0f;
+    ASSERT_TRUE(obj->readCompiledDataView(path, &value, GetTypeObject<float>()).valid());
+    EXPECT_EQ(6.0f, value);
+
+    float textValue = 0.0f;
+    ASSERT_TRUE(obj->readDataView("arrayCompound[1].z", &textValue, GetTypeObject<float>()).valid());
+    EXPECT_EQ(value, textValue);
+
+    DataViewPath path2(TestObject::GetStaticClass(), "compound.y");
+    ASSERT_TRUE(obj->readCompiledDataView(path2, &value, GetTypeObject<float>()).valid());
+    EXPECT_EQ(42.0f, value);
+}
+
+TEST(DataViewPath, WritesValue)
+{
+    auto obj = RefNew<TestObject>();
+    DataViewPath path(TestObject::GetStaticClass(), "compoundEx.max.x");
+
+    const float value = 13.0f;
+    ASSERT_TRUE(obj->writeCompiledDataView(path, &value, GetTypeObject<float>()).valid());
+    EXPECT_EQ(13.0f, obj->compoundEx.max.x);
+}
+
+TEST(DataViewPath, IndexOutOfRangeIsCheckedOnAccess)
+{
+    auto obj = RefNew<TestObject>();
+    DataViewPath path(TestObject::GetStaticClass(), "arraySimple[5]");
+
+    float value = 0.0f;
+    EXPECT_EQ(DataViewResultCode::ErrorIndexOutOfRange, obj->readCompiledDataView(path, &value, GetTypeObject<float>()).code);
+
+    obj->arraySimple.resizeWith(10, 7.0f);
+    ASSERT_TRUE(obj->readCompiledDataView(path, &value, GetTypeObject<float>()).valid());
+    EXPECT_EQ(7.0f, value);
+}
+
+TEST(DataViewPath, DescribeReportsArraySize)
+{
+    auto obj = RefNew<TestObject>();
+    obj->arraySimple.resizeWith(3, 1.0f);
+
+    DataViewPath path(TestObject::GetStaticClass(), "arraySimple");
+
+    DataViewInfo info;
+    ASSERT_TRUE(obj->describeCompiledDataView(path, info).valid());
+    EXPECT_EQ(3, info.arraySize);
+    EXPECT_TRUE(info.flags.test(DataViewInfoFlagBit::LikeArray));
+}
+
+//--
+
+END_INFERNO_NAMESPACE_EX(test)
@@ -0,0 +1,138 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "bm/core/object/include/globalEventDispatch.h"
+#include "bm/core/object/include/globalEventKey.h"
+
+DECLARE_TEST_FILE(GlobalEvent);
+
+BEGIN_INFERNO_NAMESPACE_EX(test)
+
+//--
+
+class TestEventListener : public IGlobalEventListener
+{
+public:
+	TestEventListener(GlobalEventKey key, StringID eventName, std::function<void()> func = nullptr)
+		: IGlobalEventListener(key, eventName)
+		, m_func(func)
+	{}
+
+	virtual void dispatch(IObject* source, const void* data, Type dataType) const override
+	{
+		++m_count;
+		if (m_func)
+			m_func();
+	}
+
+	INLINE uint32_t count() const { return m_count.load(); }
+
+private:
+	mutable std::atomic<uint32_t> m_count = 0;
+	std::function<void()> m_func;
+};
+
+//--
+
+TEST(GlobalEvent, DispatchCallsListener)
+{
+	const auto key = MakeUniqueEventKey();
+
+	auto listener = RefNew<TestEventListener>(key, "Test"_id);
+	RegisterGlobalEventListener(listener);
+
+	DispatchGlobalEvent(key, "Test"_id);
+	DispatchGlobalEvent(key, "Other"_id);
+	EXPECT_EQ(1, listener->count());
+
+	UnregisterGlobalEventListener(listener);
+
+	DispatchGlobalEvent(key, "Test"_id);
+	EXPECT_EQ(1, listener->count());
+}
+
+TEST(GlobalEvent, UnregisterDuringDispatch)
+{
+	const auto key = MakeUniqueEventKey();
+
+	RefPtr<TestEventListener> second = RefNew<TestEventListener>(key, "Test"_id);
+	RefPtr<TestEventListener> first;
+	first = RefNew<TestEventListener>(key, "Test"_id, [&first, &second]()
+		{
+			// unregister both ourselves and the other listener while the event is still being dispatched
+			UnregisterGlobalEventListener(first);
+			UnregisterGlobalEventListener(second);
+		});
+
+	RegisterGlobalEventListener(first);
+	RegisterGlobalEventListener(second);
+
+	// NOTE: the second listener may still get this event as it was registered when the dispatch started
+	DispatchGlobalEvent(key, "Test"_id);
+	EXPECT_EQ(1, first->count());
+	EXPECT_GE(1, second->count());
+
+	// nothing is registered any more
+	const auto secondCount = second->count();
+	DispatchGlobalEvent(key, "Test"_id);
+	EXPECT_EQ(1, first->count());
+	EXPECT_EQ(secondCount, second->count());
+}
+
+TEST(GlobalEvent, ConcurrentDispatch)
+{
+	static const uint32_t NUM_THREADS = 4;
+	static const uint32_t NUM_EVENTS = 2000;
+
+	const auto key = MakeUniqueEventKey();
+
+	auto listener = RefNew<TestEventListener>(key, "Test"_id);
+	RegisterGlobalEventListener(listener);
+
+	std::atomic<bool> done = false;
+
+	{
+		// keep changing the listeners on the same key while events are dispatched
+		ThreadSetup churnSetup;
+		churnSetup.m_function = [&done, key]()
+		{
+			while (!done.load())
+			{
+				auto other = RefNew<TestEventListener>(key, "Test"_id);
+				RegisterGlobalEventListener(other);
+				Thread::YieldThread();
+				UnregisterGlobalEventListener(other);
+			}
+		};
+
+		Thread churnThread;
+		churnThread.init(churnSetup);
+
+		{
+			ThreadSetup setup;
+			setup.m_function = [key]()
+			{
+				for (uint32_t i = 0; i < NUM_EVENTS; ++i)
+					DispatchGlobalEvent(key, "Test"_id);
+			};
+
+			Thread threads[NUM_THREADS];
+			for (uint32_t i = 0; i < NUM_THREADS; ++i)
+				threads[i].init(setup);
+		}
+
+		done = true;
+	}
+
+	EXPECT_EQ(NUM_THREADS * NUM_EVENTS, listener->count());
+
+	UnregisterGlobalEventListener(listener);
+}
+
+//--
+
+END_INFERNO_NAMESPACE_EX(test)
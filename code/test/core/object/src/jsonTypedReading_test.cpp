@@ -0,0 +1,360 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "testTypes.h"
+#include "bm/core/object/include/rttiTypedMemory.h"
+#include "bm/core/object/include/serializationStream.h"
+
+BEGIN_INFERNO_NAMESPACE_EX(test)
+
+static const PrintFlags PRINT_FLAGS = { PrintFlagBit::NoHeader };
+
+//--
+
+TEST(JSONRead, SimpleInt)
+{
+	StringView txt = "\"42\"";
+
+	int value = 0;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_EQ(42, value);
+}
+
+TEST(JSONRead, SimpleIntRelaxed)
+{
+	StringView txt = "42";
+
+	int value = 0;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_EQ(42, value);
+}
+
+TEST(JSONRead, SimpleIntParsingFailed)
+{
+	StringView txt = "\"x\"";
+
+	int value = 0;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	TestErrorReporter err;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt, err));
+	EXPECT_EQ(0, value);
+	EXPECT_EQ(1, err.numErrors);
+}
+
+TEST(JSONRead, SimpleFloat)
+{
+	StringView txt = "\"42.125\"";
+
+	float value = 0;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_EQ(42.125f, value);
+}
+
+TEST(JSONRead, SimpleString)
+{
+	StringView txt = "\"Ala ma kota\"";
+
+	StringBuf value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_STREQ("Ala ma kota", value.c_str());
+}
+
+TEST(JSONRead, SimpleStringWithEscapement)
+{
+	StringView txt = "\"Ala <ma> \\\"kota\\\"\\nkoty\\ti\\/psy\"";
+
+	StringBuf value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_STREQ("Ala <ma> \"kota\"\nkoty\ti/psy", value.c_str());
+}
+
+TEST(JSONRead, SimpleStringUnicode)
+{
+	StringView txt = "\"\\u017c\\u00F3\\u0142w \\ud83d\\ude00 \\0105\"";
+
+	StringBuf value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_STREQ("\xC5\xBC\xC3\xB3\xC5\x82w \xF0\x9F\x98\x80 \xC4\x85", value.c_str());
+}
+
+TEST(JSONRead, SimpleStringControlEscapesFollowedByHexLetters)
+{
+	StringView txt = "\"\\bcafe \\fade \\0105\"";
+
+	StringBuf value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_STREQ("\bcafe \fade \xC4\x85", value.c_str());
+}
+
+TEST(JSONRead, ControlCharactersRoundTrip)
+{
+	StringBuf value = "\bcafe\fade\x01\x1F";
+
+	const PrintFlags allFlags[] = {
+		PRINT_FLAGS,
+		{ PrintFlagBit::NoHeader, PrintFlagBit::Relaxed },
+	};
+
+	for (const auto& flags : allFlags)
+	{
+		StringBuilder txt;
+		ObjectSavingContext saveCtx;
+		saveCtx.textPrintFlags = flags;
+		EXPECT_TRUE(TypedMemory::SaveData(SerializationFormat::Json, saveCtx, TypedMemory::Wrap(value), txt));
+
+		StringBuf loaded;
+		TestErrorReporter err;
+		ObjectLoadingContext ctx;
+		EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, TypedMemory::Wrap(loaded), txt.view(), err));
+		EXPECT_EQ(0, err.numErrors);
+		EXPECT_STREQ(value.c_str(), loaded.c_str());
+	}
+}
+
+TEST(JSONRead, RelaxedStringWithSeparatorsRoundTrip)
+{
+	StringBuf value = "a,b:c";
+
+	StringBuilder txt;
+	ObjectSavingContext saveCtx;
+	saveCtx.textPrintFlags = { PrintFlagBit::NoHeader, PrintFlagBit::Relaxed };
+	EXPECT_TRUE(TypedMemory::SaveData(SerializationFormat::Json, saveCtx, TypedMemory::Wrap(value), txt));
+
+	StringBuf loaded;
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, TypedMemory::Wrap(loaded), txt.view()));
+	EXPECT_STREQ("a,b:c", loaded.c_str());
+}
+
+TEST(JSONRead, Compound)
+{
+	StringView txt = "{\"x\": \"1\", \"y\": \"2\", \"z\": \"3\"}";
+
+	Vector3 value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_EQ(1.0f, value.x);
+	EXPECT_EQ(2.0f, value.y);
+	EXPECT_EQ(3.0f, value.z);
+}
+
+TEST(JSONRead, CompoundRelaxed)
+{
+	StringView txt = "{x:1 y:2 z:3}";
+
+	Vector3 value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_EQ(1.0f, value.x);
+	EXPECT_EQ(2.0f, value.y);
+	EXPECT_EQ(3.0f, value.z);
+}
+
+TEST(JSONRead, CompoundReportsMissingProperty)
+{
+	StringView txt = "{\"w\": {\"a\": [1, 2]}, \"x\": \"5\"}";
+
+	Vector3 value;
+	auto data = TypedMemory::Wrap(value);
+
+	TestErrorReporter err;
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt, err));
+	EXPECT_EQ(1, err.numErrors);
+	EXPECT_EQ(5.0f, value.x);
+}
+
+TEST(JSONRead, BigCompound)
+{
+	StringView txt = "{\"min\": {\"x\": \"-1\", \"y\": \"-2\", \"z\": \"-3\"}, \"max\": {\"x\": \"1\", \"y\": \"2\", \"z\": \"3\"}}";
+
+	Box value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_EQ(Vector3(-1, -2, -3), value.min);
+	EXPECT_EQ(Vector3(1, 2, 3), value.max);
+}
+
+TEST(JSONRead, Array)
+{
+	StringView txt = "[\"1\", \"2\", \"3\"]";
+
+	Array<int> value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	ASSERT_EQ(3, value.size());
+	EXPECT_EQ(1, value[0]);
+	EXPECT_EQ(2, value[1]);
+	EXPECT_EQ(3, value[2]);
+}
+
+TEST(JSONRead, ArrayEmpty)
+{
+	StringView txt = "[]";
+
+	Array<int> value = { 1,2 };
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_EQ(0, value.size());
+}
+
+TEST(JSONRead, ArrayCompound)
+{
+	StringView txt = "[{\"x\": \"1\", \"y\": \"2\", \"z\": \"3\"},\n {\"x\": \"4\", \"y\": \"5\", \"z\": \"6\"}]";
+
+	Array<Vector3> value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	ASSERT_EQ(2, value.size());
+	EXPECT_EQ(Vector3(1, 2, 3), value[0]);
+	EXPECT_EQ(Vector3(4, 5, 6), value[1]);
+}
+
+TEST(JSONRead, StaticArrayReportsToManyElements)
+{
+	StringView txt = "[\"1\", \"2\", \"3\", \"4\"]";
+
+	int value[3] = { 0,0,0 };
+	auto data = TypedMemory::Wrap(value);
+
+	TestErrorReporter err;
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt, err));
+	EXPECT_EQ(1, value[0]);
+	EXPECT_EQ(2, value[1]);
+	EXPECT_EQ(3, value[2]);
+	EXPECT_LE(1, err.numErrors);
+}
+
+TEST(JSONRead, Enumeration)
+{
+	StringView txt = "\"Second\"";
+
+	TestEnum value = (TestEnum)0;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+	EXPECT_EQ(TestEnum::Second, value);
+}
+
+TEST(JSONRead, Object)
+{
+	StringView txt = "{\"#class\": \"test.TestObject\", \"simple\": \"42\", \"txt\": \"Ala\"}";
+
+	ObjectPtr value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+
+	const auto obj = rtti_cast<TestObject>(value);
+	ASSERT_TRUE(!!obj);
+	EXPECT_EQ(42.0f, obj->simple);
+	EXPECT_STREQ("Ala", obj->txt.c_str());
+}
+
+TEST(JSONRead, ObjectReferences)
+{
+	StringView txt = "{\"#class\": \"test.TestObject\", \"arrayPtrs\": [{\"#class\": \"test.TestObject\", \"#id\": \"1\", \"simple\": \"42\"}, \"#ref(1)\"]}";
+
+	ObjectPtr value;
+	auto data = TypedMemory::Wrap(value);
+
+	ObjectLoadingContext ctx;
+	EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, data, txt));
+
+	const auto obj = rtti_cast<TestObject>(value);
+	ASSERT_TRUE(!!obj);
+	ASSERT_EQ(2, obj->arrayPtrs.size());
+	ASSERT_TRUE(!!obj->arrayPtrs[0]);
+	EXPECT_EQ(42.0f, obj->arrayPtrs[0]->simple);
+	EXPECT_EQ(obj->arrayPtrs[0], obj->arrayPtrs[1]);
+}
+
+TEST(JSONRead, ObjectRoundTrip)
+{
+	const RefPtr<TestObject> ptr = RefNew<TestObject>();
+	ptr->simple = 42.0f;
+	ptr->txt = "Ala \"ma\"\n kota \xC5\xBC\xC3\xB3\xC5\x82w";
+	ptr->compoundEx = Box(Vector3(-1, -2, -3), Vector3(1, 2, 3));
+	ptr->arraySimple = { 1.0f, 2.0f, 3.0f };
+	ptr->ptr = RefNew<TestObject>();
+	ptr->ptr->simple = 5.0f;
+	ptr->weakPtr = ptr->ptr;
+
+	const PrintFlags allFlags[] = {
+		PRINT_FLAGS,
+		{ PrintFlagBit::NoHeader, PrintFlagBit::PrettyText },
+		{ PrintFlagBit::NoHeader, PrintFlagBit::Relaxed },
+		{ PrintFlagBit::NoHeader, PrintFlagBit::Relaxed, PrintFlagBit::PrettyText },
+	};
+
+	for (const auto& flags : allFlags)
+	{
+		StringBuilder txt;
+		ObjectSavingContext saveCtx;
+		saveCtx.textPrintFlags = flags;
+		EXPECT_TRUE(TypedMemory::SaveData(SerializationFormat::Json, saveCtx, TypedMemory::Wrap(ptr), txt));
+
+		RefPtr<TestObject> loaded;
+		TestErrorReporter err;
+		ObjectLoadingContext ctx;
+		EXPECT_TRUE(TypedMemory::LoadData(SerializationFormat::Json, ctx, TypedMemory::Wrap(loaded), txt.view(), err));
+		EXPECT_EQ(0, err.numErrors);
+
+		ASSERT_TRUE(!!loaded);
+		EXPECT_EQ(42.0f, loaded->simple);
+		EXPECT_STREQ(ptr->txt.c_str(), loaded->txt.c_str());
+		EXPECT_EQ(ptr->compoundEx.min, loaded->compoundEx.min);
+		EXPECT_EQ(ptr->compoundEx.max, loaded->compoundEx.max);
+		ASSERT_EQ(3, loaded->arraySimple.size());
+		EXPECT_EQ(3.0f, loaded->arraySimple[2]);
+		ASSERT_TRUE(!!loaded->ptr);
+		EXPECT_EQ(5.0f, loaded->ptr->simple);
+		EXPECT_EQ(loaded->ptr, loaded->weakPtr.lock());
+	}
+}
+
+//--
+
+END_INFERNO_NAMESPACE_EX(test)
@@ -8,6 +8,7 @@
 
 #include "bm/core/object/include/rttiClassRefType.h"
 #include "bm/core/object/include/object.h"
+#include "bm/core/object/include/objectGlobalRegistry.h"
 
 BEGIN_INFERNO_NAMESPACE_EX(test)
 
@@ -743,4 +744,105 @@ TEST(TypeConversion, BaseClassUpCastRTTI)
     TestConvert(handleA, handleB);
 }
 
+//--
+
+TEST(TypeSystem, FindClassByName)
+{
+    const auto cls = BaseClassA::GetStaticClass();
+    EXPECT_EQ(cls.ptr(), RTTI::GetInstance().findClass(cls->name()).ptr());
+    EXPECT_EQ(cls.ptr(), RTTI::GetInstance().findType(cls->name()).ptr());
+    EXPECT_EQ(nullptr, RTTI::GetInstance().findClass("test::NonExistingClass"_id).ptr());
+}
+
+TEST(TypeSystem, DynamicTypeStaysTheSame)
+{
+    const auto name = StringID(TempString("array<{}>", DevClassC::GetStaticClass()->name()));
+
+    const auto type = RTTI::GetInstance().findType(name);
+    ASSERT_TRUE(!!type);
+    EXPECT_EQ(MetaType::Array, type->metaType());
+
+    // second lookup goes through the published lookup table
+    EXPECT_EQ(type.ptr(), RTTI::GetInstance().findType(name).ptr());
+    EXPECT_EQ(type.ptr(), RTTI::GetInstance().findType(name).ptr());
+}
+
+TEST(TypeSystem, ManyDynamicTypesStayTheSame)
+{
+    // enough new types to outgrow the lookup table at least once
+    static const uint32_t NUM_TYPES = 2000;
+
+    Array<Type> types;
+    for (uint32_t i = 1; i <= NUM_TYPES; ++i)
+    {
+        const auto name = StringID(TempString("[{}]{}", i, DevClassC::GetStaticClass()->name()));
+        const auto type = RTTI::GetInstance().findType(name);
+        ASSERT_TRUE(!!type);
+        EXPECT_EQ(type.ptr(), RTTI::GetInstance().findType(name).ptr());
+        types.pushBack(type);
+    }
+
+    for (uint32_t i = 1; i <= NUM_TYPES; ++i)
+    {
+        const auto name = StringID(TempString("[{}]{}", i, DevClassC::GetStaticClass()->name()));
+        EXPECT_EQ(types[i - 1].ptr(), RTTI::GetInstance().findType(name).ptr());
+    }
+}
+
+//--
+
+TEST(ObjectRegistry, FindObjectById)
+{
+    auto obj = RefNew<DevClassB>();
+    const auto id = obj->id();
+    EXPECT_EQ(obj.get(), ObjectGlobalRegistry::GetInstance().findObject(id).get());
+
+    obj.reset();
+    EXPECT_EQ(nullptr, ObjectGlobalRegistry::GetInstance().findObject(id).get());
+}
+
+TEST(ObjectRegistry, SnapshotOfClassInCreationOrder)
+{
+    Array<RefPtr<IObject>> objects;
+    for (uint32_t i = 0; i < 100; ++i)
+    {
+        if (i & 1)
+            objects.pushBack(RefNew<DevClassB>());
+        else
+            objects.pushBack(RefNew<DevClassC>());
+    }
+
+    Array<ObjectWeakPtr> snapshot;
+    ObjectGlobalRegistry::GetInstance().collectObjects(snapshot, DevClassC::GetStaticClass());
+
+    uint32_t index = 0;
+    for (const auto& ptr : snapshot)
+    {
+        auto obj = ptr.lock();
+        ASSERT_TRUE(!!obj);
+        EXPECT_TRUE(obj->is<DevClassC>());
+
+        if (index < objects.size() && obj == objects[index])
+            index += 2;
+    }
+
+    EXPECT_EQ(100, index);
+}
+
+TEST(ObjectRegistry, IterationDoesNotBlockCreation)
+{
+    auto obj = RefNew<DevClassB>();
+
+    uint32_t numCreated = 0;
+    ObjectGlobalRegistry::GetInstance().iterateObjectsOfClass<DevClassB>([&numCreated](DevClassB* ptr)
+        {
+            // registry is not locked during the iteration, creating objects here is fine
+            auto temp = RefNew<DevClassC>();
+            numCreated += temp ? 1 : 0;
+            return false;
+        });
+
+    EXPECT_LE(1, numCreated);
+}
+
 END_INFERNO_NAMESPACE_EX(test)
@@ -269,6 +269,64 @@ TEST(VariantTest, SharedPtrVariantKeepsObjectAlive)
     ASSERT_TRUE(destroyFlag); // now object should be destroyed
 }
 
+TEST(VariantTest, SmallValuesAreStoredInline)
+{
+    Variant a = Variant(42);
+    ASSERT_EQ(42, *(const int*)a.data());
+    EXPECT_LE((const uint8_t*)&a, (const uint8_t*)a.data());
+    EXPECT_GT((const uint8_t*)&a + sizeof(Variant), (const uint8_t*)a.data());
+
+    Variant b = Variant(StringBuf("Ala ma kota"));
+    EXPECT_FALSE((const uint8_t*)&b <= (const uint8_t*)b.data() && (const uint8_t*)&b + sizeof(Variant) > (const uint8_t*)b.data());
+}
+
+TEST(VariantTest, MoveInlineValue)
+{
+    Variant a = Variant(42);
+    Variant b = std::move(a);
+    ASSERT_TRUE(a.empty());
+    ASSERT_EQ(nullptr, a.data());
+    ASSERT_EQ(42, *(const int*)b.data());
+}
+
+TEST(VariantTest, ReassignDifferentType)
+{
+    Variant a = Variant(42);
+    a = Variant(StringBuf("test"));
+    ASSERT_TRUE(a.is<StringBuf>());
+    ASSERT_STREQ("test", ((const StringBuf*)a.data())->c_str());
+
+    a = Variant(1.5f);
+    ASSERT_TRUE(a.is<float>());
+    ASSERT_EQ(1.5f, *(const float*)a.data());
+
+    a = Variant();
+    ASSERT_TRUE(a.empty());
+}
+
+TEST(VariantTest, ArrayOfVariantsSurvivesReallocation)
+{
+    Array<Variant> values;
+    for (int i = 0; i < 100; ++i)
+    {
+        if (i & 1)
+            values.emplaceBack(Variant(i));
+        else
+            values.emplaceBack(Variant(StringBuf(TempString("{}", i))));
+    }
+
+    values.erase(0, 10);
+
+    for (int i = 10; i < 100; ++i)
+    {
+        const auto& v = values[i - 10];
+        if (i & 1)
+            EXPECT_EQ(i, v.getSafe<int>(0));
+        else
+            EXPECT_STREQ(TempString("{}", i).c_str(), v.getSafe<StringBuf>("").c_str());
+    }
+}
+
 /*
 TEST(Variant, CreateStruct)
 {
@@ -0,0 +1,196 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "bm/core/containers/include/crc.h"
+#include "bm/core/object/include/stub.h"
+#include "bm/core/object/include/stubFactory.h"
+#include "bm/core/object/include/stubLoader.h"
+
+DECLARE_TEST_FILE(Stub);
+
+BEGIN_INFERNO_NAMESPACE_EX(test)
+
+//--
+
+struct TestStub : public IStub
+{
+	static StubTypeValue StaticType() { return 1; }
+	virtual StubTypeValue runtimeType() const override { return 1; }
+	virtual const char* debugName() const override { return "TestStub"; }
+
+	StringView text;
+	StringID name;
+	uint32_t value = 0;
+	uint32_t payloadSize = 0;
+	const void* payload = nullptr;
+	StubPseudoArray<TestStub> children;
+
+	virtual void write(IStubWriter& f) const override
+	{
+		f.writeString(text);
+		f.writeName(name);
+		f.writeUint32(value);
+		f.writeUint32(payloadSize);
+		f.writeData(payload, payloadSize);
+		f.writeArray(children);
+	}
+
+	virtual void read(IStubReader& f) override
+	{
+		text = f.readString();
+		name = f.readName();
+		value = f.readUint32();
+		payloadSize = f.readUint32();
+		payload = f.readData(payloadSize);
+		f.readArray(children);
+	}
+};
+
+static void CompareStubs(const TestStub* expected, const TestStub* loaded)
+{
+	ASSERT_TRUE(loaded != nullptr);
+	EXPECT_EQ(expected->text, loaded->text);
+	EXPECT_EQ(expected->name, loaded->name);
+	EXPECT_EQ(expected->value, loaded->value);
+	ASSERT_EQ(expected->payloadSize, loaded->payloadSize);
+	if (expected->payloadSize)
+		EXPECT_EQ(0, memcmp(expected->payload, loaded->payload, expected->payloadSize));
+
+	ASSERT_EQ(expected->children.size(), loaded->children.size());
+	for (uint32_t i = 0; i < expected->children.size(); ++i)
+		CompareStubs(expected->children[i], loaded->children[i]);
+}
+
+// test graph: root with some children, each child carries a block of data
+struct TestStubGraph
+{
+	TestStub root;
+	Array<TestStub*> children;
+	Array<const TestStub*> childrenPtrs;
+	Array<uint8_t> payload;
+
+	TestStubGraph(uint32_t numChildren, uint32_t payloadSizePerChild)
+	{
+		payload.resize(numChildren * payloadSizePerChild);
+		for (uint32_t i = 0; i < payload.size(); ++i)
+			payload[i] = (uint8_t)((i * 2654435761U) >> 13); // not too compressible
+
+		for (uint32_t i = 0; i < numChildren; ++i)
+		{
+			auto& child = *children.emplaceBack(new TestStub());
+			child.text = (i & 1) ? "odd" : "even";
+			child.name = (i & 1) ? "Odd"_id : "Even"_id;
+			child.value = i;
+			child.payloadSize = payloadSizePerChild;
+			child.payload = payload.typedData() + i * payloadSizePerChild;
+			childrenPtrs.pushBack(&child);
+		}
+
+		root.text = "root";
+		root.name = "Root"_id;
+		root.value = 42;
+		root.children.elemCount = childrenPtrs.size();
+		root.children.elems = childrenPtrs.typedData();
+	}
+
+	~TestStubGraph()
+	{
+		// stubs don't own the arrays
+		root.children.elems = nullptr;
+		root.children.elemCount = 0;
+
+		children.clearPtr();
+	}
+};
+
+static void ReadPackedHeader(const Buffer& data, StubHeader& outHeader)
+{
+	ASSERT_GE(data.size(), sizeof(StubHeader));
+	memcpy(&outHeader, data.data(), sizeof(StubHeader));
+}
+
+//--
+
+TEST(Stub, SmallBlobRoundTrip)
+{
+	TestStubGraph graph(3, 16);
+
+	const auto packed = graph.root.pack(1);
+	ASSERT_TRUE(packed);
+
+	StubHeader header;
+	ReadPackedHeader(packed, header);
+	EXPECT_EQ(StubHeader::MAGIC_CHUNKED, header.magic);
+	EXPECT_EQ(1U, header.numChunks);
+
+	StubFactory factory;
+	factory.registerTypeNoDestructor<TestStub>();
+
+	StubLoader loader(factory, 1);
+	const auto* loaded = (const TestStub*)loader.unpack(packed);
+	CompareStubs(&graph.root, loaded);
+}
+
+TEST(Stub, MultiChunkBlobRoundTrip)
+{
+	// well over the chunk size so the data is split
+	TestStubGraph graph(700, 1024);
+
+	const auto packed = graph.root.pack(1);
+	ASSERT_TRUE(packed);
+
+	StubHeader header;
+	ReadPackedHeader(packed, header);
+	EXPECT_EQ(StubHeader::MAGIC_CHUNKED, header.magic);
+	EXPECT_LT(StubHeader::CHUNK_SIZE, header.uncompressedSize);
+	EXPECT_EQ((header.uncompressedSize + StubHeader::CHUNK_SIZE - 1) / StubHeader::CHUNK_SIZE, header.numChunks);
+	EXPECT_LE(3U, header.numChunks);
+
+	StubFactory factory;
+	factory.registerTypeNoDestructor<TestStub>();
+
+	StubLoader loader(factory, 1);
+	const auto* loaded = (const TestStub*)loader.unpack(packed);
+	CompareStubs(&graph.root, loaded);
+}
+
+TEST(Stub, LegacyBlobRoundTrip)
+{
+	TestStubGraph graph(10, 100);
+
+	const auto packed = graph.root.pack(1);
+	ASSERT_TRUE(packed);
+
+	StubHeader header;
+	ReadPackedHeader(packed, header);
+	ASSERT_EQ(1U, header.numChunks);
+
+	// single chunk is the whole compressed stream so it can be repacked in the legacy layout: short header + compressed data
+	const auto* chunk = (const StubChunkHeader*)(packed.data() + sizeof(StubHeader));
+	const auto* compressedData = (const uint8_t*)(chunk + 1);
+	ASSERT_EQ(packed.size(), sizeof(StubHeader) + sizeof(StubChunkHeader) + chunk->compressedSize);
+
+	const auto legacyHeaderSize = offsetof(StubHeader, numChunks);
+	auto legacy = Buffer::CreateEmpty(MainPool(), legacyHeaderSize + chunk->compressedSize);
+	ASSERT_TRUE(legacy);
+
+	header.magic = StubHeader::MAGIC;
+	header.compressedCRC = CRC32().append(compressedData, chunk->compressedSize).crc();
+	memcpy(legacy.data(), &header, legacyHeaderSize);
+	memcpy(legacy.data() + legacyHeaderSize, compressedData, chunk->compressedSize);
+
+	StubFactory factory;
+	factory.registerTypeNoDestructor<TestStub>();
+
+	StubLoader loader(factory, 1);
+	const auto* loaded = (const TestStub*)loader.unpack(legacy);
+	CompareStubs(&graph.root, loaded);
+}
+
+//--
+
+END_INFERNO_NAMESPACE_EX(test)
@@ -0,0 +1,87 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+
+#include "bm/core/parser/include/jsonWriter.h"
+#include "bm/core/parser/include/jsonStreamWriter.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+static void BuildStreamSample(JSONStreamWriter& writer, BufferView blob)
+{
+    writer.beginObject();
+    writer.value("name", "test \"value\"");
+    writer.beginArray("list");
+    writer.value("a");
+    writer.value("b");
+    writer.beginObject();
+    writer.end();
+    writer.end();
+    writer.beginData("data");
+    writer.appendData(blob.subView(0, 5)); // data in uneven pieces
+    writer.appendData(blob.subView(5, blob.size() - 5));
+    writer.endData();
+    writer.end();
+}
+
+static void BuildDocumentSample(JSONWriter& doc, BufferView blob)
+{
+    doc.changeNodeType(doc.root(), JSONNodeType::Compound);
+
+    auto name = doc.createNode(doc.root());
+    doc.changeNodeName(name, "name");
+    doc.changeNodeText(name, "test \"value\"");
+
+    auto list = doc.createNode(doc.root(), JSONNodeType::Array);
+    doc.changeNodeName(list, "list");
+    doc.changeNodeText(doc.createNode(list), "a");
+    doc.changeNodeText(doc.createNode(list), "b");
+    doc.createNode(list, JSONNodeType::Compound);
+
+    auto data = doc.createNode(doc.root());
+    doc.changeNodeName(data, "data");
+    doc.changeNodeDataCopy(data, blob);
+}
+
+TEST(JSON, StreamWriterMatchesDocument)
+{
+    const uint8_t blob[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14 };
+
+    auto doc = JSONWriter::Create();
+    BuildDocumentSample(*doc, BufferView(blob, sizeof(blob)));
+
+    const PrintFlags allFlags[] = { PrintFlags(), PrintFlagBit::PrettyText, PrintFlagBit::Relaxed };
+    for (const auto flags : allFlags)
+    {
+        StringBuilder expected;
+        doc->printToText(doc->root(), expected, flags);
+
+        StringBuilder txt;
+        {
+            JSONStreamWriter writer(txt, flags);
+            BuildStreamSample(writer, BufferView(blob, sizeof(blob)));
+        }
+
+        EXPECT_STREQ(expected.c_str(), txt.c_str());
+    }
+}
+
+TEST(JSON, StreamWriterClosesOpenedScopes)
+{
+    StringBuilder txt;
+    {
+        JSONStreamWriter writer(txt);
+        writer.beginArray();
+        writer.value("x");
+        writer.beginObject();
+        EXPECT_EQ(2, writer.depth());
+    }
+
+    EXPECT_STREQ("[\"x\", {}]", txt.c_str());
+}
+
+END_INFERNO_NAMESPACE()
@@ -532,4 +532,61 @@ TEST(ComplexParser, FullTest)
     }
 }
 
+TEST(ComplexParser, BulkTokensMatchSingleTokens)
+{
+    auto lang = BuildLanguage();
+
+    auto str = "// line comment that is long enough to be scanned in bulk\n"
+        "void function VeryLongIdentifierNameThatSpansMoreThanOneBlock(int a, float b)\n"
+        "{\n"
+        "    /* block comment * with stars\n"
+        "       spanning ** multiple lines */          return new Dupa(123, \"Test string that is quite long\", 'Ident', 3.14, 0x1234);\n"
+        "}\n"
+        "                                        \t\t\t\t\t\t      x_1+y_2";
+
+    Array<FlatToken> flatTokens;
+    {
+        TextParser p(StringView(), ITextErrorReporter::GetDefault(), ITextCommentEater::StandardComments());
+        p.reset(str);
+        ASSERT_TRUE(p.parseTokens(*lang, flatTokens));
+        ASSERT_FALSE(p.hasErrors());
+    }
+
+    TextParser p(StringView(), ITextErrorReporter::GetDefault(), ITextCommentEater::StandardComments());
+    p.reset(str);
+
+    for (const auto& flat : flatTokens)
+    {
+        auto t = p.parseToken(*lang);
+        ASSERT_TRUE(t.valid());
+        ASSERT_EQ(t.type(), flat.m_type);
+        ASSERT_EQ(t.keywordID(), flat.m_keywordID);
+        ASSERT_EQ(t.view(), flat.view());
+        ASSERT_EQ(t.location().line(), flat.m_line);
+        ASSERT_EQ(t.location().charPos(), flat.m_charPos);
+    }
+
+    ASSERT_FALSE(p.parseToken(*lang).valid());
+
+    ASSERT_EQ(30, flatTokens.size());
+    ASSERT_EQ(StringView("VeryLongIdentifierNameThatSpansMoreThanOneBlock"), flatTokens[2].view());
+    ASSERT_EQ(2, flatTokens[2].m_line);
+    ASSERT_EQ(401, flatTokens[11].m_keywordID);
+    ASSERT_EQ(5, flatTokens[11].m_line);
+    ASSERT_EQ(StringView("Test string that is quite long"), flatTokens[17].view());
+    ASSERT_EQ(StringView("x_1"), flatTokens[27].view());
+    ASSERT_EQ(7, flatTokens[27].m_line);
+}
+
+TEST(ComplexParser, BulkTokensReportInvalidContent)
+{
+    auto lang = BuildLanguage();
+
+    Array<FlatToken> flatTokens;
+    TextParser p(StringView(), ITextErrorReporter::GetDevNull());
+    p.reset("a + b @ c");
+    ASSERT_FALSE(p.parseTokens(*lang, flatTokens));
+    ASSERT_EQ(3, flatTokens.size());
+}
+
 END_INFERNO_NAMESPACE()
\ No newline at end of file
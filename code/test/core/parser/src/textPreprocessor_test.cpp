@@ -6,6 +6,7 @@
 
 #include "build.h"
 #include "bm/core/parser/include/textFilePreprocessor.h"
+#include "bm/core/parser/include/textIncludeCache.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -161,11 +162,13 @@ class HelperErrorReporter : public ITextErrorReporter
 public:
     uint32_t m_numErrors = 0;
     uint32_t m_numWarnings = 0;
+    StringBuf m_lastError;
 
     virtual void reportError(const TextTokenLocation& loc, StringView message) override final
     {
         TRACE_ERROR("{}: {}", loc, message);
         m_numErrors += 1;
+        m_lastError = StringBuf(message);
     }
 
     virtual void reportWarning(const TextTokenLocation& loc, StringView message) override final
@@ -1186,4 +1189,190 @@ TEST(Preprocessor, IfDefUndef)
     EXPECT_TRUE(test.tokens().empty());
 }
 
+class TestIncluderFiles : public ITextIncludeHandler
+{
+public:
+    virtual bool loadInclude(bool global, StringView path, StringView referencePath, Buffer& outContent, StringBuf& outPath) override
+    {
+        const auto* content = m_files.find(path);
+        if (!content)
+            return false;
+
+        outContent = Buffer::CreateFromCopy(MainPool(), content->view());
+        outPath = StringBuf(path);
+        return true;
+    }
+
+    HashMap<StringBuf, StringBuf> m_files;
+};
+
+static void ExpectTokens(TokenList& tokens, std::initializer_list<const char*> expected)
+{
+    for (const auto* txt : expected)
+    {
+        auto t = tokens.popFront();
+        ASSERT_TRUE(t);
+        EXPECT_TRUE(t->view() == txt);
+    }
+
+    EXPECT_TRUE(tokens.empty());
+}
+
+TEST(Preprocessor, IncludeCacheSharedBetweenFiles)
+{
+    TestIncluderFiles includer;
+    includer.m_files["header"] = StringBuf("#ifndef HEADER\n#define HEADER\nvalue\n#endif");
+
+    TextIncludeCache cache(GetTestLanguage(), ITextCommentEater::StandardComments());
+
+    for (uint32_t i = 0; i < 2; ++i)
+    {
+        LocalAllocator allocator;
+        HelperErrorReporter errorReporter;
+        TextFilePreprocessor test(allocator, includer, errorReporter, ITextCommentEater::StandardComments(), GetTestLanguage(), &cache);
+        EXPECT_TRUE(test.processContent("first\n#include \"header\"\nlast", "TestFile"));
+        EXPECT_EQ(0, errorReporter.m_numErrors);
+        ExpectTokens(test.tokens(), { "first", "value", "last" });
+    }
+
+    EXPECT_EQ(1, cache.numMisses());
+    EXPECT_EQ(1, cache.numHits());
+}
+
+TEST(Preprocessor, IncludeCacheChangedContentIsTokenizedAgain)
+{
+    TestIncluderFiles includer;
+    TextIncludeCache cache(GetTestLanguage(), ITextCommentEater::StandardComments());
+
+    includer.m_files["header"] = StringBuf("old");
+    {
+        LocalAllocator allocator;
+        TextFilePreprocessor test(allocator, includer, ITextErrorReporter::GetDefault(), ITextCommentEater::StandardComments(), GetTestLanguage(), &cache);
+        EXPECT_TRUE(test.processContent("#include \"header\"", "TestFile"));
+        ExpectTokens(test.tokens(), { "old" });
+    }
+
+    includer.m_files["header"] = StringBuf("new");
+    {
+        LocalAllocator allocator;
+        TextFilePreprocessor test(allocator, includer, ITextErrorReporter::GetDefault(), ITextCommentEater::StandardComments(), GetTestLanguage(), &cache);
+        EXPECT_TRUE(test.processContent("#include \"header\"", "TestFile"));
+        ExpectTokens(test.tokens(), { "new" });
+    }
+
+    EXPECT_EQ(2, cache.numMisses());
+    EXPECT_EQ(1, cache.numEntries());
+}
+
+TEST(Preprocessor, IncludeCacheSkipsGuardedFile)
+{
+    TestIncluderFiles includer;
+    includer.m_files["header"] = StringBuf("#ifndef HEADER\n#define HEADER\n#ifdef OTHER\nother\n#endif\nvalue\n#endif");
+
+    TextIncludeCache cache(GetTestLanguage(), ITextCommentEater::StandardComments());
+
+    LocalAllocator allocator;
+    HelperErrorReporter errorReporter;
+    TextFilePreprocessor test(allocator, includer, errorReporter, ITextCommentEater::StandardComments(), GetTestLanguage(), &cache);
+    EXPECT_TRUE(test.processContent("#include \"header\"\n#include \"header\"\nlast", "TestFile"));
+    EXPECT_EQ(0, errorReporter.m_numErrors);
+    ExpectTokens(test.tokens(), { "value", "last" });
+}
+
+TEST(Preprocessor, IncludeCacheSkipsPragmaOnceFile)
+{
+    TestIncluderFiles includer;
+    includer.m_files["header"] = StringBuf("#pragma once\nvalue");
+
+    TextIncludeCache cache(GetTestLanguage(), ITextCommentEater::StandardComments());
+
+    LocalAllocator allocator;
+    HelperErrorReporter errorReporter;
+    TextFilePreprocessor test(allocator, includer, errorReporter, ITextCommentEater::StandardComments(), GetTestLanguage(), &cache);
+    EXPECT_TRUE(test.processContent("#include \"header\"\n#include \"header\"\nlast", "TestFile"));
+    EXPECT_EQ(0, errorReporter.m_numErrors);
+    ExpectTokens(test.tokens(), { "value", "last" });
+}
+
+TEST(Preprocessor, ProcessManyInParallel)
+{
+    TestIncluderFiles includer;
+    includer.m_files["header"] = StringBuf("#ifndef HEADER\n#define HEADER\n#if MODE > 2\nhigh\n#else\nlow\n#endif\n#endif");
+
+    TextIncludeCache cache(GetTestLanguage(), ITextCommentEater::StandardComments());
+
+    static const uint32_t NUM_JOBS = 16;
+
+    Array<UniquePtr<TextFilePreprocessorJob>> jobs;
+    Array<TextFilePreprocessorJob*> jobPtrs;
+    for (uint32_t i = 0; i < NUM_JOBS; ++i)
+    {
+        auto job = CreateUniquePtr<TextFilePreprocessorJob>();
+        job->m_content = "#include \"header\"\nMODE\n#include \"header\"";
+        job->m_contextPath = StringBuf(TempString("Permutation{}", i));
+        job->m_defines["MODE"] = StringBuf(TempString("{}", i));
+        jobPtrs.pushBack(job.get());
+        jobs.pushBack(std::move(job));
+    }
+
+    ASSERT_TRUE(TextFilePreprocessor::ProcessMany(jobPtrs, includer, ITextErrorReporter::GetDefault(), ITextCommentEater::StandardComments(), GetTestLanguage(), &cache));
+
+    for (uint32_t i = 0; i < NUM_JOBS; ++i)
+    {
+        const auto& job = jobs[i];
+        ASSERT_TRUE(job->m_valid);
+        ASSERT_TRUE(job->m_preprocessor);
+
+        auto& tokens = job->m_preprocessor->tokens();
+        ExpectTokens(tokens, { (i > 2) ? "high" : "low", TempString("{}", i).c_str() });
+    }
+
+    EXPECT_EQ(NUM_JOBS * 2, cache.numHits() + cache.numMisses());
+}
+
+TEST(Preprocessor, ObjectMacroExpandedDirectly)
+{
+    const char* code = "#define VALUE 1 + 2\n#define OTHER VALUE * 3\nVALUE OTHER";
+
+    LocalAllocator allocator;
+    HelperErrorReporter errorReporter;
+    TextFilePreprocessor test(allocator, ITextIncludeHandler::GetEmptyHandler(), errorReporter, ITextCommentEater::StandardComments(), GetTestLanguage());
+    ASSERT_TRUE(test.processContent(code, "TestFile"));
+    ExpectTokens(test.tokens(), { "1", "+", "2", "1", "+", "2", "*", "3" });
+}
+
+TEST(Preprocessor, SimpleMacroArgumentsExpanded)
+{
+    const char* code = "#define ONE 1\n#define ADD(a, b) (a + b + a)\nADD(ONE, x)";
+
+    LocalAllocator allocator;
+    HelperErrorReporter errorReporter;
+    TextFilePreprocessor test(allocator, ITextIncludeHandler::GetEmptyHandler(), errorReporter, ITextCommentEater::StandardComments(), GetTestLanguage());
+    ASSERT_TRUE(test.processContent(code, "TestFile"));
+    ExpectTokens(test.tokens(), { "(", "1", "+", "x", "+", "1", ")" });
+}
+
+TEST(Preprocessor, DefinedAfterUndef)
+{
+    const char* code = "#define X\n#undef X\n#if defined(X)\nfirst\n#else\nsecond\n#endif";
+
+    LocalAllocator allocator;
+    HelperErrorReporter errorReporter;
+    TextFilePreprocessor test(allocator, ITextIncludeHandler::GetEmptyHandler(), errorReporter, ITextCommentEater::StandardComments(), GetTestLanguage());
+    ASSERT_TRUE(test.processContent(code, "TestFile"));
+    ExpectTokens(test.tokens(), { "second" });
+}
+
+TEST(Preprocessor, ParsingErrorReportsLastValidToken)
+{
+    const char* code = "first @second";
+
+    LocalAllocator allocator;
+    HelperErrorReporter errorReporter;
+    TextFilePreprocessor test(allocator, ITextIncludeHandler::GetEmptyHandler(), errorReporter, ITextCommentEater::StandardComments(), GetTestLanguage());
+    ASSERT_FALSE(test.processContent(code, "TestFile"));
+    EXPECT_EQ(1, errorReporter.m_numErrors);
+    EXPECT_STREQ("Unable to parse text at this location: '@second', last valid token: 'first'", errorReporter.m_lastError.c_str());
+}
+
 END_INFERNO_NAMESPACE()
\ No newline at end of file
@@ -8,6 +8,9 @@
 
 #include "bm/core/parser/include/xmlReader.h"
 #include "bm/core/parser/include/xmlWriter.h"
+#include "bm/core/parser/include/xmlStreamReader.h"
+#include "bm/core/parser/include/xmlStreamWriter.h"
+#include "bm/core/file/include/fileReader.h"
 
 BEGIN_INFERNO_NAMESPACE()
 
@@ -53,6 +56,22 @@ TEST(XML, LoadFromText)
     ASSERT_TRUE(child == 0);
 }
 
+TEST(XML, LoadFromFileReader)
+{
+    auto reader = IFileReader::CreateFromBuffer(StringView(xmlSample).toBuffer());
+    ASSERT_TRUE(!!reader);
+
+    auto doc = XMLReader::LoadFromFile(ITextErrorReporter::GetDefault(), "test.xml", reader);
+    ASSERT_TRUE(!!doc);
+
+    auto root = doc->root();
+    ASSERT_EQ(StringBuf("doc"), doc->nodeName(root));
+
+    auto child = doc->firstChild(root);
+    ASSERT_TRUE(child != 0);
+    ASSERT_EQ(doc->attributeValue(child, "x"), "a");
+}
+
 TEST(XML, CreateManual)
 {
     auto doc  = XMLWriter::Create("doc");
@@ -121,4 +140,199 @@ TEST(XML, Reparse)
     ASSERT_EQ(std::string(txtA.c_str()), std::string(txtB.c_str()));
 }
 
+TEST(XML, BinaryRoundTrip)
+{
+    auto writer = XMLWriter::Create("doc");
+
+    const uint8_t blob[] = { 1, 2, 3, 4, 5, 0, 255 };
+
+    {
+        auto id = writer->createNode(writer->root(), "node");
+        writer->createAttribute(id, "x", "a");
+        writer->createAttribute(id, "y", "b");
+        writer->changeNodeText(writer->createNode(id, "text"), "hello");
+    }
+
+    {
+        auto id = writer->createNode(writer->root(), "node");
+        writer->createAttribute(id, "x", "c");
+        writer->changeNodeDataCopy(writer->createNode(id, "data"), BufferView(blob, sizeof(blob)));
+    }
+
+    auto data = writer->saveToBinaryBuffer(writer->root());
+    ASSERT_TRUE(!!data);
+
+    auto doc = XMLReader::LoadFromBuffer(ITextErrorReporter::GetDefault(), "test.binxml", data);
+    ASSERT_TRUE(!!doc);
+
+    auto root = doc->root();
+    ASSERT_EQ(StringBuf("doc"), doc->nodeName(root));
+    ASSERT_TRUE(doc->nodeParent(root) == 0);
+
+    auto child = doc->firstChild(root, "node");
+    ASSERT_TRUE(child != 0);
+    ASSERT_TRUE(doc->nodeParent(child) == root);
+    ASSERT_EQ(doc->attributeValue(child, "x"), "a");
+    ASSERT_EQ(doc->attributeValue(child, "y"), "b");
+    ASSERT_EQ(doc->nodeValueText(doc->firstChild(child, "text")), "hello");
+
+    auto attr = doc->firstAttribute(child);
+    ASSERT_EQ(doc->attributeName(attr), "x");
+    attr = doc->nextAttribute(attr);
+    ASSERT_EQ(doc->attributeName(attr), "y");
+    ASSERT_TRUE(doc->nextAttribute(attr) == 0);
+
+    child = doc->nextChild(child);
+    ASSERT_TRUE(child != 0);
+    ASSERT_EQ(doc->attributeValue(child, "x"), "c");
+    ASSERT_TRUE(doc->firstChild(child, "text") == 0);
+
+    auto value = doc->nodeValueBuffer(doc->firstChild(child, "data"));
+    ASSERT_EQ(sizeof(blob), value.size());
+    ASSERT_EQ(0, memcmp(value.data(), blob, sizeof(blob)));
+
+    ASSERT_TRUE(doc->nextChild(child) == 0);
+
+    // binary document prints the same text as the source
+    StringBuilder txtA, txtB;
+    XMLWriter::SaveToTextFile(writer, writer->root(), txtA);
+    XMLReader::SaveToTextFile(doc, doc->root(), txtB);
+    ASSERT_EQ(std::string(txtA.c_str()), std::string(txtB.c_str()));
+}
+
+static StringBuf ListStreamEvents(XMLStreamReader& reader)
+{
+    StringBuilder txt;
+    for (;;)
+    {
+        const auto ret = reader.next();
+        if (ret == XMLStreamEvent::StartElement)
+            txt.appendf("<{}:{}>", reader.name(), reader.depth());
+        else if (ret == XMLStreamEvent::Attribute)
+            txt.appendf("[{}={}]", reader.name(), reader.value());
+        else if (ret == XMLStreamEvent::Text)
+            txt.appendf("'{}'", reader.value());
+        else if (ret == XMLStreamEvent::EndElement)
+            txt.appendf("</{}>", reader.name());
+        else if (ret == XMLStreamEvent::Error)
+            txt.append("ERROR");
+        else
+            break;
+
+        if (ret == XMLStreamEvent::Error)
+            break;
+    }
+
+    return StringBuf(txt.view());
+}
+
+const char* xmlStreamSample =
+"<?xml version=\"1.0\" standalone=\"yes\"?>\n"
+"<!-- comment -->\n"
+"<doc>\n"
+"  <node x=\"a &amp; b\" y='&#65;&#x42;'>\n"
+"    <test/>\n"
+"    text &lt;here&gt;\n"
+"  </node>\n"
+"  <data><![CDATA[<raw>]]></data >\n"
+"</doc>\n";
+
+const char* xmlStreamSampleEvents = "<doc:1><node:2>[x=a & b][y=AB]<test:3></test>'\n    text <here>\n  '</node><data:2>'<raw>'</data></doc>";
+
+TEST(XML, StreamFromBuffer)
+{
+    XMLStreamReader reader(ITextErrorReporter::GetDefault(), "test.xml", StringView(xmlStreamSample).toBuffer());
+    EXPECT_STREQ(xmlStreamSampleEvents, ListStreamEvents(reader).c_str());
+    EXPECT_EQ(XMLStreamEvent::EndOfDocument, reader.next());
+}
+
+TEST(XML, StreamFromFileInSmallChunks)
+{
+    auto file = IFileReader::CreateFromBuffer(StringView(xmlStreamSample).toBuffer());
+    ASSERT_TRUE(!!file);
+
+    // chunk is smaller than some of the tokens, the window must grow
+    XMLStreamReader reader(ITextErrorReporter::GetDefault(), "test.xml", file, 4);
+    EXPECT_STREQ(xmlStreamSampleEvents, ListStreamEvents(reader).c_str());
+    EXPECT_EQ(10, reader.line());
+}
+
+TEST(XML, StreamSkipElement)
+{
+    XMLStreamReader reader(ITextErrorReporter::GetDefault(), "test.xml", StringView(xmlStreamSample).toBuffer());
+    ASSERT_EQ(XMLStreamEvent::StartElement, reader.next());
+    ASSERT_EQ(XMLStreamEvent::StartElement, reader.next());
+    ASSERT_TRUE(reader.skipElement());
+    ASSERT_EQ(XMLStreamEvent::StartElement, reader.next());
+    EXPECT_EQ(reader.name(), "data");
+}
+
+TEST(XML, StreamMismatchedTagFails)
+{
+    XMLStreamReader reader(ITextErrorReporter::GetDevNull(), "test.xml", StringView("<doc><node></doc></node>").toBuffer());
+    EXPECT_STREQ("<doc:1><node:2>ERROR", ListStreamEvents(reader).c_str());
+    EXPECT_EQ(XMLStreamEvent::Error, reader.next());
+}
+
+TEST(XML, StreamUnclosedElementFails)
+{
+    XMLStreamReader reader(ITextErrorReporter::GetDevNull(), "test.xml", StringView("<doc><node>").toBuffer());
+    EXPECT_STREQ("<doc:1><node:2>ERROR", ListStreamEvents(reader).c_str());
+}
+
+TEST(XML, StreamWriterMatchesDocument)
+{
+    const uint8_t blob[] = { 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11 };
+
+    auto doc = XMLWriter::Create("doc");
+    {
+        auto id = doc->createNode(doc->root(), "node");
+        doc->createAttribute(id, "x", "a<b");
+        doc->changeNodeText(doc->createNode(id, "text"), "hello & bye");
+        doc->createNode(id, "empty");
+        doc->changeNodeDataCopy(doc->createNode(doc->root(), "data"), BufferView(blob, sizeof(blob)));
+    }
+
+    for (uint32_t pretty = 0; pretty < 2; ++pretty)
+    {
+        const auto flags = pretty ? PrintFlags(PrintFlagBit::PrettyText) : PrintFlags();
+
+        StringBuilder expected;
+        doc->printToText(doc->root(), expected, flags);
+
+        StringBuilder txt;
+        {
+            XMLStreamWriter writer(txt, flags);
+            writer.beginNode("doc");
+            writer.beginNode("node");
+            writer.attribute("x", "a<b");
+            writer.beginNode("text");
+            writer.text("hello & bye");
+            writer.endNode();
+            writer.beginNode("empty");
+            writer.endNode();
+            writer.endNode();
+            writer.beginNode("data");
+            writer.appendData(BufferView(blob, 4)); // data in uneven pieces
+            writer.appendData(BufferView(blob + 4, 5));
+            writer.appendData(BufferView(blob + 9, 2));
+            // all nodes are closed by the writer
+        }
+
+        EXPECT_STREQ(expected.c_str(), txt.c_str());
+    }
+}
+
+TEST(XML, BinaryCorruptedDataRejected)
+{
+    auto writer = XMLWriter::Create("doc");
+    writer->createNode(writer->root(), "node");
+
+    auto data = writer->saveToBinaryBuffer(writer->root());
+    ASSERT_TRUE(!!data);
+
+    auto truncated = Buffer::CreateFromCopy(MainPool(), data.data(), data.size() - 4);
+    ASSERT_FALSE(XMLReader::LoadFromBuffer(ITextErrorReporter::GetDefault(), "test.binxml", truncated));
+}
+
 END_INFERNO_NAMESPACE()
\ No newline at end of file
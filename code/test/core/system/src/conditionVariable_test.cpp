@@ -0,0 +1,70 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "bm/core/system/include/conditionVariable.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//---
+
+TEST(ConditionVariable, WaitTimesOut)
+{
+	Mutex lock;
+	ConditionVariable cv;
+
+	auto scope = CreateLock(lock);
+	EXPECT_FALSE(cv.wait(lock, 10));
+}
+
+TEST(ConditionVariable, ProducerConsumer)
+{
+	Mutex lock;
+	ConditionVariable cv;
+	uint32_t numQueued = 0;
+	uint32_t numConsumed = 0;
+	bool finished = false;
+
+	{
+		ThreadSetup setup;
+		setup.m_function = [&]()
+		{
+			auto scope = CreateLock(lock);
+			for (;;)
+			{
+				while (!numQueued && !finished)
+					cv.waitInfinite(lock);
+
+				if (!numQueued)
+					break;
+
+				numQueued -= 1;
+				numConsumed += 1;
+			}
+		};
+
+		Thread threads[3];
+		for (uint32_t i = 0; i < 3; ++i)
+			threads[i].init(setup);
+
+		for (uint32_t i = 0; i < 10000; ++i)
+		{
+			auto scope = CreateLock(lock);
+			numQueued += 1;
+			cv.wakeOne();
+		}
+
+		auto scope = CreateLock(lock);
+		finished = true;
+		cv.wakeAll();
+	}
+
+	EXPECT_EQ(10000, numConsumed);
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
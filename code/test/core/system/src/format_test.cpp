@@ -316,6 +316,62 @@ TEST(Format, TimeIntervalPrintHours)
 	EXPECT_STREQ(printer.c_str(), "x=01:15:10;");
 }
 
+TEST(Format, FormatIntegerAllDigitCounts)
+{
+	uint64_t value = 0;
+	for (uint32_t i = 0; i < 20; ++i)
+	{
+		value = value * 10 + ((i % 9) + 1);
+
+		char expected[32];
+		snprintf(expected, sizeof(expected), "%llu", (unsigned long long)value);
+
+		StdPrinter printer;
+		printer.appendf("{}", value);
+		EXPECT_STREQ(printer.c_str(), expected);
+	}
+}
+
+TEST(Format, FormatIntegerLimits)
+{
+	StdPrinter printer;
+	printer.appendf("{};{};{}", 0, std::numeric_limits<uint64_t>::max(), -100);
+	EXPECT_STREQ(printer.c_str(), "0;18446744073709551615;-100");
+}
+
+TEST(Format, FormatPreciseFloatIsShortest)
+{
+	StdPrinter printer;
+	printer.appendf("{};{};{}", PreciseFloat(0.1f), PreciseFloat(1.0f), PreciseFloat(-2.5f));
+	EXPECT_STREQ(printer.c_str(), "0.1;1;-2.5");
+}
+
+TEST(Format, FormatPreciseDoubleIsShortest)
+{
+	StdPrinter printer;
+	printer.appendf("{};{}", PreciseDouble(0.1), PreciseDouble(1e20));
+	EXPECT_STREQ(printer.c_str(), "0.1;1e+20");
+}
+
+TEST(Format, FormatPreciseNumbersRoundTrip)
+{
+	const float floats[] = { 1.0f / 3.0f, 3.14159265f, 1e-30f, 123456.789f, std::numeric_limits<float>::max(), std::numeric_limits<float>::denorm_min() };
+	for (const auto value : floats)
+	{
+		StdPrinter printer;
+		printer.appendf("{}", PreciseFloat(value));
+		EXPECT_EQ(value, strtof(printer.c_str(), nullptr));
+	}
+
+	const double doubles[] = { 1.0 / 3.0, 3.141592653589793, 1e-300, 123456789.123456789, std::numeric_limits<double>::max(), std::numeric_limits<double>::denorm_min() };
+	for (const auto value : doubles)
+	{
+		StdPrinter printer;
+		printer.appendf("{}", PreciseDouble(value));
+		EXPECT_EQ(value, strtod(printer.c_str(), nullptr));
+	}
+}
+
 //---
 
 END_INFERNO_NAMESPACE()
\ No newline at end of file
@@ -25,7 +25,7 @@ TEST(LocklessPool, BasicTest)
 		{
 			int* items[256];
 			for (uint32_t k = 0; k < BATCH_SIZE; ++k)
-				items[i] = pool.alloc();
+				items[k] = pool.alloc();
 
 			for (uint32_t k = 0; k < BATCH_SIZE; ++k)
 				pool.free(items[k]);
@@ -33,6 +33,77 @@ TEST(LocklessPool, BasicTest)
 	}
 }
 
+TEST(LocklessPool, TryAllocFailsWhenFull)
+{
+	LockLessPoolAllocator<100, uint8_t> pool;
+
+	uint8_t index = 0;
+	for (uint32_t i = 0; i < 100; ++i)
+	{
+		ASSERT_TRUE(pool.tryAllocEntry(index));
+		EXPECT_EQ(i, index);
+	}
+
+	EXPECT_FALSE(pool.tryAllocEntry(index));
+
+	pool.freeEntry(42);
+	ASSERT_TRUE(pool.tryAllocEntry(index));
+	EXPECT_EQ(42, index);
+}
+
+TEST(LocklessPool, StressManyThreads)
+{
+	static const uint32_t POOL_SIZE = 1000;
+	static const uint32_t NUM_THREADS = 8;
+	static const uint32_t MAX_BATCH = 200;
+
+	LockLessPoolAllocator<POOL_SIZE, uint16_t> pool;
+	std::atomic<uint8_t> owned[POOL_SIZE];
+	for (auto& flag : owned)
+		flag = 0;
+
+	std::atomic<uint32_t> numDoubleAllocs = 0;
+
+	{
+		ThreadSetup setup;
+		setup.m_function = [&]()
+		{
+			uint16_t held[MAX_BATCH];
+			for (uint32_t round = 0; round < 2000; ++round)
+			{
+				const auto batchSize = 1 + ((round * 7 + Thread::CurrentThreadID()) % MAX_BATCH);
+
+				uint32_t numHeld = 0;
+				while (numHeld < batchSize && pool.tryAllocEntry(held[numHeld]))
+				{
+					if (owned[held[numHeld]].exchange(1))
+						numDoubleAllocs += 1;
+					numHeld += 1;
+				}
+
+				for (uint32_t i = 0; i < numHeld; ++i)
+				{
+					owned[held[i]] = 0;
+					pool.freeEntry(held[i]);
+				}
+			}
+		};
+
+		Thread threads[NUM_THREADS];
+		for (uint32_t i = 0; i < NUM_THREADS; ++i)
+			threads[i].init(setup);
+	}
+
+	EXPECT_EQ(0, numDoubleAllocs.load());
+
+	// nothing was lost
+	uint32_t numFree = 0;
+	uint16_t index = 0;
+	while (pool.tryAllocEntry(index))
+		numFree += 1;
+	EXPECT_EQ(POOL_SIZE, numFree);
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
\ No newline at end of file
@@ -44,6 +44,72 @@ TEST(Mutex, BasicLock)
 		threads[i].init(setup);
 }
 
+TEST(Mutex, StatsCountAcquires)
+{
+	Mutex lock;
+
+	for (uint32_t i = 0; i < 10; ++i)
+	{
+		auto scope = CreateLock(lock);
+	}
+
+	const auto stats = lock.stats();
+	EXPECT_EQ(10, stats.numAcquires);
+	EXPECT_EQ(0, stats.numContentions);
+	EXPECT_EQ(0, stats.numWaits);
+}
+
+TEST(Mutex, RecursiveLock)
+{
+	Mutex lock;
+
+	{
+		auto outer = CreateLock(lock);
+		auto inner = CreateLock(lock);
+	}
+
+	// must be fully released
+	std::atomic<bool> acquired = false;
+	{
+		ThreadSetup setup;
+		setup.m_function = [&lock, &acquired]()
+		{
+			auto scope = CreateLock(lock);
+			acquired = true;
+		};
+
+		Thread thread;
+		thread.init(setup);
+	}
+
+	EXPECT_TRUE(acquired.load());
+}
+
+TEST(Mutex, ContendedLockProtectsData)
+{
+	Mutex lock;
+	uint32_t counter = 0;
+
+	{
+		ThreadSetup setup;
+		setup.m_function = [&lock, &counter]()
+		{
+			for (uint32_t i = 0; i < 10000; ++i)
+			{
+				auto scope = CreateLock(lock);
+				counter += 1;
+			}
+		};
+
+		Thread threads[4];
+		for (uint32_t i = 0; i < 4; ++i)
+			threads[i].init(setup);
+	}
+
+	EXPECT_EQ(40000, counter);
+	EXPECT_EQ(40000, lock.stats().numAcquires);
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
\ No newline at end of file
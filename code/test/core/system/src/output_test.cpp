@@ -6,6 +6,7 @@
 
 #include "build.h"
 #include "bm/core/system/include/output.h"
+#include "bm/core/system/include/thread.h"
 
 #undef TRACE_INFO
 #define TRACE_INFO( x, ... ) TRACE_STREAM_INFO().appendf(x, ##__VA_ARGS__).append("\n");
@@ -112,6 +113,153 @@ TEST(Output, SinkHandlesLineSplitting)
 	ASSERT_EQ(2, sink.m_linesInfo.size());
 }
 
+static void PrintFromThreads(uint32_t numThreads, uint32_t numLines)
+{
+	std::vector<std::unique_ptr<Thread>> threads;
+	for (uint32_t i = 0; i < numThreads; ++i)
+	{
+		ThreadSetup setup;
+		setup.m_function = [numLines, i]()
+		{
+			for (uint32_t j = 0; j < numLines; ++j)
+				TRACE_INFO("Thread {} line {}", i, j);
+		};
+
+		threads.push_back(std::make_unique<Thread>());
+		threads.back()->init(setup);
+	}
+
+	threads.clear();
+}
+
+TEST(Output, AsyncLinesDeliveredAfterFlush)
+{
+	LocalSink sink;
+
+	Log::EnableAsync();
+	PrintFromThreads(4, 1000);
+	Log::Flush();
+
+	EXPECT_EQ(4000, sink.m_linesInfo.size());
+
+	Log::DisableAsync();
+}
+
+TEST(Output, AsyncLinesFromOneThreadKeepOrder)
+{
+	LocalSink sink;
+
+	Log::EnableAsync();
+	TRACE_INFO("First");
+	TRACE_INFO("Second");
+	TRACE_INFO("Third");
+	Log::DisableAsync();
+
+	ASSERT_EQ(3, sink.m_linesInfo.size());
+	EXPECT_STREQ("First", sink.m_linesInfo[0].c_str());
+	EXPECT_STREQ("Second", sink.m_linesInfo[1].c_str());
+	EXPECT_STREQ("Third", sink.m_linesInfo[2].c_str());
+}
+
+TEST(Output, AsyncDroppedLinesAreCounted)
+{
+	LocalSink sink;
+
+	LogAsyncSetup setup;
+	setup.m_threadBufferSize = 4096;
+	setup.m_flushInterval = 1000;
+	setup.m_overflow = LogAsyncOverflow::Drop;
+
+	const auto numDroppedBefore = Log::NumDroppedLines();
+
+	Log::EnableAsync(setup);
+	PrintFromThreads(4, 1000);
+	Log::DisableAsync();
+
+	const auto numDropped = Log::NumDroppedLines() - numDroppedBefore;
+	EXPECT_EQ(4000, sink.m_linesInfo.size() + numDropped);
+}
+
+TEST(Output, AsyncBufferSizeChangeAppliesToExistingThreads)
+{
+	LocalSink sink;
+
+	LogAsyncSetup smallSetup;
+	smallSetup.m_threadBufferSize = 4096;
+	smallSetup.m_overflow = LogAsyncOverflow::Drop;
+
+	Log::EnableAsync(smallSetup);
+	TRACE_INFO("Small buffer");
+	Log::DisableAsync();
+
+	LogAsyncSetup bigSetup;
+	bigSetup.m_threadBufferSize = 1 << 20;
+	bigSetup.m_flushInterval = 1000;
+	bigSetup.m_overflow = LogAsyncOverflow::Drop;
+
+	const auto numDroppedBefore = Log::NumDroppedLines();
+
+	// all lines fit only in the bigger buffer
+	Log::EnableAsync(bigSetup);
+	for (uint32_t i = 0; i < 1000; ++i)
+		TRACE_INFO("Line {}", i);
+	Log::DisableAsync();
+
+	EXPECT_EQ(numDroppedBefore, Log::NumDroppedLines());
+	EXPECT_EQ(1001, sink.m_linesInfo.size());
+}
+
+TEST(Output, AsyncLongLineIsNotTruncated)
+{
+	LocalSink sink;
+
+	LogAsyncSetup setup;
+	setup.m_threadBufferSize = 4096;
+
+	const std::string longLine(3000, 'x');
+
+	Log::EnableAsync(setup);
+	TRACE_INFO("Before");
+	Log::Print(LogOutputLevel::Info, __FILE__, __LINE__, longLine.c_str());
+	TRACE_INFO("After");
+	Log::DisableAsync();
+
+	ASSERT_EQ(3, sink.m_linesInfo.size());
+	EXPECT_STREQ("Before", sink.m_linesInfo[0].c_str());
+	EXPECT_EQ(longLine, sink.m_linesInfo[1]);
+	EXPECT_STREQ("After", sink.m_linesInfo[2].c_str());
+}
+
+class EchoFatalSink : public LocalSink
+{
+public:
+	std::vector<std::string> m_linesFatal;
+
+	virtual bool print(LogOutputLevel level, const char* file, uint32_t line, const char* text) override
+	{
+		if (level == LogOutputLevel::Fatal)
+			m_linesFatal.push_back(text);
+		else if (level == LogOutputLevel::Info)
+			Log::Print(LogOutputLevel::Fatal, file, line, "Echo");
+
+		return LocalSink::print(level, file, line, text);
+	}
+};
+
+TEST(Output, AsyncSinkCanPrintFatalWhileDraining)
+{
+	EchoFatalSink sink;
+
+	Log::EnableAsync();
+	TRACE_INFO("Ping");
+	Log::Flush();
+	Log::DisableAsync();
+
+	ASSERT_EQ(1, sink.m_linesInfo.size());
+	ASSERT_EQ(1, sink.m_linesFatal.size());
+	EXPECT_STREQ("Echo", sink.m_linesFatal[0].c_str());
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
\ No newline at end of file
@@ -0,0 +1,94 @@
+/***
+* Inferno Engine v4
+* Written by Tomasz Jonarski (RexDex)
+* Source code licensed under LGPL 3.0 license
+***/
+
+#include "build.h"
+#include "bm/core/system/include/readWriteLock.h"
+
+BEGIN_INFERNO_NAMESPACE()
+
+//---
+
+TEST(RWLock, SharedLockAllowsManyReaders)
+{
+	RWLock lock;
+
+	lock.acquireShared();
+	lock.acquireShared();
+	lock.releaseShared();
+	lock.releaseShared();
+
+	lock.acquireExclusive();
+	lock.releaseExclusive();
+
+	EXPECT_EQ(1, lock.stats().numExclusiveAcquires);
+}
+
+TEST(RWLock, ScopeLockReleasesBothSides)
+{
+	RWLock lock;
+
+	{
+		auto scope = CreateLock(lock.exclusive());
+	}
+
+	{
+		auto scope = CreateLock(lock.shared());
+	}
+
+	{
+		auto scope = CreateLock(lock.exclusive());
+	}
+
+	EXPECT_EQ(2, lock.stats().numExclusiveAcquires);
+}
+
+TEST(RWLock, ReadersNeverSeePartialWrites)
+{
+	RWLock lock;
+	uint32_t valueA = 0;
+	uint32_t valueB = 0;
+	std::atomic<uint32_t> numErrors = 0;
+
+	{
+		ThreadSetup readerSetup;
+		readerSetup.m_function = [&]()
+		{
+			for (uint32_t i = 0; i < 10000; ++i)
+			{
+				auto scope = CreateLock(lock.shared());
+				if (valueA != valueB)
+					numErrors += 1;
+			}
+		};
+
+		ThreadSetup writerSetup;
+		writerSetup.m_function = [&]()
+		{
+			for (uint32_t i = 0; i < 5000; ++i)
+			{
+				auto scope = CreateLock(lock.exclusive());
+				valueA += 1;
+				Thread::YieldThread();
+				valueB += 1;
+			}
+		};
+
+		Thread threads[6];
+		for (uint32_t i = 0; i < 4; ++i)
+			threads[i].init(readerSetup);
+		threads[4].init(writerSetup);
+		threads[5].init(writerSetup);
+	}
+
+	EXPECT_EQ(0, numErrors.load());
+	EXPECT_EQ(10000, valueA);
+	EXPECT_EQ(10000, valueB);
+	EXPECT_EQ(10000, lock.stats().numExclusiveAcquires);
+}
+
+//--
+
+END_INFERNO_NAMESPACE()
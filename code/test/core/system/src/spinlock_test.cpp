@@ -43,6 +43,31 @@ TEST(SpinLock, BasicLock)
 		threads[i].init(setup);
 }
 
+TEST(SpinLock, StressManyThreads)
+{
+	SpinLock lock;
+	uint32_t counter = 0;
+
+	{
+		ThreadSetup setup;
+		setup.m_function = [&lock, &counter]()
+		{
+			for (uint32_t i = 0; i < 100000; ++i)
+			{
+				lock.acquire();
+				counter += 1;
+				lock.release();
+			}
+		};
+
+		Thread threads[8];
+		for (uint32_t i = 0; i < 8; ++i)
+			threads[i].init(setup);
+	}
+
+	EXPECT_EQ(800000, counter);
+}
+
 //--
 
 END_INFERNO_NAMESPACE()
\ No newline at end of file